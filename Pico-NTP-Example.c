@@ -46,6 +46,7 @@
 
 #include "Pico-WiFi-Module.h"
 #include "Pico-NTP-Module.h"
+/// #include "ntp-ds3231.h"
 
 
 
@@ -67,11 +68,7 @@
 /* ============================================================================================================================================================= *\
                                                              Global variables declaration / definition.
 \* ============================================================================================================================================================= */
-/* Complete day names. */
-extern UCHAR DayName[7][13];
-
-/* Short month names (3-letters). */
-extern UCHAR ShortMonth[13][4];
+/* Day and month names are retrieved with ntp_get_day_name() and ntp_get_short_month() (see ntp_set_language()). */
 
 
 
@@ -109,6 +106,7 @@ int main()
 #endif  // RELEASE_VERSION
 
   UCHAR PicoUniqueId[25];
+  UCHAR String[64];               // date and time formatted by ntp_format().
 
   UINT8 Delay;
   UINT8 FlagTimeSet;
@@ -117,10 +115,17 @@ int main()
 
   UINT16 Loop1UInt16;
 
+  UINT32 Microseconds;            // sub-second part of the time read from Pico's RTC.
+
   UINT64 UTCTime;                 // locally keep track of UTC time.
 
   struct human_time HumanTime;    // structure to contain time stamp under "human" format instead of "tm" standard.
+  struct ntp_format DateFormat;   // date and time template, compiled once by ntp_format_compile().
   struct struct_ntp StructNTP;
+  struct ntp_status NTPStatus;    // clock quality returned by ntp_get_status().
+  /// struct ntp_ds3231 Ds3231;      // DS3231 holdover clock driver.
+  /// struct ntp_holdover Holdover;  // holdover clock interface.
+  /// static struct ntp_adev Adev;   // frequency stability analyzer (Allan deviation of the crystal).
   struct struct_wifi StructWiFi;
 
   /* Real-time clock variable. */
@@ -218,7 +223,40 @@ int main()
     StructNTP.FlagInit    = FLAG_OFF;                // will be automatically turned On when ntp_init() is called successfully.
     StructNTP.DSTCountry  = DST_COUNTRY;             // origin country (see User Guide for details).
     StructNTP.DeltaTime   = DELTA_TIME;              // time difference between UTC time and local time (always as of winter - "normal" - time).
+    StructNTP.LeapMode    = NTP_LEAP_SMEAR;          // spread leap seconds over 24 hours (NTP_LEAP_STEP to hold the clock during the leap second).
+    StructNTP.AuthKeyId   = 0;                       // no NTP authentication (see ntp_auth_add_key() to use a symmetric key with a private NTP server).
     ntp_init(&StructNTP);
+    ntp_set_language(ENGLISH);                       // day and month names (ENGLISH, CZECH, FRENCH, GERMAN, ITALIAN or SPANISH) may be changed at any time.
+
+    /* Optional: uncomment to timestamp NTP requests and replies at the Wi-Fi chip rather than when lwIP gets to them (more accurate round-trip delay). */
+    /// ntp_capture_init(&StructNTP);
+
+    /* Optional: uncomment to use NTP interleaved mode with servers supporting it, e.g. chrony (the server transmit timestamp is then more accurate). */
+    /// ntp_interleave_init(&StructNTP);
+
+    /* Optional: uncomment to discipline the clock from an NTP server broadcasting or multicasting time on the LAN (no request sent once calibrated).
+       Broadcasts must be authenticated: set AuthKeyId above and add the key with ntp_auth_add_key() first. */
+    /// ntp_broadcast_init(&StructNTP);
+
+    /* Optional: uncomment to compensate the crystal for temperature between syncs (better holdover, NTP_REFRESH may then be increased). */
+    /// adc_init();  // the ADC is left to the application: ntp_tempco_init() only enables the temperature sensor.
+    /// ntp_tempco_init(&StructNTP);  // the sensor is then read by ntp_observer_dispatch() in the main loop below.
+
+    /* Optional PPS input from a GPS receiver: uncomment and specify the GPIO where the PPS signal is connected. */
+    /// ntp_pps_init(&StructNTP, 22);
+
+    /* Optional DS3231 holdover clock: uncomment to get time right away at power-up and to keep it through long Wi-Fi outages (I2C bus must be initialized first). */
+    /// ntp_ds3231_init(&Ds3231, &Holdover, i2c0);
+    /// ntp_holdover_init(&StructNTP, &Holdover);
+
+    /* Optional burn-in test: uncomment to measure the frequency stability of the crystal (PPS edges if any, else an NTP request every 64 seconds, see ntp_get_stability()). */
+    /// ntp_adev_init(&StructNTP, &Adev, 64);
+
+    /* Optional field trace: uncomment to record every NTP exchange and clock input (sent to the monitor below, replay them with ntp-replay on the PC). */
+    /// ntp_trace_enable(NTP_TRACE_EXCHANGE | NTP_TRACE_CLOCK);
+
+    /* Optional time service on core 1: uncomment to let core 1 handle NTP cycles and module alarms (then only wait for StructNTP.FlagSuccess below, without calling ntp_get_time()). */
+    /// ntp_core1_start(&StructNTP, NULL);
 
 
     /* Set DST parameters. */
@@ -266,6 +304,10 @@ int main()
           /* Display Unix time received from NTP server. */
           if (stdio_usb_connected()) log_info(__LINE__, __func__, "Current Unix time returned from NTP server: %llu\r", StructNTP.UTCTime);
 
+          /* Display clock quality. */
+          ntp_get_status(&StructNTP, &NTPStatus);
+          if (stdio_usb_connected()) log_info(__LINE__, __func__, "Clock maximum error: %lu usec   Stratum: %u   Leap indicator: %u\r", NTPStatus.MaxError, NTPStatus.Stratum, NTPStatus.LeapIndicator);
+
           if (FlagLocalDebug)
           {
             log_info(__LINE__, __func__, "\r\r\r\r");
@@ -331,21 +373,13 @@ ByPass1:
   /* --------------------------------------------------------------------------------------------------------------------------- *\
                                                 Initialize Pico's real-time clock.
   \* --------------------------------------------------------------------------------------------------------------------------- */
-  /* Prepare Pico's real-time clock variable with values retrieved from NTP server. */
-  DateTime.dotw  = StructNTP.HumanTime.DayOfWeek;
-  DateTime.day   = StructNTP.HumanTime.DayOfMonth;
-  DateTime.month = StructNTP.HumanTime.Month;
-  DateTime.year  = StructNTP.HumanTime.Year;
-  DateTime.hour  = StructNTP.HumanTime.Hour;
-  DateTime.min   = StructNTP.HumanTime.Minute;
-  DateTime.sec   = StructNTP.HumanTime.Second;
-
+  /* Let the NTP module program Pico's real-time clock on the next second boundary, and keep it aligned after each NTP sync. */
   log_info(__LINE__, __func__, "Setting Pico's real-time clock with those parameters:\r");
-  log_info(__LINE__, __func__, "%s %u-%s-%4.4u   %2.2u:%2.2u:%2.2u\r", DayName[DateTime.dotw], DateTime.day, ShortMonth[DateTime.month], DateTime.year, DateTime.hour, DateTime.min, DateTime.sec);
+  if (ntp_format_compile(&DateFormat, "%A %e-%b-%Y   %H:%M:%S") != NTP_FORMAT_OK) log_info(__LINE__, __func__, "Date and time template is too long.\r");
+  ntp_format(String, sizeof(String), &DateFormat, &StructNTP.HumanTime);
+  log_info(__LINE__, __func__, "%s\r", String);
 
-  rtc_init();
-  rtc_set_datetime(&DateTime);  // set current time on Pico's RTC.
-  sleep_ms(5000);                // let some time for the real-time clock to be updated.
+  ntp_rtc_init(&StructNTP);
   log_info(__LINE__, __func__, "DST start time for %4.4u: %llu\r",        StructNTP.HumanTime.Year, StructNTP.DSTStart);
   log_info(__LINE__, __func__, "DST end   time for %4.4u: %llu\r",        StructNTP.HumanTime.Year, StructNTP.DSTEnd);
 
@@ -359,10 +393,18 @@ ByPass1:
   while (1)
   {
     /* Display real-time clock on monitor screen. */
-    rtc_get_datetime(&DateTime);  // retrieve current time from Pico's RTC.
-    printf("Current date and time: %s %u-%s-%4.4u   %2.2u:%2.2u:%2.2u\r", DayName[DateTime.dotw], DateTime.day, ShortMonth[DateTime.month], DateTime.year, DateTime.hour, DateTime.min, DateTime.sec);
+    Microseconds = ntp_rtc_now(&StructNTP, &DateTime);  // retrieve current time from Pico's RTC.
+    if (Microseconds != NTP_RTC_INVALID)
+      printf("Current date and time: %s %u-%s-%4.4u   %2.2u:%2.2u:%2.2u.%3.3lu\r", ntp_get_day_name(DateTime.dotw), DateTime.day, ntp_get_short_month(DateTime.month), DateTime.year, DateTime.hour, DateTime.min, DateTime.sec, (Microseconds / 1000));
     sleep_ms(900);
 
+    /* Send NTP module events (NTP replies, clock steps, RTC alignments, etc.) to the monitor. Decode them with ntp-log-decode on the PC. */
+    ntp_log_drain(16);
+    /// ntp_trace_drain(8);
+
+    /* Call functions registered with ntp_observer_add() for clock steps, DST changes, etc. that happened since last loop. */
+    ntp_observer_dispatch(&StructNTP);
+
     /* If user pressed <ESC>, switch Pico in upload mode. */
     if (getchar_timeout_us(100) == 0x1B)
     {
@@ -393,7 +435,7 @@ void display_human_time(UCHAR *Text, struct human_time *HumanTime)
   if ((HumanTime->Month < 1) || (HumanTime->Month > 12)) FlagValid = FLAG_OFF;
 
   if (FlagValid == FLAG_ON)
-    log_info(__LINE__, __func__, "%s %8s   %2.2u-%3s-%4u   %2.2u:%2.2u:%2.2u   (DoY: %3u   DST: 0x%2.2X)\r\r", Text, DayName[HumanTime->DayOfWeek], HumanTime->DayOfMonth, ShortMonth[HumanTime->Month], HumanTime->Year, HumanTime->Hour, HumanTime->Minute, HumanTime->Second, HumanTime->DayOfYear, HumanTime->FlagDst);
+    log_info(__LINE__, __func__, "%s %8s   %2.2u-%3s-%4u   %2.2u:%2.2u:%2.2u   (DoY: %3u   DST: 0x%2.2X)\r\r", Text, ntp_get_day_name(HumanTime->DayOfWeek), HumanTime->DayOfMonth, ntp_get_short_month(HumanTime->Month), HumanTime->Year, HumanTime->Hour, HumanTime->Minute, HumanTime->Second, HumanTime->DayOfYear, HumanTime->FlagDst);
   else
     log_info(__LINE__, __func__, "%s DoW:%u   %2.2u-%2.2u-%4u   %2.2u:%2.2u:%2.2u   (DoY: %3u   DST: %2.2X)\r\r", Text, HumanTime->DayOfWeek, HumanTime->DayOfMonth, HumanTime->Month, HumanTime->Year, HumanTime->Hour, HumanTime->Minute, HumanTime->Second, HumanTime->DayOfYear, HumanTime->FlagDst);
 
@@ -8,9 +8,9 @@
    Pico-NTP-Module.c
    St-Louys, Andre - January 2024
    astlouys@gmail.com
-   Revision 18-APR-2025
+   Revision 18-OCT-2026
    Language: C
-   Version 4.00
+   Version 4.10
 
    REVISION HISTORY:
    =================
@@ -21,6 +21,7 @@
    07-FEB-2025 4.00 - Add integrated support for daylight saving time.
                     - Make StructNTP a member of function arguments so that it can be declared in the parent C module.
                     - Debug automatic handling of daylight saving time.
+   18-OCT-2026 4.10 - Add optional symmetric key authentication (MD5 / SHA-1 MAC) of NTP requests and replies.
 \* ============================================================================================================================================================= */
 
 #define RELEASE_VERSION  ///
@@ -32,8 +33,16 @@
 #endif  // RELEASE_VERSION
 
 
+#include "hardware/adc.h"
 #include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/rtc.h"
+#include "hardware/sync.h"
+#include "lwip/dhcp.h"
 #include "lwip/dns.h"
+#include "lwip/igmp.h"
+#include "lwip/mld6.h"
+#include "pico/multicore.h"
 #include <pico/stdio_usb.h>
 #include "Pico-NTP-Module.h"
 #include <string.h>
@@ -46,17 +55,116 @@
 /* ============================================================================================================================================================= *\
                                                                       Static function prototypes.
 \* ============================================================================================================================================================= */
+/* Discipline the clock with a broadcast (mode 5) NTP packet. */
+static void ntp_broadcast_recv(struct struct_ntp *StructNTP, const ip_addr_t *IPAddress, const UINT8 *Packet, const struct ntp_packet *Info);
+
+/* Return the address family of an NTP request sent to the Wi-Fi chip (NTP_FAMILY_NONE if not an NTP request). */
+static UINT8 ntp_capture_get_family(struct pbuf *p);
+
+/* GPIO interrupt handler timestamping CYW43 interrupts. */
+static void ntp_capture_irq(void);
+
+/* Link output function of the Wi-Fi interface, timestamping NTP requests. */
+static err_t ntp_capture_linkoutput(struct netif *Netif, struct pbuf *p);
+
+/* Time service running on core 1. */
+static void ntp_core1_main(void);
+
 /* Callback with a DNS result. */
 static void ntp_dns_found(const char *HostName, const ip_addr_t *ipaddr, void *ExtraArgument);
 
 /* NTP request failed. */
 static int64_t ntp_failed_handler(alarm_id_t id, void *ExtraArgument);
 
+/* Return the address families (bit mask) still waiting for a DNS answer or an NTP reply. */
+static UINT8 ntp_family_pending(struct struct_ntp *StructNTP);
+
+/* Select the address family with the shortest round-trip delay. */
+static void ntp_family_select(struct struct_ntp *StructNTP);
+
+/* Feed the time read from the holdover clock to the disciplined clock while NTP is unreachable. */
+static void ntp_holdover_feed(struct struct_ntp *StructNTP);
+
+/* Write current time to the holdover clock on the next UTC second boundary. */
+static void ntp_holdover_write(struct struct_ntp *StructNTP);
+
+/* Return UTC time adjusted for a pending leap second. */
+static INT64 ntp_leap_adjust(INT8 LeapPending, UINT8 LeapMode, INT64 LeapTime, INT64 UTCTime);
+
+/* Complete leap second processing once the leap second is over. */
+static void ntp_leap_apply(struct struct_ntp *StructNTP, UINT64 LocalTime);
+
+/* Alarm callback to complete leap second processing. */
+static int64_t ntp_leap_handler(alarm_id_t AlarmId, void *ExtraArgument);
+
+/* Return the continuous time of the disciplined clock at which UTC time adjusted for a pending leap second reaches the time given. */
+static INT64 ntp_leap_unadjust(INT8 LeapPending, UINT8 LeapMode, INT64 LeapTime, INT64 UTCTime);
+
+/* Arm or cancel leap second processing, depending on leap indicator received. */
+static void ntp_leap_update(struct struct_ntp *StructNTP, UINT8 LeapIndicator, INT64 UTCTime);
+
+/* Queue a notification for ntp_observer_dispatch(). */
+static void ntp_observer_post(struct struct_ntp *StructNTP, UINT8 Type, INT64 Value);
+
+/* GPIO interrupt handler for PPS input. */
+static void ntp_pps_irq(void);
+
 /* NTP data received. */
 static void ntp_recv(void *ExtraArgument, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port);
 
+/* Use a valid exchange with the NTP server: round-trip delay of its address family and discipline of the clock. */
+static void ntp_reply_use(struct struct_ntp *StructNTP, struct ntp_family *Family, const struct ntp_packet *Info, const struct ntp_exchange *Exchange, INT64 ServerTime, UINT8 FlagPps, UINT8 FlagInterleaved);
+
 /* Make an NTP request. */
-static void ntp_request(struct struct_ntp *StructNTP);
+static void ntp_request(struct struct_ntp *StructNTP, struct ntp_family *Family);
+
+/* Schedule programming of Pico's real-time clock on the next second boundary. */
+static void ntp_rtc_align(struct struct_ntp *StructNTP);
+
+/* Return current local time (in usec since 01-JAN-1970) from the disciplined clock. */
+static INT64 ntp_rtc_get_local_us(struct struct_ntp *StructNTP);
+
+/* Alarm callback programming Pico's real-time clock. */
+static int64_t ntp_rtc_handler(alarm_id_t AlarmId, void *ExtraArgument);
+
+/* Measure the drift of Pico's real-time clock and re-align it if required, after an NTP sync. */
+static void ntp_rtc_update(struct struct_ntp *StructNTP);
+
+/* Alarm callback of an event scheduled by ntp_schedule_at(). */
+static int64_t ntp_schedule_handler(alarm_id_t AlarmId, void *ExtraArgument);
+
+/* Map pending scheduled events again onto the Pico timer after an update of the disciplined clock. */
+static void ntp_schedule_remap(struct struct_ntp *StructNTP);
+
+/* Publish a copy of the disciplined clock for readers on the other core. */
+static void ntp_snapshot_publish(struct struct_ntp *StructNTP);
+
+/* Copy the disciplined clock published by the other core. */
+static void ntp_snapshot_read(struct struct_ntp *StructNTP, struct ntp_snapshot *Snapshot);
+
+/* Return the temperature (in 1/1000 degree C) of the RP2040 on-chip temperature sensor. */
+static INT32 ntp_tempco_read(void);
+
+/* Read the temperature of the crystal when due, feed the change of frequency forward and fit the temperature model, outside ClockLock. */
+static void ntp_tempco_update(struct struct_ntp *StructNTP);
+
+/* Write a trace record for an input of the disciplined clock other than an NTP reply. */
+static void ntp_trace_clock(struct struct_ntp *StructNTP, UINT8 Type, UINT8 Flags, UINT8 Source, UINT64 LocalTime, INT64 Value);
+
+/* Write a trace record for an NTP exchange. */
+static void ntp_trace_exchange(struct struct_ntp *StructNTP, UINT8 Type, UINT8 Status, UINT8 Flags, const ip_addr_t *IPAddress, const struct ntp_packet *Info, const struct ntp_exchange *Exchange);
+
+/* Write a trace record, preceded by a snapshot of the disciplined clock when one is due. */
+static void ntp_trace_put(struct struct_ntp *StructNTP, UINT8 Category, struct ntp_trace_record *Record);
+
+/* Insert a job in the slot of the timer wheel corresponding to its next fire time. */
+static void ntp_wheel_insert(struct ntp_wheel *Wheel, struct ntp_job *Job);
+
+/* Return the first UTC time (in seconds since 01-JAN-1970) after the one given when a job must run. */
+static INT64 ntp_wheel_next(struct ntp_wheel *Wheel, struct ntp_job *Job, INT64 UTCTime);
+
+/* Schedule all jobs of a calendar timer wheel again from the UTC time given (in seconds since 01-JAN-1970). */
+static void ntp_wheel_restart(struct ntp_wheel *Wheel, INT64 UTCTime);
 
 
 
@@ -65,161 +173,154 @@ static void ntp_request(struct struct_ntp *StructNTP);
 /* ============================================================================================================================================================= *\
                                                                             Global variables.
 \* ============================================================================================================================================================= */
-/* Daylight saving time (DST) parameters for all countries of the world (or almost). */
-struct dst_parameters
-{
-  UINT8  StartMonth;
-  UINT8  StartDayOfWeek;
-  int8_t StartDayOfMonthLow;
-  int8_t StartDayOfMonthHigh;
-  UINT8  StartHour;
-  UINT16 StartDayOfYear;
-  UINT8  EndMonth;
-  UINT8  EndDayOfWeek;
-  int8_t EndDayOfMonthLow;
-  int8_t EndDayOfMonthHigh;
-  UINT8  EndHour;
-  UINT16 EndDayOfYear;
-  UINT8  ShiftMinutes;
-}DstParameters[25];
-
-struct dst_parameters DstParameters[25] =
-{
-  { 0,  0,  0,  0, 24,  0,  0,  0,  0,  0,  0,  0, 60},  //  0 - Dummy
-  {10,  0,  1,  7,  2,  0,  4,  0,  1,  7,  3,  0, 60},  //  1 - Australia
-  {10,  0,  1,  7,  2,  0,  4,  0,  1,  7,  2,  0, 30},  //  2 - Australia-Howe
-  { 9,  6,  1,  7, 24,  0,  4,  6,  1,  7, 24,  0, 60},  //  3 - Chile           (StartHour and EndHour changes at 24h00, will change at 00h00 the day after)
-  { 3,  0,  8, 14,  0,  0, 11,  0,  1,  7,  1,  0, 60},  //  4 - Cuba
-  { 3,  0, 25, 31,  1,  0, 10,  0, 25, 31,  1,  0, 60},  //  5 - European Union  (StartHour and EndHour are based on UTC time)
-  { 3,  5, 23, 29,  2,  0, 10,  0, 25, 31,  2,  0, 60},  //  6 - Israel
-  { 3,  0, 25, 31,  0,  0, 10,  0, 25, 31,  0,  0, 60},  //  7 - Lebanon
-  { 3,  0, 25, 31,  2,  0, 10,  0, 25, 31,  3,  0, 60},  //  8 - Moldova
-  { 9,  0, 24, 30,  2,  0,  4,  0,  1,  7,  2,  0, 60},  //  9 - New-Zealand     (StartHour and EndHour are based on UTC time)
-  { 3,  0,  8, 14,  2,  0, 11,  0,  1,  7,  2,  0, 60},  // 10 - North America
-  { 3,  6, 24, 30,  2,  0, 10,  6, 24, 30,  2,  0, 60},  // 11 - Palestine
-  {10,  0,  1,  7,  0,  0,  3,  0, 22, 28,  0,  0, 60},  // 12 - Paraguay
-};
-// #define MAX_DST_COUNTRIES 12 must be adjusted in Pico-NTP-Module.h if we add more countries.
+/* NTP structure to be disciplined by PPS edges (the GPIO interrupt handler doesn't receive any argument). */
+static struct struct_ntp *PpsStructNTP = NULL;
 
 
-/* NOTE: Variables below are defined in a language file. To add a new language, see how French and English variables are defined in language files. */
-/* ------------------------------------------------------------------------------------------------------------------------------------------------ */
-/* Complete month names. */
-UCHAR MonthName[13][13] =
-{
-  {" "}, {$JANUARY}, {$FEBRUARY}, {$MARCH}, {$APRIL}, {$MAY}, {$JUNE}, {$JULY}, {$AUGUST}, {$SEPTEMBER}, {$OCTOBER}, {$NOVEMBER}, {$DECEMBER}
-};
+/* NTP structure whose requests and replies are timestamped at the Wi-Fi chip, and original link output function of the Wi-Fi interface (see ntp_capture_init()). */
+static struct struct_ntp *CaptureStructNTP = NULL;
+static netif_linkoutput_fn CaptureLinkOutput = NULL;
 
-/* Short month names (3 letters). */
-UCHAR ShortMonth[13][4] =
-{
-  {" "}, {$JAN}, {$FEB}, {$MAR}, {$APR}, {$MAY}, {$JUN}, {$JUL}, {$AUG}, {$SEP}, {$OCT}, {$NOV}, {$DEC}
-};
 
-/* Complete day names. */
-UCHAR DayName[7][13] =
-{
-  {$SUNDAY}, {$MONDAY}, {$TUESDAY}, {$WEDNESDAY}, {$THURSDAY}, {$FRIDAY}, {$SATURDAY}
-};
+/* Hardware spin lock protecting the disciplined clock, the leap second parameters and their published snapshot: the clock is updated from lwIP
+   callbacks on core 0 and from PPS, alarm and time service code that may run on core 1, where disabling interrupts doesn't help (claimed by ntp_init()).
+   It is taken before ScheduleLock and NotifyLock when they are needed together. */
+static spin_lock_t *ClockLock = NULL;
 
-/* Short - 3-letters - day names. */
-UCHAR ShortDay[7][4] =
-{
-  {$SUN}, {$MON}, {$TUE}, {$WED}, {$THU}, {$FRI}, {$SAT}
-};
 
-/* Complete month names. */
-/// const UCHAR MonthName[13][13] =
-/// {
-///   {" "}, {"January"}, {"February"}, {"March"}, {"April"}, {"May"}, {"June"}, {"July"}, {"August"}, {"September"}, {"October"}, {"November"}, {"December"}
-/// };
+/* Hardware spin lock protecting the events scheduled by ntp_schedule_at(), which may be used from both cores (claimed by ntp_init()). */
+static spin_lock_t *ScheduleLock = NULL;
 
-/* Short - 3-letters - month names. */
-/// const UCHAR ShortMonth[13][4] =
-/// {
-///   {" "}, {"JAN"}, {"FEB"}, {"MAR"}, {"APR"}, {"MAY"}, {"JUN"}, {"JUL"}, {"AUG"}, {"SEP"}, {"OCT"}, {"NOV"}, {"DEC"}
-/// };
 
-/* Complete day names. */
-/// UCHAR DayName[7][13] =
-/// {
-///   {"Sunday"}, {"Monday"}, {"Tuesday"}, {"Wednesday"}, {"Thursday"}, {"Friday"}, {"Saturday"}
-/// };
+/* Hardware spin lock protecting the queue of notifications to observers, which may be filled from an interrupt or from the other core (claimed by ntp_init()). */
+static spin_lock_t *NotifyLock = NULL;
 
-/* Short - 3-letters - day names. */
-/// const UCHAR ShortDay[7][4] =
-/// {
-///   {"SUN"}, {"MON"}, {"TUE"}, {"WED"}, {"THU"}, {"FRI"}, {"SAT"}
-/// };
 
+/* NTP servers advertised by the DHCP server (option 42, see dhcp_set_ntp_servers()). */
+static ip_addr_t DhcpServers[LWIP_DHCP_MAX_NTP_SERVERS];
+static volatile UINT8 DhcpServerCount = 0;
+static volatile UINT8 DhcpSequence    = 0;  // incremented each time the DHCP server advertises a different list of NTP servers.
 
-/// struct struct_ntp StructNTP;
 
+/* Hour display mode used by the %K specification of ntp_format() (see ntp_format_set_hour_mode()). */
+static UINT8 FormatHourMode = H24;
 
 
+/* Day and month names for all languages, in flash. Each language file is included in turn to build its own table (see ntp-lang-undef.h).
+   NOTE: Language tables must remain in the same order as language definitions in Pico-NTP-Module.h. To add a new language, create a new
+         language file (see ntp-lang-english.h) and add it below (NTP_LANGUAGE_NAMES is defined in ntp-format.h). */
+#include "ntp-lang-english.h"
+static const UCHAR *const NamesEnglish[NTP_NAME_COUNT] = NTP_LANGUAGE_NAMES;
+#include "ntp-lang-undef.h"
 
+#include "ntp-lang-czech.h"
+static const UCHAR *const NamesCzech[NTP_NAME_COUNT] = NTP_LANGUAGE_NAMES;
+#include "ntp-lang-undef.h"
 
-/* $PAGE */
-/* $TITLE=ntp_convert_human_to_tm() */
-/* ============================================================================================================================================================= *\
-                                                                  Convert "HumanTime" to "tm_time".
-\* ============================================================================================================================================================= */
-void ntp_convert_human_to_tm(struct human_time *HumanTime, struct tm *TmTime)
+#include "ntp-lang-french.h"
+static const UCHAR *const NamesFrench[NTP_NAME_COUNT] = NTP_LANGUAGE_NAMES;
+#include "ntp-lang-undef.h"
+
+#include "ntp-lang-german.h"
+static const UCHAR *const NamesGerman[NTP_NAME_COUNT] = NTP_LANGUAGE_NAMES;
+#include "ntp-lang-undef.h"
+
+#include "ntp-lang-italian.h"
+static const UCHAR *const NamesItalian[NTP_NAME_COUNT] = NTP_LANGUAGE_NAMES;
+#include "ntp-lang-undef.h"
+
+#include "ntp-lang-spanish.h"
+static const UCHAR *const NamesSpanish[NTP_NAME_COUNT] = NTP_LANGUAGE_NAMES;
+#include "ntp-lang-undef.h"
+
+static const UCHAR *const *const LanguageTable[LANGUAGE_HI_LIMIT + 1] =
 {
-  TmTime->tm_mday  = HumanTime->DayOfMonth;     // tm_mday: 1 to 31
-  TmTime->tm_mon   = HumanTime->Month - 1;      // tm_mon:  months since January (0 to 11)
-  TmTime->tm_year  = HumanTime->Year - 1900;    // tm_year: years since 1900
-  TmTime->tm_wday  = HumanTime->DayOfWeek;      // tm_wday: Sunday = 0 (...)  Saturday = 6
-  TmTime->tm_yday  = HumanTime->DayOfYear - 1;  // tm_yday: 0 to 365
-  TmTime->tm_hour  = HumanTime->Hour;           // tm_hour: 0 to 23
-  TmTime->tm_min   = HumanTime->Minute;         // tm_min:  0 to 59
-  TmTime->tm_sec   = HumanTime->Second;         // tm_sec:  0 to 59
-  TmTime->tm_isdst = 0;                         // tm_isdst: (if < 0 means not used)   (if > 0 means FLAG_ON)   (if = 0 means FLAG_OFF)
+  NamesEnglish, NamesCzech, NamesFrench, NamesGerman, NamesItalian, NamesSpanish
+};
 
-  return;
-}
+/* Language currently used (see ntp_set_language()). */
+static UINT8 CurrentLanguage = FIRMWARE_LANGUAGE;
+
+
+/// struct struct_ntp StructNTP;
 
 
 
 
 
 /* $PAGE */
-/* $TITLE=ntp_convert_human_to_unix() */
+/* $TITLE=dhcp_set_ntp_servers() */
 /* ============================================================================================================================================================= *\
-                                                                  Convert "HumanTime" to "Unix Time".
-                                                         NOTE: Unix Time is based on UTC time, not local time.
+                                 Callback from lwIP DHCP client with the NTP servers advertised by the DHCP server (option 42).
+                  NOTE: Requires LWIP_DHCP_GET_NTP_SRV set to 1 in lwipopts.h (LWIP_DHCP_MAX_NTP_SERVERS gives the maximum number of servers kept).
+                        Called in lwIP context when a lease is obtained or renewed, usually before ntp_init(): servers are kept in global variables.
+                        A renewal advertising the same servers doesn't restart with the first one (it may be the one that just failed).
+                        Without LWIP_DHCP_GET_NTP_SRV, NTP_SERVER pool is always used (ntp_init() reports it once at run time).
 \* ============================================================================================================================================================= */
-UINT64 ntp_convert_human_to_unix(struct human_time *HumanTime)
+#if LWIP_DHCP_GET_NTP_SRV
+void dhcp_set_ntp_servers(u8_t ServerCount, const ip4_addr_t *ServerAddress)
 {
-  UINT64 UnixTime;
+  UINT8 Count;
+  UINT8 FlagChanged;
+  UINT8 Loop1UInt8;
 
-  struct tm TempTime;
+  ip_addr_t Address;
+
+
+  Count       = 0;
+  FlagChanged = FLAG_OFF;
+  for (Loop1UInt8 = 0; (ServerAddress != NULL) && (Loop1UInt8 < ServerCount) && (Loop1UInt8 < LWIP_DHCP_MAX_NTP_SERVERS); ++Loop1UInt8)
+  {
+    if (ip4_addr_isany_val(ServerAddress[Loop1UInt8])) continue;
+    ip_addr_copy_from_ip4(Address, ServerAddress[Loop1UInt8]);
+    if ((Count >= DhcpServerCount) || (!ip_addr_cmp(&Address, &DhcpServers[Count]))) FlagChanged = FLAG_ON;
+    DhcpServers[Count] = Address;
+    ++Count;
+  }
 
+  if (Count != DhcpServerCount) FlagChanged = FLAG_ON;
 
-  ntp_convert_human_to_tm(HumanTime, &TempTime);
-  UnixTime = ntp_convert_tm_to_unix(&TempTime);
+  DhcpServerCount = Count;
+  if (FlagChanged) ++DhcpSequence;
 
-  return UnixTime;
+  return;
 }
+#endif  // LWIP_DHCP_GET_NTP_SRV
 
 
 
 
 
 /* $PAGE */
-/* $TITLE=ntp_convert_tm_to_unix() */
+/* $TITLE=ntp_adev_init() */
 /* ============================================================================================================================================================= *\
-                                                                     Convert "TmTime" to "Unix Time".
-                                                         NOTE: Unix Time is based on UTC time, not local time.
+                                                Start (or stop) the frequency stability analyzer of the crystal.
+                  NOTE: To be called after ntp_init() and, if any, ntp_pps_init(). With a PPS input, PPS edges are analyzed on a grid of
+                        Interval seconds. Otherwise NTP replies are analyzed and an NTP request is sent every Interval seconds (at least
+                        NTP_ADEV_MIN_POLL: use a local server for short intervals), instead of the normal poll and read cycles. Adev is kept
+                        by the application (about 4 KB), a NULL Adev stops the analysis and restores normal cycles. Return 0 on success.
 \* ============================================================================================================================================================= */
-UINT64 ntp_convert_tm_to_unix(struct tm *TmTime)
+UINT8 ntp_adev_init(struct struct_ntp *StructNTP, struct ntp_adev *Adev, UINT32 Interval)
 {
-  time_t UnixTime;
+  UINT8 Source;
 
+  UINT32 InterruptMask;
 
-  UnixTime = mktime(TmTime);
 
-  return UnixTime;
+  Source = (StructNTP->PpsGpio == NTP_PPS_NONE) ? NTP_SOURCE_NETWORK : NTP_SOURCE_PPS;
+  if ((Adev != NULL) && (Source == NTP_SOURCE_NETWORK) && (Interval < NTP_ADEV_MIN_POLL)) return 1;
+
+  if (Adev != NULL) ntp_adev_reset(Adev, Interval, Source);
+
+  /* PPS edges are processed from an interrupt, possibly on the other core. */
+  InterruptMask = spin_lock_blocking(ClockLock);
+  StructNTP->Adev       = Adev;
+  StructNTP->Clock.Adev = Adev;
+  spin_unlock(ClockLock, InterruptMask);
+
+  StructNTP->AdevPoll = ((Adev != NULL) && (Source == NTP_SOURCE_NETWORK)) ? Interval : 0l;
+
+  return 0;
 }
 
 
@@ -227,12 +328,19 @@ UINT64 ntp_convert_tm_to_unix(struct tm *TmTime)
 
 
 /* $PAGE */
-/* $TITLE=ntp_convert_unix_time() */
+/* $TITLE=ntp_broadcast_init() */
 /* ============================================================================================================================================================= *\
-                                                             Convert Unix time to tm time and human time.
-                      NOTE: DS3231 gives correct value for day-of-year but the convertion is incorrect for leap year... must be investigated.
+                                          Listen to NTP servers broadcasting or multicasting time on the LAN (mode 5).
+                  NOTE: The PCB is bound to NTP_PORT and joins NTP multicast groups 224.0.1.1 (if LWIP_IGMP) and ff05::101 (if LWIP_IPV6_MLD).
+                        The one-way delay from a broadcast server is calibrated once by a unicast exchange with it. From then on, the clock
+                        is disciplined by its broadcasts alone and no request is sent, unless no broadcast is received for NTP_BROADCAST_TIMEOUT.
+                        Broadcasts from other servers are ignored until then.
+                        Any host on the LAN can send broadcasts: they must be authenticated, an authentication key (StructNTP->AuthKeyId, see
+                        ntp_auth_add_key()) is required. With NTP_BROADCAST_NO_AUTH defined, unauthenticated broadcasts are accepted: a single
+                        forged packet may then set the clock to any time (only for a LAN where all hosts are trusted).
+                        Must be called after ntp_init().
 \* ============================================================================================================================================================= */
-void ntp_convert_unix_time(time_t UnixTime, struct tm *TmTime, struct struct_ntp *StructNTP)
+UINT8 ntp_broadcast_init(struct struct_ntp *StructNTP)
 {
 #ifdef RELEASE_VERSION
   UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
@@ -240,55 +348,70 @@ void ntp_convert_unix_time(time_t UnixTime, struct tm *TmTime, struct struct_ntp
   UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
 #endif  // RELEASE_VERSION
 
+  err_t ReturnCode;
 
-  struct tm TempTime;
+  struct netif *Netif;
 
+#if LWIP_IGMP
+  ip4_addr_t Group4;
+#endif  // LWIP_IGMP
 
-  if (FlagLocalDebug) log_info(__LINE__, __func__, "Unix time on entry:          %12llu\r", UnixTime);
+#if LWIP_IPV6 && LWIP_IPV6_MLD
+  ip6_addr_t Group6;
+#endif  // LWIP_IPV6 && LWIP_IPV6_MLD
 
-  /* Find tm_time */
-  TempTime = *localtime(&UnixTime);
 
+  if (FlagLocalDebug) log_info(__LINE__, __func__, "Entering ntp_broadcast_init()\r");
 
-  /*** Transfer to calling structure. *** Must be optimized. ***/
-  TmTime->tm_hour  = TempTime.tm_hour;
-  TmTime->tm_min   = TempTime.tm_min;
-  TmTime->tm_sec   = TempTime.tm_sec;
-  TmTime->tm_mday  = TempTime.tm_mday;
-  TmTime->tm_mon   = TempTime.tm_mon;
-  TmTime->tm_year  = TempTime.tm_year;
-  TmTime->tm_wday  = TempTime.tm_wday;
-  TmTime->tm_yday  = TempTime.tm_yday;
-  TmTime->tm_isdst = TempTime.tm_isdst;
+  if (StructNTP->FlagInit == FLAG_OFF)
+  {
+    log_info(__LINE__, __func__, "ntp_init() has not already been done successfully. Aborting...\r");
+    return 1;
+  }
 
+#ifndef NTP_BROADCAST_NO_AUTH
+  if ((StructNTP->AuthKeyId == 0) || (ntp_auth_find_key(StructNTP->AuthKeyId) == NULL))
+  {
+    log_info(__LINE__, __func__, "Broadcast mode requires an authentication key (see ntp_auth_add_key()). Aborting...\r");
+    return 1;
+  }
+#endif  // NTP_BROADCAST_NO_AUTH
 
-  /* Find equivalent in human time. */
-  StructNTP->HumanTime.Hour       = TmTime->tm_hour;
-  StructNTP->HumanTime.Minute     = TmTime->tm_min;
-  StructNTP->HumanTime.Second     = TmTime->tm_sec;
-  StructNTP->HumanTime.DayOfMonth = TmTime->tm_mday;
-  StructNTP->HumanTime.Month      = TmTime->tm_mon + 1;
-  StructNTP->HumanTime.Year       = TmTime->tm_year + 1900;
-  StructNTP->HumanTime.DayOfWeek  = TmTime->tm_wday;
-  StructNTP->HumanTime.DayOfYear  = TmTime->tm_yday;
-  StructNTP->HumanTime.FlagDst    = TmTime->tm_isdst;
+  Netif = &cyw43_state.netif[CYW43_ITF_STA];
 
-  if (FlagLocalDebug)
+  /* Broadcast servers send to NTP_PORT: replies to our calibration requests are then received on the same port. */
+  cyw43_arch_lwip_begin();
   {
-    log_info(__LINE__, __func__, "============================================\r");
-    log_info(__LINE__, __func__, "HumanTime->Hour        =   %2.2u\r", StructNTP->HumanTime.Hour);
-    log_info(__LINE__, __func__, "HumanTime->Minute      =   %2.2u\r", StructNTP->HumanTime.Minute);
-    log_info(__LINE__, __func__, "HumanTime->Second      =   %2.2u\r", StructNTP->HumanTime.Second);
-    log_info(__LINE__, __func__, "HumanTime->DayOfMonth  =   %2.2u\r", StructNTP->HumanTime.DayOfMonth);
-    log_info(__LINE__, __func__, "HumanTime->Month       =   %2.2u\r", StructNTP->HumanTime.Month);
-    log_info(__LINE__, __func__, "HumanTime->Year        = %4.4u\r",   StructNTP->HumanTime.Year);
-    log_info(__LINE__, __func__, "HumanTime->DayOfWeek   = %4u\r",     StructNTP->HumanTime.DayOfWeek);
-    log_info(__LINE__, __func__, "HumanTime->DayOfYear   = %4u\r",     StructNTP->HumanTime.DayOfYear);
-    log_info(__LINE__, __func__, "HumanTime->FlagDst     = %4u\r", StructNTP->HumanTime.FlagDst);
-    log_info(__LINE__, __func__, "============================================\r");
+    ip_set_option(StructNTP->Pcb, SOF_BROADCAST);
+    ReturnCode = udp_bind(StructNTP->Pcb, IP_ANY_TYPE, NTP_PORT);
+
+#if LWIP_IGMP
+    IP4_ADDR(&Group4, 224, 0, 1, 1);
+    if (ReturnCode == ERR_OK) ReturnCode = igmp_joingroup_netif(Netif, &Group4);
+#endif  // LWIP_IGMP
+
+#if LWIP_IPV6 && LWIP_IPV6_MLD
+    IP6_ADDR(&Group6, PP_HTONL(0xFF050000ul), 0, 0, PP_HTONL(0x00000101ul));
+    if (ReturnCode == ERR_OK) ReturnCode = mld6_joingroup_netif(Netif, &Group6);
+#endif  // LWIP_IPV6 && LWIP_IPV6_MLD
   }
+  cyw43_arch_lwip_end();
 
-  return;
+  if (ReturnCode != ERR_OK)
+  {
+    log_info(__LINE__, __func__, "Failed to listen to NTP broadcasts (error %d)\r", ReturnCode);
+    return 1;
+  }
+
+  ip_addr_set_zero(&StructNTP->BroadcastServer);
+  StructNTP->BroadcastDelay    = -1l;
+  StructNTP->BroadcastHeard    = 0ll;
+  StructNTP->BroadcastTransmit = 0ull;
+  StructNTP->BroadcastLast     = 0ll;
+  StructNTP->BroadcastCount    = 0l;
+  StructNTP->FlagBroadcast     = FLAG_ON;
+
+  return 0;
 }
 
 
@@ -296,79 +419,114 @@ void ntp_convert_unix_time(time_t UnixTime, struct tm *TmTime, struct struct_ntp
 
 
 /* $PAGE */
-/* $TITLE=ntp_display_info() */
+/* $TITLE=ntp_broadcast_recv() */
 /* ============================================================================================================================================================= *\
-                                                                    Display handy NTP-related information.
+                                                   Discipline the clock with a broadcast (mode 5) NTP packet.
+                  NOTE: Called from ntp_recv() (lwIP callback). Until the one-way delay from the broadcast server has been calibrated, a
+                        unicast request is sent to it instead: a lost request is sent again on the next broadcast. Broadcasts from other
+                        servers are ignored while the current one has been heard from within NTP_BROADCAST_TIMEOUT. Broadcasts whose transmit
+                        timestamp is not more recent than the last one accepted from the current server are dropped (replayed packets).
 \* ============================================================================================================================================================= */
-void ntp_display_info(struct struct_ntp *StructNTP)
+static void ntp_broadcast_recv(struct struct_ntp *StructNTP, const ip_addr_t *IPAddress, const UINT8 *Packet, const struct ntp_packet *Info)
 {
-  UCHAR String[65];
+  INT16 AuthStatus;
 
-  UINT8 FlagConnection;  // flag indicating NTP connection has already been done at least once previously.
+  UINT32 InterruptMask;
 
-  INT64 DeltaTime;
+  INT64 Offset;
+  INT64 PivotTime;
+  INT64 UTCTime;
 
+  time_t UnixTime;
 
-  FlagConnection = FLAG_OFF;  // assume no connection on entry.
+  struct ntp_family *Family;
 
-  log_info(__LINE__, __func__, "======================================================================\r");
-  log_info(__LINE__, __func__, "               Network Time Protocol (NTP) information\r");
-  log_info(__LINE__, __func__, "======================================================================\r");
 
+  if (StructNTP->FlagBroadcast == FLAG_OFF) return;
 
-  if (strcmp(ip4addr_ntoa(&StructNTP->ServerAddress), "0.0.0.0") != 0) FlagConnection = FLAG_ON;
+  /* Locked onto the current broadcast server: others are ignored (and not counted as authentication errors) until it times out. */
+  if ((!ip_addr_cmp(IPAddress, &StructNTP->BroadcastServer)) && (StructNTP->BroadcastHeard != 0) && ((StructNTP->Receive - StructNTP->BroadcastHeard) < NTP_BROADCAST_TIMEOUT)) return;
 
-  if (FlagConnection)
+  AuthStatus = ntp_auth_verify(StructNTP->AuthKeyId, Packet, Info);
+  if (AuthStatus != NTP_AUTH_OK)
   {
-    /* At least one NTP request has already been done, display NTP health status and last server address used. */
-    if (StructNTP->FlagHealth == FLAG_ON)
-      strcpy(String, "Good");
-    else
-      strcpy(String, "Problems");
- 
-    log_info(__LINE__, __func__, "NTP health: %s - Last NTP server: %-15s\r",          String, ip4addr_ntoa(&StructNTP->ServerAddress));
+    ntp_log_event(NTP_LOG_AUTH, NTP_EVENT_AUTH, Info->KeyId, AuthStatus, 0);
+    ++StructNTP->AuthErrors;
   }
-  else
+
+  if ((Info->Stratum == 0) || (Info->Stratum > NTP_MAX_STRATUM) || (Info->LeapIndicator == NTP_LEAP_ALARM) || (AuthStatus != 0))
   {
-    /* NTP information is displayed before the first NTP request. */
-    log_info(__LINE__, __func__, "No NTP cycle has been executed so far.\r");
+    ntp_log_event(NTP_LOG_SYNC, NTP_EVENT_INVALID, Info->Mode, Info->Stratum, AuthStatus);
+    return;
   }
 
+  /* Replay protection: a broadcast captured earlier and sent again (even authenticated) must not move the clock back. */
+  if ((ip_addr_cmp(IPAddress, &StructNTP->BroadcastServer)) && (StructNTP->BroadcastTransmit != 0ull) && (ntp_ts_diff(Info->Transmit, StructNTP->BroadcastTransmit) <= 0))
+  {
+    ntp_log_event(NTP_LOG_SYNC, NTP_EVENT_BOGUS, NTP_PACKET_OK, 0, 0);
+    ++StructNTP->PacketErrors;
+    return;
+  }
 
-  log_info(__LINE__, __func__, "Errors: %lu     Reads: %lu     Polls: %lu\r",      StructNTP->TotalErrors, StructNTP->ReadCycles, StructNTP->PollCycles);
-  log_info(__LINE__, __func__, "FlagInit:                      0x%2.2X\r",         StructNTP->FlagInit);
-  log_info(__LINE__, __func__, "FlagSuccess:                   0x%2.2X\r",         StructNTP->FlagSuccess);
-  log_info(__LINE__, __func__, "FlagHistory:                   0x%2.2X\r",         StructNTP->FlagHistory);
-  log_info(__LINE__, __func__, "Pico internal timer:   %12llu usec   (%5llu sec)\r", get_absolute_time(), (time_us_64() / 1000000ll));
-  log_info(__LINE__, __func__, "NTP update time:       %12llu usec   (%5llu sec)\r", to_us_since_boot(StructNTP->UpdateTime), to_us_since_boot(StructNTP->UpdateTime) / 1000000ll);
-  log_info(__LINE__, __func__, "Time difference:       %12lld usec\r",             absolute_time_diff_us(get_absolute_time(), StructNTP->UpdateTime));
-  sleep_ms(80);  // prevent communication override.
+  /* A new broadcast server must be calibrated before its broadcasts are used. */
+  if (!ip_addr_cmp(IPAddress, &StructNTP->BroadcastServer))
+  {
+    StructNTP->BroadcastServer = *IPAddress;
+    StructNTP->BroadcastDelay  = -1l;
+  }
+  StructNTP->BroadcastHeard    = StructNTP->Receive;
+  StructNTP->BroadcastTransmit = Info->Transmit;
 
-  DeltaTime = (absolute_time_diff_us(get_absolute_time(), StructNTP->UpdateTime) / 1000000ll);
-  if (DeltaTime >= 0)
-    log_info(__LINE__, __func__, "Time remaining:        %12llu sec        (%llu min)\r", DeltaTime, (DeltaTime / 60));
-  else
-    log_info(__LINE__, __func__, "Time over by:          %12llu sec        (%llu min)\r", llabs(DeltaTime), (llabs(DeltaTime) / 60));
+  /* Calibration request, unless a request of the read cycle is still pending for this address family (its address and origin timestamp must be kept). */
+  if (StructNTP->BroadcastDelay < 0)
+  {
+    Family = &StructNTP->Family[IP_IS_V6(IPAddress) ? NTP_FAMILY_V6 : NTP_FAMILY_V4];
+    if (Family->FlagPending) return;
 
-  log_info(__LINE__, __func__, "ScanCount:                       %2u\r",       StructNTP->ScanCount);
-  log_info(__LINE__, __func__, "DST country:                     %2u\r",       StructNTP->DSTCountry);
-  log_info(__LINE__, __func__, "Delta time:                    %4d minutes\r", StructNTP->DeltaTime);
+    Family->Address        = *IPAddress;
+    Family->FlagPending    = FLAG_ON;
+    StructNTP->FlagSampled = FLAG_OFF;
+    ntp_request(StructNTP, Family);
 
-  if (FlagConnection)
+    return;
+  }
+
+  /* Server time when the broadcast is received = its transmit timestamp + one-way delay. */
+  InterruptMask = spin_lock_blocking(ClockLock);
+  ntp_leap_apply(StructNTP, StructNTP->Receive);
+  if (StructNTP->Clock.FlagValid)
+    PivotTime = ntp_clock_get_utc_us(&StructNTP->Clock, StructNTP->Receive);
+  else
+    PivotTime = NTP_TS_PIVOT * 1000000ll;
+  UTCTime = ntp_ts_to_unix_us(Info->Transmit, PivotTime) + StructNTP->BroadcastDelay;
+  Offset  = UTCTime - PivotTime;
+
+  /* When PPS is locked, it disciplines the clock and NTP is only used to make sure that we are on the right second. */
+  if ((ntp_pps_locked(StructNTP) == FLAG_OFF) || (Offset > NTP_PPS_MAX_OFFSET) || (Offset < -NTP_PPS_MAX_OFFSET))
   {
-    log_info(__LINE__, __func__, "Day-of-year start:              %3u\r",    StructNTP->DoYStart);
-    log_info(__LINE__, __func__, "Day-of-year end:                %3u\r",    StructNTP->DoYEnd);
-    log_info(__LINE__, __func__, "UTC start:             %12llu\r",          StructNTP->DSTStart);
-    log_info(__LINE__, __func__, "UTC end:               %12llu\r",          StructNTP->DSTEnd);
-    log_info(__LINE__, __func__, "UTCTime:               %12llu\r",          StructNTP->UTCTime);
-    log_info(__LINE__, __func__, "LocaTime:              %12llu\r",          StructNTP->LocalTime);
-    log_info(__LINE__, __func__, "Flag summer time:              0x%2.2X\r", StructNTP->FlagSummerTime);
-    log_info(__LINE__, __func__, "Latency (round-trip):  %12ld usec  (one-way: %ld usec)\r", StructNTP->Latency, (StructNTP->Latency / 2));
-    log_info(__LINE__, __func__, "DNSRequestSent:                0x%2.2X\r", StructNTP->DNSRequestSent);
-    log_info(__LINE__, __func__, "ResendAlarm:                 %6u\r",       StructNTP->ResendAlarm);
+    ntp_trace_clock(StructNTP, NTP_TRACE_SAMPLE, NTP_TRACE_FLAG_BROADCAST, NTP_SOURCE_NETWORK, StructNTP->Receive, UTCTime);
+    if ((ntp_clock_sample(&StructNTP->Clock, StructNTP->Receive, UTCTime, NTP_SOURCE_NETWORK) == NTP_CLOCK_STEPPED) && (StructNTP->Clock.StepCount > 0))
+      ntp_log_event(NTP_LOG_CLOCK, NTP_EVENT_STEP, (INT32)StructNTP->Clock.LastOffset, NTP_SOURCE_NETWORK, 0);
   }
-  log_info(__LINE__, __func__, "======================================================================\r\r\r");
-  sleep_ms(80);  // prevent communication override.
+  ntp_snapshot_publish(StructNTP);
+  spin_unlock(ClockLock, InterruptMask);
+
+  /* Path asymmetry is unknown: the one-way delay itself is added to the error bound. */
+  StructNTP->LeapIndicator  = Info->LeapIndicator;
+  StructNTP->Stratum        = Info->Stratum;
+  StructNTP->RootDelay      = Info->RootDelay;
+  StructNTP->RootDispersion = Info->RootDispersion;
+  StructNTP->SyncError      = (StructNTP->RootDelay / 2) + StructNTP->RootDispersion + StructNTP->BroadcastDelay;
+  StructNTP->ServerAddress  = *IPAddress;
+  StructNTP->BroadcastLast  = StructNTP->Receive;
+  ++StructNTP->BroadcastCount;
+
+  ntp_leap_update(StructNTP, StructNTP->LeapIndicator, UTCTime);
+
+  ntp_log_event(NTP_LOG_SYNC, NTP_EVENT_BROADCAST, (INT32)Offset, StructNTP->BroadcastDelay, Info->Stratum);
+
+  UnixTime = (time_t)(UTCTime / 1000000ll);
+  ntp_result(0, &UnixTime, StructNTP);
 
   return;
 }
@@ -378,298 +536,3214 @@ void ntp_display_info(struct struct_ntp *StructNTP)
 
 
 /* $PAGE */
-/* $TITLE=ntp_dns_found() */
+/* $TITLE=ntp_capture_get_family() */
 /* ============================================================================================================================================================= *\
-                                                                   Call back with a DNS result.
+                           Return the address family of an NTP request sent to the Wi-Fi chip (NTP_FAMILY_NONE if not an NTP request).
 \* ============================================================================================================================================================= */
-static void ntp_dns_found(const char *HostName, const ip_addr_t *ipaddr, void *ExtraArgument)
+static UINT8 ntp_capture_get_family(struct pbuf *p)
 {
-#ifdef RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
-#else   // RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
-#endif  // RELEASE_VERSION
+  UINT8 Family;
 
-  UCHAR String[20];
+  UINT16 EtherType;
+  UINT16 Offset;
 
-  struct struct_ntp *StructNTP = ExtraArgument;
 
+  if (p->tot_len < 14) return NTP_FAMILY_NONE;
 
-  if (FlagLocalDebug)
+  EtherType = (pbuf_get_at(p, 12) << 8) | pbuf_get_at(p, 13);
+  if ((EtherType == 0x0800) && (pbuf_get_at(p, 23) == 17))
   {
-    log_info(__LINE__, __func__, "Entering ntp_dns_found()\r");
-    log_info(__LINE__, __func__, "NTP pool host name:         <%s>\r", HostName);
-    log_info(__LINE__, __func__, "NTP org host IP address:  %15s\r",   ip4addr_ntoa(&StructNTP->ServerAddress));
-    log_info(__LINE__, __func__, "NTP pool IP address:      %15s\r",   ip4addr_ntoa(ipaddr));
+    Family = NTP_FAMILY_V4;
+    Offset = 14 + ((pbuf_get_at(p, 14) & 0x0F) * 4);  // IPv4: header length is variable.
   }
-
-  if (ipaddr)
+  else if ((EtherType == 0x86DD) && (pbuf_get_at(p, 20) == 17))
   {
-    StructNTP->ServerAddress = *ipaddr;
-    ntp_request(StructNTP);
+    Family = NTP_FAMILY_V6;
+    Offset = 14 + 40;                                 // IPv6: no extension header before UDP.
   }
   else
-  {
-    if (FlagLocalDebug) log_info(__LINE__, __func__, "NTP DNS request failed.\r");
-    ntp_result(-1, NULL, StructNTP);
-  }
+    return NTP_FAMILY_NONE;
 
-  return;
+  if (p->tot_len < (Offset + 8)) return NTP_FAMILY_NONE;
+  if (((pbuf_get_at(p, Offset + 2) << 8) | pbuf_get_at(p, Offset + 3)) != NTP_PORT) return NTP_FAMILY_NONE;
+
+  return Family;
 }
 
 
 
 
 
-/* $TITLE=ntp_dst_settings() */
 /* $PAGE */
+/* $TITLE=ntp_capture_init() */
 /* ============================================================================================================================================================= *\
-                                                  Set parameters required for Daily Saving Time automatic handling.
-                                            NOTE: StructNTP.UTCTime must have been initialized before calling this function.
+                                                     Capture request and reply timestamps at the Wi-Fi chip.
+                NOTE: The request is timestamped by the link output function of the Wi-Fi interface, right before its transfer to the CYW43,
+                      and the reply by the CYW43 interrupt that signalled it, instead of when lwIP callbacks run. Must be called on the core where
+                      cyw43_arch_init() has been called, once the Wi-Fi interface is up.
 \* ============================================================================================================================================================= */
-void ntp_dst_settings(struct struct_ntp *StructNTP)
+UINT8 ntp_capture_init(struct struct_ntp *StructNTP)
 {
-#ifdef RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
-#else   // RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
-#endif  // RELEASE_VERSION
+  struct netif *Netif;
 
-  UINT8 FlagNorth;   // indicate we are in a northern hemisphere country.
-  UINT8 Loop1UInt8;
-  UINT8 StartDoM;
-  UINT8 EndDoM;
-  
-  UINT16 CurrentDayOfYear;
 
-  struct human_time HumanTime;
+  if (StructNTP->FlagCapture) return 0;
 
+  Netif = &cyw43_state.netif[CYW43_ITF_STA];
+  if (Netif->linkoutput == NULL) return 1;
 
-  /* Validate DST country setting. */
-  if (StructNTP->DSTCountry == 0)
-  {
-    if (stdio_usb_connected()) log_info(__LINE__, __func__, "Daylight saving time is currently disabled: %u\r\r\r", StructNTP->DSTCountry);
-    StructNTP->FlagSummerTime = FLAG_OFF;
-    return;
-  }
+  StructNTP->CaptureWake  = 0ll;
+  StructNTP->CaptureCount = 0l;
+  CaptureStructNTP        = StructNTP;
 
-  if (StructNTP->DSTCountry > MAX_DST_COUNTRIES)
+  cyw43_arch_lwip_begin();
   {
-    if (stdio_usb_connected()) log_info(__LINE__, __func__, "Invalid DST country setting: %u\r\r\r", StructNTP->DSTCountry);
-    StructNTP->FlagSummerTime = FLAG_OFF;
-    return;
+    CaptureLinkOutput = Netif->linkoutput;
+    Netif->linkoutput = ntp_capture_linkoutput;
   }
+  cyw43_arch_lwip_end();
 
+  /* Our handler must run before the CYW43 one, that disables the interrupt until the CYW43 has been serviced. */
+  gpio_add_raw_irq_handler_with_order_priority(CYW43_PIN_WL_HOST_WAKE, ntp_capture_irq, PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY);
+  StructNTP->FlagCapture = FLAG_ON;
 
-  StructNTP->ShiftMinutes = DstParameters[StructNTP->DSTCountry].ShiftMinutes;
+  return 0;
+}
 
 
 
-  /* --------------------------------------------------------------------------------------------------------------------------- *\
-                    Find day-of-week of Daylight Saving Time start for current year and for specific DST country.
-  \* --------------------------------------------------------------------------------------------------------------------------- */
-  /* Find the right day-of-week between the soonest and the latest possible dates. */
-  for (Loop1UInt8 = DstParameters[StructNTP->DSTCountry].StartDayOfMonthLow; Loop1UInt8 <= DstParameters[StructNTP->DSTCountry].StartDayOfMonthHigh; ++Loop1UInt8)
-  {
-    /* Check if this date is the right day-of-week. If it is, find day-of-year for daylight saving time start. */
-    if (ntp_get_day_of_week(Loop1UInt8, DstParameters[StructNTP->DSTCountry].StartMonth, StructNTP->HumanTime.Year) == DstParameters[StructNTP->DSTCountry].StartDayOfWeek)
-    {
-      StartDoM = Loop1UInt8;
-      StructNTP->DoYStart = ntp_get_day_of_year(Loop1UInt8, DstParameters[StructNTP->DSTCountry].StartMonth, StructNTP->HumanTime.Year);
-      break;
-    }
-  }
 
-  /* Check if operation has been successful. */
-  if (Loop1UInt8 > DstParameters[StructNTP->DSTCountry].StartDayOfMonthHigh)
-  {
-    log_info(__LINE__, __func__, "Date for daylight saving time start NOT FOUND\r\r\r");
-    StructNTP->FlagSummerTime = FLAG_OFF;
-    return;
-  }
-  else
-  {
-    if (FlagLocalDebug) log_info(__LINE__, __func__, "Date for daylight saving time start in %4.4u: %2.2u-%s-%4.4u\r", StructNTP->HumanTime.Year, Loop1UInt8, ShortMonth[DstParameters[StructNTP->DSTCountry].StartMonth], StructNTP->HumanTime.Year);
+
+/* $PAGE */
+/* $TITLE=ntp_capture_irq() */
+/* ============================================================================================================================================================= *\
+                                                      GPIO interrupt handler timestamping CYW43 interrupts.
+              NOTE: The interrupt is not acknowledged here: it is a level interrupt handled by the CYW43 driver. When a reply arrives while the driver
+                    is still servicing a previous interrupt, it is timestamped by that previous interrupt (slightly early, by the servicing time).
+\* ============================================================================================================================================================= */
+static void ntp_capture_irq(void)
+{
+  UINT64 WakeTime;
+
+
+  /* Capture the timer first, before anything else. */
+  WakeTime = time_us_64();
+
+  if ((CaptureStructNTP == NULL) || ((gpio_get_irq_event_mask(CYW43_PIN_WL_HOST_WAKE) & GPIO_IRQ_LEVEL_HIGH) == 0)) return;
+
+  CaptureStructNTP->CaptureWake = WakeTime;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_capture_linkoutput() */
+/* ============================================================================================================================================================= *\
+                                             Link output function of the Wi-Fi interface, timestamping NTP requests.
+                    NOTE: A request waiting for ARP resolution is timestamped when it is finally sent, not when udp_sendto() has been called.
+\* ============================================================================================================================================================= */
+static err_t ntp_capture_linkoutput(struct netif *Netif, struct pbuf *p)
+{
+  UINT8 Family;
+
+
+  if ((CaptureStructNTP != NULL) && (CaptureStructNTP->FlagCaptureSend))
+  {
+    Family = ntp_capture_get_family(p);
+    if ((Family != NTP_FAMILY_NONE) && (CaptureStructNTP->FlagCaptureSend & (1 << Family)))
+    {
+      CaptureStructNTP->Family[Family].Send = time_us_64();
+      CaptureStructNTP->FlagCaptureSend    &= ~(1 << Family);
+    }
+  }
+
+  return CaptureLinkOutput(Netif, p);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_convert_unix_time() */
+/* ============================================================================================================================================================= *\
+                                                             Convert Unix time to tm time and human time.
+                      NOTE: DS3231 gives correct value for day-of-year but the convertion is incorrect for leap year... must be investigated.
+\* ============================================================================================================================================================= */
+void ntp_convert_unix_time(time_t UnixTime, struct tm *TmTime, struct struct_ntp *StructNTP)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+
+  struct tm TempTime;
+
+
+  if (FlagLocalDebug) log_info(__LINE__, __func__, "Unix time on entry:          %12llu\r", UnixTime);
+
+  /* Find tm_time */
+  TempTime = *localtime(&UnixTime);
+
+
+  /*** Transfer to calling structure. *** Must be optimized. ***/
+  TmTime->tm_hour  = TempTime.tm_hour;
+  TmTime->tm_min   = TempTime.tm_min;
+  TmTime->tm_sec   = TempTime.tm_sec;
+  TmTime->tm_mday  = TempTime.tm_mday;
+  TmTime->tm_mon   = TempTime.tm_mon;
+  TmTime->tm_year  = TempTime.tm_year;
+  TmTime->tm_wday  = TempTime.tm_wday;
+  TmTime->tm_yday  = TempTime.tm_yday;
+  TmTime->tm_isdst = TempTime.tm_isdst;
+
+
+  /* Find equivalent in human time. */
+  StructNTP->HumanTime.Hour       = TmTime->tm_hour;
+  StructNTP->HumanTime.Minute     = TmTime->tm_min;
+  StructNTP->HumanTime.Second     = TmTime->tm_sec;
+  StructNTP->HumanTime.DayOfMonth = TmTime->tm_mday;
+  StructNTP->HumanTime.Month      = TmTime->tm_mon + 1;
+  StructNTP->HumanTime.Year       = TmTime->tm_year + 1900;
+  StructNTP->HumanTime.DayOfWeek  = TmTime->tm_wday;
+  StructNTP->HumanTime.DayOfYear  = TmTime->tm_yday;
+  StructNTP->HumanTime.FlagDst    = TmTime->tm_isdst;
+
+  if (FlagLocalDebug)
+  {
+    log_info(__LINE__, __func__, "============================================\r");
+    log_info(__LINE__, __func__, "HumanTime->Hour        =   %2.2u\r", StructNTP->HumanTime.Hour);
+    log_info(__LINE__, __func__, "HumanTime->Minute      =   %2.2u\r", StructNTP->HumanTime.Minute);
+    log_info(__LINE__, __func__, "HumanTime->Second      =   %2.2u\r", StructNTP->HumanTime.Second);
+    log_info(__LINE__, __func__, "HumanTime->DayOfMonth  =   %2.2u\r", StructNTP->HumanTime.DayOfMonth);
+    log_info(__LINE__, __func__, "HumanTime->Month       =   %2.2u\r", StructNTP->HumanTime.Month);
+    log_info(__LINE__, __func__, "HumanTime->Year        = %4.4u\r",   StructNTP->HumanTime.Year);
+    log_info(__LINE__, __func__, "HumanTime->DayOfWeek   = %4u\r",     StructNTP->HumanTime.DayOfWeek);
+    log_info(__LINE__, __func__, "HumanTime->DayOfYear   = %4u\r",     StructNTP->HumanTime.DayOfYear);
+    log_info(__LINE__, __func__, "HumanTime->FlagDst     = %4u\r", StructNTP->HumanTime.FlagDst);
+    log_info(__LINE__, __func__, "============================================\r");
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_core1_command() */
+/* ============================================================================================================================================================= *\
+                                              Send a command (NTP_CORE1_xxx) to the time service running on core 1.
+                         NOTE: Never waits: return 1 if the inter-core FIFO is full (core 1 empties it at least every NTP_CORE1_PERIOD usec).
+\* ============================================================================================================================================================= */
+UINT8 ntp_core1_command(UINT32 Command)
+{
+  if (multicore_fifo_wready() == false) return 1;
+
+  multicore_fifo_push_blocking(Command);
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_core1_main() */
+/* ============================================================================================================================================================= *\
+                                                                 Time service running on core 1.
+              NOTE: Module alarms are served by an alarm pool created on core 1. lwIP callbacks (DNS and NTP replies) are served by the core where
+                    cyw43_arch_init() has been called: call it from the Setup function given to ntp_core1_start() to move them to core 1 as well.
+\* ============================================================================================================================================================= */
+static void ntp_core1_main(void)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  UINT32 Command;
+  UINT32 InterruptMask;
+
+  struct struct_ntp *StructNTP;
+
+  void (*Setup)(struct struct_ntp *StructNTP);
+
+
+  /* Parameters are sent by ntp_core1_start() through the inter-core FIFO. */
+  StructNTP = (struct struct_ntp *)multicore_fifo_pop_blocking();
+  Setup     = (void (*)(struct struct_ntp *))multicore_fifo_pop_blocking();
+
+  /* Module alarms will now fire on core 1. */
+  StructNTP->AlarmPool = alarm_pool_create_with_unused_hardware_alarm(NTP_CORE1_ALARMS);
+  if (Setup != NULL) Setup(StructNTP);
+
+  InterruptMask = spin_lock_blocking(ClockLock);
+  ntp_snapshot_publish(StructNTP);
+  spin_unlock(ClockLock, InterruptMask);
+  StructNTP->FlagCore1 = FLAG_ON;
+  multicore_fifo_push_blocking(0);  // tell core 0 that the time service is running.
+  if (FlagLocalDebug) log_info(__LINE__, __func__, "Time service now running on core 1.\r");
+
+
+  while (1)
+  {
+    /* Wait for a command from core 0, or until it is time to check if a read cycle is due. */
+    if (multicore_fifo_pop_timeout_us(NTP_CORE1_PERIOD, &Command))
+    {
+      ++StructNTP->Core1Commands;
+      switch (Command)
+      {
+        case (NTP_CORE1_SYNC):
+          StructNTP->UpdateTime = nil_time;  // nil time forces a read cycle.
+        break;
+
+        case (NTP_CORE1_DST):
+          ntp_dst_settings(StructNTP);
+        break;
+
+        case (NTP_CORE1_INFO):
+          ntp_display_info(StructNTP);
+        break;
+
+        default:
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Invalid command received from core 0: %lu\r", Command);
+        break;
+      }
+    }
+
+    if (time_reached(StructNTP->UpdateTime))
+    {
+      /* A read cycle that failed must be followed by another read cycle (not a poll cycle). */
+      if ((StructNTP->FlagSuccess == FLAG_OFF) && (StructNTP->FlagHealth == FLAG_ON))
+      {
+        ++StructNTP->TotalErrors;
+        StructNTP->FlagHealth = FLAG_OFF;
+      }
+      ntp_get_time(StructNTP);
+    }
+
+    if (StructNTP->FlagSuccess == FLAG_ON) StructNTP->FlagHealth = FLAG_ON;
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_core1_start() */
+/* ============================================================================================================================================================= *\
+                                                                 Run the time service on core 1.
+                NOTE: Core 1 then handles NTP read and poll cycles, module alarms (RTC, leap second, lost requests), holdover clock and commands
+                      sent with ntp_core1_command(). Core 0 reads the clock (ntp_get_utc_us(), ntp_get_timestamp(), etc.) from a snapshot published
+                      by core 1, without locking. Must be called after ntp_init() and before ntp_get_time(), ntp_rtc_init() and ntp_holdover_init().
+                      Setup (may be NULL) is called on core 1 before the time service starts, for example to initialize Wi-Fi and PPS input there.
+\* ============================================================================================================================================================= */
+UINT8 ntp_core1_start(struct struct_ntp *StructNTP, void (*Setup)(struct struct_ntp *StructNTP))
+{
+  if ((StructNTP->FlagInit == FLAG_OFF) || (StructNTP->FlagCore1 == FLAG_ON)) return 1;
+
+  multicore_launch_core1(ntp_core1_main);
+  multicore_fifo_push_blocking((UINT32)StructNTP);
+  multicore_fifo_push_blocking((UINT32)Setup);
+
+  /* Wait until core 1 has taken over. */
+  multicore_fifo_pop_blocking();
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_display_info() */
+/* ============================================================================================================================================================= *\
+                                                                    Display handy NTP-related information.
+\* ============================================================================================================================================================= */
+void ntp_display_info(struct struct_ntp *StructNTP)
+{
+  UCHAR String[65];
+
+  UINT8 Loop1UInt8;
+
+  UINT8 FlagConnection;  // flag indicating NTP connection has already been done at least once previously.
+
+  INT64 DeltaTime;
+
+  struct ntp_stability Stability;
+  struct ntp_status Status;
+
+
+  FlagConnection = FLAG_OFF;  // assume no connection on entry.
+
+  log_info(__LINE__, __func__, "======================================================================\r");
+  log_info(__LINE__, __func__, "               Network Time Protocol (NTP) information\r");
+  log_info(__LINE__, __func__, "======================================================================\r");
+
+
+  if (!ip_addr_isany(&StructNTP->ServerAddress)) FlagConnection = FLAG_ON;
+
+  if (FlagConnection)
+  {
+    /* At least one NTP request has already been done, display NTP health status and last server address used. */
+    if (StructNTP->FlagHealth == FLAG_ON)
+      strcpy(String, "Good");
+    else
+      strcpy(String, "Problems");
+ 
+    log_info(__LINE__, __func__, "NTP health: %s - Last NTP server: %-15s\r",          String, ipaddr_ntoa(&StructNTP->ServerAddress));
+  }
+  else
+  {
+    /* NTP information is displayed before the first NTP request. */
+    log_info(__LINE__, __func__, "No NTP cycle has been executed so far.\r");
+  }
+
+
+  log_info(__LINE__, __func__, "Errors: %lu     Reads: %lu     Polls: %lu\r",      StructNTP->TotalErrors, StructNTP->ReadCycles, StructNTP->PollCycles);
+  log_info(__LINE__, __func__, "FlagInit:                      0x%2.2X\r",         StructNTP->FlagInit);
+  log_info(__LINE__, __func__, "FlagSuccess:                   0x%2.2X\r",         StructNTP->FlagSuccess);
+  log_info(__LINE__, __func__, "FlagHistory:                   0x%2.2X\r",         StructNTP->FlagHistory);
+  log_info(__LINE__, __func__, "Pico internal timer:   %12llu usec   (%5llu sec)\r", get_absolute_time(), (time_us_64() / 1000000ll));
+  log_info(__LINE__, __func__, "NTP update time:       %12llu usec   (%5llu sec)\r", to_us_since_boot(StructNTP->UpdateTime), to_us_since_boot(StructNTP->UpdateTime) / 1000000ll);
+  log_info(__LINE__, __func__, "Time difference:       %12lld usec\r",             absolute_time_diff_us(get_absolute_time(), StructNTP->UpdateTime));
+
+  DeltaTime = (absolute_time_diff_us(get_absolute_time(), StructNTP->UpdateTime) / 1000000ll);
+  if (DeltaTime >= 0)
+    log_info(__LINE__, __func__, "Time remaining:        %12llu sec        (%llu min)\r", DeltaTime, (DeltaTime / 60));
+  else
+    log_info(__LINE__, __func__, "Time over by:          %12llu sec        (%llu min)\r", llabs(DeltaTime), (llabs(DeltaTime) / 60));
+
+  log_info(__LINE__, __func__, "ScanCount:                       %2u\r",       StructNTP->ScanCount);
+  log_info(__LINE__, __func__, "DST country:                     %2u\r",       StructNTP->DSTCountry);
+  log_info(__LINE__, __func__, "Delta time:                    %4d minutes\r", StructNTP->DeltaTime);
+
+  if (FlagConnection)
+  {
+    log_info(__LINE__, __func__, "Day-of-year start:              %3u\r",    StructNTP->DoYStart);
+    log_info(__LINE__, __func__, "Day-of-year end:                %3u\r",    StructNTP->DoYEnd);
+    log_info(__LINE__, __func__, "UTC start:             %12llu\r",          StructNTP->DSTStart);
+    log_info(__LINE__, __func__, "UTC end:               %12llu\r",          StructNTP->DSTEnd);
+    log_info(__LINE__, __func__, "UTCTime:               %12llu\r",          StructNTP->UTCTime);
+    log_info(__LINE__, __func__, "LocaTime:              %12llu\r",          StructNTP->LocalTime);
+    log_info(__LINE__, __func__, "Flag summer time:              0x%2.2X\r", StructNTP->FlagSummerTime);
+    log_info(__LINE__, __func__, "Latency (round-trip):  %12ld usec  (one-way: %ld usec)\r", StructNTP->Latency, (StructNTP->Latency / 2));
+    ntp_get_status(StructNTP, &Status);
+    log_info(__LINE__, __func__, "Max error: %lu usec   Leap: %u   Stratum: %u   Sync age: %lu sec\r", Status.MaxError, Status.LeapIndicator, Status.Stratum, Status.SyncAge);
+    log_info(__LINE__, __func__, "Clock source:                    %2u   (samples: %lu   steps: %lu)\r", StructNTP->Clock.Source, StructNTP->Clock.SampleCount, StructNTP->Clock.StepCount);
+    log_info(__LINE__, __func__, "Clock frequency error:   %10ld ppb   (last offset: %lld usec)\r", StructNTP->Clock.FrequencyPpb, StructNTP->Clock.LastOffset);
+    if (StructNTP->LeapPending != 0)
+      log_info(__LINE__, __func__, "Leap second pending: %d   at UTC time %lld   (mode: %u)\r", StructNTP->LeapPending, StructNTP->LeapTime / 1000000ll, StructNTP->LeapMode);
+    if (StructNTP->PpsGpio != NTP_PPS_NONE)
+      log_info(__LINE__, __func__, "PPS GPIO: %2u   locked: 0x%2.2X   edges: %lu   rejected: %lu\r", StructNTP->PpsGpio, ntp_pps_locked(StructNTP), StructNTP->PpsEdges, StructNTP->PpsRejects);
+    if (StructNTP->FlagRtc)
+      log_info(__LINE__, __func__, "RTC set: 0x%2.2X   drift: %ld usec   alignments: %lu\r", StructNTP->FlagRtcSet, StructNTP->RtcDrift, StructNTP->RtcAlignCount);
+    if (StructNTP->Holdover != NULL)
+      log_info(__LINE__, __func__, "Holdover clock: %s   offset: %lld usec   drift: %ld ppb   errors: %lu\r", StructNTP->Holdover->Name, StructNTP->HoldoverOffset, StructNTP->HoldoverDriftPpb, StructNTP->HoldoverErrors);
+    log_info(__LINE__, __func__, "Authentication key ID:       %6lu   (errors: %lu   MAC time: %lu usec)\r", StructNTP->AuthKeyId, StructNTP->AuthErrors, StructNTP->AuthTime);
+    log_info(__LINE__, __func__, "Rejected replies:            %6lu\r", StructNTP->PacketErrors);
+    if (DhcpServerCount)
+      log_info(__LINE__, __func__, "NTP servers from DHCP: %u   next one: %u   pool servers for %u more read cycles\r", DhcpServerCount, StructNTP->DhcpIndex + 1, StructNTP->DhcpRetry);
+    for (Loop1UInt8 = 0; Loop1UInt8 < NTP_FAMILIES; ++Loop1UInt8)
+      if (StructNTP->Family[Loop1UInt8].Replies)
+        log_info(__LINE__, __func__, "IPv%u server: %-15s   round-trip: %ld usec   replies: %lu   interleaved: %lu%s\r", (Loop1UInt8 == NTP_FAMILY_V6) ? 6 : 4, ipaddr_ntoa(&StructNTP->Family[Loop1UInt8].Address), StructNTP->Family[Loop1UInt8].Delay, StructNTP->Family[Loop1UInt8].Replies, StructNTP->Family[Loop1UInt8].Interleaved, (Loop1UInt8 == StructNTP->FamilyPreferred) ? "   (preferred)" : "");
+    if (StructNTP->FlagCapture)
+      log_info(__LINE__, __func__, "Replies timestamped by CYW43 interrupt: %lu\r", StructNTP->CaptureCount);
+    if (StructNTP->ScheduleFired)
+      log_info(__LINE__, __func__, "Scheduled events fired: %lu   re-mapped: %lu   last latency: %ld usec\r", StructNTP->ScheduleFired, StructNTP->ScheduleRemaps, StructNTP->ScheduleLatency);
+    if (StructNTP->FlagBroadcast)
+      log_info(__LINE__, __func__, "Broadcast server: %-15s   one-way delay: %ld usec   broadcasts: %lu\r", ipaddr_ntoa(&StructNTP->BroadcastServer), StructNTP->BroadcastDelay, StructNTP->BroadcastCount);
+    if (StructNTP->FlagTempco)
+      log_info(__LINE__, __func__, "Crystal temperature: %ld mC   range: %ld to %ld mC   measurements: %lu   feed-forward: %ld ppb   last residual: %ld ppb\r", StructNTP->Tempco.Temperature, StructNTP->Tempco.Minimum, StructNTP->Tempco.Maximum, StructNTP->Tempco.Points, StructNTP->TempcoPpb, StructNTP->Tempco.ResidualPpb);
+    if (StructNTP->NotifyLost)
+      log_info(__LINE__, __func__, "Notifications lost (queue full): %lu\r", StructNTP->NotifyLost);
+    if (StructNTP->Adev != NULL)
+    {
+      ntp_get_stability(StructNTP, &Stability);
+      log_info(__LINE__, __func__, "Stability analyzer: source %u   samples: %lu   restarts: %lu   optimal poll: %s%lu sec   bad crystal: 0x%2.2X\r", Stability.Source, Stability.Samples, Stability.Restarts, (Stability.FlagOpen) ? ">= " : "", Stability.OptimalPoll, Stability.FlagBadCrystal);
+      for (Loop1UInt8 = 0; Loop1UInt8 < NTP_ADEV_LEVELS; ++Loop1UInt8)
+        if (Stability.Terms[Loop1UInt8])
+          log_info(__LINE__, __func__, "  tau: %8lu sec   Allan deviation: %10lu ppt   (terms: %lu)\r", Stability.Tau[Loop1UInt8], Stability.Deviation[Loop1UInt8], Stability.Terms[Loop1UInt8]);
+    }
+    log_info(__LINE__, __func__, "DNSRequestSent:                0x%2.2X\r", StructNTP->DNSRequestSent);
+    log_info(__LINE__, __func__, "ResendAlarm:                 %6u\r",       StructNTP->ResendAlarm);
+  }
+  log_info(__LINE__, __func__, "======================================================================\r\r\r");
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_dns_found() */
+/* ============================================================================================================================================================= *\
+                                                                   Call back with a DNS result.
+\* ============================================================================================================================================================= */
+static void ntp_dns_found(const char *HostName, const ip_addr_t *ipaddr, void *ExtraArgument)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  UCHAR String[20];
+
+  struct ntp_family *Family = ExtraArgument;
+
+  struct struct_ntp *StructNTP = Family->StructNTP;
+
+
+  if (FlagLocalDebug)
+  {
+    log_info(__LINE__, __func__, "Entering ntp_dns_found() - IPv%u\r", (Family->Type == NTP_FAMILY_V6) ? 6 : 4);
+    log_info(__LINE__, __func__, "NTP pool host name:         <%s>\r", HostName);
+    log_info(__LINE__, __func__, "NTP org host IP address:  %15s\r",   ipaddr_ntoa(&StructNTP->ServerAddress));
+    if (ipaddr) log_info(__LINE__, __func__, "NTP pool IP address:      %15s\r",   ipaddr_ntoa(ipaddr));
+  }
+
+  if (ipaddr)
+  {
+    Family->Address = *ipaddr;
+    ntp_request(StructNTP, Family);
+  }
+  else
+  {
+    /* The read cycle fails only if the other address family has not been resolved either. */
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "NTP DNS request failed.\r");
+    Family->FlagPending = FLAG_OFF;
+    if ((ntp_family_pending(StructNTP) == 0) && (StructNTP->FlagSampled == FLAG_OFF)) ntp_result(-1, NULL, StructNTP);
+  }
+
+  return;
+}
+
+
+
+
+
+/* $TITLE=ntp_dst_settings() */
+/* $PAGE */
+/* ============================================================================================================================================================= *\
+                                                  Set parameters required for Daily Saving Time automatic handling.
+                                            NOTE: StructNTP.UTCTime must have been initialized before calling this function.
+\* ============================================================================================================================================================= */
+void ntp_dst_settings(struct struct_ntp *StructNTP)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  UINT8 FlagNorth;   // indicate we are in a northern hemisphere country.
+  UINT8 StartDoM;
+  UINT8 EndDoM;
+  
+  UINT16 CurrentDayOfYear;
+
+  INT64 EndTime;
+  INT64 StartTime;
+
+
+  /* Validate DST country setting. */
+  if (StructNTP->DSTCountry == 0)
+  {
+    if (stdio_usb_connected()) log_info(__LINE__, __func__, "Daylight saving time is currently disabled: %u\r\r\r", StructNTP->DSTCountry);
+    StructNTP->FlagSummerTime = FLAG_OFF;
+    return;
+  }
+
+  if (StructNTP->DSTCountry > MAX_DST_COUNTRIES)
+  {
+    if (stdio_usb_connected()) log_info(__LINE__, __func__, "Invalid DST country setting: %u\r\r\r", StructNTP->DSTCountry);
+    StructNTP->FlagSummerTime = FLAG_OFF;
+    return;
+  }
+
+
+  StructNTP->ShiftMinutes = DstParameters[StructNTP->DSTCountry].ShiftMinutes;
+
+
+
+  /* --------------------------------------------------------------------------------------------------------------------------- *\
+                    Find day-of-week of Daylight Saving Time start for current year and for specific DST country.
+  \* --------------------------------------------------------------------------------------------------------------------------- */
+  /* Find the right day-of-week between the soonest and the latest possible dates. */
+  StartDoM = ntp_dst_find_day(DstParameters[StructNTP->DSTCountry].StartMonth, DstParameters[StructNTP->DSTCountry].StartDayOfWeek, DstParameters[StructNTP->DSTCountry].StartDayOfMonthLow, DstParameters[StructNTP->DSTCountry].StartDayOfMonthHigh, StructNTP->HumanTime.Year);
+
+  /* Check if operation has been successful. */
+  if (StartDoM == 0)
+  {
+    log_info(__LINE__, __func__, "Date for daylight saving time start NOT FOUND\r\r\r");
+    StructNTP->FlagSummerTime = FLAG_OFF;
+    return;
+  }
+  else
+  {
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "Date for daylight saving time start in %4.4u: %2.2u-%s-%4.4u\r", StructNTP->HumanTime.Year, StartDoM, ntp_get_short_month(DstParameters[StructNTP->DSTCountry].StartMonth), StructNTP->HumanTime.Year);
+  }
+
+
+
+  /* --------------------------------------------------------------------------------------------------------------------------- *\
+                    Find day-of-week of Daylight Saving Time end for current year and for specific DST country.
+  \* --------------------------------------------------------------------------------------------------------------------------- */
+  /* Find the right day-of-week between the soonest and the latest possible dates. */
+  EndDoM = ntp_dst_find_day(DstParameters[StructNTP->DSTCountry].EndMonth, DstParameters[StructNTP->DSTCountry].EndDayOfWeek, DstParameters[StructNTP->DSTCountry].EndDayOfMonthLow, DstParameters[StructNTP->DSTCountry].EndDayOfMonthHigh, StructNTP->HumanTime.Year);
+
+  /* Check if operation has been successful. */
+  if (EndDoM == 0)
+  {
+    log_info(__LINE__, __func__, "Date for daylight saving time end NOT FOUND\r\r\r");
+    StructNTP->FlagSummerTime = FLAG_OFF;
+    return;
+  }
+  else
+  {
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "Date for daylight saving time end   in %4.4u: %2.2u-%s-%4.4u\r", StructNTP->HumanTime.Year, EndDoM, ntp_get_short_month(DstParameters[StructNTP->DSTCountry].EndMonth), StructNTP->HumanTime.Year);
+  }
+
+
+
+  /* --------------------------------------------------------------------------------------------------------------------------- *\
+                                Check if DST country specified is for a northern or southern country.
+  \* --------------------------------------------------------------------------------------------------------------------------- */
+  if (DstParameters[StructNTP->DSTCountry].StartMonth < DstParameters[StructNTP->DSTCountry].EndMonth)
+  {
+    FlagNorth = FLAG_ON;
+    log_info(__LINE__, __func__, "Daylight saving time current parameters:\r");
+    if (FlagLocalDebug)
+      log_info(__LINE__, __func__, "Northern DST country: %u     Delta time with UTC: %d minutes     DST shift: %d minutes.\r", StructNTP->DSTCountry, StructNTP->DeltaTime, DstParameters[StructNTP->DSTCountry].ShiftMinutes);
+  }
+  else
+  {
+    FlagNorth = FLAG_OFF;
+    if (FlagLocalDebug)
+      log_info(__LINE__, __func__, "Southern DST country: %u     Delta time with UTC: %d minutes     DST shift: %d minutes.\r", StructNTP->DSTCountry, StructNTP->DeltaTime, DstParameters[StructNTP->DSTCountry].ShiftMinutes);
+  }
+
+
+
+  /* --------------------------------------------------------------------------------------------------------------------------- *\
+                                  Find UTC time for DST start time and DST end time for current year.
+  \* --------------------------------------------------------------------------------------------------------------------------- */
+  /* Keep day-of-year values for DST start and DST end. */
+  StructNTP->DoYStart = ntp_get_day_of_year(StartDoM, DstParameters[StructNTP->DSTCountry].StartMonth, StructNTP->HumanTime.Year);
+  StructNTP->DoYEnd   = ntp_get_day_of_year(EndDoM,   DstParameters[StructNTP->DSTCountry].EndMonth,   StructNTP->HumanTime.Year);
+
+  /* DST starts during "normal time" and ends during "summer time"; change hours are local time or UTC time, depending on the country (see ntp-dst.c). */
+  ntp_dst_get_changes(StructNTP->DSTCountry, StructNTP->HumanTime.Year, StructNTP->DeltaTime, &StartTime, &EndTime);
+  StructNTP->DSTStart = (UINT64)StartTime;
+  StructNTP->DSTEnd   = (UINT64)EndTime;
+
+
+  /* --------------------------------------------------------------------------------------------------------------------------- *\
+                                        Display parameters found for DST start and end time.
+  \* --------------------------------------------------------------------------------------------------------------------------- */
+  log_info(__LINE__, __func__, "DST start date for %4.4u: %8s %2.2u-%s-%4.4u at %2.2u:00   day-of-year: %3u   UTC time: %llu\r",
+            StructNTP->HumanTime.Year,
+            ntp_get_day_name(DstParameters[StructNTP->DSTCountry].StartDayOfWeek),
+            StartDoM, ntp_get_short_month(DstParameters[StructNTP->DSTCountry].StartMonth), StructNTP->HumanTime.Year,
+            DstParameters[StructNTP->DSTCountry].StartHour, StructNTP->DoYStart,
+            StructNTP->DSTStart);
+
+  log_info(__LINE__, __func__, "DST end   date for %4.4u: %8s %2.2u-%s-%4.4u at %2.2u:00   day-of-year: %3u   UTC time: %llu\r",
+            StructNTP->HumanTime.Year,
+            ntp_get_day_name(DstParameters[StructNTP->DSTCountry].EndDayOfWeek),
+            EndDoM, ntp_get_short_month(DstParameters[StructNTP->DSTCountry].EndMonth), StructNTP->HumanTime.Year,
+            DstParameters[StructNTP->DSTCountry].EndHour, StructNTP->DoYEnd,
+            StructNTP->DSTEnd);
+
+
+
+  /* --------------------------------------------------------------------------------------------------------------------------- *\
+                                                  Update local time from UTC time in StructNTP.
+              NOTE: This value can be wrong if the function is called during the one-hour period of the time change,
+                    either from summer timer to winter time or vice versa... This will come back to normal after next reboot
+                    or after next NTP update.
+  \* --------------------------------------------------------------------------------------------------------------------------- */
+  StructNTP->LocalTime = StructNTP->UTCTime + ((INT64)(StructNTP->DeltaTime * 60));
+  if (FlagLocalDebug)
+  {
+    log_info(__LINE__, __func__, "StructNTP->UTCTime:    %12llu\r",    StructNTP->UTCTime);
+    log_info(__LINE__, __func__, "StructNTP->LocalTime:  %12llu\r",    StructNTP->LocalTime);
+    log_info(__LINE__, __func__, "StructNTP->DeltaTime:        %6d minutes\r", StructNTP->DeltaTime);
+  }
+
+
+
+  // log_info(__LINE__, __func__, "StructNTP->UTCTime before accounting for summer time or winter time: %12llu\r", StructNTP->UTCTime);  ///
+
+  /* --------------------------------------------------------------------------------------------------------------------------- *\
+                                                Check if DST is currently On or Off.
+  \* --------------------------------------------------------------------------------------------------------------------------- */
+  /* Find if daylight saving time is active for a southern country. */
+  if (FlagNorth == FLAG_ON)
+  {
+    /* Find for a northern country. */
+    if ((StructNTP->UTCTime > StructNTP->DSTStart) && (StructNTP->UTCTime < StructNTP->DSTEnd))
+    {
+      StructNTP->FlagSummerTime = FLAG_ON;
+      log_info(__LINE__, __func__, "DST settings is for a northern country and currently during daily saving time period of the year.\r");
+    }
+    else
+    {
+      StructNTP->FlagSummerTime = FLAG_OFF;
+      log_info(__LINE__, __func__, "DST settings is for a northern country and currently not during daily saving time period of the year.\r");
+    }
+  }
+  else
+  {
+    /* Find for a southern country. */
+    if ((StructNTP->UTCTime > StructNTP->DSTEnd) && (StructNTP->UTCTime < StructNTP->DSTStart))
+    {
+      StructNTP->FlagSummerTime = FLAG_OFF;
+      log_info(__LINE__, __func__, "DST settings is for a southern country and currently not during daily saving time period of the year.\r");
+    }
+    else
+    {
+      StructNTP->FlagSummerTime = FLAG_ON;
+      log_info(__LINE__, __func__, "DST settings is for a southern country and currently during daily saving time period of the year.\r");
+    }
+  }
+
+  if (StructNTP->FlagSummerTime) StructNTP->LocalTime += (StructNTP->ShiftMinutes * 60);
+
+  /* Observers are notified when DST starts or ends, whoever called this function (read cycle or NTP_CORE1_DST), but not when it is found on first sync. */
+  if (StructNTP->FlagSummerTime != StructNTP->NotifyDst)
+  {
+    if (StructNTP->NotifyDst != NTP_NOTIFY_UNKNOWN) ntp_observer_post(StructNTP, NTP_NOTIFY_DST, StructNTP->FlagSummerTime);
+    StructNTP->NotifyDst = StructNTP->FlagSummerTime;
+  }
+
+  if (FlagLocalDebug)
+  {
+    log_info(__LINE__, __func__, "StructNTP.LocalTime:   %12llu\r", StructNTP->LocalTime);
+    log_info(__LINE__, __func__, "StructNTP.FlagSummerTime:      0x%2.2X\r", StructNTP->FlagSummerTime);
+    log_info(__LINE__, __func__, "StructNTP.UTCTime:     %12llu\r", StructNTP->UTCTime);
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_failed_handler() */
+/* ============================================================================================================================================================= *\
+                                                                           NTP request failed.
+\* ============================================================================================================================================================= */
+static int64_t ntp_failed_handler(alarm_id_t AlarmId, void *ExtraArgument)
+{
+  UINT8 Loop1UInt8;
+
+  UINT64 CurrentTime;
+
+  struct ntp_exchange Exchange;
+
+  struct ntp_family *Family;
+
+  struct struct_ntp *StructNTP;
+
+
+  StructNTP = (struct struct_ntp *)ExtraArgument;
+
+  /* Interleaved mode: the second reply of a burst has been lost, its first exchange is used in basic mode (server time extrapolated). */
+  CurrentTime = time_us_64();
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_FAMILIES; ++Loop1UInt8)
+  {
+    Family = &StructNTP->Family[Loop1UInt8];
+    if (ntp_sync_burst_close(&Family->Burst, CurrentTime, &Exchange) != NTP_SYNC_OK) continue;
+
+    Family->FlagPending = FLAG_OFF;
+    ntp_reply_use(StructNTP, Family, &Family->Burst.Info, &Exchange, ntp_ts_to_unix_us(Exchange.T3, Exchange.PivotTime) + (INT64)(CurrentTime - Exchange.Receive), ntp_pps_locked(StructNTP), FLAG_OFF);
+  }
+  if (StructNTP->FlagSampled) return 0;
+
+  /* Alarm callback (interrupt context): logged through the event log only. */
+  ntp_log_event(NTP_LOG_SYNC, NTP_EVENT_FAILED, AlarmId, ntp_family_pending(StructNTP), 0);
+  ntp_trace_exchange(StructNTP, NTP_TRACE_TIMEOUT, NTP_SYNC_TIMEOUT, 0, NULL, NULL, NULL);
+  StructNTP->RaceCount = 0;  // race both address families again on next read cycle.
+  ntp_result(-1, NULL, StructNTP);
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_family_pending() */
+/* ============================================================================================================================================================= *\
+                                     Return the address families (bit mask) still waiting for a DNS answer or an NTP reply.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_family_pending(struct struct_ntp *StructNTP)
+{
+  UINT8 Loop1UInt8;
+  UINT8 Mask;
+
+
+  Mask = 0;
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_FAMILIES; ++Loop1UInt8)
+    if (StructNTP->Family[Loop1UInt8].FlagPending) Mask |= (1 << Loop1UInt8);
+
+  return Mask;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_family_select() */
+/* ============================================================================================================================================================= *\
+                                                  Select the address family with the shortest round-trip delay.
+                          NOTE: IPv6 is selected when both families have the same delay. Families that did not answer are ignored.
+\* ============================================================================================================================================================= */
+static void ntp_family_select(struct struct_ntp *StructNTP)
+{
+  UINT8 Loop1UInt8;
+  UINT8 Preferred;
+
+
+  Preferred = NTP_FAMILY_NONE;
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_FAMILIES; ++Loop1UInt8)
+  {
+    if (StructNTP->Family[Loop1UInt8].Delay < 0) continue;
+    if ((Preferred == NTP_FAMILY_NONE) || (StructNTP->Family[Loop1UInt8].Delay < StructNTP->Family[Preferred].Delay)) Preferred = Loop1UInt8;
+  }
+
+  if ((Preferred == NTP_FAMILY_NONE) || (Preferred == StructNTP->FamilyPreferred)) return;
+
+  ntp_log_event(NTP_LOG_SYNC, NTP_EVENT_FAMILY, (Preferred == NTP_FAMILY_V6) ? 6 : 4, StructNTP->Family[NTP_FAMILY_V6].Delay, StructNTP->Family[NTP_FAMILY_V4].Delay);
+  StructNTP->FamilyPreferred = Preferred;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_format() */
+/* ============================================================================================================================================================= *\
+                                          Format a human time in a string, according to a template compiled by ntp_format_compile().
+                  NOTE: Day and month names are those of the current language (see ntp_set_language()), %K follows ntp_format_set_hour_mode().
+                        Result is truncated to BufferSize - 1 characters. Return the number of characters written.
+\* ============================================================================================================================================================= */
+UINT16 ntp_format(UCHAR *Buffer, UINT16 BufferSize, const struct ntp_format *Format, const struct human_time *HumanTime)
+{
+  return ntp_format_apply(Buffer, BufferSize, Format, HumanTime, LanguageTable[CurrentLanguage], FormatHourMode);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_format_set_hour_mode() */
+/* ============================================================================================================================================================= *\
+                                                       Select hour display mode (H12 or H24) used by the %K specification of ntp_format().
+\* ============================================================================================================================================================= */
+void ntp_format_set_hour_mode(UINT8 HourMode)
+{
+  FormatHourMode = (HourMode == H12) ? H12 : H24;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_day_name() */
+/* ============================================================================================================================================================= *\
+                                        Return the name of the day of week specified (Sunday = 0) in current language.
+\* ============================================================================================================================================================= */
+const UCHAR *ntp_get_day_name(UINT8 DayOfWeek)
+{
+  if (DayOfWeek > SAT) return " ";
+
+  return LanguageTable[CurrentLanguage][NTP_NAME_DAY + DayOfWeek];
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_language() */
+/* ============================================================================================================================================================= *\
+                                                 Return the language currently used for day and month names.
+\* ============================================================================================================================================================= */
+UINT8 ntp_get_language(void)
+{
+  return CurrentLanguage;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_month_name() */
+/* ============================================================================================================================================================= *\
+                                          Return the name of the month specified (January = 1) in current language.
+\* ============================================================================================================================================================= */
+const UCHAR *ntp_get_month_name(UINT8 Month)
+{
+  if (Month > 12) Month = 0;
+
+  return LanguageTable[CurrentLanguage][NTP_NAME_MONTH + Month];
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_short_day() */
+/* ============================================================================================================================================================= *\
+                               Return the short (3-letter) name of the day of week specified (Sunday = 0) in current language.
+\* ============================================================================================================================================================= */
+const UCHAR *ntp_get_short_day(UINT8 DayOfWeek)
+{
+  if (DayOfWeek > SAT) return " ";
+
+  return LanguageTable[CurrentLanguage][NTP_NAME_SHORT_DAY + DayOfWeek];
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_short_month() */
+/* ============================================================================================================================================================= *\
+                                  Return the short (3-letter) name of the month specified (January = 1) in current language.
+\* ============================================================================================================================================================= */
+const UCHAR *ntp_get_short_month(UINT8 Month)
+{
+  if (Month > 12) Month = 0;
+
+  return LanguageTable[CurrentLanguage][NTP_NAME_SHORT_MONTH + Month];
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_stability() */
+/* ============================================================================================================================================================= *\
+                                             Return the frequency stability of the crystal measured by the analyzer.
+                   NOTE: Meant for burn-in tests (FlagBadCrystal) and to choose the NTP refresh interval of a device (OptimalPoll). The
+                         Allan deviation is computed with interrupts disabled one averaging time at a time, as PPS edges update it from an interrupt.
+\* ============================================================================================================================================================= */
+void ntp_get_stability(struct struct_ntp *StructNTP, struct ntp_stability *Stability)
+{
+  UINT8 Last;
+  UINT8 Loop1UInt8;
+
+  UINT32 InterruptMask;
+
+
+  memset(Stability, 0x00, sizeof(struct ntp_stability));
+  Stability->Intercept = NTP_ADEV_NONE;
+  if (StructNTP->Adev == NULL) return;
+
+  Stability->FlagValid = FLAG_ON;
+  Stability->Source    = StructNTP->Adev->Source;
+  Last                 = NTP_ADEV_NONE;
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_ADEV_LEVELS; ++Loop1UInt8)
+  {
+    InterruptMask = spin_lock_blocking(ClockLock);
+    Stability->Deviation[Loop1UInt8] = ntp_adev_deviation(StructNTP->Adev, Loop1UInt8, &Stability->Terms[Loop1UInt8]);
+    spin_unlock(ClockLock, InterruptMask);
+
+    Stability->Tau[Loop1UInt8] = ntp_adev_tau(StructNTP->Adev, Loop1UInt8);
+    if (Stability->Terms[Loop1UInt8] >= NTP_ADEV_MIN_TERMS) Last = Loop1UInt8;
+  }
+  Stability->Samples  = StructNTP->Adev->Samples;
+  Stability->Restarts = StructNTP->Adev->Restarts;
+
+  /* Same as ntp_adev_intercept(), on the deviations just read. */
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_ADEV_LEVELS; ++Loop1UInt8)
+  {
+    if (Stability->Terms[Loop1UInt8] < NTP_ADEV_MIN_TERMS) continue;
+    if ((Stability->Intercept == NTP_ADEV_NONE) || (Stability->Deviation[Loop1UInt8] < Stability->Deviation[Stability->Intercept])) Stability->Intercept = Loop1UInt8;
+  }
+
+  if (Stability->Intercept != NTP_ADEV_NONE)
+  {
+    Stability->OptimalPoll    = Stability->Tau[Stability->Intercept];
+    Stability->FlagOpen       = (Stability->Intercept == Last) ? FLAG_ON : FLAG_OFF;
+    Stability->FlagBadCrystal = (Stability->Deviation[Stability->Intercept] > (NTP_ADEV_BAD_PPB * 1000ul)) ? FLAG_ON : FLAG_OFF;
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_status() */
+/* ============================================================================================================================================================= *\
+                                                Return clock quality: error bound, leap indicator, stratum and time since last sync.
+                  NOTE: The error bound is the error right after the last sample plus the offset not slewed yet, growing by NTP_FREQ_TOLERANCE_PPM
+                        for the time elapsed since then. It is cheap enough to be called before each timed action instead of forcing an NTP sync.
+\* ============================================================================================================================================================= */
+void ntp_get_status(struct struct_ntp *StructNTP, struct ntp_status *Status)
+{
+  UINT32 InterruptMask;
+
+  UINT64 Age;
+  UINT64 LocalTime;
+  UINT64 MaxError;
+
+  INT64 Pending;
+
+  struct ntp_snapshot Snapshot;
+
+
+  /* Same as ntp_schedule_at(): the clock may be updated at any time by a PPS edge or by the other core. */
+  if ((StructNTP->FlagCore1) && (get_core_num() == 0))
+  {
+    ntp_snapshot_read(StructNTP, &Snapshot);
+  }
+  else
+  {
+    InterruptMask = spin_lock_blocking(ClockLock);
+    Snapshot.Clock = StructNTP->Clock;
+    spin_unlock(ClockLock, InterruptMask);
+  }
+
+  Status->LeapIndicator = StructNTP->LeapIndicator;
+  Status->Source        = Snapshot.Clock.Source;
+  Status->FlagValid     = Snapshot.Clock.FlagValid;
+
+  if (Status->FlagValid == FLAG_OFF)
+  {
+    Status->Stratum  = 0;
+    Status->MaxError = NTP_UNKNOWN_ERROR;
+    Status->SyncAge  = NTP_UNKNOWN_ERROR;
+    return;
+  }
+
+  LocalTime = time_us_64();
+  Age       = LocalTime - Snapshot.Clock.LastSample;
+  Pending   = ntp_clock_get_pending(&Snapshot.Clock, LocalTime);
+
+  if (Snapshot.Clock.Source == NTP_SOURCE_PPS)
+  {
+    Status->Stratum = 1;
+    MaxError        = NTP_PPS_ERROR;
+  }
+  else if (Snapshot.Clock.Source == NTP_SOURCE_HOLDOVER)
+  {
+    /* Time only comes from the battery-backed clock: not synchronized as far as other NTP clients are concerned. */
+    Status->Stratum = NTP_STRATUM_UNSYNC;
+    MaxError        = StructNTP->SyncError;
+  }
+  else
+  {
+    Status->Stratum = (StructNTP->Stratum == 0) ? 0 : StructNTP->Stratum + 1;
+    MaxError        = StructNTP->SyncError;
+  }
+
+  MaxError += (UINT64)((Pending < 0) ? -Pending : Pending);
+  MaxError += (Age * NTP_FREQ_TOLERANCE_PPM) / 1000000ull;
+  Status->MaxError = (MaxError > NTP_UNKNOWN_ERROR) ? NTP_UNKNOWN_ERROR : (UINT32)MaxError;
+  Status->SyncAge  = (UINT32)(Age / 1000000ull);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_time() */
+/* ============================================================================================================================================================= *\
+                                                               Retrieve current UTC time from NTP server.
+\* ============================================================================================================================================================= */
+void ntp_get_time(struct struct_ntp *StructNTP)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  UCHAR Dum1Str[64];
+
+  INT ReturnCode;
+
+  UINT8 FamilyMask;
+  UINT8 FlagRetry;
+  UINT8 Loop1UInt8;
+
+  INT64 DeltaTime;
+
+  struct ntp_family *Family;
+
+
+  if (FlagLocalDebug)
+  {
+    log_info(__LINE__, __func__, "======================================================================\r");
+    log_info(__LINE__, __func__, "                       Entering ntp_get_time()\r");
+    // display_ntp_info();
+  }
+
+
+  if (StructNTP->FlagInit == FLAG_OFF) log_info(__LINE__, __func__, "ntp_init() has not already been done successfully. Aborting...\r");
+
+
+  /* Measure and write the holdover clock, if any, after a good sync. */
+  ntp_holdover_update(StructNTP);
+
+
+  /* In broadcast mode, no request is sent while broadcasts from a calibrated server are received. */
+  if ((StructNTP->FlagBroadcast) && (StructNTP->BroadcastDelay >= 0))
+  {
+    if ((time_us_64() - StructNTP->BroadcastLast) < NTP_BROADCAST_TIMEOUT)
+    {
+      StructNTP->UpdateTime  = make_timeout_time_ms(NTP_REFRESH * 1000);
+      StructNTP->FlagSuccess = FLAG_POLL;
+      StructNTP->PollCycles++;
+
+      return;
+    }
+
+    /* Broadcasts lost: back to read cycles, the server will be calibrated again if its broadcasts come back. */
+    StructNTP->BroadcastDelay = -1l;
+  }
+
+
+  /* While the stability analyzer runs on NTP replies, every cycle is a read cycle (see ntp_adev_init()). */
+  if ((StructNTP->FlagHealth) && (StructNTP->AdevPoll == 0) && (StructNTP->ScanCount < NTP_SCAN_FACTOR) && (!is_nil_time(StructNTP->UpdateTime)))
+  {
+    if (FlagLocalDebug)
+    {
+      log_info(__LINE__, __func__, "================================================================\r");
+      log_info(__LINE__, __func__, "                           Poll cycle\r");
+      log_info(__LINE__, __func__, "================================================================\r");
+      // display_ntp_info();
+    }
+
+    StructNTP->UpdateTime = make_timeout_time_ms(NTP_REFRESH * 1000);
+    StructNTP->FlagSuccess = FLAG_POLL;
+    StructNTP->PollCycles++;
+    StructNTP->ScanCount++;
+
+    return;
+  }
+
+
+  if (FlagLocalDebug)
+  {
+    log_info(__LINE__, __func__, "======================================================================\r");
+    log_info(__LINE__, __func__, "                              Read cycle\r");
+    log_info(__LINE__, __func__, "======================================================================\r");
+    // display_ntp_info(StructNTP);
+  }
+
+  StructNTP->UpdateTime = make_timeout_time_ms(((StructNTP->AdevPoll) ? StructNTP->AdevPoll : NTP_REFRESH) * 1000);
+  StructNTP->ReadCycles++;
+  StructNTP->ScanCount = 1;
+
+  /* Set alarm in case udp requests are lost (10 seconds). */
+  StructNTP->ResendAlarm = alarm_pool_add_alarm_in_ms(StructNTP->AlarmPool, NTP_RESEND_TIME, ntp_failed_handler, StructNTP, true);
+
+  /* NTP servers advertised by DHCP are usually on the LAN: they are used first, without any DNS request. */
+  if (StructNTP->DhcpSequence != DhcpSequence)
+  {
+    /* New DHCP lease: start again with the first server. */
+    StructNTP->DhcpSequence = DhcpSequence;
+    StructNTP->DhcpIndex    = 0;
+    StructNTP->DhcpRetry    = 0;
+  }
+
+  if ((StructNTP->DhcpRetry > 0) && (--StructNTP->DhcpRetry == 0)) StructNTP->DhcpIndex = 0;  // try DHCP servers again.
+
+  StructNTP->FlagDhcp    = FLAG_OFF;
+  StructNTP->FlagSampled = FLAG_OFF;
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_FAMILIES; ++Loop1UInt8)
+  {
+    /* A new burst of 2 is sent in interleaved mode (see ntp_recv()). */
+    StructNTP->Family[Loop1UInt8].FlagBurst      = FLAG_OFF;
+    StructNTP->Family[Loop1UInt8].Burst.FlagOpen = FLAG_OFF;
+  }
+
+  if (StructNTP->DhcpIndex < DhcpServerCount)
+  {
+    Family = &StructNTP->Family[NTP_FAMILY_V4];
+    for (Loop1UInt8 = 0; Loop1UInt8 < NTP_FAMILIES; ++Loop1UInt8)
+      StructNTP->Family[Loop1UInt8].FlagPending = ((Loop1UInt8 == NTP_FAMILY_V4) ? FLAG_ON : FLAG_OFF);
+
+    cyw43_arch_lwip_begin();
+    {
+      Family->Address = DhcpServers[StructNTP->DhcpIndex];
+    }
+    cyw43_arch_lwip_end();
+
+    StructNTP->FlagDhcp = FLAG_ON;
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "Using NTP server advertised by DHCP (%u / %u).\r", StructNTP->DhcpIndex + 1, DhcpServerCount);
+    ntp_request(StructNTP, Family);
+
+    return;
+  }
+
+  /* Both address families are raced on the first read cycle and every NTP_RACE_CYCLES read cycles, otherwise only the fastest one is used. */
+  if (StructNTP->RaceCount == 0)
+  {
+    FamilyMask           = NTP_FAMILY_ALL;
+    StructNTP->RaceCount = NTP_RACE_CYCLES;
+    for (Loop1UInt8 = 0; Loop1UInt8 < NTP_FAMILIES; ++Loop1UInt8)
+      StructNTP->Family[Loop1UInt8].Delay = -1l;
+  }
+  else
+  {
+    FamilyMask = (1 << StructNTP->FamilyPreferred);
+    --StructNTP->RaceCount;
+  }
+
+  /* All families are marked pending first: a DNS request failing right away must not end the read cycle while the other one is in progress. */
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_FAMILIES; ++Loop1UInt8)
+    StructNTP->Family[Loop1UInt8].FlagPending = ((FamilyMask & (1 << Loop1UInt8)) ? FLAG_ON : FLAG_OFF);
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_FAMILIES; ++Loop1UInt8)
+  {
+    Family = &StructNTP->Family[Loop1UInt8];
+    if (Family->FlagPending == FLAG_OFF) continue;
+
+    /* NOTE: cyw43_arch_lwip_begin() / cyw43_arch_lwip_end() should be used around calls into LwIP to ensure correct locking.
+             You can omit them if you are in a callback from LwIP. Note that when using pico_cyw_arch_poll library these calls
+             are a no-op and can be omitted, but it is a good practice to use them in case you switch the cyw43_arch type later. */
+    cyw43_arch_lwip_begin();
+    {
+      ReturnCode = dns_gethostbyname_addrtype(NTP_SERVER, &Family->Address, ntp_dns_found, Family, (Family->Type == NTP_FAMILY_V6) ? LWIP_DNS_ADDRTYPE_IPV6 : LWIP_DNS_ADDRTYPE_IPV4);
+    }
+    cyw43_arch_lwip_end();
+
+
+    StructNTP->DNSRequestSent = true;
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "Request NTP server IPv%u address from NTP pool: <%s>\r", (Family->Type == NTP_FAMILY_V6) ? 6 : 4, NTP_SERVER);
+
+
+    if (ReturnCode == 0)
+    {
+      if (FlagLocalDebug) log_info(__LINE__, __func__, "Cache DNS response.\r");
+      ntp_request(StructNTP, Family);  // cached result.
+    }
+    else
+    {
+      /* Other error codes. */
+      switch (ReturnCode)
+      {
+        case (ERR_OK):
+          /* ReturnCode = 0 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "No error, everything OK.\r");
+        break;
+
+        case (ERR_MEM):
+          /* ReturnCode = -1 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Out of memory.\r");
+        break;
+
+        case (ERR_BUF):
+          /* ReturnCode = -2 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Buffer error.\r");
+        break;
+
+        case (ERR_TIMEOUT):
+          /* ReturnCode = -3 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Timeout.\r");
+        break;
+
+        case (ERR_RTE):
+          /* ReturnCode = -4 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Routing problem.\r");
+        break;
+
+        case (ERR_INPROGRESS):
+          /* ReturnCode = -5 */
+          if (FlagLocalDebug)
+          {
+            log_info(__LINE__, __func__, "Request sent for an NTP server address. Return code: <ERR_INPROGRESS>.\r");
+            log_info(__LINE__, __func__, "Waiting for callback.\r");
+          }
+        break;
+
+        case (ERR_VAL):
+          /* ReturnCode = -6 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Illegal value.\r");
+        break;
+
+        case (ERR_WOULDBLOCK):
+          /* ReturnCode = -7 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Operation would block.\r");
+        break;
+
+        case (ERR_USE):
+          /* ReturnCode = -8 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Address in use.\r");
+        break;
+
+        case (ERR_ALREADY):
+          /* ReturnCode = -9 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Already connecting.\r");
+        break;
+
+        case (ERR_ISCONN):
+          /* ReturnCode = -10 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Connection already established.\r");
+        break;
+
+        case (ERR_CONN):
+          /* ReturnCode = -11 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Not connected.\r");
+        break;
+
+        case (ERR_IF):
+          /* ReturnCode = -12 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Low level netif error.\r");
+        break;
+
+        case (ERR_ABRT):
+          /* ReturnCode = -13 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Connection aborted.\r");
+        break;
+
+        case (ERR_RST):
+          /* ReturnCode = -14 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Connection reset.\r");
+        break;
+
+        case (ERR_CLSD):
+          /* ReturnCode = -15 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Connection closed.\r");
+        break;
+
+        case (ERR_ARG):
+          /* ReturnCode = -16 */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Illegal argument.\r");
+        break;
+
+        default:
+          /* Unrecognized ReturnCode. */
+          if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Unknown return code: %d\r", ReturnCode);
+        break;
+      }
+    }
+
+    /* DNS request could not be sent for this family. */
+    if ((ReturnCode != ERR_OK) && (ReturnCode != ERR_INPROGRESS)) Family->FlagPending = FLAG_OFF;
+  }
+
+  /* The read cycle fails only if no DNS request could be sent (otherwise, ntp_dns_found() will be called back). */
+  if (ntp_family_pending(StructNTP) == 0) ntp_result(-1, NULL, StructNTP);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_timestamp() */
+/* ============================================================================================================================================================= *\
+                                                           Return current time of the disciplined clock as an NTP timestamp.
+\* ============================================================================================================================================================= */
+ntp_timestamp_t ntp_get_timestamp(struct struct_ntp *StructNTP)
+{
+  return ntp_ts_from_unix_us(ntp_get_utc_us(StructNTP));
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_utc_us() */
+/* ============================================================================================================================================================= *\
+                                                 Return current UTC time (in usec since 01-JAN-1970) from the disciplined clock.
+                 NOTE: Return 0 if the clock has never been set. Time returned takes a pending leap second into account. It is monotonic only while
+                       offsets are slewed: a clock step (offset larger than NTP_CLOCK_STEP_US) or a leap second applied in step mode may move it
+                       backward. Callers that must not see time go back should register an observer for NTP_NOTIFY_STEP (see ntp_observer_add()).
+\* ============================================================================================================================================================= */
+INT64 ntp_get_utc_us(struct struct_ntp *StructNTP)
+{
+  UINT32 InterruptMask;
+
+  UINT64 LocalTime;
+
+  INT64 UTCTime;
+
+  struct ntp_snapshot Snapshot;
+
+
+  /* When the time service runs on core 1, core 0 reads the snapshot it publishes. */
+  if ((StructNTP->FlagCore1) && (get_core_num() == 0))
+  {
+    ntp_snapshot_read(StructNTP, &Snapshot);
+    if (Snapshot.Clock.FlagValid == FLAG_OFF) return 0ll;
+
+    return ntp_leap_adjust(Snapshot.LeapPending, Snapshot.LeapMode, Snapshot.LeapTime, ntp_clock_get_utc_us(&Snapshot.Clock, time_us_64()));
+  }
+
+  if (StructNTP->Clock.FlagValid == FLAG_OFF) return 0ll;
+
+  /* Prevent a PPS edge or the other core from updating the clock while we read it. */
+  InterruptMask = spin_lock_blocking(ClockLock);
+  LocalTime = time_us_64();
+  ntp_leap_apply(StructNTP, LocalTime);
+  UTCTime = ntp_leap_adjust(StructNTP->LeapPending, StructNTP->LeapMode, StructNTP->LeapTime, ntp_clock_get_utc_us(&StructNTP->Clock, LocalTime));
+  spin_unlock(ClockLock, InterruptMask);
+
+  return UTCTime;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_holdover_feed() */
+/* ============================================================================================================================================================= *\
+                                           Feed the time read from the holdover clock to the disciplined clock while NTP is unreachable.
+                 NOTE: Without it, the disciplined clock free-runs on the Pico crystal (tens of ppm, with no temperature compensation) for the whole
+                       outage, while the holdover clock (a few ppm for a DS3231) is left unused after power-up. The time read is fed as an
+                       NTP_SOURCE_HOLDOVER sample at most every NTP_HOLDOVER_FEED, without counting as a successful NTP cycle.
+\* ============================================================================================================================================================= */
+static void ntp_holdover_feed(struct struct_ntp *StructNTP)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  UINT32 InterruptMask;
+
+  UINT64 Age;
+  UINT64 LocalTime;
+
+  INT64 UTCTime;
+
+  struct ntp_clock Clock;
+
+
+  /* Last NTP cycle succeeded, or PPS keeps disciplining the clock. */
+  if ((StructNTP->FlagHealth == FLAG_ON) || (ntp_pps_locked(StructNTP))) return;
+
+  InterruptMask = spin_lock_blocking(ClockLock);
+  Clock         = StructNTP->Clock;
+  spin_unlock(ClockLock, InterruptMask);
+
+  /* Clock disciplined (or fed) recently enough. A clock never set is fed right away. */
+  Age = time_us_64() - Clock.LastSample;
+  if ((Clock.FlagValid) && (Age < NTP_HOLDOVER_FEED)) return;
+
+  /* Reading a DS3231 takes up to one second: Pico timer is read right after, when the time returned is current. */
+  if (StructNTP->Holdover->Read(StructNTP->Holdover->Context, &UTCTime) != 0)
+  {
+    ++StructNTP->HoldoverErrors;
+    return;
+  }
+  LocalTime = time_us_64();
+
+  InterruptMask = spin_lock_blocking(ClockLock);
+  ntp_trace_clock(StructNTP, NTP_TRACE_SAMPLE, 0, NTP_SOURCE_HOLDOVER, LocalTime, UTCTime);
+  ntp_clock_sample(&StructNTP->Clock, LocalTime, UTCTime, NTP_SOURCE_HOLDOVER);
+  ntp_snapshot_publish(StructNTP);
+  spin_unlock(ClockLock, InterruptMask);
+  StructNTP->SyncError = NTP_HOLDOVER_ERROR;
+
+  if (FlagLocalDebug) log_info(__LINE__, __func__, "Holdover clock fed to the disciplined clock (%llu sec since last sample).\r", Age / 1000000ull);
+  ntp_log_event(NTP_LOG_HOLDOVER, NTP_EVENT_HOLDOVER_FEED, (Clock.FlagValid) ? (INT32)(Age / 1000000ull) : -1l, 0, 0);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_holdover_init() */
+/* ============================================================================================================================================================= *\
+                                                  Use an external clock (see ntp-holdover.h) as holdover source and read time from it.
+                 NOTE: Must be called after ntp_init(). If the clock has not been set yet, the time read from the holdover clock sets it right away
+                       (with an error bound of NTP_HOLDOVER_ERROR) without waiting for Wi-Fi and NTP. May take up to one second with a DS3231.
+                       Return 0 if time has been read from the holdover clock.
+\* ============================================================================================================================================================= */
+UINT8 ntp_holdover_init(struct struct_ntp *StructNTP, struct ntp_holdover *Holdover)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  UINT32 InterruptMask;
+
+  UINT64 LocalTime;
+
+  INT64 UTCTime;
+
+  time_t UnixTime;
+
+
+  StructNTP->Holdover          = Holdover;
+  StructNTP->FlagHoldoverCheck = FLAG_OFF;
+  StructNTP->HoldoverWrite     = 0ll;
+  StructNTP->HoldoverOffset    = 0ll;
+  StructNTP->HoldoverDriftPpb  = 0l;
+  StructNTP->HoldoverErrors    = 0l;
+
+  if (Holdover->Read(Holdover->Context, &UTCTime) != 0)
+  {
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "Failed to read holdover clock (%s).\r", Holdover->Name);
+    ++StructNTP->HoldoverErrors;
+    return 1;
+  }
+
+  if (FlagLocalDebug) log_info(__LINE__, __func__, "Time read from holdover clock (%s): %lld\r", Holdover->Name, UTCTime / 1000000ll);
+
+  /* Don't override a clock already set by NTP or PPS. */
+  if (StructNTP->Clock.FlagValid) return 0;
+
+  InterruptMask = spin_lock_blocking(ClockLock);
+  LocalTime     = time_us_64();
+  ntp_trace_clock(StructNTP, NTP_TRACE_SAMPLE, 0, NTP_SOURCE_HOLDOVER, LocalTime, UTCTime);
+  ntp_clock_sample(&StructNTP->Clock, LocalTime, UTCTime, NTP_SOURCE_HOLDOVER);
+  ntp_snapshot_publish(StructNTP);
+  spin_unlock(ClockLock, InterruptMask);
+  StructNTP->SyncError = NTP_HOLDOVER_ERROR;
+
+  UnixTime = (time_t)(UTCTime / 1000000ll);
+  ntp_result(0, &UnixTime, StructNTP);
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_holdover_update() */
+/* ============================================================================================================================================================= *\
+                                         Measure the frequency error of the holdover clock against NTP, trim it and write current time to it.
+                 NOTE: Called from ntp_get_time() (not from an interrupt context) since reading a DS3231 takes up to one second, and so does waiting
+                       for the second boundary to write it. The holdover clock is written after the first good sync, then measured and re-written
+                       every NTP_HOLDOVER_INTERVAL so that its frequency error is learned over a long period (from a DS3231 write phase error of
+                       a few hundred usec). While NTP is unreachable, the holdover clock is fed to the disciplined clock instead.
+\* ============================================================================================================================================================= */
+void ntp_holdover_update(struct struct_ntp *StructNTP)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  INT64 HoldoverTime;
+  INT64 UTCTime;
+
+
+  if (StructNTP->Holdover == NULL) return;
+
+  /* NTP unreachable: the holdover clock keeps the disciplined clock on time. */
+  ntp_holdover_feed(StructNTP);
+
+  if (StructNTP->FlagHoldoverCheck == FLAG_OFF) return;
+
+  /* Holdover clock not written since power-up: write it without measuring (its frequency error since last write is unknown). */
+  if (StructNTP->HoldoverWrite == 0ll)
+  {
+    StructNTP->FlagHoldoverCheck = FLAG_OFF;
+    ntp_holdover_write(StructNTP);
+    return;
+  }
+
+  if ((time_us_64() - StructNTP->HoldoverWrite) < NTP_HOLDOVER_INTERVAL) return;
+  StructNTP->FlagHoldoverCheck = FLAG_OFF;
+
+  if (StructNTP->Holdover->Read(StructNTP->Holdover->Context, &HoldoverTime) != 0)
+  {
+    ++StructNTP->HoldoverErrors;
+    ntp_holdover_write(StructNTP);
+    return;
+  }
+  UTCTime = ntp_get_utc_us(StructNTP);
+
+  /* Offset accumulated since last write is due to the frequency error of the holdover clock (see ntp-holdover.c). */
+  if (ntp_holdover_measure(StructNTP->Holdover, HoldoverTime, UTCTime, (INT64)(time_us_64() - StructNTP->HoldoverWrite), &StructNTP->HoldoverOffset, &StructNTP->HoldoverDriftPpb) != 0)
+    ++StructNTP->HoldoverErrors;
+
+  if (FlagLocalDebug) log_info(__LINE__, __func__, "Holdover clock offset: %lld usec   drift: %ld ppb\r", StructNTP->HoldoverOffset, StructNTP->HoldoverDriftPpb);
+  ntp_log_event(NTP_LOG_HOLDOVER, NTP_EVENT_HOLDOVER, (INT32)StructNTP->HoldoverOffset, StructNTP->HoldoverDriftPpb, 0);
+
+  ntp_holdover_write(StructNTP);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_holdover_write() */
+/* ============================================================================================================================================================= *\
+                                                       Write current time to the holdover clock on the next UTC second boundary.
+                 NOTE: Writing a DS3231 restarts its seconds divider, so the write must happen right on a second boundary. It is done here, in
+                       thread context, rather than from an alarm callback: an I2C transfer must not run in an interrupt handler (where it would
+                       also race with other users of the bus). Sleeps until shortly before the boundary, then busy-waits for it.
+\* ============================================================================================================================================================= */
+static void ntp_holdover_write(struct struct_ntp *StructNTP)
+{
+  INT64 Second;
+
+  UINT64 WriteTime;
+
+
+  WriteTime = time_us_64() + (UINT64)(1000000ll - (ntp_get_utc_us(StructNTP) % 1000000ll));
+  if ((WriteTime - time_us_64()) > NTP_HOLDOVER_WAKEUP) sleep_until(from_us_since_boot(WriteTime - NTP_HOLDOVER_WAKEUP));
+  busy_wait_until(from_us_since_boot(WriteTime));
+
+  WriteTime = time_us_64();
+  Second    = ((ntp_get_utc_us(StructNTP) + 500000ll) / 1000000ll) * 1000000ll;
+
+  if (StructNTP->Holdover->Write(StructNTP->Holdover->Context, Second) == 0)
+    StructNTP->HoldoverWrite = WriteTime;
+  else
+    ++StructNTP->HoldoverErrors;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_init() */
+/* ============================================================================================================================================================= *\
+                                                                    Initialize NTP connection.
+\* ============================================================================================================================================================= */
+UINT8 ntp_init(struct struct_ntp *StructNTP)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  UINT8 Loop1UInt8;
+
+  UINT32 InterruptMask;
+
+  struct tm TmTime;
+
+
+  if (StructNTP->FlagInit) log_info(__LINE__, __func__, "ntp_init() has already been called before. No action taken.\r");
+
+  StructNTP->FlagSuccess    = FLAG_OFF;  // will be turned On after successful NTP answer.
+  StructNTP->FlagHealth     = FLAG_OFF;  // will be set according to last NTP outcome (assume no NTP answer on entry).
+  StructNTP->FlagHistory    = FLAG_OFF;  // will be set according to last NTP outcome (assume no NTP answer on entry).
+  StructNTP->FlagInit       = FLAG_OFF;  // NTP has not already been initialized.
+  StructNTP->FlagSummerTime = FLAG_OFF;  // assume we are not during summer time on entry and system will automatically adjust the right status.
+  StructNTP->ScanCount      = 0;
+  StructNTP->TotalErrors    = 0l;        // reset total number of NTP errors on entry.
+  StructNTP->ReadCycles     = 0l;
+  StructNTP->PollCycles     = 0l;        // reset number of NTP poll cycles on entry.
+  StructNTP->AuthErrors     = 0l;        // reset number of authentication errors on entry.
+  StructNTP->AuthTime       = 0l;
+  StructNTP->PacketErrors   = 0l;        // reset number of malformed or bogus replies on entry.
+  ntp_log_init(time_us_32, NTP_LOG_ALL); // events are sent to the monitor by ntp_log_drain(), called from the idle loop.
+  ntp_trace_init(0);                     // call ntp_trace_enable() to record exchanges, sent to the monitor by ntp_trace_drain().
+  StructNTP->UpdateTime     = nil_time;
+  StructNTP->UTCTime        = (StructNTP->LocalTime - (StructNTP->DeltaTime * 60));
+  StructNTP->PpsGpio        = NTP_PPS_NONE;  // call ntp_pps_init() after ntp_init() to use a PPS input.
+  StructNTP->PpsEdges       = 0l;
+  StructNTP->PpsRejects     = 0l;
+  StructNTP->LeapIndicator  = NTP_LEAP_NONE;
+  StructNTP->Stratum        = 0;
+  StructNTP->SyncError      = 0l;
+  StructNTP->LeapPending    = 0;
+  StructNTP->LeapTime       = 0ll;
+  StructNTP->LeapAlarm      = 0;
+  StructNTP->LeapCount      = 0l;
+  StructNTP->Holdover       = NULL;          // call ntp_holdover_init() after ntp_init() to use an external holdover clock.
+  StructNTP->FlagRtc        = FLAG_OFF;      // call ntp_rtc_init() after ntp_init() to let the NTP module handle Pico's RTC.
+  StructNTP->FlagRtcSet     = FLAG_OFF;
+  StructNTP->RtcAlarm       = 0;
+  StructNTP->RtcDrift       = 0l;
+  StructNTP->RtcAlignCount  = 0l;
+  StructNTP->AlarmPool      = alarm_pool_get_default();  // replaced by an alarm pool on core 1 if ntp_core1_start() is called.
+  StructNTP->FlagCore1      = FLAG_OFF;
+  StructNTP->Core1Commands  = 0l;
+  StructNTP->FlagCapture    = FLAG_OFF;      // call ntp_capture_init() after ntp_init() to timestamp requests and replies at the Wi-Fi chip.
+  StructNTP->FlagCaptureSend = FLAG_OFF;
+  StructNTP->FlagInterleave = FLAG_OFF;      // call ntp_interleave_init() after ntp_init() to use NTP interleaved mode with servers supporting it.
+  StructNTP->FamilyPreferred = ((NTP_FAMILY_ALL & (1 << NTP_FAMILY_V6)) ? NTP_FAMILY_V6 : NTP_FAMILY_V4);
+  StructNTP->RaceCount      = 0;             // race both address families on first read cycle.
+  StructNTP->FlagSampled    = FLAG_OFF;
+  StructNTP->FlagDhcp       = FLAG_OFF;
+  StructNTP->FlagBroadcast  = FLAG_OFF;
+  StructNTP->BroadcastDelay = -1l;
+  StructNTP->DhcpSequence   = DhcpSequence - 1;  // DHCP servers already advertised (if any) are considered new.
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_FAMILIES; ++Loop1UInt8)
+  {
+    StructNTP->Family[Loop1UInt8].StructNTP   = StructNTP;
+    StructNTP->Family[Loop1UInt8].Type        = Loop1UInt8;
+    StructNTP->Family[Loop1UInt8].FlagPending = FLAG_OFF;
+    StructNTP->Family[Loop1UInt8].Delay       = -1l;
+    StructNTP->Family[Loop1UInt8].Replies     = 0l;
+    StructNTP->Family[Loop1UInt8].FlagPrevious    = FLAG_OFF;
+    StructNTP->Family[Loop1UInt8].FlagInterleaved = FLAG_OFF;
+    StructNTP->Family[Loop1UInt8].FlagBurst       = FLAG_OFF;
+    StructNTP->Family[Loop1UInt8].Burst.FlagOpen  = FLAG_OFF;
+    StructNTP->Family[Loop1UInt8].Interleaved     = 0l;
+    ip_addr_set_zero(&StructNTP->Family[Loop1UInt8].Address);
+  }
+  if (ClockLock == NULL)    ClockLock    = spin_lock_init(spin_lock_claim_unused(true));
+  if (ScheduleLock == NULL) ScheduleLock = spin_lock_init(spin_lock_claim_unused(true));
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_SCHEDULE_MAX; ++Loop1UInt8)
+  {
+    StructNTP->Schedule[Loop1UInt8].FlagActive = FLAG_OFF;
+    StructNTP->Schedule[Loop1UInt8].AlarmId    = 0;
+  }
+  StructNTP->ScheduleFired   = 0l;
+  StructNTP->ScheduleRemaps  = 0l;
+  StructNTP->ScheduleLatency = 0l;
+  if (NotifyLock == NULL) NotifyLock = spin_lock_init(spin_lock_claim_unused(true));
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_OBSERVER_MAX; ++Loop1UInt8)
+    StructNTP->Observer[Loop1UInt8].Mask = 0;  // call ntp_observer_add() after ntp_init() to be notified of clock and DST changes.
+  StructNTP->NotifyHead     = 0;
+  StructNTP->NotifyCount    = 0;
+  StructNTP->NotifyLost     = 0l;
+  StructNTP->NotifySamples  = 0l;
+  StructNTP->NotifySteps    = 0l;
+  StructNTP->NotifyDst      = NTP_NOTIFY_UNKNOWN;
+  StructNTP->FlagNotifySync = FLAG_OFF;
+  StructNTP->FlagTempco     = FLAG_OFF;      // call ntp_tempco_init() after ntp_init() to compensate the crystal for temperature.
+  StructNTP->TempcoNext     = 0ull;
+  StructNTP->TempcoPpb      = 0l;
+  StructNTP->Adev           = NULL;        // call ntp_adev_init() after ntp_init() to measure the frequency stability of the crystal.
+  StructNTP->AdevPoll       = 0l;
+  if (StructNTP->LeapMode != NTP_LEAP_SMEAR) StructNTP->LeapMode = NTP_LEAP_STEP;
+  InterruptMask = spin_lock_blocking(ClockLock);
+  ntp_clock_init(&StructNTP->Clock);
+  ntp_snapshot_publish(StructNTP);
+  spin_unlock(ClockLock, InterruptMask);
+
+
+  StructNTP->Pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+  if (StructNTP->Pcb == 0)
+  {
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "Failed to create Pcb.\r");
+    StructNTP->FlagInit = FLAG_OFF;
+    return 1;
+  }
+
+
+  StructNTP->FlagInit = FLAG_ON;  // ntp_init() was successful.
+  udp_recv(StructNTP->Pcb, ntp_recv, StructNTP);
+
+#if !LWIP_DHCP_GET_NTP_SRV
+  log_info(__LINE__, __func__, "LWIP_DHCP_GET_NTP_SRV is not set to 1 in lwipopts.h: NTP servers advertised by DHCP are ignored, NTP_SERVER pool is always used.\r");
+#endif  // LWIP_DHCP_GET_NTP_SRV
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_interleave_init() */
+/* ============================================================================================================================================================= *\
+                                       Request the precise transmit timestamps of NTP servers supporting interleaved mode.
+                NOTE: Each read cycle sends a burst of 2 requests: the second one, sent as soon as the first reply is received, carries the
+                      timestamps of the first exchange (NTP interleaved basic mode). The offset is then computed with the transmit timestamp
+                      captured by the server once its first reply has been sent. Servers that don't support it (or lost their state) answer
+                      in basic mode, which is used as before. If the second reply is lost, rejected or inconsistent, the first exchange is
+                      used in basic mode.
+\* ============================================================================================================================================================= */
+UINT8 ntp_interleave_init(struct struct_ntp *StructNTP)
+{
+  StructNTP->FlagInterleave = FLAG_ON;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_leap_adjust() */
+/* ============================================================================================================================================================= *\
+                                                            Return UTC time adjusted for a pending leap second.
+                 NOTE: UTCTime is the continuous time of the disciplined clock. In smear mode, the leap second is spread linearly over the 24 hours
+                       before it. In step mode, the clock is held at 23:59:59.999999 during an inserted second (instead of repeating 23:59:59)
+                       and 23:59:59 is skipped for a deleted second. Leap second parameters are given by the caller (live or snapshot copy).
+\* ============================================================================================================================================================= */
+static INT64 ntp_leap_adjust(INT8 LeapPending, UINT8 LeapMode, INT64 LeapTime, INT64 UTCTime)
+{
+  INT64 End;
+  INT64 Start;
+
+
+  if (LeapPending == 0) return UTCTime;
+
+  /* Continuous time at which the leap second correction must be complete. */
+  End = LeapTime;
+  if (LeapPending < 0) End -= 1000000ll;
+
+  if (LeapMode == NTP_LEAP_SMEAR)
+  {
+    Start = End - NTP_LEAP_SMEAR_US;
+    if (UTCTime < Start) return UTCTime;
+    if (UTCTime < End)   return UTCTime - ((LeapPending * (UTCTime - Start)) / (NTP_LEAP_SMEAR_US / 1000000ll));
+  }
+  else
+  {
+    if (UTCTime < End) return UTCTime;
+    if ((LeapPending > 0) && (UTCTime < (End + 1000000ll))) return End - 1;
+  }
+
+  return UTCTime - (LeapPending * 1000000ll);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_leap_apply() */
+/* ============================================================================================================================================================= *\
+                                                          Complete leap second processing once the leap second is over.
+                      NOTE: The leap second is folded into the disciplined clock so that the following NTP replies agree with it. ClockLock must be
+                            held by the caller.
+\* ============================================================================================================================================================= */
+static void ntp_leap_apply(struct struct_ntp *StructNTP, UINT64 LocalTime)
+{
+  INT64 End;
+
+
+  if (StructNTP->LeapPending == 0) return;
+
+  End = StructNTP->LeapTime;
+  if (StructNTP->LeapPending < 0) End -= 1000000ll;
+  if ((StructNTP->LeapMode != NTP_LEAP_SMEAR) && (StructNTP->LeapPending > 0)) End += 1000000ll;
+
+  if (ntp_clock_get_utc_us(&StructNTP->Clock, LocalTime) < End) return;
+
+  ntp_trace_clock(StructNTP, NTP_TRACE_LEAP, 0, NTP_SOURCE_NONE, LocalTime, StructNTP->LeapPending);
+  StructNTP->Clock.BaseUTC -= (StructNTP->LeapPending * 1000000ll);
+  ntp_log_event(NTP_LOG_CLOCK, NTP_EVENT_LEAP, StructNTP->LeapPending, 0, 0);
+  if (StructNTP->LeapMode != NTP_LEAP_SMEAR) ntp_observer_post(StructNTP, NTP_NOTIFY_STEP, -(StructNTP->LeapPending * 1000000ll));
+  StructNTP->LeapPending    = 0;
+  StructNTP->LeapTime       = 0ll;
+  ++StructNTP->LeapCount;
+  ntp_snapshot_publish(StructNTP);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_leap_handler() */
+/* ============================================================================================================================================================= *\
+                                                              Alarm callback to complete leap second processing.
+\* ============================================================================================================================================================= */
+static int64_t ntp_leap_handler(alarm_id_t AlarmId, void *ExtraArgument)
+{
+  UINT32 InterruptMask;
+
+  struct struct_ntp *StructNTP;
+
+
+  StructNTP = (struct struct_ntp *)ExtraArgument;
+
+  InterruptMask = spin_lock_blocking(ClockLock);
+  StructNTP->LeapAlarm = 0;
+  ntp_leap_apply(StructNTP, time_us_64());
+  spin_unlock(ClockLock, InterruptMask);
+
+  /* Alarm may fire slightly early because of crystal frequency error: try again one second later. */
+  if (StructNTP->LeapPending != 0)
+  {
+    StructNTP->LeapAlarm = AlarmId;
+    return 1000000ll;
+  }
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_leap_unadjust() */
+/* ============================================================================================================================================================= *\
+                           Return the continuous time of the disciplined clock at which UTC time adjusted for a pending leap second reaches the time given.
+                 NOTE: Inverse of ntp_leap_adjust(), used to map a scheduled UTC instant onto the disciplined clock. During smearing, UTC time runs
+                       slower (or faster) than the disciplined clock. In step mode, an instant within an inserted second fires at its beginning
+                       and an instant within a deleted second fires when the second is skipped.
+\* ============================================================================================================================================================= */
+static INT64 ntp_leap_unadjust(INT8 LeapPending, UINT8 LeapMode, INT64 LeapTime, INT64 UTCTime)
+{
+  INT64 ContinuousTime;
+  INT64 End;
+  INT64 Start;
+
+
+  if (LeapPending == 0) return UTCTime;
+
+  /* Continuous time at which the leap second correction must be complete. */
+  End = LeapTime;
+  if (LeapPending < 0) End -= 1000000ll;
+
+  if (LeapMode == NTP_LEAP_SMEAR)
+  {
+    Start = End - NTP_LEAP_SMEAR_US;
+    if (UTCTime < Start) return UTCTime;
+    if (UTCTime > (End - (LeapPending * 1000000ll))) return UTCTime + (LeapPending * 1000000ll);
+
+    /* UTC time runs at (86400 - LeapPending) / 86400 of the disciplined clock: round up, then make sure that the instant is not reached one usec earlier. */
+    ContinuousTime = Start + ((((UTCTime - Start) * 86400ll) + (86400ll - LeapPending) - 1) / (86400ll - LeapPending));
+    while ((ContinuousTime < End) && (ntp_leap_adjust(LeapPending, LeapMode, LeapTime, ContinuousTime) < UTCTime)) ++ContinuousTime;
+    while ((ContinuousTime > Start) && (ntp_leap_adjust(LeapPending, LeapMode, LeapTime, ContinuousTime - 1) >= UTCTime)) --ContinuousTime;
+
+    return ContinuousTime;
+  }
+
+  if (UTCTime < End) return UTCTime;
+  ContinuousTime = UTCTime + (LeapPending * 1000000ll);
+
+  return (ContinuousTime < End) ? End : ContinuousTime;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_leap_update() */
+/* ============================================================================================================================================================= *\
+                                                  Arm or cancel leap second processing, depending on leap indicator received.
+              NOTE: NTP servers announce a leap second during the last month (or last day) before it. It always occurs at the end of the last day
+                    of a month (UTC). A leap second announcement is cancelled only if the leap indicator is cleared before smearing has begun.
+\* ============================================================================================================================================================= */
+static void ntp_leap_update(struct struct_ntp *StructNTP, UINT8 LeapIndicator, INT64 UTCTime)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  UINT32 InterruptMask;
+
+  INT64 AlarmDelay;
+
+  time_t Seconds;
+
+  struct tm TmTime;
+
+
+  if ((LeapIndicator == NTP_LEAP_INSERT) || (LeapIndicator == NTP_LEAP_DELETE))
+  {
+    if (StructNTP->LeapPending != 0) return;  // already armed.
+
+    /* Leap second occurs at the end of the current month: find UTC time of the first day of next month. */
+    Seconds = (time_t)(UTCTime / 1000000ll);
+    gmtime_r(&Seconds, &TmTime);
+    TmTime.tm_mday = 1;
+    TmTime.tm_hour = 0;
+    TmTime.tm_min  = 0;
+    TmTime.tm_sec  = 0;
+    if (++TmTime.tm_mon > 11)
+    {
+      TmTime.tm_mon = 0;
+      ++TmTime.tm_year;
+    }
+
+    InterruptMask = spin_lock_blocking(ClockLock);
+    StructNTP->LeapTime    = (INT64)ntp_convert_tm_to_unix(&TmTime) * 1000000ll;
+    StructNTP->LeapPending = (LeapIndicator == NTP_LEAP_INSERT) ? 1 : -1;
+    ntp_snapshot_publish(StructNTP);
+    spin_unlock(ClockLock, InterruptMask);
+
+    /* Alarm to complete leap second processing (allow for the inserted second itself). */
+    AlarmDelay = StructNTP->LeapTime - UTCTime + 1000000ll;
+    StructNTP->LeapAlarm = alarm_pool_add_alarm_in_us(StructNTP->AlarmPool, AlarmDelay, ntp_leap_handler, StructNTP, true);
+
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "Leap second (%d) armed for UTC time %lld (in %lld sec).\r", StructNTP->LeapPending, StructNTP->LeapTime / 1000000ll, AlarmDelay / 1000000ll);
+  }
+  else if ((LeapIndicator == NTP_LEAP_NONE) && (StructNTP->LeapPending != 0) && (UTCTime < (StructNTP->LeapTime - NTP_LEAP_SMEAR_US - 1000000ll)))
+  {
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "Leap second announcement has been cancelled.\r");
+    if (StructNTP->LeapAlarm > 0) alarm_pool_cancel_alarm(StructNTP->AlarmPool, StructNTP->LeapAlarm);
+    StructNTP->LeapAlarm   = 0;
+    InterruptMask = spin_lock_blocking(ClockLock);
+    StructNTP->LeapPending = 0;
+    StructNTP->LeapTime    = 0ll;
+    ntp_snapshot_publish(StructNTP);
+    spin_unlock(ClockLock, InterruptMask);
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_observer_add() */
+/* ============================================================================================================================================================= *\
+                                  Register a function to be notified of clock steps, clock slews, DST changes and sync losses.
+                  NOTE: Mask selects notifications (NTP_NOTIFY_xxx). Return the observer number (see ntp_observer_remove()) or NTP_OBSERVER_NONE
+                        if no entry is free. Callback is called from ntp_observer_dispatch(), never from an interrupt or from lwIP.
+\* ============================================================================================================================================================= */
+UINT8 ntp_observer_add(struct struct_ntp *StructNTP, UINT8 Mask, void (*Callback)(struct struct_ntp *StructNTP, const struct ntp_notification *Notification, void *Argument), void *Argument)
+{
+  UINT8 Observer;
+
+
+  if ((Callback == NULL) || ((Mask & NTP_NOTIFY_ALL) == 0)) return NTP_OBSERVER_NONE;
+
+  for (Observer = 0; Observer < NTP_OBSERVER_MAX; ++Observer)
+    if (StructNTP->Observer[Observer].Mask == 0) break;
+  if (Observer == NTP_OBSERVER_MAX) return NTP_OBSERVER_NONE;
+
+  StructNTP->Observer[Observer].Callback = Callback;
+  StructNTP->Observer[Observer].Argument = Argument;
+  StructNTP->Observer[Observer].Mask     = (Mask & NTP_NOTIFY_ALL);
+
+  return Observer;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_observer_dispatch() */
+/* ============================================================================================================================================================= *\
+                                                   Deliver pending notifications to the observers registered.
+                  NOTE: To be called from the main loop (as ntp_log_drain()). Notifications are queued where the change happens (lwIP callback,
+                        PPS interrupt, alarm or core 1) and delivered here, so that observers may take their time. Sync loss and recovery are
+                        checked here too, and the temperature sensor is read (see ntp_tempco_init()). Return the number of notifications delivered.
+\* ============================================================================================================================================================= */
+UINT16 ntp_observer_dispatch(struct struct_ntp *StructNTP)
+{
+  UINT8 FlagSync;
+  UINT8 Observer;
+
+  UINT16 Delivered;
+
+  UINT32 InterruptMask;
+
+  struct ntp_notification Notification;
+
+  struct ntp_snapshot Snapshot;
+
+
+  if (NotifyLock == NULL) return 0;
+
+  /* Temperature compensation: the ADC is read here, in the main loop of the application that owns it. */
+  ntp_tempco_update(StructNTP);
+
+  /* Sync is lost when no sample has disciplined the clock for a while (time read from the holdover clock at power-up doesn't count). */
+  ntp_snapshot_read(StructNTP, &Snapshot);
+  FlagSync = FLAG_OFF;
+  if ((Snapshot.Clock.FlagValid) && (Snapshot.Clock.Source != NTP_SOURCE_HOLDOVER) && ((time_us_64() - Snapshot.Clock.LastSample) < (NTP_NOTIFY_SYNC_AGE * 1000000ull))) FlagSync = FLAG_ON;
+  if (FlagSync != StructNTP->FlagNotifySync)
+  {
+    StructNTP->FlagNotifySync = FlagSync;
+    ntp_observer_post(StructNTP, NTP_NOTIFY_SYNC, FlagSync);
+  }
+
+  Delivered = 0;
+  while (1)
+  {
+    InterruptMask = spin_lock_blocking(NotifyLock);
+    if (StructNTP->NotifyCount == 0)
+    {
+      spin_unlock(NotifyLock, InterruptMask);
+      break;
+    }
+    Notification = StructNTP->NotifyQueue[StructNTP->NotifyHead];
+    StructNTP->NotifyHead = (StructNTP->NotifyHead + 1) % NTP_NOTIFY_QUEUE;
+    --StructNTP->NotifyCount;
+    spin_unlock(NotifyLock, InterruptMask);
+
+    /* Callbacks are called with the lock released: they may register or remove observers. */
+    for (Observer = 0; Observer < NTP_OBSERVER_MAX; ++Observer)
+      if (StructNTP->Observer[Observer].Mask & Notification.Type)
+        StructNTP->Observer[Observer].Callback(StructNTP, &Notification, StructNTP->Observer[Observer].Argument);
+
+    ++Delivered;
+  }
+
+  return Delivered;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_observer_post() */
+/* ============================================================================================================================================================= *\
+                                                        Queue a notification for ntp_observer_dispatch().
+                  NOTE: Never blocks for long and may be called from an interrupt or from the other core. A step or slew notification is
+                        merged with the last one still queued if of the same type (steps are added). Sync and DST notifications are never merged,
+                        so that an observer sees every loss and every recovery. When the queue is full, the oldest notification is lost.
+\* ============================================================================================================================================================= */
+static void ntp_observer_post(struct struct_ntp *StructNTP, UINT8 Type, INT64 Value)
+{
+  UINT8 Last;
+
+  UINT32 InterruptMask;
+
+  struct ntp_notification *Notification;
+
+
+  if (NotifyLock == NULL) return;
+
+  InterruptMask = spin_lock_blocking(NotifyLock);
+
+  Last = (StructNTP->NotifyHead + StructNTP->NotifyCount + NTP_NOTIFY_QUEUE - 1) % NTP_NOTIFY_QUEUE;
+  if ((StructNTP->NotifyCount) && (StructNTP->NotifyQueue[Last].Type == Type) && ((Type == NTP_NOTIFY_STEP) || (Type == NTP_NOTIFY_SLEW)))
+  {
+    Notification = &StructNTP->NotifyQueue[Last];
+    if (Type == NTP_NOTIFY_STEP)
+      Notification->Value += Value;
+    else
+      Notification->Value = Value;
+  }
+  else
+  {
+    if (StructNTP->NotifyCount == NTP_NOTIFY_QUEUE)
+    {
+      StructNTP->NotifyHead = (StructNTP->NotifyHead + 1) % NTP_NOTIFY_QUEUE;
+      --StructNTP->NotifyCount;
+      ++StructNTP->NotifyLost;
+    }
+    Notification        = &StructNTP->NotifyQueue[(StructNTP->NotifyHead + StructNTP->NotifyCount) % NTP_NOTIFY_QUEUE];
+    Notification->Type  = Type;
+    Notification->Value = Value;
+    ++StructNTP->NotifyCount;
+  }
+  Notification->LocalTime = time_us_64();
+
+  spin_unlock(NotifyLock, InterruptMask);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_observer_remove() */
+/* ============================================================================================================================================================= *\
+                                                      Remove an observer registered by ntp_observer_add().
+                         NOTE: Return 0 if the observer has been removed, 1 if the observer number is invalid.
+\* ============================================================================================================================================================= */
+UINT8 ntp_observer_remove(struct struct_ntp *StructNTP, UINT8 Observer)
+{
+  if ((Observer >= NTP_OBSERVER_MAX) || (StructNTP->Observer[Observer].Mask == 0)) return 1;
+
+  StructNTP->Observer[Observer].Mask     = 0;
+  StructNTP->Observer[Observer].Callback = NULL;
+  StructNTP->Observer[Observer].Argument = NULL;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_pps_edge() */
+/* ============================================================================================================================================================= *\
+                                                         Process a PPS edge captured at the specified Pico timer value.
+                        NOTE: The PPS edge marks the beginning of a UTC second, NTP only tells which second it is. The edge is rejected until the clock
+                              has been set by NTP or if it is too far from a second boundary. May be called with simulated edges for testing purposes.
+\* ============================================================================================================================================================= */
+void ntp_pps_edge(struct struct_ntp *StructNTP, UINT64 EdgeTime)
+{
+  UINT32 InterruptMask;
+
+  INT64 Predicted;
+  INT64 Second;
+
+
+  InterruptMask = spin_lock_blocking(ClockLock);
+
+  if (StructNTP->Clock.FlagValid == FLAG_OFF)
+  {
+    ++StructNTP->PpsRejects;
+    spin_unlock(ClockLock, InterruptMask);
+    return;
+  }
+
+  /* Round predicted time to the nearest second. */
+  Predicted = ntp_clock_get_utc_us(&StructNTP->Clock, EdgeTime);
+  Second    = ((Predicted + 500000ll) / 1000000ll) * 1000000ll;
+  if (((Predicted - Second) > NTP_PPS_MAX_OFFSET) || ((Second - Predicted) > NTP_PPS_MAX_OFFSET))
+  {
+    ntp_log_event(NTP_LOG_PPS, NTP_EVENT_PPS_REJECT, (INT32)(Predicted - Second), 0, 0);
+    ++StructNTP->PpsRejects;
+    spin_unlock(ClockLock, InterruptMask);
+    return;
+  }
+
+  ntp_trace_clock(StructNTP, NTP_TRACE_SAMPLE, 0, NTP_SOURCE_PPS, EdgeTime, Second);
+  ntp_clock_sample(&StructNTP->Clock, EdgeTime, Second, NTP_SOURCE_PPS);
+  ntp_snapshot_publish(StructNTP);
+  StructNTP->PpsLastEdge = EdgeTime;
+  ++StructNTP->PpsEdges;
+  spin_unlock(ClockLock, InterruptMask);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_pps_init() */
+/* ============================================================================================================================================================= *\
+                                                                  Enable PPS input on the specified GPIO.
+                              NOTE: A raw interrupt handler is used so that it may coexist with other GPIO interrupts (for example the CYW43 one).
+\* ============================================================================================================================================================= */
+void ntp_pps_init(struct struct_ntp *StructNTP, UINT8 Gpio)
+{
+  StructNTP->PpsGpio     = Gpio;
+  StructNTP->PpsLastEdge = 0ll;
+  StructNTP->PpsEdges    = 0l;
+  StructNTP->PpsRejects  = 0l;
+  PpsStructNTP           = StructNTP;
+
+  gpio_init(Gpio);
+  gpio_set_dir(Gpio, GPIO_IN);
+  gpio_pull_down(Gpio);
+  gpio_add_raw_irq_handler(Gpio, ntp_pps_irq);
+  gpio_set_irq_enabled(Gpio, GPIO_IRQ_EDGE_RISE, true);
+  irq_set_enabled(IO_IRQ_BANK0, true);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_pps_irq() */
+/* ============================================================================================================================================================= *\
+                                                                    GPIO interrupt handler for PPS input.
+\* ============================================================================================================================================================= */
+static void ntp_pps_irq(void)
+{
+  UINT64 EdgeTime;
+
+
+  /* Capture the timer first, before anything else. */
+  EdgeTime = time_us_64();
+
+  if ((PpsStructNTP == NULL) || ((gpio_get_irq_event_mask(PpsStructNTP->PpsGpio) & GPIO_IRQ_EDGE_RISE) == 0)) return;
+  gpio_acknowledge_irq(PpsStructNTP->PpsGpio, GPIO_IRQ_EDGE_RISE);
+
+  ntp_pps_edge(PpsStructNTP, EdgeTime);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_pps_locked() */
+/* ============================================================================================================================================================= *\
+                                                                Return FLAG_ON if PPS edges are currently received.
+\* ============================================================================================================================================================= */
+UINT8 ntp_pps_locked(struct struct_ntp *StructNTP)
+{
+  if (StructNTP->PpsGpio == NTP_PPS_NONE) return FLAG_OFF;
+  if ((StructNTP->PpsEdges == 0) || ((time_us_64() - StructNTP->PpsLastEdge) > NTP_PPS_TIMEOUT)) return FLAG_OFF;
+
+  return FLAG_ON;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_recv() */
+/* ============================================================================================================================================================= *\
+                                                                         NTP data received.
+\* ============================================================================================================================================================= */
+static void ntp_recv(void *ExtraArgument, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *IPAddress, u16_t port)
+{
+  INT16 AuthStatus;
+
+  UINT8 FlagInterleaved;
+  UINT8 FlagPps;
+  UINT8 Packet[NTP_MAX_PACKET_LEN];
+  UINT8 ParseStatus;
+  UINT8 ReplyStatus;
+
+  UINT16 PacketLength;
+
+  UINT32 InterruptMask;
+  UINT32 StartTime;
+
+  UINT64 WakeTime;
+
+  struct ntp_exchange Current;
+  struct ntp_exchange Exchange;
+
+  struct ntp_packet Info;
+
+  struct ntp_family *Family;
+
+
+  struct struct_ntp *StructNTP = ExtraArgument;
+ 
+  StructNTP->Receive = time_us_64();
+  Family = &StructNTP->Family[IP_IS_V6(IPAddress) ? NTP_FAMILY_V6 : NTP_FAMILY_V4];
+
+  /* Use the CYW43 interrupt that signalled the reply instead, if it happened after the request has been sent. */
+  if (StructNTP->FlagCapture)
+  {
+    InterruptMask = save_and_disable_interrupts();
+    WakeTime      = StructNTP->CaptureWake;
+    restore_interrupts(InterruptMask);
+
+    if ((WakeTime > Family->Send) && (WakeTime <= StructNTP->Receive))
+    {
+      StructNTP->Receive = WakeTime;
+      ++StructNTP->CaptureCount;
+    }
+  }
+
+  /* This is a callback from lwIP: logged through the event log, USB output would delay the next packets (mode and stratum are in the events that follow). */
+  ntp_log_event(NTP_LOG_SYNC, NTP_EVENT_RECEIVE, p->tot_len, port, ip_addr_cmp(IPAddress, &Family->Address));
+
+
+  /* Copy the whole packet (header, extension fields and MAC) in a local buffer, whether the pbuf is chained or not. The parser never reads beyond PacketLength. */
+  PacketLength = 0;
+  if (p->tot_len <= NTP_MAX_PACKET_LEN) PacketLength = pbuf_copy_partial(p, Packet, p->tot_len, 0);
+  ParseStatus = ntp_packet_parse(Packet, PacketLength, &Info);
+
+  /* Broadcasts (mode 5) don't answer any request of ours. */
+  if ((ParseStatus == NTP_PACKET_OK) && (Info.Mode == 0x05))
+  {
+    ntp_broadcast_recv(StructNTP, IPAddress, Packet, &Info);
+    pbuf_free(p);
+    return;
+  }
+
+  /* Interleaved reply: the server echoes the receive timestamp of our request instead of its transmit timestamp (see ntp_request()). */
+  FlagInterleaved = ((ParseStatus == NTP_PACKET_OK) && (Family->FlagInterleaved) && (Info.Origin == Family->Previous.T4) && (Info.Origin != Family->Origin)) ? FLAG_ON : FLAG_OFF;
+
+  /* Ignore malformed replies and replies that don't echo the transmit timestamp of our last request (late, duplicated or spoofed).
+     The request is still pending: the real reply may follow, otherwise ntp_failed_handler() will be called. */
+  if ((ParseStatus != NTP_PACKET_OK) || ((Info.Origin != Family->Origin) && (!FlagInterleaved)) || (Family->FlagPending == FLAG_OFF))
+  {
+    ntp_log_event(NTP_LOG_SYNC, NTP_EVENT_BOGUS, ParseStatus, 0, 0);
+    ntp_trace_exchange(StructNTP, NTP_TRACE_REPLY, NTP_SYNC_BOGUS, 0, IPAddress, (ParseStatus == NTP_PACKET_OK) ? &Info : NULL, NULL);
+    ++StructNTP->PacketErrors;
+    pbuf_free(p);
+    return;
+  }
+
+  /* Validate message authentication code (see ntp-auth.c). */
+  StartTime  = time_us_32();
+  AuthStatus = ntp_auth_verify(StructNTP->AuthKeyId, Packet, &Info);
+  if ((StructNTP->AuthKeyId != 0) && (Info.DigestLength != 0)) StructNTP->AuthTime = time_us_32() - StartTime;
+
+
+  /* Check the result (mode, stratum, leap indicator and authentication are checked by ntp_sync_check(), shared with ntp-replay.c).
+     A reply from another address or port is rejected first, so that it isn't counted as an authentication error. */
+  Family->FlagPending = FLAG_OFF;
+  if ((!ip_addr_cmp(IPAddress, &Family->Address)) || (port != NTP_PORT))
+    ReplyStatus = NTP_SYNC_ADDRESS;
+  else
+    ReplyStatus = ntp_sync_check(&Info, AuthStatus);
+
+  if (ReplyStatus == NTP_SYNC_AUTH)
+  {
+    ntp_log_event(NTP_LOG_AUTH, NTP_EVENT_AUTH, Info.KeyId, AuthStatus, 0);
+    ++StructNTP->AuthErrors;
+  }
+  if (ReplyStatus == NTP_SYNC_OK)
+  {
+    /* Timestamps, offset and round-trip delay are computed from the disciplined clock (see ntp_sync_exchange()). The transmit timestamp
+       of an interleaved reply is the one of the previous reply: T3 of this exchange will only be known when the next reply is received. */
+    Current.Send    = Family->Send;
+    Current.Receive = StructNTP->Receive;
+    Current.T2      = Info.Receive;
+    Current.T3      = (FlagInterleaved) ? Info.Receive : Info.Transmit;
+
+    InterruptMask = spin_lock_blocking(ClockLock);
+    ntp_leap_apply(StructNTP, StructNTP->Receive);
+    ntp_sync_exchange(&StructNTP->Clock, &Current);
+    Exchange = Current;
+    if (FlagInterleaved)
+    {
+      /* The precise transmit timestamp completes the previous exchange, which is the one used. If it is inconsistent (or the previous
+         exchange too old), the first exchange of the burst is used in basic mode or, out of a burst, this reply (its own transmit timestamp
+         is unknown, the server's turnaround is neglected). */
+      Exchange = Family->Previous;
+      if (ntp_sync_interleaved(&StructNTP->Clock, &Exchange, Info.Transmit, StructNTP->Receive) != NTP_SYNC_OK)
+      {
+        Exchange        = Current;
+        FlagInterleaved = FLAG_OFF;
+        ntp_sync_burst_close(&Family->Burst, StructNTP->Receive, &Exchange);
+      }
+    }
+    Family->Burst.FlagOpen = FLAG_OFF;
+    FlagPps = ntp_pps_locked(StructNTP);
+    spin_unlock(ClockLock, InterruptMask);
+
+    /* Kept to be completed by the next reply if the server supports interleaved mode. */
+    Family->Previous        = Current;
+    Family->PreviousAddress = Family->Address;
+    Family->FlagPrevious    = FLAG_ON;
+
+    /* Interleaved mode: the previous exchange must be recent, or the clock has drifted since. The first reply of a read cycle opens a burst
+       of 2, the second request asking right away for the precise transmit timestamp of this reply. This exchange is kept to be used in
+       basic mode if the second reply is inconsistent or lost (see ntp_failed_handler()). */
+    if ((StructNTP->FlagInterleave) && (FlagInterleaved == FLAG_OFF) && (Family->FlagBurst == FLAG_OFF) && (StructNTP->FlagSampled == FLAG_OFF))
+    {
+      ntp_sync_burst_open(&Family->Burst, &Current, &Info);
+      Family->FlagBurst   = FLAG_ON;
+      Family->FlagPending = FLAG_ON;
+      ntp_request(StructNTP, Family);
+      pbuf_free(p);
+      return;
+    }
+  }
+
+  if (ReplyStatus == NTP_SYNC_OK)
+  /// if (!ip_addr_cmp(IPAddress, &StructNTP->ServerAddress) && (port == NTP_PORT) && (p->tot_len == NTP_MSG_LEN) && (Mode == 0x04) && (Stratum != 0))
+  {
+    ntp_reply_use(StructNTP, Family, &Info, &Exchange, ntp_ts_to_unix_us(Current.T3, Current.PivotTime), FlagPps, FlagInterleaved);
+    /// printf("[%5u] - 10\r", __LINE__);
+  }
+  else
+  {
+    ntp_log_event(NTP_LOG_SYNC, NTP_EVENT_INVALID, Info.Mode, Info.Stratum, AuthStatus);
+    ntp_trace_exchange(StructNTP, NTP_TRACE_REPLY, ReplyStatus, 0, IPAddress, &Info, NULL);
+
+    /* Second reply of a burst rejected: its first exchange is used in basic mode (server time extrapolated). */
+    if (ntp_sync_burst_close(&Family->Burst, StructNTP->Receive, &Exchange) == NTP_SYNC_OK)
+      ntp_reply_use(StructNTP, Family, &Family->Burst.Info, &Exchange, ntp_ts_to_unix_us(Exchange.T3, Exchange.PivotTime) + (INT64)(StructNTP->Receive - Exchange.Receive), ntp_pps_locked(StructNTP), FLAG_OFF);
+    else if ((ntp_family_pending(StructNTP) == 0) && (StructNTP->FlagSampled == FLAG_OFF))
+      ntp_result(-1, NULL, StructNTP);
+  }
+
+  /// printf("[%5u] - 11\r", __LINE__);
+  pbuf_free(p);
+
+  return;
+}
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_reply_use() */
+/* ============================================================================================================================================================= *\
+                                  Use a valid exchange with the NTP server: round-trip delay of its address family and discipline of the clock.
+                 NOTE: Only the first exchange of a read cycle disciplines the clock. Called by ntp_recv() (lwIP callback) and by ntp_failed_handler()
+                       (alarm callback) for the first exchange of a burst whose second reply has been lost. ServerTime is the UTC time (in usec
+                       since 01-JAN-1970) of the server when the reply has been received.
+\* ============================================================================================================================================================= */
+static void ntp_reply_use(struct struct_ntp *StructNTP, struct ntp_family *Family, const struct ntp_packet *Info, const struct ntp_exchange *Exchange, INT64 ServerTime, UINT8 FlagPps, UINT8 FlagInterleaved)
+{
+  UINT32 InterruptMask;
+
+  time_t UnixTime;
+
+
+  if (FlagInterleaved) ++Family->Interleaved;
+
+  /* Round-trip delay is measured for each address family raced, but only the first reply of a read cycle disciplines the clock. */
+  Family->Delay = Exchange->Delay;
+  ++Family->Replies;
+  ntp_family_select(StructNTP);
+  ntp_trace_exchange(StructNTP, NTP_TRACE_REPLY, NTP_SYNC_OK, ((StructNTP->FlagSampled) ? 0 : NTP_TRACE_FLAG_FIRST) | ((FlagPps) ? NTP_TRACE_FLAG_PPS : 0) | ((FlagInterleaved) ? NTP_TRACE_FLAG_INTERLEAVED : 0), &Family->Address, Info, Exchange);
+
+  /* Reply from the broadcast server: one-way delay is half the round-trip delay. */
+  if ((StructNTP->FlagBroadcast) && (ip_addr_cmp(&Family->Address, &StructNTP->BroadcastServer)))
+  {
+    StructNTP->BroadcastDelay = ((Family->Delay < 0) ? 0 : (Family->Delay / 2));
+    StructNTP->BroadcastLast  = Exchange->Receive;
+  }
+  if (StructNTP->FlagSampled) return;
+  StructNTP->FlagSampled   = FLAG_ON;
+  StructNTP->ServerAddress = Family->Address;
+  StructNTP->Send          = Family->Send;
+
+  StructNTP->Latency = Family->Delay;
+  UnixTime           = (time_t)(ServerTime / 1000000ll);
+
+  /* Keep information required to estimate clock quality. */
+  StructNTP->LeapIndicator  = Info->LeapIndicator;
+  StructNTP->Stratum        = Info->Stratum;
+  StructNTP->RootDelay      = Info->RootDelay;
+  StructNTP->RootDispersion = Info->RootDispersion;
+  StructNTP->SyncError      = (StructNTP->RootDelay / 2) + StructNTP->RootDispersion + ((StructNTP->Latency < 0) ? 0 : (StructNTP->Latency / 2));
+
+  /* When PPS is locked, it disciplines the clock and NTP is only used to make sure that we are on the right second. */
+  InterruptMask = spin_lock_blocking(ClockLock);
+  if ((ntp_sync_discipline(&StructNTP->Clock, Exchange, FlagPps) == NTP_CLOCK_STEPPED) && (StructNTP->Clock.StepCount > 0))
+    ntp_log_event(NTP_LOG_CLOCK, NTP_EVENT_STEP, (INT32)StructNTP->Clock.LastOffset, NTP_SOURCE_NETWORK, 0);
+  ntp_snapshot_publish(StructNTP);
+  spin_unlock(ClockLock, InterruptMask);
+
+  ntp_leap_update(StructNTP, StructNTP->LeapIndicator, ServerTime);
+
+  /* Logged through the event log rather than log_info(): this is a callback from lwIP (or an alarm) and USB output would delay the next packets. */
+  ntp_log_event(NTP_LOG_SYNC, NTP_EVENT_REPLY, (INT32)Exchange->Offset, StructNTP->Latency, Info->Stratum);
+
+  ntp_result(0, &UnixTime, StructNTP);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_request() */
+/* ============================================================================================================================================================= *\
+                                                          Make an NTP request to the server address resolved for an address family.
+\* ============================================================================================================================================================= */
+static void ntp_request(struct struct_ntp *StructNTP, struct ntp_family *Family)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  UINT8 Packet[NTP_MAX_PACKET_LEN];
+
+  UINT16 PacketLength;
+
+
+  /* Also called from lwIP callbacks (ntp_dns_found(), ntp_recv()): requests are logged as NTP_EVENT_REQUEST, the address only for debugging. */
+  if (FlagLocalDebug)
+  {
+    log_info(__LINE__, __func__, "Entering ntp_request()\r");
+    log_info(__LINE__, __func__, "NTP pool IP address:      %15s\r", ipaddr_ntoa(&Family->Address));
+  }
+
+
+  /* NOTE: cyw43_arch_lwip_begin() / cyw43_arch_lwip_end() should be used around calls into LwIP to ensure correct locking.
+           You can omit them if you are in a callback from LwIP. Note that when using pico_cyw_arch_poll library these calls
+           are a no-op and can be omitted, but it is a good practice to use them in case you switch the cyw43_arch type later. */
+  /* Build the request: NTP header (LI = 0, version 3, mode 3 - client), extension fields (none so far) and MAC if authentication is used.
+     Transmit timestamp is our clock time or, before the first sync, the Pico timer: the server echoes it as origin timestamp of its reply. */
+  Family->Origin = ntp_get_timestamp(StructNTP);
+  if (Family->Origin == ntp_ts_from_unix_us(0ll)) Family->Origin = time_us_64();
+
+  memset(Packet, 0, NTP_MSG_LEN);
+  Packet[0]    = 0x1B;
+  ntp_ts_to_packet(Family->Origin, &Packet[40]);
+
+  /* Interleaved mode: origin and receive timestamps are the server's receive timestamp and our receive timestamp of its last reply. A server
+     supporting it answers with the precise transmit timestamp of that reply and echoes our receive timestamp, others ignore both fields.
+     Only sent while the last reply is recent (second request of a burst, see ntp_recv()). */
+  Family->FlagInterleaved = FLAG_OFF;
+  if ((StructNTP->FlagInterleave) && (Family->FlagPrevious) && (ip_addr_cmp(&Family->PreviousAddress, &Family->Address)) && ((time_us_64() - Family->Previous.Receive) < NTP_SYNC_MAX_PREVIOUS))
+  {
+    Family->FlagInterleaved = FLAG_ON;
+    ntp_ts_to_packet(Family->Previous.T2, &Packet[24]);
+    ntp_ts_to_packet(Family->Previous.T4, &Packet[32]);
+  }
+
+  PacketLength = NTP_MSG_LEN;
+  PacketLength = ntp_auth_sign(StructNTP->AuthKeyId, Packet, PacketLength);
+
+  cyw43_arch_lwip_begin();
+  {
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, PacketLength, PBUF_RAM);
+    if (p != NULL)
+    {
+      memcpy(p->payload, Packet, PacketLength);
+      /* Send time is captured again right before the transfer to the Wi-Fi chip if ntp_capture_init() has been called. */
+      Family->Send             = time_us_64();
+      StructNTP->ServerAddress = Family->Address;
+      if (StructNTP->FlagCapture) StructNTP->FlagCaptureSend |= (1 << Family->Type);
+      udp_sendto(StructNTP->Pcb, p, &Family->Address, NTP_PORT);
+      ntp_log_event(NTP_LOG_SYNC, NTP_EVENT_REQUEST, (INT32)Family->Origin, (Family->Type == NTP_FAMILY_V6) ? 6 : 4, 0);
+      pbuf_free(p);
+    }
+  }
+  cyw43_arch_lwip_end();
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_result() */
+/* ============================================================================================================================================================= *\
+                                                                  Called with results of operation.
+\* ============================================================================================================================================================= */
+void ntp_result(INT16 ResultStatus, time_t *UnixTime, struct struct_ntp *StructNTP)
+{
+#ifdef RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
+#else   // RELEASE_VERSION
+  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
+#endif  // RELEASE_VERSION
+
+  struct tm TempTime;
+
+
+  if (!stdio_usb_connected()) FlagLocalDebug = FLAG_OFF;
+
+  if (FlagLocalDebug) log_info(__LINE__, __func__, "Entering ntp_result()   ResultStatus: %3d\r", ResultStatus);
+
+  if ((ResultStatus == 0) && UnixTime)
+  {
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "ResultStatus: %d    UnixTime: %12llu\r", ResultStatus, *UnixTime);
+    StructNTP->UTCTime     = *UnixTime;
+    StructNTP->FlagSuccess = FLAG_ON;
+
+    /* Proceed with first conversion of UTC time to determine current year. */
+    ntp_convert_unix_time(StructNTP->UTCTime, &TempTime, StructNTP);
+
+    /* Compute all DST parameters for current year (observers are notified by ntp_dst_settings() when DST starts or ends). */
+    ntp_dst_settings(StructNTP);
+
+    /* Add DeltaTime to UTC time to get UTC equivalent of local time. */
+    StructNTP->LocalTime = *UnixTime + (StructNTP->DeltaTime * 60);
+
+    /* Determine current local time for winter time ("normal time") and then for current period of the year (summer time or winter time). */
+    if (FlagLocalDebug)
+    {
+      log_info(__LINE__, __func__, "Unix time received from NTP server:                   %12llu\r",           StructNTP->UTCTime);
+      log_info(__LINE__, __func__, "Delta time in minutes: StructNTP->DeltaTime:              %8d minutes\r",  StructNTP->DeltaTime);
+      log_info(__LINE__, __func__, "Delta time in seconds: StructNTP->DeltaTime * 60:         %8d seconds\r", (StructNTP->DeltaTime * 60));
+      log_info(__LINE__, __func__, "Unix time after adding delta time:                    %12llu\r",          (StructNTP->UTCTime + (StructNTP->DeltaTime * 60)));
+      log_info(__LINE__, __func__, "Unix time after adjusting for DST period of the year: %12lld\r",           StructNTP->LocalTime + (StructNTP->FlagSummerTime * (StructNTP->ShiftMinutes * 60)));
+    }
+
+    StructNTP->LocalTime += (StructNTP->FlagSummerTime * (StructNTP->ShiftMinutes * 60));
+
+    /* Convert UTC found to human time. */
+    ntp_convert_unix_time(StructNTP->LocalTime, &TempTime, StructNTP);
+
+    /* Holdover clock will be checked on next call to ntp_get_time(), unless time has just been read from it. */
+    if ((StructNTP->Holdover != NULL) && (StructNTP->Clock.Source != NTP_SOURCE_HOLDOVER)) StructNTP->FlagHoldoverCheck = FLAG_ON;
+
+    /* Re-align Pico's real-time clock if it is handled by the NTP module. */
+    if (StructNTP->FlagRtc) ntp_rtc_update(StructNTP);
+  }
+  else
+  {
+    StructNTP->FlagSuccess = FLAG_OFF;
+    StructNTP->FlagHistory = FLAG_OFF;
+    StructNTP->UpdateTime  = make_timeout_time_ms(NTP_RETRY * 1000);
+
+    /* Try next server advertised by DHCP. When they all failed, pool servers are used for NTP_DHCP_RETRY read cycles. */
+    if (StructNTP->FlagDhcp)
+    {
+      StructNTP->FlagDhcp = FLAG_OFF;
+      if (++StructNTP->DhcpIndex >= DhcpServerCount) StructNTP->DhcpRetry = NTP_DHCP_RETRY;
+    }
+  }
+
+  if (StructNTP->ResendAlarm > 0)
+  {
+    if (FlagLocalDebug) log_info(__LINE__, __func__, "Cancelling alarm (0x%X)\r", StructNTP->ResendAlarm);
+    alarm_pool_cancel_alarm(StructNTP->AlarmPool, StructNTP->ResendAlarm);  // removed for crash test only 
+    StructNTP->ResendAlarm = 0;
+  }
+
+  if (FlagLocalDebug)
+  {
+    log_info(__LINE__, __func__, "Resetting DNSRequestSent\r");
+    log_info(__LINE__, __func__, "======================================================================\r");
+  }
+  StructNTP->DNSRequestSent = false;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_rtc_align() */
+/* ============================================================================================================================================================= *\
+                                                  Schedule programming of Pico's real-time clock on the next second boundary.
+                         NOTE: The RTC only has a one-second resolution. It is programmed from an alarm set at the fractional remainder of the current
+                               second of the disciplined clock, so that its seconds begin exactly when local time seconds begin.
+\* ============================================================================================================================================================= */
+static void ntp_rtc_align(struct struct_ntp *StructNTP)
+{
+  INT64 Fraction;
+
+
+  if (StructNTP->RtcAlarm > 0)
+  {
+    alarm_pool_cancel_alarm(StructNTP->AlarmPool, StructNTP->RtcAlarm);
+    StructNTP->RtcAlarm = 0;
   }
 
+  Fraction = ntp_rtc_get_local_us(StructNTP) % 1000000ll;
+  StructNTP->RtcAlarm = alarm_pool_add_alarm_in_us(StructNTP->AlarmPool, 1000000ll - Fraction, ntp_rtc_handler, StructNTP, true);
+  if (StructNTP->RtcAlarm < 0) StructNTP->RtcAlarm = 0;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_rtc_get_local_us() */
+/* ============================================================================================================================================================= *\
+                                                    Return current local time (in usec since 01-JAN-1970) from the disciplined clock.
+\* ============================================================================================================================================================= */
+static INT64 ntp_rtc_get_local_us(struct struct_ntp *StructNTP)
+{
+  return ntp_get_utc_us(StructNTP) + ((INT64)(StructNTP->DeltaTime + (StructNTP->FlagSummerTime * StructNTP->ShiftMinutes)) * 60000000ll);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_rtc_handler() */
+/* ============================================================================================================================================================= *\
+                                                           Alarm callback programming Pico's real-time clock.
+                          NOTE: The RTC restarts a full second when it is loaded, so that the Pico timer value right after rtc_set_datetime()
+                                marks the beginning of the second programmed.
+\* ============================================================================================================================================================= */
+static int64_t ntp_rtc_handler(alarm_id_t AlarmId, void *ExtraArgument)
+{
+  INT64 LocalTime;
+
+  time_t Seconds;
+
+  datetime_t DateTime;
+
+  struct tm TmTime;
+
+  struct struct_ntp *StructNTP;
+
+
+  StructNTP = (struct struct_ntp *)ExtraArgument;
+  StructNTP->RtcAlarm = 0;
+
+  /* Alarm fires right on (or a few usec after) the second boundary. */
+  LocalTime = ntp_rtc_get_local_us(StructNTP);
+  Seconds   = (time_t)((LocalTime + 500000ll) / 1000000ll);
+  gmtime_r(&Seconds, &TmTime);
+
+  DateTime.year  = TmTime.tm_year + 1900;
+  DateTime.month = TmTime.tm_mon + 1;
+  DateTime.day   = TmTime.tm_mday;
+  DateTime.dotw  = TmTime.tm_wday;
+  DateTime.hour  = TmTime.tm_hour;
+  DateTime.min   = TmTime.tm_min;
+  DateTime.sec   = TmTime.tm_sec;
+
+  rtc_set_datetime(&DateTime);
+  StructNTP->RtcBase     = time_us_64();
+  StructNTP->RtcBaseTime = Seconds;
+  StructNTP->FlagRtcSet  = FLAG_ON;
+  ++StructNTP->RtcAlignCount;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_rtc_init() */
+/* ============================================================================================================================================================= *\
+                                                       Let the NTP module handle Pico's real-time clock (local time).
+                   NOTE: Must be called after ntp_init(). The RTC is programmed on the first second boundary after the first successful NTP sync
+                         (or right away if the clock has already been set) and re-aligned after each sync when it drifts by more than NTP_RTC_MAX_DRIFT.
+\* ============================================================================================================================================================= */
+void ntp_rtc_init(struct struct_ntp *StructNTP)
+{
+  rtc_init();
+
+  StructNTP->FlagRtc    = FLAG_ON;
+  StructNTP->FlagRtcSet = FLAG_OFF;
+
+  if ((StructNTP->FlagSuccess == FLAG_ON) && (StructNTP->Clock.FlagValid == FLAG_ON)) ntp_rtc_align(StructNTP);
+
+  return;
+}
+
+
 
 
-  /* --------------------------------------------------------------------------------------------------------------------------- *\
-                    Find day-of-week of Daylight Saving Time end for current year and for specific DST country.
-  \* --------------------------------------------------------------------------------------------------------------------------- */
-  /* Find the right day-of-week between the soonest and the latest possible dates. */
-  for (Loop1UInt8 = DstParameters[StructNTP->DSTCountry].EndDayOfMonthLow; Loop1UInt8 <= DstParameters[StructNTP->DSTCountry].EndDayOfMonthHigh; ++Loop1UInt8)
+
+/* $PAGE */
+/* $TITLE=ntp_rtc_now() */
+/* ============================================================================================================================================================= *\
+                                         Read Pico's real-time clock and return the number of usec elapsed since the beginning of current second.
+                  NOTE: Whole seconds come from the RTC and the sub-second part from the Pico timer, both running from the same crystal. A read
+                        at the very beginning of a second waits (at most NTP_RTC_TICK_GUARD usec) for the RTC to tick.
+                        Return NTP_RTC_INVALID if the RTC has not been programmed yet (DateTime is then left unchanged).
+\* ============================================================================================================================================================= */
+UINT32 ntp_rtc_now(struct struct_ntp *StructNTP, datetime_t *DateTime)
+{
+  UINT64 After;
+  UINT64 Before;
+
+
+  if (StructNTP->FlagRtcSet == FLAG_OFF) return NTP_RTC_INVALID;
+
+  while (1)
   {
-    /* Check if this date is the right day-of-week. If it is, find day-of-year for daylight saving time end. */
-    if (ntp_get_day_of_week(Loop1UInt8, DstParameters[StructNTP->DSTCountry].EndMonth, StructNTP->HumanTime.Year) == DstParameters[StructNTP->DSTCountry].EndDayOfWeek)
+    Before = time_us_64() - StructNTP->RtcBase;
+    if ((Before % 1000000ull) < NTP_RTC_TICK_GUARD)
     {
-      EndDoM = Loop1UInt8;
-      StructNTP->DoYEnd = ntp_get_day_of_year(Loop1UInt8, DstParameters[StructNTP->DSTCountry].EndMonth, StructNTP->HumanTime.Year);
-      break;
+      busy_wait_us_32(NTP_RTC_TICK_GUARD - (Before % 1000000ull));
+      continue;
     }
+
+    rtc_get_datetime(DateTime);
+    After = time_us_64() - StructNTP->RtcBase;
+
+    /* Make sure that the RTC has not ticked while we were reading it. */
+    if ((Before / 1000000ull) == (After / 1000000ull)) return (UINT32)(After % 1000000ull);
   }
+}
 
-  /* Check if operation has been successful. */
-  if (Loop1UInt8 > DstParameters[StructNTP->DSTCountry].EndDayOfMonthHigh)
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_rtc_update() */
+/* ============================================================================================================================================================= *\
+                                             Measure the drift of Pico's real-time clock and re-align it if required, after an NTP sync.
+                        NOTE: The RTC counts seconds of the Pico's crystal, while the disciplined clock is corrected for its frequency error.
+                              A change between winter time and summer time also shows up as a (large) drift.
+\* ============================================================================================================================================================= */
+static void ntp_rtc_update(struct struct_ntp *StructNTP)
+{
+  INT64 Drift;
+
+
+  if (StructNTP->RtcAlarm > 0) return;  // RTC is about to be programmed.
+
+  if (StructNTP->FlagRtcSet == FLAG_OFF)
   {
-    log_info(__LINE__, __func__, "Date for daylight saving time end NOT FOUND\r\r\r");
-    StructNTP->FlagSummerTime = FLAG_OFF;
+    ntp_rtc_align(StructNTP);
     return;
   }
-  else
+
+  Drift = ((INT64)StructNTP->RtcBaseTime * 1000000ll) + (INT64)(time_us_64() - StructNTP->RtcBase) - ntp_rtc_get_local_us(StructNTP);
+  if (Drift >  0x7FFFFFFFll) Drift =  0x7FFFFFFFll;
+  if (Drift < -0x7FFFFFFFll) Drift = -0x7FFFFFFFll;
+  StructNTP->RtcDrift = (INT32)Drift;
+
+  if ((Drift > NTP_RTC_MAX_DRIFT) || (Drift < -NTP_RTC_MAX_DRIFT))
   {
-    if (FlagLocalDebug) log_info(__LINE__, __func__, "Date for daylight saving time end   in %4.4u: %2.2u-%s-%4.4u\r", StructNTP->HumanTime.Year, Loop1UInt8, ShortMonth[DstParameters[StructNTP->DSTCountry].EndMonth], StructNTP->HumanTime.Year);
+    ntp_log_event(NTP_LOG_RTC, NTP_EVENT_RTC_ALIGN, StructNTP->RtcDrift, 0, 0);
+    ntp_rtc_align(StructNTP);
   }
 
+  return;
+}
 
 
-  /* --------------------------------------------------------------------------------------------------------------------------- *\
-                                Check if DST country specified is for a northern or southern country.
-  \* --------------------------------------------------------------------------------------------------------------------------- */
-  if (DstParameters[StructNTP->DSTCountry].StartMonth < DstParameters[StructNTP->DSTCountry].EndMonth)
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_schedule_at() */
+/* ============================================================================================================================================================= *\
+                                 Call a function at a UTC instant (in nsec since 01-JAN-1970), as seen by the disciplined clock.
+                  NOTE: The instant is mapped onto the Pico timer and an alarm of StructNTP->AlarmPool is armed for it. Pending events are
+                        re-mapped each time the disciplined clock is updated (see ntp_schedule_remap()), so that devices synchronized to the
+                        same server fire within their clock error bound. Callback is called from the alarm interrupt and must be kept short.
+                        An instant already reached fires right away. If ntp_core1_start() is used, it must be called first. Return the event
+                        number (see ntp_schedule_cancel()) or NTP_SCHEDULE_NONE if the clock has never been set or if no entry is free.
+\* ============================================================================================================================================================= */
+UINT8 ntp_schedule_at(struct struct_ntp *StructNTP, INT64 UTCTime, void (*Callback)(void *Argument), void *Argument)
+{
+  UINT8 Event;
+
+  UINT32 InterruptMask;
+
+  UINT64 LocalTime;
+
+  struct ntp_schedule *Schedule;
+
+  struct ntp_snapshot Snapshot;
+
+
+  if ((Callback == NULL) || (ScheduleLock == NULL)) return NTP_SCHEDULE_NONE;
+
+  if ((StructNTP->FlagCore1) && (get_core_num() == 0))
   {
-    FlagNorth = FLAG_ON;
-    log_info(__LINE__, __func__, "Daylight saving time current parameters:\r");
-    if (FlagLocalDebug)
-      log_info(__LINE__, __func__, "Northern DST country: %u     Delta time with UTC: %d minutes     DST shift: %d minutes.\r", StructNTP->DSTCountry, StructNTP->DeltaTime, DstParameters[StructNTP->DSTCountry].ShiftMinutes);
+    ntp_snapshot_read(StructNTP, &Snapshot);
   }
   else
   {
-    FlagNorth = FLAG_OFF;
-    if (FlagLocalDebug)
-      log_info(__LINE__, __func__, "Southern DST country: %u     Delta time with UTC: %d minutes     DST shift: %d minutes.\r", StructNTP->DSTCountry, StructNTP->DeltaTime, DstParameters[StructNTP->DSTCountry].ShiftMinutes);
+    InterruptMask = spin_lock_blocking(ClockLock);
+    Snapshot.Clock       = StructNTP->Clock;
+    Snapshot.LeapPending = StructNTP->LeapPending;
+    Snapshot.LeapMode    = StructNTP->LeapMode;
+    Snapshot.LeapTime    = StructNTP->LeapTime;
+    spin_unlock(ClockLock, InterruptMask);
   }
 
+  if (Snapshot.Clock.FlagValid == FLAG_OFF) return NTP_SCHEDULE_NONE;
 
+  InterruptMask = spin_lock_blocking(ScheduleLock);
 
-  /* --------------------------------------------------------------------------------------------------------------------------- *\
-                                  Find UTC time for DST start time and DST end time for current year.
-  \* --------------------------------------------------------------------------------------------------------------------------- */
-  /* Find and set UTC time corresponding to local DST start time. */
-  HumanTime.FlagDst    = FLAG_OFF;
-  HumanTime.DayOfWeek  = DstParameters[StructNTP->DSTCountry].StartDayOfWeek;
-  HumanTime.DayOfMonth = StartDoM;
-  HumanTime.DayOfYear  = ntp_get_day_of_year(StartDoM, DstParameters[StructNTP->DSTCountry].StartMonth, StructNTP->HumanTime.Year);
-  HumanTime.Month      = DstParameters[StructNTP->DSTCountry].StartMonth;
-  HumanTime.Year       = StructNTP->HumanTime.Year;
-  HumanTime.Hour       = DstParameters[StructNTP->DSTCountry].StartHour;
-  HumanTime.Minute     = 0;
-  HumanTime.Second     = 0;
+  for (Event = 0; Event < NTP_SCHEDULE_MAX; ++Event)
+    if (StructNTP->Schedule[Event].FlagActive == FLAG_OFF) break;
+
+  if (Event < NTP_SCHEDULE_MAX)
+  {
+    Schedule = &StructNTP->Schedule[Event];
+    Schedule->StructNTP = StructNTP;
+    Schedule->UTCTime   = (UTCTime + 500ll) / 1000ll;
+    Schedule->Callback  = Callback;
+    Schedule->Argument  = Argument;
+
+    /* The alarm is never armed in the past: the handler would then be called right away, with the lock held. */
+    LocalTime = ntp_clock_get_local_us(&Snapshot.Clock, ntp_leap_unadjust(Snapshot.LeapPending, Snapshot.LeapMode, Snapshot.LeapTime, Schedule->UTCTime));
+    if (LocalTime < (time_us_64() + NTP_SCHEDULE_GUARD)) LocalTime = time_us_64() + NTP_SCHEDULE_GUARD;
+    Schedule->LocalTime = LocalTime;
+    Schedule->AlarmId   = alarm_pool_add_alarm_at(StructNTP->AlarmPool, from_us_since_boot(LocalTime), ntp_schedule_handler, Schedule, false);
+
+    if (Schedule->AlarmId > 0)
+      Schedule->FlagActive = FLAG_ON;
+    else
+      Event = NTP_SCHEDULE_MAX;
+  }
 
-  /* Keep Day-of-year value for DST start. */
-  StructNTP->DoYStart = HumanTime.DayOfYear;
+  spin_unlock(ScheduleLock, InterruptMask);
 
-  /* Convert "local human time" of DST start time to "Unix local time". */
-  StructNTP->DSTStart = ntp_convert_human_to_unix(&HumanTime);
+  if (Event == NTP_SCHEDULE_MAX) return NTP_SCHEDULE_NONE;
 
-  /* "UTC time" for DST start time will be "DeltaTime" sooner or later, depending on local timezone. */
-  /* NOTE: Since we are during "normal time" when Daylight Saving Time begins, there is no need to take into account the "ShiftMinutes" count. */
-  StructNTP->DSTStart -= (StructNTP->DeltaTime * 60);
+  return Event;
+}
 
 
 
-  /* Find and set UTC time corresponding to local DST end time. */
-  HumanTime.FlagDst    = FLAG_OFF;
-  HumanTime.DayOfWeek  = DstParameters[StructNTP->DSTCountry].EndDayOfWeek;
-  HumanTime.DayOfMonth = EndDoM;
-  HumanTime.DayOfYear  = ntp_get_day_of_year(EndDoM, DstParameters[StructNTP->DSTCountry].EndMonth, StructNTP->HumanTime.Year);
-  HumanTime.Month      = DstParameters[StructNTP->DSTCountry].EndMonth;
-  HumanTime.Year       = StructNTP->HumanTime.Year;
-  HumanTime.Hour       = DstParameters[StructNTP->DSTCountry].EndHour;
-  HumanTime.Minute     = 0;
-  HumanTime.Second     = 0;
 
-  /* Keep Day-of-year value for DST end. */
-  StructNTP->DoYEnd = HumanTime.DayOfYear;
 
-  /* Convert "local human time" of DST end time to "Unix local time". */
-  StructNTP->DSTEnd = ntp_convert_human_to_unix(&HumanTime);
+/* $PAGE */
+/* $TITLE=ntp_schedule_cancel() */
+/* ============================================================================================================================================================= *\
+                                                         Cancel an event scheduled by ntp_schedule_at().
+                  NOTE: Return 0 if the event has been cancelled, 1 if it was not pending anymore (already fired or cancelled).
+\* ============================================================================================================================================================= */
+UINT8 ntp_schedule_cancel(struct struct_ntp *StructNTP, UINT8 Event)
+{
+  UINT8 ReturnCode;
 
-  /* "UTC time" for DST end time will be "DeltaTime" sooner or later, depending on local timezone. */
-  StructNTP->DSTEnd -=  (StructNTP->DeltaTime * 60);
+  UINT32 InterruptMask;
 
-  /* Since we are during "summer time" when Daylight Saving Time ends, we must take into account the "ShiftMinutes" to get the correct UTC time. */
-  StructNTP->DSTEnd -= (StructNTP->ShiftMinutes * 60);
+  struct ntp_schedule *Schedule;
 
 
-  /* --------------------------------------------------------------------------------------------------------------------------- *\
-                                        Display parameters found for DST start and end time.
-  \* --------------------------------------------------------------------------------------------------------------------------- */
-  log_info(__LINE__, __func__, "DST start date for %4.4u: %8s %2.2u-%s-%4.4u at %2.2u:00   day-of-year: %3u   UTC time: %llu\r",
-            StructNTP->HumanTime.Year,
-            DayName[DstParameters[StructNTP->DSTCountry].StartDayOfWeek],
-            StartDoM, ShortMonth[DstParameters[StructNTP->DSTCountry].StartMonth], StructNTP->HumanTime.Year,
-            DstParameters[StructNTP->DSTCountry].StartHour, StructNTP->DoYStart,
-            StructNTP->DSTStart);
+  if ((Event >= NTP_SCHEDULE_MAX) || (ScheduleLock == NULL)) return 1;
 
-  log_info(__LINE__, __func__, "DST end   date for %4.4u: %8s %2.2u-%s-%4.4u at %2.2u:00   day-of-year: %3u   UTC time: %llu\r",
-            StructNTP->HumanTime.Year,
-            DayName[DstParameters[StructNTP->DSTCountry].EndDayOfWeek],
-            EndDoM, ShortMonth[DstParameters[StructNTP->DSTCountry].EndMonth], StructNTP->HumanTime.Year,
-            DstParameters[StructNTP->DSTCountry].EndHour, StructNTP->DoYEnd,
-            StructNTP->DSTEnd);
+  ReturnCode = 1;
+  Schedule   = &StructNTP->Schedule[Event];
 
+  InterruptMask = spin_lock_blocking(ScheduleLock);
+  if (Schedule->FlagActive)
+  {
+    alarm_pool_cancel_alarm(StructNTP->AlarmPool, Schedule->AlarmId);
+    Schedule->FlagActive = FLAG_OFF;
+    Schedule->AlarmId    = 0;
+    ReturnCode           = 0;
+  }
+  spin_unlock(ScheduleLock, InterruptMask);
 
+  return ReturnCode;
+}
 
-  /* --------------------------------------------------------------------------------------------------------------------------- *\
-                                                  Update local time from UTC time in StructNTP.
-              NOTE: This value can be wrong if the function is called during the one-hour period of the time change,
-                    either from summer timer to winter time or vice versa... This will come back to normal after next reboot
-                    or after next NTP update.
-  \* --------------------------------------------------------------------------------------------------------------------------- */
-  StructNTP->LocalTime = StructNTP->UTCTime + ((INT64)(StructNTP->DeltaTime * 60));
-  if (FlagLocalDebug)
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_schedule_handler() */
+/* ============================================================================================================================================================= *\
+                                                   Alarm callback of an event scheduled by ntp_schedule_at().
+                  NOTE: The instant is mapped again before calling the user function: if the clock has been stepped back since the alarm
+                        has been armed, the alarm is simply rescheduled.
+\* ============================================================================================================================================================= */
+static int64_t ntp_schedule_handler(alarm_id_t AlarmId, void *ExtraArgument)
+{
+  UINT32 InterruptMask;
+
+  UINT64 LocalTime;
+  UINT64 Now;
+
+  INT64 Delay;
+
+  void (*Callback)(void *Argument);
+  void *Argument;
+
+  struct ntp_schedule *Schedule = ExtraArgument;
+  struct struct_ntp   *StructNTP;
+
+  struct ntp_snapshot Snapshot;
+
+
+  StructNTP = Schedule->StructNTP;
+
+  /* ClockLock is taken before ScheduleLock (see ntp_snapshot_publish()): copy the clock and the leap second parameters first. */
+  InterruptMask        = spin_lock_blocking(ClockLock);
+  Snapshot.Clock       = StructNTP->Clock;
+  Snapshot.LeapPending = StructNTP->LeapPending;
+  Snapshot.LeapMode    = StructNTP->LeapMode;
+  Snapshot.LeapTime    = StructNTP->LeapTime;
+  spin_unlock(ClockLock, InterruptMask);
+
+  InterruptMask = spin_lock_blocking(ScheduleLock);
+
+  /* Event cancelled, or re-armed under another alarm by ntp_schedule_remap(). */
+  if ((Schedule->FlagActive == FLAG_OFF) || (Schedule->AlarmId != AlarmId))
   {
-    log_info(__LINE__, __func__, "StructNTP->UTCTime:    %12llu\r",    StructNTP->UTCTime);
-    log_info(__LINE__, __func__, "StructNTP->LocalTime:  %12llu\r",    StructNTP->LocalTime);
-    log_info(__LINE__, __func__, "StructNTP->DeltaTime:        %6d minutes\r", StructNTP->DeltaTime);
+    spin_unlock(ScheduleLock, InterruptMask);
+    return 0;
   }
 
+  Now       = time_us_64();
+  LocalTime = ntp_clock_get_local_us(&Snapshot.Clock, ntp_leap_unadjust(Snapshot.LeapPending, Snapshot.LeapMode, Snapshot.LeapTime, Schedule->UTCTime));
+  if (LocalTime > Now)
+  {
+    /* A positive return value reschedules the alarm relative to the time it was armed for. */
+    Delay               = (INT64)(LocalTime - Schedule->LocalTime);
+    Schedule->LocalTime = LocalTime;
+    spin_unlock(ScheduleLock, InterruptMask);
+    return Delay;
+  }
 
+  Callback             = Schedule->Callback;
+  Argument             = Schedule->Argument;
+  Schedule->FlagActive = FLAG_OFF;
+  Schedule->AlarmId    = 0;
+  StructNTP->ScheduleLatency = (INT32)(Now - LocalTime);
+  ++StructNTP->ScheduleFired;
+  spin_unlock(ScheduleLock, InterruptMask);
 
-  // log_info(__LINE__, __func__, "StructNTP->UTCTime before accounting for summer time or winter time: %12llu\r", StructNTP->UTCTime);  ///
+  Callback(Argument);
 
-  /* --------------------------------------------------------------------------------------------------------------------------- *\
-                                                Check if DST is currently On or Off.
-  \* --------------------------------------------------------------------------------------------------------------------------- */
-  /* Find if daylight saving time is active for a southern country. */
-  if (FlagNorth == FLAG_ON)
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_schedule_remap() */
+/* ============================================================================================================================================================= *\
+                                Map pending scheduled events again onto the Pico timer after an update of the disciplined clock.
+                  NOTE: Called by ntp_snapshot_publish() (ClockLock held). An alarm that is already firing is left alone: its handler maps the instant again.
+\* ============================================================================================================================================================= */
+static void ntp_schedule_remap(struct struct_ntp *StructNTP)
+{
+  UINT8 Loop1UInt8;
+
+  UINT32 InterruptMask;
+
+  UINT64 LocalTime;
+
+  struct ntp_schedule *Schedule;
+
+
+  if (ScheduleLock == NULL) return;
+
+  InterruptMask = spin_lock_blocking(ScheduleLock);
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_SCHEDULE_MAX; ++Loop1UInt8)
   {
-    /* Find for a northern country. */
-    if ((StructNTP->UTCTime > StructNTP->DSTStart) && (StructNTP->UTCTime < StructNTP->DSTEnd))
-    {
-      StructNTP->FlagSummerTime = FLAG_ON;
-      log_info(__LINE__, __func__, "DST settings is for a northern country and currently during daily saving time period of the year.\r");
-    }
-    else
-    {
-      StructNTP->FlagSummerTime = FLAG_OFF;
-      log_info(__LINE__, __func__, "DST settings is for a northern country and currently not during daily saving time period of the year.\r");
-    }
+    Schedule = &StructNTP->Schedule[Loop1UInt8];
+    if (Schedule->FlagActive == FLAG_OFF) continue;
+
+    LocalTime = ntp_clock_get_local_us(&StructNTP->Clock, ntp_leap_unadjust(StructNTP->LeapPending, StructNTP->LeapMode, StructNTP->LeapTime, Schedule->UTCTime));
+    if (LocalTime < (time_us_64() + NTP_SCHEDULE_GUARD)) LocalTime = time_us_64() + NTP_SCHEDULE_GUARD;
+    if (LocalTime == Schedule->LocalTime) continue;
+
+    if (alarm_pool_cancel_alarm(StructNTP->AlarmPool, Schedule->AlarmId) == false) continue;
+
+    Schedule->LocalTime = LocalTime;
+    Schedule->AlarmId   = alarm_pool_add_alarm_at(StructNTP->AlarmPool, from_us_since_boot(LocalTime), ntp_schedule_handler, Schedule, false);
+    if (Schedule->AlarmId <= 0) Schedule->FlagActive = FLAG_OFF;
+    ++StructNTP->ScheduleRemaps;
   }
-  else
+  spin_unlock(ScheduleLock, InterruptMask);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_set_language() */
+/* ============================================================================================================================================================= *\
+                                                      Select the language used for day and month names.
+                                              NOTE: Return 1 (and keep current language) if the language specified is not supported.
+\* ============================================================================================================================================================= */
+UINT8 ntp_set_language(UINT8 Language)
+{
+  if (Language > LANGUAGE_HI_LIMIT) return 1;
+
+  CurrentLanguage = Language;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_snapshot_publish() */
+/* ============================================================================================================================================================= *\
+                                             Publish a copy of the disciplined clock for readers on the other core.
+                   NOTE: Must be called after each update of the disciplined clock or of the leap second parameters, with ClockLock held (so that
+                         two updates from both cores never interleave and the sequence number is always even again). Readers retry if the sequence
+                         number was odd or has changed while they were copying the snapshot (see ntp_snapshot_read()). Scheduled events are re-mapped.
+\* ============================================================================================================================================================= */
+static void ntp_snapshot_publish(struct struct_ntp *StructNTP)
+{
+  ++StructNTP->Snapshot.Sequence;  // odd: update in progress.
+  __dmb();
+  StructNTP->Snapshot.Clock       = StructNTP->Clock;
+  StructNTP->Snapshot.LeapPending = StructNTP->LeapPending;
+  StructNTP->Snapshot.LeapMode    = StructNTP->LeapMode;
+  StructNTP->Snapshot.LeapTime    = StructNTP->LeapTime;
+  __dmb();
+  ++StructNTP->Snapshot.Sequence;  // even: update complete.
+
+  /* Every update of the disciplined clock ends up here: events scheduled at a UTC instant follow it. */
+  ntp_schedule_remap(StructNTP);
+
+  /* Observers are notified of clock steps and of offsets large enough to be noticed while they are slewed. */
+  if (StructNTP->Clock.SampleCount != StructNTP->NotifySamples)
   {
-    /* Find for a southern country. */
-    if ((StructNTP->UTCTime > StructNTP->DSTEnd) && (StructNTP->UTCTime < StructNTP->DSTStart))
+    StructNTP->NotifySamples = StructNTP->Clock.SampleCount;
+    if (StructNTP->Clock.StepCount != StructNTP->NotifySteps)
     {
-      StructNTP->FlagSummerTime = FLAG_OFF;
-      log_info(__LINE__, __func__, "DST settings is for a southern country and currently not during daily saving time period of the year.\r");
+      StructNTP->NotifySteps = StructNTP->Clock.StepCount;
+      ntp_observer_post(StructNTP, NTP_NOTIFY_STEP, StructNTP->Clock.LastOffset);
     }
-    else
+    else if ((StructNTP->Clock.LastOffset >= NTP_NOTIFY_SLEW_MIN) || (StructNTP->Clock.LastOffset <= -NTP_NOTIFY_SLEW_MIN))
     {
-      StructNTP->FlagSummerTime = FLAG_ON;
-      log_info(__LINE__, __func__, "DST settings is for a southern country and currently during daily saving time period of the year.\r");
+      ntp_observer_post(StructNTP, NTP_NOTIFY_SLEW, StructNTP->Clock.LastOffset);
     }
   }
 
-  if (StructNTP->FlagSummerTime) StructNTP->LocalTime += (StructNTP->ShiftMinutes * 60);
+  return;
+}
 
-  if (FlagLocalDebug)
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_snapshot_read() */
+/* ============================================================================================================================================================= *\
+                                                     Copy the disciplined clock published by the other core.
+                          NOTE: Never blocks the core updating the clock: the copy is done again if an update happened while copying.
+\* ============================================================================================================================================================= */
+static void ntp_snapshot_read(struct struct_ntp *StructNTP, struct ntp_snapshot *Snapshot)
+{
+  UINT32 Sequence;
+
+
+  do
   {
-    log_info(__LINE__, __func__, "StructNTP.LocalTime:   %12llu\r", StructNTP->LocalTime);
-    log_info(__LINE__, __func__, "StructNTP.FlagSummerTime:      0x%2.2X\r", StructNTP->FlagSummerTime);
-    log_info(__LINE__, __func__, "StructNTP.UTCTime:     %12llu\r", StructNTP->UTCTime);
-  }
+    do
+    {
+      Sequence = StructNTP->Snapshot.Sequence;
+    } while (Sequence & 0x01);
+    __dmb();
+
+    Snapshot->Clock       = StructNTP->Snapshot.Clock;
+    Snapshot->LeapPending = StructNTP->Snapshot.LeapPending;
+    Snapshot->LeapMode    = StructNTP->Snapshot.LeapMode;
+    Snapshot->LeapTime    = StructNTP->Snapshot.LeapTime;
+    __dmb();
+  } while (Sequence != StructNTP->Snapshot.Sequence);
 
   return;
 }
@@ -679,31 +3753,43 @@ void ntp_dst_settings(struct struct_ntp *StructNTP)
 
 
 /* $PAGE */
-/* $TITLE=ntp_failed_handler() */
+/* $TITLE=ntp_tempco_init() */
 /* ============================================================================================================================================================= *\
-                                                                           NTP request failed.
+                           Compensate the frequency error of the crystal for temperature, using the RP2040 on-chip temperature sensor.
+                  NOTE: To be called after ntp_init(). The model needs a few hours of samples (NTP_TEMPCO_MIN_POINTS measurements spaced by at
+                        least NTP_TEMPCO_MIN_INTERVAL) and some temperature change before corrections are applied. The ADC is shared with the
+                        application, which must have called adc_init() first (it resets the whole ADC): only the temperature sensor is enabled
+                        here. It is then read by ntp_observer_dispatch(), which must be called from the main loop: never from an interrupt or
+                        from core 1, so that conversions of the application are not preempted. Return 0 on success.
 \* ============================================================================================================================================================= */
-static int64_t ntp_failed_handler(alarm_id_t AlarmId, void *ExtraArgument)
+UINT8 ntp_tempco_init(struct struct_ntp *StructNTP)
 {
-#ifdef RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
-#else   // RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
-#endif  // RELEASE_VERSION
+  INT32 Temperature;
 
-  struct struct_ntp *StructNTP;
+  UINT32 InterruptMask;
 
 
-  StructNTP = (struct struct_ntp *)ExtraArgument;
+  if (StructNTP->FlagTempco) return 0;
 
-  if (FlagLocalDebug)
+  if ((adc_hw->cs & ADC_CS_EN_BITS) == 0)
   {
-    log_info(__LINE__, __func__, "Entering ntp_failed_handler()\r");
-    log_info(__LINE__, __func__, "NTP request failed - AlarmId: %u.\r", AlarmId);
-    log_info(__LINE__, __func__, "Pointer to StructNTP: 0x%p\r", StructNTP);
+    log_info(__LINE__, __func__, "adc_init() has not been called by the application. Aborting...\r");
+    return 1;
   }
+  adc_set_temp_sensor_enabled(true);
+  adc_select_input(NTP_TEMPCO_ADC_INPUT);
 
-  ntp_result(-1, NULL, StructNTP);
+  Temperature = ntp_tempco_read();
+
+  InterruptMask = spin_lock_blocking(ClockLock);
+  ntp_tempco_reset(&StructNTP->Tempco);
+  ntp_tempco_temperature(&StructNTP->Tempco, time_us_64(), Temperature);
+  StructNTP->Clock.Tempco = &StructNTP->Tempco;
+  StructNTP->TempcoPpb    = 0l;
+  spin_unlock(ClockLock, InterruptMask);
+
+  StructNTP->TempcoNext = time_us_64() + NTP_TEMPCO_PERIOD;
+  StructNTP->FlagTempco = FLAG_ON;
 
   return 0;
 }
@@ -713,20 +3799,34 @@ static int64_t ntp_failed_handler(alarm_id_t AlarmId, void *ExtraArgument)
 
 
 /* $PAGE */
-/* $TITLE=ntp_get_day_of_week() */
+/* $TITLE=ntp_tempco_read() */
 /* ============================================================================================================================================================= *\
-                                               Return the day-of-week for the specified date. Sunday =  (...) Saturday =
+                                      Return the temperature (in 1/1000 degree C) of the RP2040 on-chip temperature sensor.
+                  NOTE: Average of NTP_TEMPCO_ADC_SAMPLES readings. ADC input selected by the application, if any, is restored.
 \* ============================================================================================================================================================= */
-UINT8 ntp_get_day_of_week(UINT8 DayOfMonth, UINT8 Month, UINT16 Year)
+static INT32 ntp_tempco_read(void)
 {
-  UINT8 DayOfWeek;
-  UINT8 Table[12] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+  UINT8 Input;
+  UINT8 Loop1UInt8;
 
+  UINT32 Sum;
 
-  Year -= Month < 3;
-  DayOfWeek = ((Year + (Year / 4) - (Year / 100) + (Year / 400) + Table[Month - 1] + DayOfMonth) % 7);
+  INT64 Microvolts;
 
-  return DayOfWeek;;
+
+  Input = adc_get_selected_input();
+  adc_select_input(NTP_TEMPCO_ADC_INPUT);
+
+  Sum = 0l;
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_TEMPCO_ADC_SAMPLES; ++Loop1UInt8)
+    Sum += adc_read();
+
+  adc_select_input(Input);
+
+  /* RP2040 datasheet: T = 27 - (V - 0.706) / 0.001721 with V = reading * Vref / 4096. */
+  Microvolts = ((INT64)Sum * NTP_TEMPCO_VREF) / (4096ll * NTP_TEMPCO_ADC_SAMPLES);
+
+  return 27000l - (INT32)(((Microvolts - 706000ll) * 1000ll) / 1721ll);
 }
 
 
@@ -734,44 +3834,100 @@ UINT8 ntp_get_day_of_week(UINT8 DayOfMonth, UINT8 Month, UINT16 Year)
 
 
 /* $PAGE */
-/* $TITLE=ntp_get_day_of_year() */
+/* $TITLE=ntp_tempco_update() */
 /* ============================================================================================================================================================= *\
-                                                          Determine the day-of-year of date given in argument.
-            NOTE: We shouldn't use log_info() in this function since the timestamp is not available when get_day_of_year() is called from ds3231_init()
+                  Read the temperature of the crystal when due, feed the change of frequency forward and fit the temperature model, outside ClockLock.
+                  NOTE: Called from ntp_observer_dispatch() (main loop of the application, even with the time service on core 1): the ADC is read
+                        every NTP_TEMPCO_PERIOD in thread context, on the core of the application, and only the frequency adjustment is done under ClockLock. ntp_clock_sample() only records the measurement:
+                        the fit and the solution of the normal equations are done on a copy of the model, so that interrupts are not held off by
+                        floating point computations. Only this function changes the fit, which is copied back under ClockLock.
 \* ============================================================================================================================================================= */
-UINT16 ntp_get_day_of_year(UINT8 DayOfMonth, UINT8 Month, UINT16 Year)
+static void ntp_tempco_update(struct struct_ntp *StructNTP)
 {
-  UINT8 Loop1UInt8;
-  UINT8 MonthDays;
+  INT32 Correction;
+  INT32 Temperature;
 
-  UINT16 TargetDayOfYear;
+  UINT32 InterruptMask;
 
+  UINT64 LocalTime;
 
-  /// if (DebugBitMask & DEBUG_NTP) printf("[%4u]   DayOfMonth %u   Month: %u   Year: %u\r", __LINE__, DayOfMonth, Month, Year);
-  if ((Month < 1)    || (Month > 12))   return 0;
-  if ((Year  < 2000) || (Year  > 2100)) Year = 2024;
+  struct ntp_tempco Tempco;
 
 
-  /* Initializations. */
-  TargetDayOfYear = 0;
+  if (StructNTP->FlagTempco == FLAG_OFF) return;
 
-  /* Add up all complete months. */
-  for (Loop1UInt8 = 1; Loop1UInt8 < Month; ++Loop1UInt8)
+  /* Temperature reading: late readings are not caught up, the next one is NTP_TEMPCO_PERIOD after this one was due. */
+  LocalTime = time_us_64();
+  if (LocalTime >= StructNTP->TempcoNext)
   {
-    MonthDays = ntp_get_month_days(Loop1UInt8, Year);
-    TargetDayOfYear += MonthDays;
+    StructNTP->TempcoNext += NTP_TEMPCO_PERIOD;
+    if (StructNTP->TempcoNext <= LocalTime) StructNTP->TempcoNext = LocalTime + NTP_TEMPCO_PERIOD;
+    Temperature = ntp_tempco_read();
+
+    InterruptMask = spin_lock_blocking(ClockLock);
+    LocalTime     = time_us_64();
+    ntp_tempco_temperature(&StructNTP->Tempco, LocalTime, Temperature);
+    Correction = ntp_tempco_correction(&StructNTP->Tempco);
+    if (Correction != 0)
+    {
+      ntp_trace_clock(StructNTP, NTP_TRACE_ADJUST, 0, NTP_SOURCE_NONE, LocalTime, Correction);
+      ntp_clock_adjust_frequency(&StructNTP->Clock, LocalTime, Correction);
+      StructNTP->TempcoPpb += Correction;
+      ntp_snapshot_publish(StructNTP);
+    }
+    spin_unlock(ClockLock, InterruptMask);
+  }
 
-    /// if (DebugBitMask & DEBUG_NTP)
-    ///   printf("[%4u]   Adding month %2u [%3s]   Number of days: %2u   (cumulative: %3u)\r", __LINE__, Loop1UInt8, ShortMonth[Loop1UInt8], MonthDays, TargetDayOfYear);
+  /* Fit of the model with the measurement of the last sample, if any. */
+  InterruptMask = spin_lock_blocking(ClockLock);
+  if (StructNTP->Tempco.FlagMeasure == FLAG_OFF)
+  {
+    spin_unlock(ClockLock, InterruptMask);
+    return;
   }
+  Tempco = StructNTP->Tempco;
+  StructNTP->Tempco.FlagMeasure = FLAG_OFF;
+  spin_unlock(ClockLock, InterruptMask);
+
+  if (ntp_tempco_fit(&Tempco) == 0) return;
+
+  InterruptMask = spin_lock_blocking(ClockLock);
+  memcpy(StructNTP->Tempco.Matrix,      Tempco.Matrix,      sizeof(Tempco.Matrix));
+  memcpy(StructNTP->Tempco.Vector,      Tempco.Vector,      sizeof(Tempco.Vector));
+  memcpy(StructNTP->Tempco.Coefficient, Tempco.Coefficient, sizeof(Tempco.Coefficient));
+  StructNTP->Tempco.Points      = Tempco.Points;
+  StructNTP->Tempco.ResidualPpb = Tempco.ResidualPpb;
+  spin_unlock(ClockLock, InterruptMask);
+
+  return;
+}
 
-  /* Then add days of the last, partial month. */
-  /// if (DebugBitMask & DEBUG_NTP)
-  ///   printf("[%4u]   Final DayNumber after adding final partial month: (%u + %u) = %3u\r\r\r", __LINE__, TargetDayOfYear, DayOfMonth, TargetDayOfYear + DayOfMonth);
 
-  TargetDayOfYear += DayOfMonth;
 
-  return TargetDayOfYear;
+
+
+/* $PAGE */
+/* $TITLE=ntp_trace_clock() */
+/* ============================================================================================================================================================= *\
+                                       Write a trace record for an input of the disciplined clock other than an NTP reply.
+               NOTE: To be called with ClockLock held, before the disciplined clock is updated, so that a replay from the last snapshot applies the
+                     same input to the same clock state. PPS edges are in their own category (NTP_TRACE_PPS), as they would fill the ring buffer in one minute.
+\* ============================================================================================================================================================= */
+static void ntp_trace_clock(struct struct_ntp *StructNTP, UINT8 Type, UINT8 Flags, UINT8 Source, UINT64 LocalTime, INT64 Value)
+{
+  struct ntp_trace_record Record;
+
+
+  memset(&Record, 0x00, sizeof(Record));
+  Record.Type                   = Type;
+  Record.Flags                  = Flags;
+  Record.Data.Sample.LocalTime  = LocalTime;
+  Record.Data.Sample.Value      = Value;
+  Record.Data.Sample.Source     = Source;
+
+  ntp_trace_put(StructNTP, (Source == NTP_SOURCE_PPS) ? NTP_TRACE_PPS : NTP_TRACE_CLOCK, &Record);
+
+  return;
 }
 
 
@@ -779,50 +3935,66 @@ UINT16 ntp_get_day_of_year(UINT8 DayOfMonth, UINT8 Month, UINT16 Year)
 
 
 /* $PAGE */
-/* $TITLE=ntp_get_month_days() */
+/* $TITLE=ntp_trace_exchange() */
 /* ============================================================================================================================================================= *\
-                            Return the number of days of a specific month, given the specified year (to know if it is a leap year or not).
+                                                            Write a trace record for an NTP exchange.
+                   NOTE: Info is NULL when the reply could not be parsed, Exchange is NULL when the reply has not been used to compute
+                         timestamps (invalid reply). For IPv6 servers, only the last 32 bits of the address are kept. Takes ClockLock.
 \* ============================================================================================================================================================= */
-UINT8 ntp_get_month_days(UINT8 MonthNumber, UINT16 TargetYear)
+static void ntp_trace_exchange(struct struct_ntp *StructNTP, UINT8 Type, UINT8 Status, UINT8 Flags, const ip_addr_t *IPAddress, const struct ntp_packet *Info, const struct ntp_exchange *Exchange)
 {
-  UINT8 NumberOfDays;
+  UINT32 InterruptMask;
+
+  struct ntp_trace_record Record;
 
 
-  switch (MonthNumber)
+  memset(&Record, 0x00, sizeof(Record));
+  Record.Type                 = Type;
+  Record.Flags                = Flags;
+  Record.Data.Exchange.Status = Status;
+
+  if (IPAddress != NULL)
+  {
+    if (IP_IS_V6(IPAddress))
+    {
+      Record.Flags |= NTP_TRACE_FLAG_IPV6;
+      Record.Data.Exchange.Server = ip_2_ip6(IPAddress)->addr[3];
+    }
+    else
+      Record.Data.Exchange.Server = ip_2_ip4(IPAddress)->addr;
+  }
+
+  if (Info != NULL)
   {
-    case (1):
-    case (3):
-    case (5):
-    case (7):
-    case (8):
-    case (10):
-    case (12):
-      NumberOfDays = 31;
-    break;
-
-    case (4):
-    case (6):
-    case (9):
-    case (11):
-      NumberOfDays = 30;
-    break;
+    Record.Data.Exchange.Stratum        = Info->Stratum;
+    Record.Data.Exchange.LeapIndicator  = Info->LeapIndicator;
+    Record.Data.Exchange.Mode           = Info->Mode;
+    Record.Data.Exchange.RootDelay      = Info->RootDelay;
+    Record.Data.Exchange.RootDispersion = Info->RootDispersion;
+    Record.Data.Exchange.T2             = Info->Receive;
+    Record.Data.Exchange.T3             = Info->Transmit;
+  }
 
-    case 2:
-      /* February, we must check if it is a leap year. */
-      if (((TargetYear % 4 == 0) && (TargetYear % 100 != 0)) || (TargetYear % 400 == 0))
-      {
-        /* This is a leap year. */
-        NumberOfDays = 29;
-      }
-      else
-      {
-        /* Not a leap year. */
-        NumberOfDays = 28;
-      }
-    break;
+  if (Exchange != NULL)
+  {
+    Record.Data.Exchange.Send     = Exchange->Send;
+    Record.Data.Exchange.Receive  = Exchange->Receive;
+    Record.Data.Exchange.Complete = Exchange->Complete;
+    Record.Data.Exchange.T1       = Exchange->T1;
+    Record.Data.Exchange.T2       = Exchange->T2;
+    Record.Data.Exchange.T3       = Exchange->T3;
+    Record.Data.Exchange.T4       = Exchange->T4;
+    Record.Data.Exchange.Delay    = Exchange->Delay;
+    Record.Data.Exchange.Offset   = Exchange->Offset;
   }
+  else if (Type == NTP_TRACE_REPLY)
+    Record.Data.Exchange.Receive = StructNTP->Receive;
 
-  return NumberOfDays;
+  InterruptMask = spin_lock_blocking(ClockLock);
+  ntp_trace_put(StructNTP, NTP_TRACE_EXCHANGE, &Record);
+  spin_unlock(ClockLock, InterruptMask);
+
+  return;
 }
 
 
@@ -830,192 +4002,127 @@ UINT8 ntp_get_month_days(UINT8 MonthNumber, UINT16 TargetYear)
 
 
 /* $PAGE */
-/* $TITLE=ntp_get_time() */
+/* $TITLE=ntp_trace_put() */
 /* ============================================================================================================================================================= *\
-                                                               Retrieve current UTC time from NTP server.
+                                     Write a trace record, preceded by a snapshot of the disciplined clock when one is due.
+                NOTE: ClockLock must be held by the caller, so that the disciplined clock isn't updated (PPS edge, other core) between the snapshot
+                      and the record.
 \* ============================================================================================================================================================= */
-void ntp_get_time(struct struct_ntp *StructNTP)
+static void ntp_trace_put(struct struct_ntp *StructNTP, UINT8 Category, struct ntp_trace_record *Record)
 {
-#ifdef RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
-#else   // RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
-#endif  // RELEASE_VERSION
-
-  UCHAR Dum1Str[64];
-
-  INT ReturnCode;
+  INT16 Temperature;
 
-  UINT8 FlagRetry;
+  struct ntp_trace_record State;
 
-  INT64 DeltaTime;
 
+  Temperature = (StructNTP->FlagTempco) ? (INT16)(StructNTP->Tempco.Temperature / 10) : NTP_TRACE_NO_TEMPERATURE;
 
-  if (FlagLocalDebug)
+  if (ntp_trace_state_due(Category))
   {
-    log_info(__LINE__, __func__, "======================================================================\r");
-    log_info(__LINE__, __func__, "                       Entering ntp_get_time()\r");
-    // display_ntp_info();
+    ntp_trace_snapshot(&StructNTP->Clock, &State);
+    State.Temperature = Temperature;
+    State.Cycle       = StructNTP->ReadCycles;
+    ntp_trace_write(Category, &State);
   }
 
+  Record->Temperature = Temperature;
+  Record->Cycle       = StructNTP->ReadCycles;
+  ntp_trace_write(Category, Record);
 
-  if (StructNTP->FlagInit == FLAG_OFF) log_info(__LINE__, __func__, "ntp_init() has not already been done successfully. Aborting...\r");
-
-
-  if ((StructNTP->FlagHealth) && (StructNTP->ScanCount < NTP_SCAN_FACTOR) && (!is_nil_time(StructNTP->UpdateTime)))
-  {
-    if (FlagLocalDebug)
-    {
-      log_info(__LINE__, __func__, "================================================================\r");
-      log_info(__LINE__, __func__, "                           Poll cycle\r");
-      log_info(__LINE__, __func__, "================================================================\r");
-      // display_ntp_info();
-    }
-
-    StructNTP->UpdateTime = make_timeout_time_ms(NTP_REFRESH * 1000);
-    StructNTP->FlagSuccess = FLAG_POLL;
-    StructNTP->PollCycles++;
-    StructNTP->ScanCount++;
+  return;
+}
 
-    return;
-  }
 
 
-  if (FlagLocalDebug)
-  {
-    log_info(__LINE__, __func__, "======================================================================\r");
-    log_info(__LINE__, __func__, "                              Read cycle\r");
-    log_info(__LINE__, __func__, "======================================================================\r");
-    // display_ntp_info(StructNTP);
-  }
 
-  StructNTP->UpdateTime = make_timeout_time_ms(NTP_REFRESH * 1000);
-  StructNTP->ReadCycles++;
-  StructNTP->ScanCount = 1;
 
-  /* Set alarm in case udp requests are lost (10 seconds). */
-  StructNTP->ResendAlarm = add_alarm_in_ms(NTP_RESEND_TIME, ntp_failed_handler, &StructNTP, true);
+/* $PAGE */
+/* $TITLE=ntp_ts_to_absolute_time() */
+/* ============================================================================================================================================================= *\
+                                                Convert an NTP timestamp to the corresponding Pico absolute time, using the disciplined clock.
+                                NOTE: Return nil_time if the clock has never been set. A pending leap second smear is not taken into account.
+\* ============================================================================================================================================================= */
+absolute_time_t ntp_ts_to_absolute_time(struct struct_ntp *StructNTP, ntp_timestamp_t Timestamp)
+{
+  UINT32 InterruptMask;
 
-  /* NOTE: cyw43_arch_lwip_begin() / cyw43_arch_lwip_end() should be used around calls into LwIP to ensure correct locking.
-           You can omit them if you are in a callback from LwIP. Note that when using pico_cyw_arch_poll library these calls
-           are a no-op and can be omitted, but it is a good practice to use them in case you switch the cyw43_arch type later. */
-  cyw43_arch_lwip_begin();
-  {
-    ReturnCode = dns_gethostbyname(NTP_SERVER, &StructNTP->ServerAddress, ntp_dns_found, StructNTP);
-  }
-  cyw43_arch_lwip_end();
+  UINT64 LocalTime;
 
+  absolute_time_t AbsoluteTime;
 
-  StructNTP->DNSRequestSent = true;
-  if (FlagLocalDebug) log_info(__LINE__, __func__, "Request NTP server IP address from NTP pool: <%s>\r", NTP_SERVER);
+  struct ntp_snapshot Snapshot;
 
 
-  if (ReturnCode == 0)
+  if ((StructNTP->FlagCore1) && (get_core_num() == 0))
   {
-    if (FlagLocalDebug) log_info(__LINE__, __func__, "Cache DNS response.\r");
-    ntp_request(StructNTP);  // cached result.
+    ntp_snapshot_read(StructNTP, &Snapshot);
   }
   else
   {
-    /* Other error codes. */
-    switch (ReturnCode)
-    {
-      case (ERR_OK):
-        /* ReturnCode = 0 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "No error, everything OK.\r");
-      break;
-
-      case (ERR_MEM):
-        /* ReturnCode = -1 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Out of memory.\r");
-      break;
-
-      case (ERR_BUF):
-        /* ReturnCode = -2 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Buffer error.\r");
-      break;
+    InterruptMask = spin_lock_blocking(ClockLock);
+    Snapshot.Clock = StructNTP->Clock;
+    spin_unlock(ClockLock, InterruptMask);
+  }
 
-      case (ERR_TIMEOUT):
-        /* ReturnCode = -3 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Timeout.\r");
-      break;
+  if (Snapshot.Clock.FlagValid == FLAG_OFF) return nil_time;
 
-      case (ERR_RTE):
-        /* ReturnCode = -4 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Routing problem.\r");
-      break;
+  LocalTime = ntp_clock_get_local_us(&Snapshot.Clock, ntp_ts_to_unix_us(Timestamp, ntp_clock_get_utc_us(&Snapshot.Clock, time_us_64())));
 
-      case (ERR_INPROGRESS):
-        /* ReturnCode = -5 */
-        if (FlagLocalDebug)
-        {
-          log_info(__LINE__, __func__, "Request sent for an NTP server address. Return code: <ERR_INPROGRESS>.\r");
-          log_info(__LINE__, __func__, "Waiting for callback.\r");
-        }
-        ntp_result(-1, NULL, StructNTP);
-      break;
+  update_us_since_boot(&AbsoluteTime, LocalTime);
 
-      case (ERR_VAL):
-        /* ReturnCode = -6 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Illegal value.\r");
-      break;
+  return AbsoluteTime;
+}
 
-      case (ERR_WOULDBLOCK):
-        /* ReturnCode = -7 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Operation would block.\r");
-      break;
 
-      case (ERR_USE):
-        /* ReturnCode = -8 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Address in use.\r");
-      break;
 
-      case (ERR_ALREADY):
-        /* ReturnCode = -9 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Already connecting.\r");
-      break;
 
-      case (ERR_ISCONN):
-        /* ReturnCode = -10 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Connection already established.\r");
-      break;
 
-      case (ERR_CONN):
-        /* ReturnCode = -11 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Not connected.\r");
-      break;
+/* $PAGE */
+/* $TITLE=ntp_wheel_add() */
+/* ============================================================================================================================================================= *\
+                               Register a recurring job at a local wall time (daily, weekly or monthly) in a calendar timer wheel.
+                  NOTE: Job storage is provided by the caller and must remain valid until ntp_wheel_remove(). Day is the day-of-week (Sunday = 0)
+                        for NTP_JOB_WEEKLY, the day-of-month for NTP_JOB_MONTHLY (last day of shorter months) and is ignored for NTP_JOB_DAILY.
+                        Return 0 if the job has been registered, 1 if the rule is invalid.
+\* ============================================================================================================================================================= */
+UINT8 ntp_wheel_add(struct ntp_wheel *Wheel, struct ntp_job *Job, UINT8 Type, UINT8 Day, UINT8 Hour, UINT8 Minute, UINT8 Second, void (*Callback)(struct ntp_job *Job), void *Argument)
+{
+  if ((Callback == NULL) || (Hour > 23) || (Minute > 59) || (Second > 59)) return 1;
+  if ((Type == NTP_JOB_WEEKLY) && (Day > 6)) return 1;
+  if ((Type == NTP_JOB_MONTHLY) && ((Day < 1) || (Day > 31))) return 1;
+  if (Type > NTP_JOB_MONTHLY) return 1;
+
+  Job->Type     = Type;
+  Job->Day      = Day;
+  Job->Hour     = Hour;
+  Job->Minute   = Minute;
+  Job->Second   = Second;
+  Job->Callback = Callback;
+  Job->Argument = Argument;
+  Job->FireTime = ntp_wheel_next(Wheel, Job, Wheel->Now);
+  ntp_wheel_insert(Wheel, Job);
+  ++Wheel->JobCount;
 
-      case (ERR_IF):
-        /* ReturnCode = -12 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Low level netif error.\r");
-      break;
+  return 0;
+}
 
-      case (ERR_ABRT):
-        /* ReturnCode = -13 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Connection aborted.\r");
-      break;
 
-      case (ERR_RST):
-        /* ReturnCode = -14 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Connection reset.\r");
-      break;
 
-      case (ERR_CLSD):
-        /* ReturnCode = -15 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Connection closed.\r");
-      break;
 
-      case (ERR_ARG):
-        /* ReturnCode = -16 */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Illegal argument.\r");
-      break;
 
-      default:
-        /* Unrecognized ReturnCode. */
-        if (FlagLocalDebug) log_info(__LINE__, __func__, "Error: Unknown return code: %d\r", ReturnCode);
-      break;
-    }
-  }
+/* $PAGE */
+/* $TITLE=ntp_wheel_init() */
+/* ============================================================================================================================================================= *\
+                                             Initialize a calendar timer wheel, jobs being keyed on local wall time.
+                  NOTE: Local time follows StructNTP->DeltaTime and the daylight saving time rules of StructNTP->DSTCountry. If they are changed,
+                        jobs must be removed and registered again. The wheel may be initialized before the first sync: jobs are scheduled again
+                        from current time when the clock is set (see ntp_wheel_tick()).
+\* ============================================================================================================================================================= */
+void ntp_wheel_init(struct struct_ntp *StructNTP, struct ntp_wheel *Wheel)
+{
+  memset(Wheel, 0, sizeof(struct ntp_wheel));
+  Wheel->StructNTP = StructNTP;
+  Wheel->Now       = ntp_get_utc_us(StructNTP) / 1000000ll;
 
   return;
 }
@@ -1025,49 +4132,36 @@ void ntp_get_time(struct struct_ntp *StructNTP)
 
 
 /* $PAGE */
-/* $TITLE=ntp_init() */
+/* $TITLE=ntp_wheel_insert() */
 /* ============================================================================================================================================================= *\
-                                                                    Initialize NTP connection.
+                                        Insert a job in the slot of the timer wheel corresponding to its next fire time.
+                  NOTE: Level 0 slots are seconds, each higher level slot covers a whole turn of the level below. A job is put on the lowest level
+                        that reaches its fire time, and cascades to the lower levels as current time gets closer (see ntp_wheel_tick()).
 \* ============================================================================================================================================================= */
-UINT8 ntp_init(struct struct_ntp *StructNTP)
+static void ntp_wheel_insert(struct ntp_wheel *Wheel, struct ntp_job *Job)
 {
-#ifdef RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
-#else   // RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
-#endif  // RELEASE_VERSION
-
-  struct tm TmTime;
+  UINT8 Level;
 
+  INT64 Delta;
 
-  if (StructNTP->FlagInit) log_info(__LINE__, __func__, "ntp_init() has already been called before. No action taken.\r");
-
-  StructNTP->FlagSuccess    = FLAG_OFF;  // will be turned On after successful NTP answer.
-  StructNTP->FlagHealth     = FLAG_OFF;  // will be set according to last NTP outcome (assume no NTP answer on entry).
-  StructNTP->FlagHistory    = FLAG_OFF;  // will be set according to last NTP outcome (assume no NTP answer on entry).
-  StructNTP->FlagInit       = FLAG_OFF;  // NTP has not already been initialized.
-  StructNTP->FlagSummerTime = FLAG_OFF;  // assume we are not during summer time on entry and system will automatically adjust the right status.
-  StructNTP->ScanCount      = 0;
-  StructNTP->TotalErrors    = 0l;        // reset total number of NTP errors on entry.
-  StructNTP->ReadCycles     = 0l;
-  StructNTP->PollCycles     = 0l;        // reset number of NTP poll cycles on entry.
-  StructNTP->UpdateTime     = nil_time;
-  StructNTP->UTCTime        = (StructNTP->LocalTime - (StructNTP->DeltaTime * 60));
+  struct ntp_job **Head;
 
 
-  StructNTP->Pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
-  if (StructNTP->Pcb == 0)
-  {
-    if (FlagLocalDebug) log_info(__LINE__, __func__, "Failed to create Pcb.\r");
-    StructNTP->FlagInit = FLAG_OFF;
-    return 1;
-  }
+  /* A job due now goes to the slot being processed by ntp_wheel_tick(). */
+  Delta = Job->FireTime - Wheel->Now;
+  if (Delta < 0) Delta = 0;
 
+  /* Beyond the range of the wheel, a job stays on the highest level and is simply cascaded again. */
+  for (Level = 0; Level < (NTP_WHEEL_LEVELS - 1); ++Level)
+    if (Delta < (1ll << ((Level + 1) * NTP_WHEEL_BITS))) break;
 
-  StructNTP->FlagInit = FLAG_ON;  // ntp_init() was successful.
-  udp_recv(StructNTP->Pcb, ntp_recv, StructNTP);
+  Head = &Wheel->Slot[Level][(Job->FireTime >> (Level * NTP_WHEEL_BITS)) & (NTP_WHEEL_SLOTS - 1)];
+  Job->Next = *Head;
+  Job->Prev = Head;
+  if (*Head != NULL) (*Head)->Prev = &Job->Next;
+  *Head = Job;
 
-  return 0;
+  return;
 }
 
 
@@ -1075,89 +4169,48 @@ UINT8 ntp_init(struct struct_ntp *StructNTP)
 
 
 /* $PAGE */
-/* $TITLE=ntp_recv() */
+/* $TITLE=ntp_wheel_next() */
 /* ============================================================================================================================================================= *\
-                                                                         NTP data received.
+                                Return the first UTC time (in seconds since 01-JAN-1970) after the one given when a job must run.
+                  NOTE: Computed only when the job is registered or has just run, by ntp_dst_next() (see ntp-dst.c). Time zone settings are taken
+                        from the NTP structure each time: DST changes are computed again when they have been modified.
 \* ============================================================================================================================================================= */
-static void ntp_recv(void *ExtraArgument, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *IPAddress, u16_t port)
+static INT64 ntp_wheel_next(struct ntp_wheel *Wheel, struct ntp_job *Job, INT64 UTCTime)
 {
-#ifdef RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
-#else   // RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
-#endif  // RELEASE_VERSION
-
-  UINT8 Mode;
-  UINT8 SecondBuffer[4] = {0};
-  UINT8 Stratum;
-
-  UINT64 SecondsSince1900;
-  UINT64 SecondsSince1970;
-
-  time_t UnixTime;
-
+  struct struct_ntp *StructNTP;
 
-  struct struct_ntp *StructNTP = ExtraArgument;
- 
-  StructNTP->Receive = time_us_32();
 
-  if (FlagLocalDebug)
+  StructNTP = Wheel->StructNTP;
+  if ((Wheel->Zone.Country != StructNTP->DSTCountry) || (Wheel->Zone.DeltaTime != StructNTP->DeltaTime) || (Wheel->Zone.ShiftMinutes != StructNTP->ShiftMinutes))
   {
-    log_info(__LINE__, __func__, "Entering ntp_recv()\r");
-    log_info(__LINE__, __func__, "ExtraArgument:                 0x%p\r",         ExtraArgument);
-    log_info(__LINE__, __func__, "pcb pointer:                   0x%p\r",         pcb);
-    log_info(__LINE__, __func__, "Mode:                                  %2u\r", (pbuf_get_at(p, 0) & 0x7));
-    log_info(__LINE__, __func__, "Stratum:                               %2u\r", (pbuf_get_at(p, 1)));
-    log_info(__LINE__, __func__, "NTP pool IP address:      %15s\r",              ip4addr_ntoa(IPAddress));
-    log_info(__LINE__, __func__, "NTP server IP address:    %15s\r",              ip4addr_ntoa(&StructNTP->ServerAddress));
-    log_info(__LINE__, __func__, "IP address compare:                    %2u\r", (ip_addr_cmp(IPAddress, &StructNTP->ServerAddress)));
-    log_info(__LINE__, __func__, "Port:       %3u        NTP_PORT:      %3u\r",   port, NTP_PORT);
-    log_info(__LINE__, __func__, "p->tot_len: %3u        NTP_MSG_LEN:   %3u\r",   p->tot_len, NTP_MSG_LEN);
+    Wheel->Zone.Country      = StructNTP->DSTCountry;
+    Wheel->Zone.DeltaTime    = StructNTP->DeltaTime;
+    Wheel->Zone.ShiftMinutes = StructNTP->ShiftMinutes;
+    Wheel->Zone.Year         = 0;
   }
 
+  return ntp_dst_next(&Wheel->Zone, Job->Type, Job->Day, Job->Hour, Job->Minute, Job->Second, UTCTime);
+}
 
-  /* Initializations. */
-  SecondsSince1900 = 0ll;
-  SecondsSince1970 = 0ll;
-
-
-  Mode     = pbuf_get_at(p, 0) & 0x7;
-  Stratum  = pbuf_get_at(p, 1);
 
 
-  /* Check the result. */
-  if (ip_addr_cmp(IPAddress, &StructNTP->ServerAddress) && (port == NTP_PORT) && (p->tot_len == NTP_MSG_LEN) && (Mode == 0x04) && (Stratum != 0))
-  /// if (!ip_addr_cmp(IPAddress, &StructNTP->ServerAddress) && (port == NTP_PORT) && (p->tot_len == NTP_MSG_LEN) && (Mode == 0x04) && (Stratum != 0))
-  {
-    pbuf_copy_partial(p, SecondBuffer, sizeof(SecondBuffer), 40);
-    /// StructNTP->Latency = absolute_time_diff_us(StructNTP->Send, StructNTP->Receive);
-    StructNTP->Latency = StructNTP->Receive - StructNTP->Send;
-    SecondsSince1900   = ((UINT64)SecondBuffer[0] << 24) | ((UINT64)SecondBuffer[1] << 16) | ((UINT64)SecondBuffer[2] << 8) | ((UINT64)SecondBuffer[3]);
-    SecondsSince1970   = SecondsSince1900 - NTP_DELTA;
-    UnixTime           = SecondsSince1970;
 
-    if (FlagLocalDebug)
-    {
-      log_info(__LINE__, __func__, "Stratum:                                %u\r",                     Stratum);
-      log_info(__LINE__, __func__, "Send timer:                    %10lu\r",                           StructNTP->Send);
-      log_info(__LINE__, __func__, "Receive timer:                 %10lu\r",                           StructNTP->Receive);
-      log_info(__LINE__, __func__, "Latency (round-trip):          %10ld msec  (one-way: %ld msec)\r", StructNTP->Latency, (StructNTP->Latency / 2));
-      log_info(__LINE__, __func__, "Seconds since 1970:          %12llu\r",                            SecondsSince1970);
-      // log_info(__LINE__, __func__, "Seconds between 1900 and 1970: %10lu\r",                          (UINT32)NTP_DELTA);
-      // log_info(__LINE__, __func__, "Seconds since 1900:          %12llu\r",                            SecondsSince1900);
-    }
 
-    ntp_result(0, &UnixTime, StructNTP);
-    /// printf("[%5u] - 10\r", __LINE__);
-  }
-  else
-  {
-    if (FlagLocalDebug) log_info(__LINE__, __func__, "Invalid ntp response\r");
-    ntp_result(-1, NULL, StructNTP);
-  }
+/* $PAGE */
+/* $TITLE=ntp_wheel_remove() */
+/* ============================================================================================================================================================= *\
+                                                            Remove a job from a calendar timer wheel.
+                         NOTE: Constant time. May be called from a job callback, including for the job being run.
+\* ============================================================================================================================================================= */
+void ntp_wheel_remove(struct ntp_wheel *Wheel, struct ntp_job *Job)
+{
+  if (Job->Prev == NULL) return;
 
-  /// printf("[%5u] - 11\r", __LINE__);
-  pbuf_free(p);
+  *Job->Prev = Job->Next;
+  if (Job->Next != NULL) Job->Next->Prev = Job->Prev;
+  Job->Next = NULL;
+  Job->Prev = NULL;
+  --Wheel->JobCount;
 
   return;
 }
@@ -1165,40 +4218,44 @@ static void ntp_recv(void *ExtraArgument, struct udp_pcb *pcb, struct pbuf *p, c
 
 
 
+
 /* $PAGE */
-/* $TITLE=ntp_request() */
+/* $TITLE=ntp_wheel_restart() */
 /* ============================================================================================================================================================= *\
-                                                                         Make an NTP request.
+                            Schedule all jobs of a calendar timer wheel again from the UTC time given (in seconds since 01-JAN-1970).
+                         NOTE: Used after a large forward jump of the clock (first sync): occurrences missed meanwhile are skipped.
 \* ============================================================================================================================================================= */
-static void ntp_request(struct struct_ntp *StructNTP)
+static void ntp_wheel_restart(struct ntp_wheel *Wheel, INT64 UTCTime)
 {
-#ifdef RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
-#else   // RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
-#endif  // RELEASE_VERSION
-
+  UINT8 Level;
+  UINT8 Slot;
 
-  if (FlagLocalDebug)
-    log_info(__LINE__, __func__, "Entering ntp_request()\r");
+  struct ntp_job *Job;
+  struct ntp_job *List;
 
-  log_info(__LINE__, __func__, "NTP pool IP address:      %15s\r", ip4addr_ntoa(&StructNTP->ServerAddress));
 
+  /* Empty the wheel, keeping all jobs in a temporary list. */
+  List = NULL;
+  for (Level = 0; Level < NTP_WHEEL_LEVELS; ++Level)
+  {
+    for (Slot = 0; Slot < NTP_WHEEL_SLOTS; ++Slot)
+    {
+      while ((Job = Wheel->Slot[Level][Slot]) != NULL)
+      {
+        Wheel->Slot[Level][Slot] = Job->Next;
+        Job->Next = List;
+        List      = Job;
+      }
+    }
+  }
 
-  /* NOTE: cyw43_arch_lwip_begin() / cyw43_arch_lwip_end() should be used around calls into LwIP to ensure correct locking.
-           You can omit them if you are in a callback from LwIP. Note that when using pico_cyw_arch_poll library these calls
-           are a no-op and can be omitted, but it is a good practice to use them in case you switch the cyw43_arch type later. */
-  cyw43_arch_lwip_begin();
+  Wheel->Now = UTCTime;
+  while ((Job = List) != NULL)
   {
-    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, NTP_MSG_LEN, PBUF_RAM);
-    uint8_t *req = (uint8_t *)p->payload;
-    memset(req, 0, NTP_MSG_LEN);
-    req[0] = 0x1B;
-    udp_sendto(StructNTP->Pcb, p, &StructNTP->ServerAddress, NTP_PORT);
-    StructNTP->Send = time_us_32();
-    pbuf_free(p);
+    List          = Job->Next;
+    Job->FireTime = ntp_wheel_next(Wheel, Job, UTCTime);
+    ntp_wheel_insert(Wheel, Job);
   }
-  cyw43_arch_lwip_end();
 
   return;
 }
@@ -1208,75 +4265,68 @@ static void ntp_request(struct struct_ntp *StructNTP)
 
 
 /* $PAGE */
-/* $TITLE=ntp_result() */
+/* $TITLE=ntp_wheel_tick() */
 /* ============================================================================================================================================================= *\
-                                                                  Called with results of operation.
+                                    Run the jobs of a calendar timer wheel that are due, according to the disciplined clock.
+                  NOTE: To be called at least once per second, for example from the main loop. Each second elapsed costs one slot of level 0
+                        and, once per turn, the cascade of one slot of the level above, whatever the number of jobs registered. Callbacks are
+                        called from this function; a job may remove itself or other jobs.
 \* ============================================================================================================================================================= */
-void ntp_result(INT16 ResultStatus, time_t *UnixTime, struct struct_ntp *StructNTP)
+void ntp_wheel_tick(struct ntp_wheel *Wheel)
 {
-#ifdef RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_OFF;  // must remain OFF all time.
-#else   // RELEASE_VERSION
-  UINT8 FlagLocalDebug = FLAG_ON;  // may be modified for debug purposes.
-#endif  // RELEASE_VERSION
+  UINT8 Level;
 
-  struct tm TempTime;
+  UINT16 Slot;
 
+  INT64 UTCTime;
 
-  if (!stdio_usb_connected()) FlagLocalDebug = FLAG_OFF;
+  struct ntp_job *Job;
+  struct ntp_job *List;
 
-  if (FlagLocalDebug) log_info(__LINE__, __func__, "Entering ntp_result()   ResultStatus: %3d\r", ResultStatus);
 
-  if ((ResultStatus == 0) && UnixTime)
-  {
-    if (FlagLocalDebug) log_info(__LINE__, __func__, "ResultStatus: %d    UnixTime: %12llu\r", ResultStatus, *UnixTime);
-    StructNTP->UTCTime     = *UnixTime;
-    StructNTP->FlagSuccess = FLAG_ON;
+  UTCTime = ntp_get_utc_us(Wheel->StructNTP) / 1000000ll;
+  if (UTCTime == 0) return;
 
-    /* Proceed with first conversion of UTC time to determine current year. */
-    ntp_convert_unix_time(StructNTP->UTCTime, &TempTime, StructNTP);
+  /* Clock set for the first time, or stepped forward by a large amount. */
+  if ((UTCTime - Wheel->Now) > NTP_WHEEL_CATCHUP)
+  {
+    ntp_wheel_restart(Wheel, UTCTime);
+    return;
+  }
 
-    /* Compute all DST parameters for current year. */
-    ntp_dst_settings(StructNTP);
+  while (Wheel->Now < UTCTime)
+  {
+    ++Wheel->Now;
 
-    /* Add DeltaTime to UTC time to get UTC equivalent of local time. */
-    StructNTP->LocalTime = *UnixTime + (StructNTP->DeltaTime * 60);
+    /* Find the highest level whose slot has just changed, then cascade its jobs (and those of the levels below) toward level 0. */
+    for (Level = 1; Level < NTP_WHEEL_LEVELS; ++Level)
+      if (Wheel->Now & ((1ll << (Level * NTP_WHEEL_BITS)) - 1)) break;
 
-    /* Determine current local time for winter time ("normal time") and then for current period of the year (summer time or winter time). */
-    if (FlagLocalDebug)
+    while (--Level > 0)
     {
-      log_info(__LINE__, __func__, "Unix time received from NTP server:                   %12llu\r",           StructNTP->UTCTime);
-      log_info(__LINE__, __func__, "Delta time in minutes: StructNTP->DeltaTime:              %8d minutes\r",  StructNTP->DeltaTime);
-      log_info(__LINE__, __func__, "Delta time in seconds: StructNTP->DeltaTime * 60:         %8d seconds\r", (StructNTP->DeltaTime * 60));
-      log_info(__LINE__, __func__, "Unix time after adding delta time:                    %12llu\r",          (StructNTP->UTCTime + (StructNTP->DeltaTime * 60)));
-      log_info(__LINE__, __func__, "Unix time after adjusting for DST period of the year: %12lld\r",           StructNTP->LocalTime + (StructNTP->FlagSummerTime * (StructNTP->ShiftMinutes * 60)));
+      /* Detach the whole slot first: a job beyond the range of the wheel goes back to the same slot. */
+      Slot = (Wheel->Now >> (Level * NTP_WHEEL_BITS)) & (NTP_WHEEL_SLOTS - 1);
+      List = Wheel->Slot[Level][Slot];
+      Wheel->Slot[Level][Slot] = NULL;
+      while ((Job = List) != NULL)
+      {
+        List = Job->Next;
+        ntp_wheel_insert(Wheel, Job);
+      }
     }
 
-    StructNTP->LocalTime += (StructNTP->FlagSummerTime * (StructNTP->ShiftMinutes * 60));
-
-    /* Convert UTC found to human time. */
-    ntp_convert_unix_time(StructNTP->LocalTime, &TempTime, StructNTP);
-  }
-  else
-  {
-    StructNTP->FlagSuccess = FLAG_OFF;
-    StructNTP->FlagHistory = FLAG_OFF;
-    StructNTP->UpdateTime  = make_timeout_time_ms(NTP_RETRY * 1000);
-  }
-
-  if (StructNTP->ResendAlarm > 0)
-  {
-    if (FlagLocalDebug) log_info(__LINE__, __func__, "Cancelling alarm (0x%X)\r", StructNTP->ResendAlarm);
-    cancel_alarm(StructNTP->ResendAlarm);  // removed for crash test only 
-    StructNTP->ResendAlarm = 0;
-  }
+    /* Run the jobs due this second. Each one is given its next fire time before its callback, so that the callback may remove it. */
+    Slot = Wheel->Now & (NTP_WHEEL_SLOTS - 1);
+    while ((Job = Wheel->Slot[0][Slot]) != NULL)
+    {
+      Wheel->Slot[0][Slot] = Job->Next;
+      if (Job->Next != NULL) Job->Next->Prev = &Wheel->Slot[0][Slot];
 
-  if (FlagLocalDebug)
-  {
-    log_info(__LINE__, __func__, "Resetting DNSRequestSent\r");
-    log_info(__LINE__, __func__, "======================================================================\r");
+      if (Job->FireTime <= Wheel->Now) Job->FireTime = ntp_wheel_next(Wheel, Job, Wheel->Now);
+      ntp_wheel_insert(Wheel, Job);
+      Job->Callback(Job);
+    }
   }
-  StructNTP->DNSRequestSent = false;
 
   return;
 }
@@ -10,8 +10,8 @@
    Adapted as an "add-on module" for many other projects
    St-Louys, Andre - January 2024
    astlouys@gmail.com
-   Revision 18-APR-2025
-   Version 4.00
+   Revision 18-OCT-2026
+   Version 4.10
 
    REVISION HISTORY:
    =================
@@ -21,12 +21,59 @@
    17-AUG-2024 3.00 - Streamlined as a "library" for many other projects.
                     - Create a main "struct_ntp" containing all data to be shared with parent program.
    31-JAN-2025 4.00 - Add integrated support for Daylight Saving Time for most countries of the world.
+   18-OCT-2026 4.10 - Add optional symmetric key authentication (MD5 / SHA-1 MAC) of NTP requests and replies.
+                    - Add disciplined clock and optional PPS input from a GPS receiver.
+                    - Add ntp_get_status() to report clock quality.
+                    - Add leap second handling (step or smear).
+                    - Use 64-bit NTP timestamps (ntp-timestamp.c) for offset and delay computations.
+                    - Handle Pico's real-time clock, programmed on a second boundary of the disciplined clock.
+                    - Add holdover clock interface (ntp-holdover.c) with a DS3231 driver (ntp-ds3231.c).
+                    - Add ntp_format() to format date and time from templates compiled by ntp_format_compile() (ntp-format.c).
+                    - Select language at run time (ntp_set_language()), add Czech, German, Italian and Spanish.
+                    - Remove year clamping from ntp_get_day_of_year().
+                    - DST rules and calendar computations moved to ntp-dst.c and checked on the host (ntp-dst-test.c): DST changes against
+                      the time zone database, day-of-week, day-of-year and days in the month against the C library for every day up to 2200.
+                      European Union changes are now at 01h00 UTC, New Zealand DST now ends at 03h00 summer time.
+                    - Parse NTP replies with a bounded, stateless parser (ntp-packet.c) and check their origin timestamp.
+                    - Add non-blocking binary event log (ntp-log.c) for interrupt handlers and lwIP callbacks.
+                    - Add optional time service on core 1 (ntp_core1_start()), core 0 reading the clock from a lock-free snapshot.
+                    - Optionally timestamp NTP requests and replies at the Wi-Fi chip (ntp_capture_init()).
+                    - Dual-stack IPv6 / IPv4: resolve both address families, race them and keep the one with the shortest round-trip delay.
+                    - Use NTP servers advertised by DHCP (option 42) first, NTP_SERVER pool being the fallback.
+                      Requires LWIP_DHCP_GET_NTP_SRV set to 1 in lwipopts.h (otherwise the pool is always used, reported by ntp_init()).
+                    - Optional broadcast / multicast client mode (ntp_broadcast_init()), one-way delay calibrated by a unicast exchange.
+                      Broadcasts must be authenticated (unless NTP_BROADCAST_NO_AUTH) and only the calibrated server is used.
+                    - Add ntp_schedule_at() to call a function at a UTC instant, re-mapped onto the Pico timer when the clock is updated.
+                    - Add a timer wheel of daily, weekly and monthly jobs keyed on local wall time, handling DST changes (ntp_wheel_init()).
+                    - Add observers notified of clock steps, clock slews, DST changes and sync losses through a bounded queue (ntp_observer_add()).
+                    - Optional temperature compensation of the crystal from the on-chip sensor (ntp_tempco_init(), model in ntp-tempco.c).
+                    - Add a frequency stability analyzer computing the Allan deviation of the crystal (ntp_adev_init(), ntp_get_stability()).
+                    - Optional trace of every exchange and clock input in a binary ring buffer (ntp-trace.c), replayed on the host by ntp-replay.c
+                      through the reply processing moved to ntp-sync.c.
+                    - Optional NTP interleaved mode (ntp_interleave_init()): offsets computed with the precise transmit timestamp of the server's
+                      previous reply (burst of 2 requests per read cycle), with transparent fallback to basic mode for servers that don't
+                      support it and for inconsistent interleaved replies.
+                    - Next occurrence of the jobs of the timer wheel (local wall time across DST changes) moved to ntp-dst.c (ntp_dst_next()).
+                    - Symmetric key authentication moved to ntp-auth.c (also used by the fuzzer, ntp-fuzz.c); the reason of a rejected MAC
+                      is logged with NTP_EVENT_AUTH.
 \* ============================================================================================================================================================= */
 
 #ifndef _NTP_MODULE_H
 #define _NTP_MODULE_H
 
 #include "baseline.h"
+#include "ntp-adev.h"
+#include "ntp-auth.h"
+#include "ntp-clock.h"
+#include "ntp-dst.h"
+#include "ntp-format.h"
+#include "ntp-holdover.h"
+#include "ntp-log.h"
+#include "ntp-packet.h"
+#include "ntp-sync.h"
+#include "ntp-tempco.h"
+#include "ntp-timestamp.h"
+#include "ntp-trace.h"
 #include "pico/cyw43_arch.h"
 #include "time.h"
 
@@ -46,28 +93,17 @@
                                                   End of Language definitions.
 \* --------------------------------------------------------------------------------------------------------------------------- */
 
-/* Select only one language. */
+/* Language selected at power-up (see ntp_set_language() to change it at run time). */
 #define FIRMWARE_LANGUAGE   FRENCH
 // #define FIRMWARE_LANGUAGE   ENGLISH
 
 
-#if FIRMWARE_LANGUAGE == ENGLISH
-#include "ntp-lang-english.h"
-#endif
-
-#if FIRMWARE_LANGUAGE == FRENCH
-#include "ntp-lang-french.h"
-#endif
-
-
 
 #define FLAG_POLL               0x02
 
 #define MAX_NTP_RETRIES            5   // number of times we try to get an answer from a NTP server.
 #define MAX_NTP_CHECKS            10   // number of times we wait and check to get an answer from the callback.
 
-#define NTP_DELTA         2208988800   // number of seconds between 01-JAN-1900 and 01-JAN-1970.
-#define NTP_MSG_LEN               48
 #define NTP_PORT                 123
 #define NTP_REFRESH             3600
 #define NTP_RESEND_TIME   (10 * 1000)
@@ -80,11 +116,145 @@
 
 
 /* --------------------------------------------------------------------------------------------------------------------------- *\
-                                              Date and time related definitions.
+                                   Dual-stack IPv6 / IPv4 NTP server addresses (both families are raced, the fastest one is kept).
+\* --------------------------------------------------------------------------------------------------------------------------- */
+#define NTP_FAMILY_V6              0   // IPv6 (selected when both families have the same round-trip delay).
+#define NTP_FAMILY_V4              1   // IPv4.
+#define NTP_FAMILIES               2   // number of address families.
+#define NTP_FAMILY_NONE         0xFF   // no address family.
+#define NTP_RACE_CYCLES            8   // read cycles using only the fastest family before both families are raced again.
+#define NTP_DHCP_RETRY             8   // read cycles using pool servers once all NTP servers advertised by DHCP failed (see dhcp_set_ntp_servers()).
+
+#if LWIP_IPV4 && LWIP_IPV6
+#define NTP_FAMILY_ALL          0x03   // address families raced (bit mask of NTP_FAMILY_xxx), depending on lwIP options.
+#elif LWIP_IPV6
+#define NTP_FAMILY_ALL          0x01
+#else   // LWIP_IPV4
+#define NTP_FAMILY_ALL          0x02
+#endif  // LWIP_IPV4 && LWIP_IPV6
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                  Broadcast / multicast NTP servers on the LAN (mode 5, see ntp_broadcast_init()).
+\* --------------------------------------------------------------------------------------------------------------------------- */
+#define NTP_BROADCAST_TIMEOUT  1024000000ull  // back to read cycles if no broadcast has been received for this period (in usec).
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                  Pulse-per-second (PPS) input from a GPS receiver to discipline the Pico's clock.
+\* --------------------------------------------------------------------------------------------------------------------------- */
+#define NTP_PPS_NONE             0xFF  // no PPS input configured.
+/* NTP_PPS_MAX_OFFSET (NTP offset that overrides a locked PPS) is defined in ntp-sync.h. */
+#define NTP_PPS_TIMEOUT       2000000  // PPS is considered lost if no edge has been received for this period (in usec).
+#define NTP_PPS_ERROR              10  // estimated error (in usec) of a PPS edge timestamp (GPS receiver and interrupt latency).
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                  External holdover clock (for example a DS3231) used when NTP is not available (see ntp-holdover.h).
+\* --------------------------------------------------------------------------------------------------------------------------- */
+#define NTP_HOLDOVER_ERROR      1000000      // error (in usec) assumed for a time read from the holdover clock.
+#define NTP_HOLDOVER_INTERVAL   21600000000ll  // interval (in usec) between two frequency measurements of the holdover clock (6 hours).
+#define NTP_HOLDOVER_FEED        7200000000ll  // NTP unreachable and no sample for this long (in usec, 2 hours): time read from the holdover clock is fed to the disciplined clock.
+#define NTP_HOLDOVER_WAKEUP           2000ull  // busy-wait (in usec) before the second boundary when writing the holdover clock.
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                            Pico's real-time clock (RTC) handled by the NTP module (see ntp_rtc_init()).
+\* --------------------------------------------------------------------------------------------------------------------------- */
+#define NTP_RTC_MAX_DRIFT      20000   // RTC is re-aligned after an NTP sync when it has drifted by more than this (in usec).
+#define NTP_RTC_TICK_GUARD       100   // RTC seconds may change up to this delay (in usec) after the Pico timer second boundary.
+#define NTP_RTC_INVALID   0xFFFFFFFF   // ntp_rtc_now() return value when the RTC has not been programmed yet.
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                             Functions called at a UTC instant (see ntp_schedule_at()).
 \* --------------------------------------------------------------------------------------------------------------------------- */
-#define H12  1  // time display mode is 12 hours.
-#define H24  2  // time display mode is 24 hours.
+#define NTP_SCHEDULE_MAX           8   // maximum number of events pending at the same time.
+#define NTP_SCHEDULE_NONE       0xFF   // ntp_schedule_at() return value when the event could not be scheduled.
+#define NTP_SCHEDULE_GUARD        20   // minimum delay (in usec) when arming an alarm for an instant already reached.
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                       Crystal temperature compensation (see ntp_tempco_init() and ntp-tempco.h).
+\* --------------------------------------------------------------------------------------------------------------------------- */
+#define NTP_TEMPCO_PERIOD   60000000ll   // interval between two temperature readings (in usec).
+#define NTP_TEMPCO_ADC_INPUT        4   // ADC input connected to the RP2040 on-chip temperature sensor.
+#define NTP_TEMPCO_ADC_SAMPLES     16   // number of ADC readings averaged for each temperature reading.
+#define NTP_TEMPCO_VREF       3300000   // ADC reference voltage (in uV).
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                        Frequency stability analyzer (see ntp_adev_init() and ntp-adev.h).
+\* --------------------------------------------------------------------------------------------------------------------------- */
+#define NTP_ADEV_MIN_POLL          16   // minimum interval (in seconds) between NTP requests while the analyzer runs on NTP replies.
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                    Notifications of clock and DST changes to observers (see ntp_observer_add()).
+\* --------------------------------------------------------------------------------------------------------------------------- */
+#define NTP_OBSERVER_MAX           8   // maximum number of observers registered at the same time.
+#define NTP_OBSERVER_NONE       0xFF   // ntp_observer_add() return value when no entry is free.
+#define NTP_NOTIFY_QUEUE          16   // maximum number of notifications waiting for ntp_observer_dispatch().
+#define NTP_NOTIFY_SLEW_MIN     1000   // minimum offset (in usec) to notify observers that the clock is slewing.
+#define NTP_NOTIFY_SYNC_AGE  ((NTP_REFRESH * NTP_SCAN_FACTOR) + NTP_REFRESH)  // sync is lost when no sample has disciplined the clock for a read cycle period plus a poll cycle (in seconds).
+#define NTP_NOTIFY_UNKNOWN      0xFF   // DST status not known yet (no sync so far).
+
+#define NTP_NOTIFY_STEP         0x01   // clock stepped: Value is the step (in usec).
+#define NTP_NOTIFY_SLEW         0x02   // clock slewing: Value is the offset (in usec) being slewed.
+#define NTP_NOTIFY_DST          0x04   // daylight saving time started (Value = FLAG_ON) or ended (Value = FLAG_OFF).
+#define NTP_NOTIFY_SYNC         0x08   // sync regained (Value = FLAG_ON) or lost (Value = FLAG_OFF).
+#define NTP_NOTIFY_ALL          0x0F
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                  Timer wheel of recurring jobs keyed on local wall time (see ntp_wheel_init()).
+\* --------------------------------------------------------------------------------------------------------------------------- */
+/* Job types (NTP_JOB_DAILY, NTP_JOB_WEEKLY and NTP_JOB_MONTHLY) are defined in ntp-dst.h. */
+#define NTP_WHEEL_LEVELS           4   // number of levels of the timer wheel (the wheel covers 2^24 seconds, about 194 days).
+#define NTP_WHEEL_BITS             6   // each level has 2^NTP_WHEEL_BITS slots.
+#define NTP_WHEEL_SLOTS           64
+#define NTP_WHEEL_CATCHUP       3600   // if the clock jumps forward by more than this (in seconds), occurrences missed are skipped.
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                       Optional time service running on Pico's second core (see ntp_core1_start()).
+\* --------------------------------------------------------------------------------------------------------------------------- */
+#define NTP_CORE1_ALARMS          16   // maximum number of alarms pending at the same time in the alarm pool of core 1.
+#define NTP_CORE1_PERIOD      100000   // maximum time (in usec) that core 1 waits for a command before checking if a read cycle is due.
+
+#define NTP_CORE1_SYNC             1   // command to core 1: start an NTP read cycle right away.
+#define NTP_CORE1_DST              2   // command to core 1: compute DST parameters again (after changing DSTCountry or DeltaTime).
+#define NTP_CORE1_INFO             3   // command to core 1: display NTP-related information.
+
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                                            Clock quality (see ntp_get_status()).
+\* --------------------------------------------------------------------------------------------------------------------------- */
+#define NTP_FREQ_TOLERANCE_PPM     15   // frequency tolerance used to grow the error bound between syncs (RFC 5905 PHI).
+#define NTP_UNKNOWN_ERROR  0xFFFFFFFF   // error bound and sync age when the clock has never been set.
+#define NTP_STRATUM_UNSYNC         16   // stratum reported when the clock only runs from the holdover clock (RFC 5905 "unsynchronized").
+
+/* Leap indicator values (NTP_LEAP_NONE, NTP_LEAP_INSERT, NTP_LEAP_DELETE and NTP_LEAP_ALARM) are defined in ntp-packet.h. */
+#define NTP_LEAP_STEP               0   // leap second handling: hold the clock during an inserted second, skip a deleted second.
+#define NTP_LEAP_SMEAR              1   // leap second handling: spread the leap second linearly over the 24 hours before it.
+#define NTP_LEAP_SMEAR_US  86400000000ll  // smear period (in usec).
 
+
+
+/* --------------------------------------------------------------------------------------------------------------------------- *\
+                                              Date and time related definitions.
+\* --------------------------------------------------------------------------------------------------------------------------- */
 #define SUN 0
 #define MON 1
 #define TUE 2
@@ -115,18 +285,95 @@
 
 
 
-/* Structure to contain time stamp under "human" format instead of "tm" standard. */
-struct human_time
+/* Clock quality, as returned by ntp_get_status(). */
+struct ntp_status
+{
+  UINT8  FlagValid;              // flag indicating that the clock has been set at least once.
+  UINT8  LeapIndicator;          // leap indicator of the last NTP reply (NTP_LEAP_xxx).
+  UINT8  Stratum;                // our stratum: 1 when disciplined by PPS, NTP server stratum + 1 otherwise, NTP_STRATUM_UNSYNC from holdover (0 if unknown).
+  UINT8  Source;                 // source of the last sample (NTP_SOURCE_xxx).
+  UINT32 MaxError;               // maximum error estimate (in usec), including the offset not slewed yet and growing with the time since the last sync.
+  UINT32 SyncAge;                // number of seconds since the last good sample.
+};
+
+
+/* Frequency stability of the crystal, as returned by ntp_get_stability(). */
+struct ntp_stability
+{
+  UINT8  FlagValid;              // flag indicating that the analyzer is running (see ntp_adev_init()).
+  UINT8  Source;                 // source of the samples analyzed (NTP_SOURCE_PPS or NTP_SOURCE_NETWORK).
+  UINT32 Samples;                // number of samples analyzed.
+  UINT32 Restarts;               // number of restarts of the analysis (gaps or phase jumps).
+  UINT32 Tau[NTP_ADEV_LEVELS];        // averaging times (in seconds).
+  UINT32 Deviation[NTP_ADEV_LEVELS];  // overlapping Allan deviation at each averaging time (in parts per trillion, 0 if not measured yet).
+  UINT32 Terms[NTP_ADEV_LEVELS];      // number of terms each deviation is computed from.
+  UINT8  Intercept;              // level of the minimum deviation (Allan intercept), NTP_ADEV_NONE if not known yet.
+  UINT32 OptimalPoll;            // best interval (in seconds) between two samples of the disciplined clock: Tau[Intercept] (0 if not known yet).
+  UINT8  FlagOpen;               // flag indicating that the deviation still decreases at the longest averaging time measured (OptimalPoll is a lower bound).
+  UINT8  FlagBadCrystal;         // flag indicating that the best stability of the crystal is worse than NTP_ADEV_BAD_PPB.
+};
+
+
+/* NTP server address and last exchange for one address family. */
+struct ntp_family
 {
-  UINT8 FlagDst;
-  UINT8 Hour;
-  UINT8 Minute;
-  UINT8 Second;
-  UINT8 DayOfWeek;
-  UINT8 DayOfMonth;
-  UINT8 Month;
-  UINT16 Year;
-  UINT16 DayOfYear;
+  struct struct_ntp *StructNTP;  // NTP structure the family belongs to (DNS callback argument is the family).
+  UINT8  Type;                   // NTP_FAMILY_V6 or NTP_FAMILY_V4.
+  UINT8  FlagPending;            // flag indicating that a DNS answer or an NTP reply is expected for this family.
+  ip_addr_t Address;             // NTP server address resolved for this family.
+  ntp_timestamp_t Origin;        // transmit timestamp of the last request, that the server must echo in its reply.
+  UINT64 Send;                   // Pico timer (in usec) when the last request has been sent.
+  INT32  Delay;                  // round-trip delay (in usec) of the last reply (-1 when no reply since the last race).
+  UINT32 Replies;                // number of valid replies received through this family.
+  UINT8  FlagPrevious;           // flag indicating that Previous holds the last valid exchange with the server at PreviousAddress.
+  UINT8  FlagInterleaved;        // flag indicating that the last request has been sent in interleaved mode.
+  UINT8  FlagBurst;              // flag indicating that the second request of a burst has been sent during this read cycle (interleaved mode).
+  struct ntp_burst Burst;        // first exchange of the burst, used in basic mode if the second one fails (see ntp_sync_burst_close()).
+  ip_addr_t PreviousAddress;     // server address of the previous exchange.
+  struct ntp_exchange Previous;  // last valid exchange, completed by the next reply in interleaved mode (see ntp_sync_interleaved()).
+  UINT32 Interleaved;            // number of valid replies received in interleaved mode through this family.
+};
+
+
+/* Function to be called at a UTC instant (see ntp_schedule_at()). */
+struct ntp_schedule
+{
+  struct struct_ntp *StructNTP;  // NTP structure the event belongs to (alarm callback argument is the event).
+  UINT8  FlagActive;             // flag indicating that the event is pending.
+  INT64  UTCTime;                // UTC time (in usec since 01-JAN-1970) when the event must fire.
+  UINT64 LocalTime;              // Pico timer value (in usec) the alarm is currently armed for.
+  alarm_id_t AlarmId;            // alarm armed for the event.
+  void (*Callback)(void *Argument);  // function called from the alarm interrupt.
+  void  *Argument;               // argument passed to Callback.
+};
+
+
+/* Notification queued for observers (see ntp_observer_dispatch()). */
+struct ntp_notification
+{
+  UINT8  Type;                   // NTP_NOTIFY_xxx.
+  INT64  Value;                  // step or offset (in usec), or new status (FLAG_ON / FLAG_OFF), depending on Type.
+  UINT64 LocalTime;              // Pico timer value (in usec) when the notification has been queued (or last merged).
+};
+
+
+/* Function notified of clock and DST changes (see ntp_observer_add()). */
+struct ntp_observer
+{
+  UINT8  Mask;                   // notifications wanted (NTP_NOTIFY_xxx bit mask, 0 = entry free).
+  void (*Callback)(struct struct_ntp *StructNTP, const struct ntp_notification *Notification, void *Argument);
+  void  *Argument;               // argument passed to Callback.
+};
+
+
+/* Copy of the disciplined clock published for the other core (see ntp_core1_start()). */
+struct ntp_snapshot
+{
+  volatile UINT32 Sequence;      // incremented before and after each update (odd while an update is in progress).
+  struct ntp_clock Clock;        // copy of the disciplined clock.
+  INT8   LeapPending;            // copy of the leap second parameters.
+  UINT8  LeapMode;
+  INT64  LeapTime;
 };
 
 
@@ -149,95 +396,250 @@ struct struct_ntp
 	UINT32 ReadCycles;
   UINT32 PollCycles;
   INT32  Latency;
+  UINT32 AuthKeyId;              // key ID used to authenticate NTP requests and replies (0 = no authentication).
+  UINT32 AuthErrors;             // cumulative number of replies rejected because of a missing or invalid MAC.
+  UINT32 AuthTime;               // time (in usec) required to compute the MAC of the last authenticated reply.
+  UINT32 PacketErrors;           // cumulative number of replies rejected because they are malformed or don't match our last request.
+  struct ntp_family Family[NTP_FAMILIES];  // server address and last exchange for each address family (NTP_FAMILY_xxx).
+  UINT8  FamilyPreferred;        // address family with the shortest round-trip delay, used between races.
+  UINT8  RaceCount;              // read cycles remaining before both address families are raced again.
+  UINT8  FlagSampled;            // flag indicating that a reply has already disciplined the clock during current read cycle.
+  UINT8  FlagDhcp;               // flag indicating that current read cycle uses an NTP server advertised by DHCP.
+  UINT8  DhcpIndex;              // NTP server advertised by DHCP to be used on next read cycle.
+  UINT8  DhcpRetry;              // read cycles remaining before NTP servers advertised by DHCP are tried again.
+  UINT8  DhcpSequence;           // DHCP advertisement the DhcpIndex refers to.
+  UINT8  FlagBroadcast;          // flag indicating that broadcasts from NTP servers on the LAN are used (see ntp_broadcast_init()).
+  ip_addr_t BroadcastServer;     // address of the broadcast server currently used.
+  INT32  BroadcastDelay;         // one-way delay (in usec) from the broadcast server, calibrated by a unicast exchange (-1 = not calibrated).
+  UINT64 BroadcastHeard;         // Pico timer (in usec) when the broadcast server has last been heard from (other servers are ignored until NTP_BROADCAST_TIMEOUT).
+  ntp_timestamp_t BroadcastTransmit;  // transmit timestamp of the last broadcast accepted from the broadcast server (older ones are replays).
+  UINT64 BroadcastLast;          // Pico timer (in usec) when the last broadcast has been used.
+  UINT32 BroadcastCount;         // number of broadcasts used to discipline the clock.
   bool   DNSRequestSent;
   alarm_id_t       ResendAlarm;
   absolute_time_t  UpdateTime;
   /// absolute_time_t  Send;
   /// absolute_time_t  Receive;
-  UINT32  Send;
-  UINT32  Receive;
+  UINT64  Send;                  // Pico timer (in usec) when the request answered by the last reply used has been sent.
+  UINT64  Receive;               // Pico timer (in usec) when last reply has been received.
+  UINT8  FlagCapture;            // flag indicating that Send and Receive are captured at the Wi-Fi chip (see ntp_capture_init()).
+  UINT8  FlagInterleave;         // flag indicating that requests are sent in interleaved mode when possible (see ntp_interleave_init()).
+  UINT8  FlagCaptureSend;        // address families (bit mask) whose next NTP request passed to the Wi-Fi chip must be timestamped.
+  volatile UINT64 CaptureWake;   // Pico timer (in usec) of the last CYW43 interrupt (data pending for the Pico).
+  UINT32 CaptureCount;           // number of replies timestamped by the CYW43 interrupt.
   ip_addr_t        ServerAddress;
   time_t           UTCTime;
   time_t           LocalTime;
   struct udp_pcb  *Pcb;
   struct human_time HumanTime;
+  struct ntp_clock  Clock;       // disciplined clock fed by NTP replies and by PPS edges.
+  UINT8  PpsGpio;                // GPIO used for PPS input (NTP_PPS_NONE if no PPS input).
+  UINT64 PpsLastEdge;            // Pico timer value (in usec) of the last valid PPS edge.
+  UINT32 PpsEdges;               // cumulative number of valid PPS edges.
+  UINT32 PpsRejects;             // cumulative number of PPS edges too far from a second boundary.
+  UINT8  LeapIndicator;          // leap indicator of the last NTP reply.
+  UINT8  Stratum;                // stratum of the NTP server of the last reply.
+  UINT32 RootDelay;              // round-trip delay (in usec) from the NTP server to its reference clock.
+  UINT32 RootDispersion;         // maximum error (in usec) of the NTP server relative to its reference clock.
+  UINT32 SyncError;              // maximum error (in usec) of the clock right after the last NTP reply.
+  UINT8  LeapMode;               // leap second handling (NTP_LEAP_STEP or NTP_LEAP_SMEAR) - to be set before calling ntp_init().
+  INT8   LeapPending;            // +1 when a leap second will be inserted, -1 when one will be deleted, 0 otherwise.
+  INT64  LeapTime;               // UTC time (in usec since 01-JAN-1970) of the end of the day where leap second occurs.
+  alarm_id_t LeapAlarm;          // alarm set to complete leap second processing.
+  UINT32 LeapCount;              // number of leap seconds processed since ntp_init().
+  struct ntp_holdover *Holdover; // external holdover clock (NULL if none, see ntp_holdover_init()).
+  UINT8  FlagHoldoverCheck;      // flag indicating that a good sync has been done since the last holdover clock check.
+  UINT64 HoldoverWrite;          // Pico timer (in usec) when the holdover clock has been written (0 if not since power-up).
+  INT64  HoldoverOffset;         // last offset (in usec) of the holdover clock relative to the disciplined clock.
+  INT32  HoldoverDriftPpb;       // last frequency error (in ppb) measured on the holdover clock (positive when it runs fast).
+  UINT32 HoldoverErrors;         // cumulative number of holdover clock read or write errors.
+  UINT8  FlagRtc;                // flag indicating that Pico's RTC is handled by the NTP module (see ntp_rtc_init()).
+  UINT8  FlagRtcSet;             // flag indicating that Pico's RTC has been programmed at least once.
+  alarm_id_t RtcAlarm;           // alarm set on the next second boundary to program the RTC.
+  UINT64 RtcBase;                // Pico timer (in usec) when the RTC has been programmed (beginning of an RTC second).
+  time_t RtcBaseTime;            // local time (in seconds since 01-JAN-1970) programmed in the RTC at RtcBase.
+  INT32  RtcDrift;               // drift (in usec) of the RTC relative to the disciplined clock, measured at the last NTP sync.
+  UINT32 RtcAlignCount;          // number of times the RTC has been programmed.
+  alarm_pool_t *AlarmPool;       // alarm pool used for module alarms (served by the core running the time service).
+  UINT8  FlagCore1;              // flag indicating that the time service runs on core 1 (see ntp_core1_start()).
+  UINT32 Core1Commands;          // number of commands received by core 1.
+  struct ntp_snapshot Snapshot;  // disciplined clock published after each update, for readers on the other core.
+  struct ntp_schedule Schedule[NTP_SCHEDULE_MAX];  // functions to be called at a UTC instant (see ntp_schedule_at()).
+  UINT32 ScheduleFired;          // number of scheduled events fired.
+  UINT32 ScheduleRemaps;         // number of times a pending event has been re-mapped after a clock update.
+  INT32  ScheduleLatency;        // delay (in usec) between the instant and the alarm handler, for the last event fired.
+  struct ntp_observer Observer[NTP_OBSERVER_MAX];  // functions notified of clock and DST changes (see ntp_observer_add()).
+  struct ntp_notification NotifyQueue[NTP_NOTIFY_QUEUE];  // notifications waiting for ntp_observer_dispatch().
+  UINT8  NotifyHead;             // oldest notification in NotifyQueue.
+  UINT8  NotifyCount;            // number of notifications in NotifyQueue.
+  UINT32 NotifyLost;             // number of notifications lost because the queue was full.
+  UINT32 NotifySamples;          // clock samples already checked for steps and slews.
+  UINT32 NotifySteps;            // clock steps already notified.
+  UINT8  NotifyDst;              // DST status already notified (NTP_NOTIFY_UNKNOWN before first sync).
+  UINT8  FlagNotifySync;         // sync status already notified.
+  UINT8  FlagTempco;             // flag indicating that the crystal is compensated for temperature (see ntp_tempco_init()).
+  struct ntp_tempco Tempco;      // temperature model of the crystal, trained with each sample of the disciplined clock.
+  UINT64 TempcoNext;             // Pico timer (in usec) when the temperature sensor is due to be read again (see ntp_tempco_update()).
+  INT32  TempcoPpb;              // total frequency correction (in ppb) fed forward since ntp_tempco_init().
+  struct ntp_adev *Adev;         // frequency stability analyzer (NULL if none, see ntp_adev_init()).
+  UINT32 AdevPoll;               // interval (in seconds) between NTP requests while the analyzer runs on NTP replies (0 = normal NTP cycles).
 };
 
 
-#if 0
-struct dst_parameters
+/* Recurring job of a calendar timer wheel (storage provided by the caller, see ntp_wheel_add()). */
+struct ntp_job
 {
-  UINT8  StartMonth;
-  UINT8  StartDayOfWeek;
-  int8_t StartDayOfMonthLow;
-  int8_t StartDayOfMonthHigh;
-  UINT8  StartHour;
-  UINT16 StartDayOfYear;
-  UINT8  EndMonth;
-  UINT8  EndDayOfWeek;
-  int8_t EndDayOfMonthLow;
-  int8_t EndDayOfMonthHigh;
-  UINT8  EndHour;
-  UINT16 EndDayOfYear;
-  UINT8  ShiftMinutes;
-}DstParameters[25];
-
-struct dst_parameters DstParameters[25] =
+  struct ntp_job  *Next;         // next job in the same slot of the wheel.
+  struct ntp_job **Prev;         // link pointing to this job (NULL when the job is not registered).
+  INT64  FireTime;               // next UTC time (in seconds since 01-JAN-1970) when the job must run.
+  UINT8  Type;                   // NTP_JOB_DAILY, NTP_JOB_WEEKLY or NTP_JOB_MONTHLY.
+  UINT8  Day;                    // day-of-week (weekly job) or day-of-month (monthly job).
+  UINT8  Hour;                   // local wall time when the job must run.
+  UINT8  Minute;
+  UINT8  Second;
+  void (*Callback)(struct ntp_job *Job);  // function called from ntp_wheel_tick().
+  void  *Argument;               // free for the caller.
+};
+
+
+/* Hierarchical timer wheel of calendar jobs, slots being UTC seconds (see ntp_wheel_init()). */
+struct ntp_wheel
 {
-  { 0,  0,  0,  0, 24,  0,  0,  0,  0,  0,  0,  0, 60},  //  0 - Dummy
-  {10,  0,  1,  7,  2,  0,  4,  0,  1,  7,  3,  0, 60},  //  1 - Australia
-  {10,  0,  1,  7,  2,  0,  4,  0,  1,  7,  2,  0, 30},  //  2 - Australia-Howe
-  { 9,  6,  1,  7, 24,  0,  4,  6,  1,  7, 24,  0, 60},  //  3 - Chile           (StartHour and EndHour changes at 24h00, will change at 00h00 the day after)
-  { 3,  0,  8, 14,  0,  0, 11,  0,  1,  7,  1,  0, 60},  //  4 - Cuba
-  { 3,  0, 25, 31,  1,  0, 10,  0, 25, 31,  1,  0, 60},  //  5 - European Union  (StartHour and EndHour are based on UTC time)
-  { 3,  5, 23, 29,  2,  0, 10,  0, 25, 31,  2,  0, 60},  //  6 - Israel
-  { 3,  0, 25, 31,  0,  0, 10,  0, 25, 31,  0,  0, 60},  //  7 - Lebanon
-  { 3,  0, 25, 31,  2,  0, 10,  0, 25, 31,  3,  0, 60},  //  8 - Moldova
-  { 9,  0, 24, 30,  2,  0,  4,  0,  1,  7,  2,  0, 60},  //  9 - New-Zealand     (StartHour and EndHour are based on UTC time)
-  { 3,  0,  8, 14,  2,  0, 11,  0,  1,  7,  2,  0, 60},  // 10 - North America
-  { 3,  6, 24, 30,  2,  0, 10,  6, 24, 30,  2,  0, 60},  // 11 - Palestine
-  {10,  0,  1,  7,  0,  0,  3,  0, 22, 28,  0,  0, 60},  // 12 - Paraguay
+  struct struct_ntp *StructNTP;  // NTP structure giving current time, time zone and daylight saving time rules.
+  INT64  Now;                    // last UTC second (since 01-JAN-1970) processed by ntp_wheel_tick().
+  struct ntp_job *Slot[NTP_WHEEL_LEVELS][NTP_WHEEL_SLOTS];
+  UINT32 JobCount;               // number of jobs registered.
+  struct ntp_dst_zone Zone;      // time zone settings and DST changes used by ntp_dst_next() (see ntp-dst.h).
 };
-#endif  // 0
-#define MAX_DST_COUNTRIES 12
 
 
-/* Convert "HumanTime" to "tm_time". */
-void ntp_convert_human_to_tm(struct human_time *HumanTime, struct tm *TmTime);
+/* Start (or stop) the frequency stability analyzer of the crystal. */
+UINT8 ntp_adev_init(struct struct_ntp *StructNTP, struct ntp_adev *Adev, UINT32 Interval);
 
-/* Convert "HumanTime" to "Unix Time". */
-UINT64 ntp_convert_human_to_unix(struct human_time *HumanTime);
+/* Listen to NTP servers broadcasting or multicasting time on the LAN. */
+UINT8 ntp_broadcast_init(struct struct_ntp *StructNTP);
 
-/* Convert "TmTime" to "Unix Time". */
-UINT64 ntp_convert_tm_to_unix(struct tm *TmTime);
+/* Capture request and reply timestamps at the Wi-Fi chip. */
+UINT8 ntp_capture_init(struct struct_ntp *StructNTP);
 
 /* Convert Unix time to tm time and human time. */
 void ntp_convert_unix_time(time_t UnixTime, struct tm *TmTime, struct struct_ntp *StructNTP);
 
+/* Send a command (NTP_CORE1_xxx) to the time service running on core 1. */
+UINT8 ntp_core1_command(UINT32 Command);
+
+/* Run the time service on core 1. */
+UINT8 ntp_core1_start(struct struct_ntp *StructNTP, void (*Setup)(struct struct_ntp *StructNTP));
+
 /* Display NTP-related information. */
 void ntp_display_info(struct struct_ntp *StructNTP);
 
 /* Set parameters required for Daily Saving Time automatic handling. */
 void ntp_dst_settings(struct struct_ntp *StructNTP);
 
-/* Return the day-of-week for the specified date. Sunday =  (...) Saturday =  */
-UINT8 ntp_get_day_of_week(UINT8 DayOfMonth, UINT8 Month, UINT16 Year);
+/* Format a human time in a string, according to a template compiled by ntp_format_compile(). */
+UINT16 ntp_format(UCHAR *Buffer, UINT16 BufferSize, const struct ntp_format *Format, const struct human_time *HumanTime);
+
+/* Select hour display mode (H12 or H24) used by the %K specification of ntp_format(). */
+void ntp_format_set_hour_mode(UINT8 HourMode);
+
+/* Return the name of the day of week specified (Sunday = 0) in current language. */
+const UCHAR *ntp_get_day_name(UINT8 DayOfWeek);
+
+/* Return the language currently used for day and month names. */
+UINT8 ntp_get_language(void);
+
+/* Return the name of the month specified (January = 1) in current language. */
+const UCHAR *ntp_get_month_name(UINT8 Month);
+
+/* Return the short (3-letter) name of the day of week specified (Sunday = 0) in current language. */
+const UCHAR *ntp_get_short_day(UINT8 DayOfWeek);
 
-/* Determine the day-of-year of date given in argument. */
-UINT16 ntp_get_day_of_year(UINT8 DayOfMonth, UINT8 Month, UINT16 Year);
+/* Return the short (3-letter) name of the month specified (January = 1) in current language. */
+const UCHAR *ntp_get_short_month(UINT8 Month);
 
-/* Return the number of days of a specific month, given the specified year (to know if it is a leap year or not). */
-UINT8 ntp_get_month_days(UINT8 MonthNumber, UINT16 TargetYear);
+/* Return the frequency stability of the crystal measured by the analyzer. */
+void ntp_get_stability(struct struct_ntp *StructNTP, struct ntp_stability *Stability);
+
+/* Return clock quality: error bound, leap indicator, stratum and time since last sync. */
+void ntp_get_status(struct struct_ntp *StructNTP, struct ntp_status *Status);
 
 /* Retrieve current utc time from NTP server. */
 void ntp_get_time(struct struct_ntp *StructNTP);
 
+/* Return current time of the disciplined clock as an NTP timestamp. */
+ntp_timestamp_t ntp_get_timestamp(struct struct_ntp *StructNTP);
+
+/* Return current UTC time (in usec since 01-JAN-1970) from the disciplined clock. Only slews are monotonic: clock steps (offset larger than
+   NTP_CLOCK_STEP_US) and leap second steps may move it backward, and are reported to the observers of NTP_NOTIFY_STEP. */
+INT64 ntp_get_utc_us(struct struct_ntp *StructNTP);
+
+/* Use an external clock (see ntp-holdover.h) as holdover source and read time from it. */
+UINT8 ntp_holdover_init(struct struct_ntp *StructNTP, struct ntp_holdover *Holdover);
+
+/* Measure the frequency error of the holdover clock against NTP, trim it and write current time to it. */
+void ntp_holdover_update(struct struct_ntp *StructNTP);
+
 /* Initialize variables require for NTP connection. */
 UINT8 ntp_init(struct struct_ntp *StructNTP);
 
+/* Request the precise transmit timestamps of NTP servers supporting interleaved mode. */
+UINT8 ntp_interleave_init(struct struct_ntp *StructNTP);
+
+/* Register a function to be notified of clock steps, clock slews, DST changes and sync losses. */
+UINT8 ntp_observer_add(struct struct_ntp *StructNTP, UINT8 Mask, void (*Callback)(struct struct_ntp *StructNTP, const struct ntp_notification *Notification, void *Argument), void *Argument);
+
+/* Deliver pending notifications to the observers registered. */
+UINT16 ntp_observer_dispatch(struct struct_ntp *StructNTP);
+
+/* Remove an observer registered by ntp_observer_add(). */
+UINT8 ntp_observer_remove(struct struct_ntp *StructNTP, UINT8 Observer);
+
+/* Process a PPS edge captured at the specified Pico timer value. */
+void ntp_pps_edge(struct struct_ntp *StructNTP, UINT64 EdgeTime);
+
+/* Enable PPS input on the specified GPIO. */
+void ntp_pps_init(struct struct_ntp *StructNTP, UINT8 Gpio);
+
+/* Return FLAG_ON if PPS edges are currently received. */
+UINT8 ntp_pps_locked(struct struct_ntp *StructNTP);
+
 /* Called with results of operation. */
 void ntp_result(INT16 ResultStatus, time_t *UnixTime, struct struct_ntp *StructNTP);
 
+/* Let the NTP module handle Pico's real-time clock (local time). */
+void ntp_rtc_init(struct struct_ntp *StructNTP);
+
+/* Read Pico's real-time clock and return the number of usec elapsed since the beginning of current second. */
+UINT32 ntp_rtc_now(struct struct_ntp *StructNTP, datetime_t *DateTime);
+
+/* Call a function at a UTC instant (in nsec since 01-JAN-1970), as seen by the disciplined clock. */
+UINT8 ntp_schedule_at(struct struct_ntp *StructNTP, INT64 UTCTime, void (*Callback)(void *Argument), void *Argument);
+
+/* Cancel an event scheduled by ntp_schedule_at(). */
+UINT8 ntp_schedule_cancel(struct struct_ntp *StructNTP, UINT8 Event);
+
+/* Select the language used for day and month names. */
+UINT8 ntp_set_language(UINT8 Language);
+
+/* Compensate the frequency error of the crystal for temperature, using the RP2040 on-chip temperature sensor. */
+UINT8 ntp_tempco_init(struct struct_ntp *StructNTP);
+
+/* Convert an NTP timestamp to the corresponding Pico absolute time, using the disciplined clock. */
+absolute_time_t ntp_ts_to_absolute_time(struct struct_ntp *StructNTP, ntp_timestamp_t Timestamp);
+
+/* Register a recurring job at a local wall time (daily, weekly or monthly) in a calendar timer wheel. */
+UINT8 ntp_wheel_add(struct ntp_wheel *Wheel, struct ntp_job *Job, UINT8 Type, UINT8 Day, UINT8 Hour, UINT8 Minute, UINT8 Second, void (*Callback)(struct ntp_job *Job), void *Argument);
+
+/* Initialize a calendar timer wheel, jobs being keyed on local wall time. */
+void ntp_wheel_init(struct struct_ntp *StructNTP, struct ntp_wheel *Wheel);
+
+/* Remove a job from a calendar timer wheel. */
+void ntp_wheel_remove(struct ntp_wheel *Wheel, struct ntp_job *Job);
+
+/* Run the jobs of a calendar timer wheel that are due, according to the disciplined clock. */
+void ntp_wheel_tick(struct ntp_wheel *Wheel);
+
 /* Send a string to external monitor through Pico UART (or USB CDC). */
 extern void log_info(UINT LineNumber, const UCHAR *FunctionName, UCHAR *Format, ...);
 
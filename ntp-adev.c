@@ -0,0 +1,243 @@
+/* ============================================================================================================================================================= *\
+   ntp-adev.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Frequency stability analyzer used by Pico-NTP-Module (see ntp-adev.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include <math.h>
+#include <string.h>
+
+#include "ntp-adev.h"
+
+
+#define NTP_ADEV_MAX_PPM         500   // frequency error of the crystal tolerated between two samples before a phase jump is detected.
+
+
+
+/* Add a phase point to a decimation stage, update its Allan sums and feed the next stage. */
+static void ntp_adev_push(struct ntp_adev *Adev, INT64 Phase);
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_adev_deviation() */
+/* ============================================================================================================================================================= *\
+                           Return the Allan deviation (in parts per trillion) at a level, and the number of terms it is computed from.
+                  NOTE: Overlapping estimator: sigma^2(tau) = sum((x[i + 2m] - 2 x[i + m] + x[i])^2) / (2 tau^2 (N - 2m)), x being the phase.
+\* ============================================================================================================================================================= */
+UINT32 ntp_adev_deviation(struct ntp_adev *Adev, UINT8 Level, UINT32 *Terms)
+{
+  double Deviation;
+
+
+  if (Terms != NULL) *Terms = 0l;
+  if ((Level >= NTP_ADEV_LEVELS) || (Adev->Level[Level].Terms == 0)) return 0l;
+  if (Terms != NULL) *Terms = Adev->Level[Level].Terms;
+
+  /* Phase is in nsec and tau in seconds: sigma x 10^12 = sqrt(Sum / (2 x Terms)) x 10^3 / tau. */
+  Deviation = (sqrt(Adev->Level[Level].Sum / (2.0 * Adev->Level[Level].Terms)) * 1000.0) / (double)ntp_adev_tau(Adev, Level);
+
+  return (Deviation > 4000000000.0) ? 4000000000ul : (UINT32)Deviation;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_adev_intercept() */
+/* ============================================================================================================================================================= *\
+                                   Return the level where the Allan deviation is minimal (Allan intercept), or NTP_ADEV_NONE.
+                    NOTE: Only levels with NTP_ADEV_MIN_TERMS terms are considered. When the minimum is the last level measured, the real
+                          intercept may be beyond it: the result improves as the analysis runs longer.
+\* ============================================================================================================================================================= */
+UINT8 ntp_adev_intercept(struct ntp_adev *Adev)
+{
+  UINT8 Intercept;
+  UINT8 Loop1UInt8;
+
+  UINT32 Deviation;
+  UINT32 Minimum;
+  UINT32 Terms;
+
+
+  Intercept = NTP_ADEV_NONE;
+  Minimum   = 0l;
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_ADEV_LEVELS; ++Loop1UInt8)
+  {
+    Deviation = ntp_adev_deviation(Adev, Loop1UInt8, &Terms);
+    if (Terms < NTP_ADEV_MIN_TERMS) continue;
+
+    if ((Intercept == NTP_ADEV_NONE) || (Deviation < Minimum))
+    {
+      Intercept = Loop1UInt8;
+      Minimum   = Deviation;
+    }
+  }
+
+  return Intercept;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_adev_push() */
+/* ============================================================================================================================================================= *\
+                                     Add a phase point to a decimation stage, update its Allan sums and feed the next stage.
+                 NOTE: Stage 0 computes levels 0 to NTP_ADEV_BITS (m = 1 to 2^NTP_ADEV_BITS points), stage s computes the following
+                       NTP_ADEV_BITS levels (m = 2 to 2^NTP_ADEV_BITS of its own points, each one being 2^(s x NTP_ADEV_BITS) grid points apart).
+                       The oldest point needed (x[n - 2m]) is read before the new one overwrites it in the ring.
+\* ============================================================================================================================================================= */
+static void ntp_adev_push(struct ntp_adev *Adev, INT64 Phase)
+{
+  UINT8 First;
+  UINT8 Level;
+  UINT8 Stage;
+
+  UINT32 Count;
+  UINT32 Point;
+
+  INT64 Difference;
+
+  struct ntp_adev_stage *Current;
+
+
+  for (Stage = 0; Stage < NTP_ADEV_STAGES; ++Stage)
+  {
+    Current = &Adev->Stage[Stage];
+    Point   = Current->Points;
+    First   = (Stage == 0) ? 0 : (Stage * NTP_ADEV_BITS) + 1;
+
+    for (Level = First; Level <= ((Stage + 1) * NTP_ADEV_BITS); ++Level)
+    {
+      Count = 1ul << (Level - (Stage * NTP_ADEV_BITS));
+      if (Point < (2 * Count)) break;
+
+      Difference = Phase - (2 * Current->Phase[(Point - Count) % NTP_ADEV_RING]) + Current->Phase[(Point - (2 * Count)) % NTP_ADEV_RING];
+      Adev->Level[Level].Sum += ((double)Difference * (double)Difference);
+      ++Adev->Level[Level].Terms;
+    }
+
+    Current->Phase[Point % NTP_ADEV_RING] = Phase;
+    ++Current->Points;
+
+    /* Only every 2^NTP_ADEV_BITS point goes to the next stage. */
+    if (Point % (1ul << NTP_ADEV_BITS)) break;
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_adev_reset() */
+/* ============================================================================================================================================================= *\
+                                    Initialize a stability analyzer for samples of one source at a grid period (in seconds).
+\* ============================================================================================================================================================= */
+void ntp_adev_reset(struct ntp_adev *Adev, UINT32 Interval, UINT8 Source)
+{
+  memset(Adev, 0x00, sizeof(struct ntp_adev));
+
+  Adev->Interval    = (Interval == 0) ? 1 : Interval;
+  Adev->Source      = Source;
+  Adev->FlagStarted = FLAG_OFF;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_adev_sample() */
+/* ============================================================================================================================================================= *\
+                         Feed a sample of the disciplined clock (Pico timer value and corresponding UTC time) to the stability analyzer.
+                   NOTE: The phase is the raw Pico timer against the reference, not the disciplined clock, so that clock steps and slews
+                         don't show in the analysis. Samples are not regular (NTP replies): the phase is linearly interpolated at each grid point.
+                         A gap of more than NTP_ADEV_MAX_GAP points or a phase jump restarts the rings, the Allan sums remaining valid.
+\* ============================================================================================================================================================= */
+void ntp_adev_sample(struct ntp_adev *Adev, UINT64 LocalTime, INT64 UTCTime)
+{
+  UINT8 Loop1UInt8;
+
+  INT64 Delta;
+  INT64 GridTime;
+  INT64 Jump;
+  INT64 Phase;
+  INT64 Time;
+
+
+  ++Adev->Samples;
+
+  if (Adev->FlagStarted)
+  {
+    Time  = UTCTime - Adev->StartUTC;
+    Phase = (((INT64)(LocalTime - Adev->StartLocal)) - Time) * 1000ll;
+    Delta = Time - Adev->LastTime;
+    if (Delta <= 0) return;
+
+    Jump = Phase - Adev->LastPhase;
+    if (Jump < 0) Jump = -Jump;
+
+    if ((Delta <= ((NTP_ADEV_MAX_GAP + 1) * (INT64)Adev->Interval * 1000000ll)) && (Jump <= (NTP_ADEV_MAX_JUMP + ((Delta * NTP_ADEV_MAX_PPM) / 1000ll))))
+    {
+      for (GridTime = Adev->NextPoint * (INT64)Adev->Interval * 1000000ll; GridTime <= Time; GridTime += (INT64)Adev->Interval * 1000000ll)
+      {
+        ntp_adev_push(Adev, Adev->LastPhase + (INT64)(((double)(Phase - Adev->LastPhase) * (double)(GridTime - Adev->LastTime)) / (double)Delta));
+        ++Adev->NextPoint;
+      }
+      Adev->LastTime  = Time;
+      Adev->LastPhase = Phase;
+
+      return;
+    }
+
+    ++Adev->Restarts;
+    for (Loop1UInt8 = 0; Loop1UInt8 < NTP_ADEV_STAGES; ++Loop1UInt8)
+      Adev->Stage[Loop1UInt8].Points = 0l;
+  }
+
+  /* First sample or restart: the grid starts on this sample. */
+  Adev->FlagStarted = FLAG_ON;
+  Adev->StartLocal  = LocalTime;
+  Adev->StartUTC    = UTCTime;
+  Adev->LastTime    = 0ll;
+  Adev->LastPhase   = 0ll;
+  Adev->NextPoint   = 1ll;
+  ntp_adev_push(Adev, 0ll);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_adev_tau() */
+/* ============================================================================================================================================================= *\
+                                                       Return the averaging time (in seconds) of a level.
+\* ============================================================================================================================================================= */
+UINT32 ntp_adev_tau(struct ntp_adev *Adev, UINT8 Level)
+{
+  return Adev->Interval << Level;
+}
+
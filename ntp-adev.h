@@ -0,0 +1,86 @@
+/* ============================================================================================================================================================= *\
+   ntp-adev.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.00
+
+   Frequency stability analyzer used by Pico-NTP-Module. The phase of the Pico's crystal against the reference (NTP replies or PPS edges)
+   is resampled on a regular grid of period tau0 and the overlapping Allan deviation is computed incrementally at octave-spaced
+   averaging times tau0, 2 x tau0, 4 x tau0, ... Memory is bounded: the first NTP_ADEV_BITS octaves are computed from a ring of the last
+   phase points, the following ones from the same ring size in each further stage, fed with every 2^NTP_ADEV_BITS point of the previous one.
+   The minimum of the curve (Allan intercept) is the averaging time beyond which the crystal wanders more than the reference jitters,
+   i.e. the best interval between two samples of the disciplined clock.
+   This file doesn't depend on the Pico SDK so that it may also be compiled on a host computer.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_ADEV_H
+#define _NTP_ADEV_H
+
+#include "baseline.h"
+
+
+#define NTP_ADEV_BITS              7   // octaves computed in each stage (each stage keeps 2^(NTP_ADEV_BITS + 1) phase points).
+#define NTP_ADEV_STAGES            2   // number of decimation stages.
+#define NTP_ADEV_RING            (2 << NTP_ADEV_BITS)                   // phase points kept by each stage.
+#define NTP_ADEV_LEVELS          ((NTP_ADEV_BITS * NTP_ADEV_STAGES) + 1)  // number of averaging times (tau0 to 2^(NTP_ADEV_LEVELS - 1) x tau0).
+#define NTP_ADEV_MAX_GAP           4   // phase points missing that are interpolated, larger gaps restart the analysis (Allan sums are kept).
+#define NTP_ADEV_MAX_JUMP  100000000ll // phase jump (in nsec) considered as a reference error (e.g. a leap second) that restarts the analysis.
+#define NTP_ADEV_MIN_TERMS        16   // terms required before the deviation at an averaging time is used.
+#define NTP_ADEV_BAD_PPB        1000   // crystal flagged as bad when even its best stability is worse than this (in ppb).
+#define NTP_ADEV_NONE           0xFF   // no level measured yet (see ntp_adev_intercept()).
+
+
+/* Allan sum at one averaging time. */
+struct ntp_adev_level
+{
+  double Sum;                    // sum of the squared second differences of phase (in nsec^2).
+  UINT32 Terms;                  // number of terms in Sum.
+};
+
+
+/* Phase points at one decimation stage. */
+struct ntp_adev_stage
+{
+  INT64  Phase[NTP_ADEV_RING];   // last phase points (in nsec), Phase[Points % NTP_ADEV_RING] being the next one.
+  UINT32 Points;                 // number of phase points received since the last restart.
+};
+
+
+struct ntp_adev
+{
+  UINT32 Interval;               // tau0: interval between two phase points (in seconds).
+  UINT8  Source;                 // source of the samples analyzed (NTP_SOURCE_xxx, see ntp-clock.h), others are ignored.
+  UINT8  FlagStarted;            // flag indicating that a first sample has been received.
+  UINT64 StartLocal;             // Pico timer (in usec) of the first sample.
+  INT64  StartUTC;               // UTC time (in usec since 01-JAN-1970) of the first sample.
+  INT64  LastTime;               // time of the last sample (in usec since StartUTC).
+  INT64  LastPhase;              // phase of the last sample (in nsec): Pico timer elapsed minus UTC time elapsed since the first sample.
+  INT64  NextPoint;              // index of the next grid point (grid point n is at n x Interval seconds since StartUTC).
+  UINT32 Samples;                // number of samples received.
+  UINT32 Restarts;               // number of restarts (gaps or phase jumps).
+  struct ntp_adev_stage Stage[NTP_ADEV_STAGES];
+  struct ntp_adev_level Level[NTP_ADEV_LEVELS];
+};
+
+
+/* Return the Allan deviation (in parts per trillion) at a level, and the number of terms it is computed from. */
+UINT32 ntp_adev_deviation(struct ntp_adev *Adev, UINT8 Level, UINT32 *Terms);
+
+/* Return the level where the Allan deviation is minimal (Allan intercept), or NTP_ADEV_NONE. */
+UINT8 ntp_adev_intercept(struct ntp_adev *Adev);
+
+/* Initialize a stability analyzer for samples of one source at a grid period (in seconds). */
+void ntp_adev_reset(struct ntp_adev *Adev, UINT32 Interval, UINT8 Source);
+
+/* Feed a sample of the disciplined clock (Pico timer value and corresponding UTC time) to the stability analyzer. */
+void ntp_adev_sample(struct ntp_adev *Adev, UINT64 LocalTime, INT64 UTCTime);
+
+/* Return the averaging time (in seconds) of a level. */
+UINT32 ntp_adev_tau(struct ntp_adev *Adev, UINT8 Level);
+
+#endif  // _NTP_ADEV_H
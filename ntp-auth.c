@@ -0,0 +1,429 @@
+/* ============================================================================================================================================================= *\
+   ntp-auth.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Symmetric key authentication of NTP packets (see ntp-auth.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include "ntp-auth.h"
+
+
+
+/* Process one 64-byte block through the MD5 compression function. */
+static void ntp_auth_md5_block(UINT32 *State, const UINT8 *Block);
+
+/* Process one 64-byte block through the SHA-1 compression function. */
+static void ntp_auth_sha1_block(UINT32 *State, const UINT8 *Block);
+
+
+
+/* Symmetric key table used for NTP authentication (see ntp_auth_add_key()). */
+static struct ntp_key NtpKeyTable[NTP_MAX_KEYS];
+
+/* MD5 per-round additive constants (integer part of abs(sin(i + 1)) * 2^32). */
+static const UINT32 Md5Constant[64] =
+{
+  0xD76AA478, 0xE8C7B756, 0x242070DB, 0xC1BDCEEE, 0xF57C0FAF, 0x4787C62A, 0xA8304613, 0xFD469501,
+  0x698098D8, 0x8B44F7AF, 0xFFFF5BB1, 0x895CD7BE, 0x6B901122, 0xFD987193, 0xA679438E, 0x49B40821,
+  0xF61E2562, 0xC040B340, 0x265E5A51, 0xE9B6C7AA, 0xD62F105D, 0x02441453, 0xD8A1E681, 0xE7D3FBC8,
+  0x21E1CDE6, 0xC33707D6, 0xF4D50D87, 0x455A14ED, 0xA9E3E905, 0xFCEFA3F8, 0x676F02D9, 0x8D2A4C8A,
+  0xFFFA3942, 0x8771F681, 0x6D9D6122, 0xFDE5380C, 0xA4BEEA44, 0x4BDECFA9, 0xF6BB4B60, 0xBEBFBC70,
+  0x289B7EC6, 0xEAA127FA, 0xD4EF3085, 0x04881D05, 0xD9D4D039, 0xE6DB99E5, 0x1FA27CF8, 0xC4AC5665,
+  0xF4292244, 0x432AFF97, 0xAB9423A7, 0xFC93A039, 0x655B59C3, 0x8F0CCC92, 0xFFEFF47D, 0x85845DD1,
+  0x6FA87E4F, 0xFE2CE6E0, 0xA3014314, 0x4E0811A1, 0xF7537E82, 0xBD3AF235, 0x2AD7D2BB, 0xEB86D391
+};
+
+/* MD5 per-round left rotation amounts. */
+static const UINT8 Md5Shift[64] =
+{
+  7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+  5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+  4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+  6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+};
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_auth_add_key() */
+/* ============================================================================================================================================================= *\
+                                                       Add (or replace) a symmetric key in the authentication key table.
+                                                         Return 0 on success, 1 if parameters are invalid or table is full.
+\* ============================================================================================================================================================= */
+UINT8 ntp_auth_add_key(UINT32 KeyId, UINT8 KeyType, const UINT8 *Key, UINT8 KeyLength)
+{
+  struct ntp_key *KeyEntry;
+
+
+  /* Key ID 0 is reserved to indicate "no authentication" (and for crypto-NAK replies). */
+  if ((KeyId == 0) || (Key == NULL) || (KeyLength == 0) || (KeyLength > NTP_MAX_KEY_LEN)) return 1;
+  if ((KeyType != NTP_AUTH_MD5) && (KeyType != NTP_AUTH_SHA1)) return 1;
+
+  /* Replace key if this key ID is already in the table, otherwise take the first free entry. */
+  KeyEntry = ntp_auth_find_key(KeyId);
+  if (KeyEntry == NULL) KeyEntry = ntp_auth_find_key(0);
+  if (KeyEntry == NULL) return 1;
+
+  KeyEntry->KeyId     = KeyId;
+  KeyEntry->KeyType   = KeyType;
+  KeyEntry->KeyLength = KeyLength;
+  memcpy(KeyEntry->Key, Key, KeyLength);
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_auth_digest() */
+/* ============================================================================================================================================================= *\
+                                                           Compute the digest of a symmetric key followed by a message.
+                           NOTE: MD5 and SHA-1 share the same 64-byte block structure and padding; only the compression function and the byte order
+                                 of the state and of the message length differ. No heap is used: blocks are assembled on the stack.
+                                 Return the length of the digest (0 if the key type is not supported).
+\* ============================================================================================================================================================= */
+UINT8 ntp_auth_digest(UINT8 KeyType, const UINT8 *Key, UINT8 KeyLength, const UINT8 *Message, UINT16 MessageLength, UINT8 *Digest)
+{
+  UINT8 Block[64];
+  UINT8 BlockIndex;
+  UINT8 DigestLength;
+  UINT8 Loop1UInt8;
+
+  UINT16 Loop1UInt16;
+  UINT16 TotalLength;
+
+  UINT32 State[5];
+
+  UINT64 BitLength;
+
+
+  if (KeyType == NTP_AUTH_MD5)
+  {
+    State[0] = 0x67452301;
+    State[1] = 0xEFCDAB89;
+    State[2] = 0x98BADCFE;
+    State[3] = 0x10325476;
+    DigestLength = 16;
+  }
+  else if (KeyType == NTP_AUTH_SHA1)
+  {
+    State[0] = 0x67452301;
+    State[1] = 0xEFCDAB89;
+    State[2] = 0x98BADCFE;
+    State[3] = 0x10325476;
+    State[4] = 0xC3D2E1F0;
+    DigestLength = 20;
+  }
+  else
+  {
+    return 0;
+  }
+
+
+  /* Feed the key, then the message, one 64-byte block at a time. */
+  TotalLength = KeyLength + MessageLength;
+  BlockIndex  = 0;
+  for (Loop1UInt16 = 0; Loop1UInt16 < TotalLength; ++Loop1UInt16)
+  {
+    Block[BlockIndex++] = (Loop1UInt16 < KeyLength) ? Key[Loop1UInt16] : Message[Loop1UInt16 - KeyLength];
+    if (BlockIndex == 64)
+    {
+      if (KeyType == NTP_AUTH_MD5) ntp_auth_md5_block(State, Block);
+      else                         ntp_auth_sha1_block(State, Block);
+      BlockIndex = 0;
+    }
+  }
+
+
+  /* Padding: one "1" bit, zeroes up to 56 bytes in the last block, then the message length in bits. */
+  Block[BlockIndex++] = 0x80;
+  if (BlockIndex > 56)
+  {
+    memset(&Block[BlockIndex], 0, 64 - BlockIndex);
+    if (KeyType == NTP_AUTH_MD5) ntp_auth_md5_block(State, Block);
+    else                         ntp_auth_sha1_block(State, Block);
+    BlockIndex = 0;
+  }
+  memset(&Block[BlockIndex], 0, 56 - BlockIndex);
+
+  BitLength = (UINT64)TotalLength * 8;
+  for (Loop1UInt8 = 0; Loop1UInt8 < 8; ++Loop1UInt8)
+  {
+    if (KeyType == NTP_AUTH_MD5)
+      Block[56 + Loop1UInt8] = (UINT8)(BitLength >> (8 * Loop1UInt8));         // little endian.
+    else
+      Block[63 - Loop1UInt8] = (UINT8)(BitLength >> (8 * Loop1UInt8));         // big endian.
+  }
+
+  if (KeyType == NTP_AUTH_MD5) ntp_auth_md5_block(State, Block);
+  else                         ntp_auth_sha1_block(State, Block);
+
+
+  /* Output the digest. */
+  for (Loop1UInt8 = 0; Loop1UInt8 < DigestLength; ++Loop1UInt8)
+  {
+    if (KeyType == NTP_AUTH_MD5)
+      Digest[Loop1UInt8] = (UINT8)(State[Loop1UInt8 / 4] >> (8 * (Loop1UInt8 % 4)));
+    else
+      Digest[Loop1UInt8] = (UINT8)(State[Loop1UInt8 / 4] >> (24 - (8 * (Loop1UInt8 % 4))));
+  }
+
+  return DigestLength;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_auth_find_key() */
+/* ============================================================================================================================================================= *\
+                                                             Find the key table entry for the specified key ID.
+                                                      NOTE: A key ID of 0 returns the first free entry of the table.
+\* ============================================================================================================================================================= */
+struct ntp_key *ntp_auth_find_key(UINT32 KeyId)
+{
+  UINT8 Loop1UInt8;
+
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < NTP_MAX_KEYS; ++Loop1UInt8)
+  {
+    if (KeyId == 0)
+    {
+      if (NtpKeyTable[Loop1UInt8].KeyType == NTP_AUTH_NONE) return &NtpKeyTable[Loop1UInt8];
+    }
+    else
+    {
+      if ((NtpKeyTable[Loop1UInt8].KeyType != NTP_AUTH_NONE) && (NtpKeyTable[Loop1UInt8].KeyId == KeyId)) return &NtpKeyTable[Loop1UInt8];
+    }
+  }
+
+  return NULL;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_auth_md5_block() */
+/* ============================================================================================================================================================= *\
+                                                         Process one 64-byte block through the MD5 compression function.
+\* ============================================================================================================================================================= */
+static void ntp_auth_md5_block(UINT32 *State, const UINT8 *Block)
+{
+  UINT8 Index;
+  UINT8 Loop1UInt8;
+
+  UINT32 A, B, C, D, F;
+  UINT32 Word[16];
+
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < 16; ++Loop1UInt8)
+    Word[Loop1UInt8] = ((UINT32)Block[(Loop1UInt8 * 4)]) | ((UINT32)Block[(Loop1UInt8 * 4) + 1] << 8) | ((UINT32)Block[(Loop1UInt8 * 4) + 2] << 16) | ((UINT32)Block[(Loop1UInt8 * 4) + 3] << 24);
+
+  A = State[0];
+  B = State[1];
+  C = State[2];
+  D = State[3];
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < 64; ++Loop1UInt8)
+  {
+    switch (Loop1UInt8 / 16)
+    {
+      case (0):
+        F     = (B & C) | (~B & D);
+        Index = Loop1UInt8;
+      break;
+
+      case (1):
+        F     = (D & B) | (~D & C);
+        Index = ((5 * Loop1UInt8) + 1) % 16;
+      break;
+
+      case (2):
+        F     = B ^ C ^ D;
+        Index = ((3 * Loop1UInt8) + 5) % 16;
+      break;
+
+      default:
+        F     = C ^ (B | ~D);
+        Index = (7 * Loop1UInt8) % 16;
+      break;
+    }
+
+    F = F + A + Md5Constant[Loop1UInt8] + Word[Index];
+    A = D;
+    D = C;
+    C = B;
+    B = B + ((F << Md5Shift[Loop1UInt8]) | (F >> (32 - Md5Shift[Loop1UInt8])));
+  }
+
+  State[0] += A;
+  State[1] += B;
+  State[2] += C;
+  State[3] += D;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_auth_sha1_block() */
+/* ============================================================================================================================================================= *\
+                                                        Process one 64-byte block through the SHA-1 compression function.
+                                     NOTE: The message schedule is kept in a 16-word circular buffer to limit stack usage on the Pico.
+\* ============================================================================================================================================================= */
+static void ntp_auth_sha1_block(UINT32 *State, const UINT8 *Block)
+{
+  UINT8 Loop1UInt8;
+
+  UINT32 A, B, C, D, E, F, K;
+  UINT32 Temp;
+  UINT32 Word[16];
+
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < 16; ++Loop1UInt8)
+    Word[Loop1UInt8] = ((UINT32)Block[(Loop1UInt8 * 4)] << 24) | ((UINT32)Block[(Loop1UInt8 * 4) + 1] << 16) | ((UINT32)Block[(Loop1UInt8 * 4) + 2] << 8) | ((UINT32)Block[(Loop1UInt8 * 4) + 3]);
+
+  A = State[0];
+  B = State[1];
+  C = State[2];
+  D = State[3];
+  E = State[4];
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < 80; ++Loop1UInt8)
+  {
+    if (Loop1UInt8 >= 16)
+    {
+      Temp = Word[(Loop1UInt8 + 13) & 0x0F] ^ Word[(Loop1UInt8 + 8) & 0x0F] ^ Word[(Loop1UInt8 + 2) & 0x0F] ^ Word[Loop1UInt8 & 0x0F];
+      Word[Loop1UInt8 & 0x0F] = (Temp << 1) | (Temp >> 31);
+    }
+
+    if (Loop1UInt8 < 20)
+    {
+      F = (B & C) | (~B & D);
+      K = 0x5A827999;
+    }
+    else if (Loop1UInt8 < 40)
+    {
+      F = B ^ C ^ D;
+      K = 0x6ED9EBA1;
+    }
+    else if (Loop1UInt8 < 60)
+    {
+      F = (B & C) | (B & D) | (C & D);
+      K = 0x8F1BBCDC;
+    }
+    else
+    {
+      F = B ^ C ^ D;
+      K = 0xCA62C1D6;
+    }
+
+    Temp = ((A << 5) | (A >> 27)) + F + E + K + Word[Loop1UInt8 & 0x0F];
+    E = D;
+    D = C;
+    C = (B << 30) | (B >> 2);
+    B = A;
+    A = Temp;
+  }
+
+  State[0] += A;
+  State[1] += B;
+  State[2] += C;
+  State[3] += D;
+  State[4] += E;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_auth_sign() */
+/* ============================================================================================================================================================= *\
+                                                                 Append key ID and digest to an NTP packet.
+                       NOTE: Packet buffer must be at least NTP_MAX_PACKET_LEN bytes. A key ID of 0 (or not in the key table) leaves the packet
+                             unauthenticated. Return the new packet length.
+\* ============================================================================================================================================================= */
+UINT16 ntp_auth_sign(UINT32 KeyId, UINT8 *Packet, UINT16 PacketLength)
+{
+  struct ntp_key *KeyEntry;
+
+
+  if (KeyId == 0) return PacketLength;
+
+  KeyEntry = ntp_auth_find_key(KeyId);
+  if (KeyEntry == NULL) return PacketLength;  // key has not been added to the key table: send the request unauthenticated.
+
+  Packet[PacketLength++] = (UINT8)(KeyEntry->KeyId >> 24);
+  Packet[PacketLength++] = (UINT8)(KeyEntry->KeyId >> 16);
+  Packet[PacketLength++] = (UINT8)(KeyEntry->KeyId >> 8);
+  Packet[PacketLength++] = (UINT8)(KeyEntry->KeyId);
+
+  /* The digest covers the NTP header and extension fields, not the key ID. */
+  PacketLength += ntp_auth_digest(KeyEntry->KeyType, KeyEntry->Key, KeyEntry->KeyLength, Packet, PacketLength - NTP_KEY_ID_LEN, &Packet[PacketLength]);
+
+  return PacketLength;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_auth_verify() */
+/* ============================================================================================================================================================= *\
+                                                              Validate the MAC (if any) of an NTP packet received.
+                   NOTE: Packet must have been parsed by ntp_packet_parse(). KeyId is the key ID configured (0 = no authentication: any MAC
+                         is ignored). Return NTP_AUTH_OK if the packet is acceptable, the reason of the rejection (NTP_AUTH_xxx) otherwise.
+\* ============================================================================================================================================================= */
+UINT8 ntp_auth_verify(UINT32 KeyId, const UINT8 *Packet, const struct ntp_packet *Info)
+{
+  UINT8 Difference;
+  UINT8 Digest[NTP_MAX_DIGEST_LEN];
+  UINT8 DigestLength;
+  UINT8 Loop1UInt8;
+
+  struct ntp_key *KeyEntry;
+
+
+  /* We don't authenticate: ignore the MAC, if any. */
+  if (KeyId == 0) return NTP_AUTH_OK;
+
+  if (Info->DigestLength == 0)   return NTP_AUTH_UNSIGNED;
+  if (Info->KeyId != KeyId)      return NTP_AUTH_KEY_ID;
+
+  KeyEntry = ntp_auth_find_key(KeyId);
+  if (KeyEntry == NULL) return NTP_AUTH_NO_KEY;
+
+  DigestLength = ntp_auth_digest(KeyEntry->KeyType, KeyEntry->Key, KeyEntry->KeyLength, Packet, Info->MacOffset, Digest);
+  if (DigestLength != Info->DigestLength) return NTP_AUTH_BAD_MAC;
+
+  /* Compare the whole digest whatever the first difference is, so that the time taken doesn't tell how many bytes of a forged MAC are right. */
+  Difference = 0;
+  for (Loop1UInt8 = 0; Loop1UInt8 < DigestLength; ++Loop1UInt8)
+    Difference |= (Digest[Loop1UInt8] ^ Packet[Info->MacOffset + NTP_KEY_ID_LEN + Loop1UInt8]);
+
+  if (Difference != 0) return NTP_AUTH_BAD_MAC;
+
+  return NTP_AUTH_OK;
+}
@@ -0,0 +1,64 @@
+/* ============================================================================================================================================================= *\
+   ntp-auth.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.00
+
+   Symmetric key authentication of NTP packets (RFC 5905 message authentication code, MD5 or SHA-1): key table, digest, signature of
+   the requests and verification of the MAC of the replies parsed by ntp_packet_parse().
+   NTP packet layout (see ntp-packet.h): 48-byte header + optional extension fields (reserved for NTS) + optional MAC.
+   This file doesn't depend on the Pico SDK so that it may also be compiled on a host computer (see ntp-fuzz.c).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release (moved from Pico-NTP-Module.c), ntp_auth_verify() returns the reason of a rejection.
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_AUTH_H
+#define _NTP_AUTH_H
+
+#include "baseline.h"
+#include "ntp-packet.h"
+
+
+#define NTP_AUTH_NONE              0   // no authentication (key table entry is free).
+#define NTP_AUTH_MD5               1   // MD5 digest (16 bytes).
+#define NTP_AUTH_SHA1              2   // SHA-1 digest (20 bytes).
+
+#define NTP_MAX_KEYS               4   // number of entries in symmetric key table.
+#define NTP_MAX_KEY_LEN           20   // maximum length of a symmetric key (in bytes).
+
+#define NTP_AUTH_OK                0   // ntp_auth_verify() return codes.
+#define NTP_AUTH_UNSIGNED          1   // no MAC while a key ID is configured.
+#define NTP_AUTH_KEY_ID            2   // MAC computed with another key ID than the one configured.
+#define NTP_AUTH_NO_KEY            3   // key ID configured is not in the key table.
+#define NTP_AUTH_BAD_MAC           4   // digest length or digest doesn't match.
+
+
+/* Symmetric key table entry (see ntp_auth_add_key()). */
+struct ntp_key
+{
+  UINT32 KeyId;
+  UINT8  KeyType;                // NTP_AUTH_NONE means that this entry is free.
+  UINT8  KeyLength;
+  UINT8  Key[NTP_MAX_KEY_LEN];
+};
+
+
+/* Add (or replace) a symmetric key in the authentication key table. */
+UINT8 ntp_auth_add_key(UINT32 KeyId, UINT8 KeyType, const UINT8 *Key, UINT8 KeyLength);
+
+/* Compute the digest of a symmetric key followed by a message. */
+UINT8 ntp_auth_digest(UINT8 KeyType, const UINT8 *Key, UINT8 KeyLength, const UINT8 *Message, UINT16 MessageLength, UINT8 *Digest);
+
+/* Find the key table entry for the specified key ID. */
+struct ntp_key *ntp_auth_find_key(UINT32 KeyId);
+
+/* Append key ID and digest to an NTP packet. */
+UINT16 ntp_auth_sign(UINT32 KeyId, UINT8 *Packet, UINT16 PacketLength);
+
+/* Validate the MAC (if any) of an NTP packet received. */
+UINT8 ntp_auth_verify(UINT32 KeyId, const UINT8 *Packet, const struct ntp_packet *Info);
+
+#endif  // _NTP_AUTH_H
@@ -0,0 +1,592 @@
+/* ============================================================================================================================================================= *\
+   ntp-clock-test.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Host computer regression test of the disciplined clock (ntp-clock.c). Each scenario feeds ntp_clock_sample() with the samples a
+   Pico would receive from a crystal of known frequency error, and checks the clock error, the frequency estimate and the number
+   of clock steps against fixed limits:
+   - PPS edges every second, the clock having been set by NTP 10 msec off: the frequency estimate must stay close to the crystal
+     error while the initial offset is slewed (it must not take the slewed offset for a frequency error),
+   - a 100 msec offset slewed by NTP samples every 64 seconds: the clock must converge without overshoot,
+   - one NTP sample per day with a 10 ppm crystal: only the first daily sample may step the clock, the next ones are slewed,
+   - a time jump (server set 5 seconds off): the clock is stepped, but the frequency estimate is kept,
+   - ntp_clock_get_local_us() is the exact inverse of ntp_clock_get_utc_us() while an offset is slewed, for large frequency errors,
+   - interleaved bursts of 2 requests (ntp-sync.c) whose second reply is received, lost or inconsistent: the first exchange of the burst
+     must then be used in basic mode, and the clock must converge as if no reply had been lost,
+   - exchanges whose transmit timestamp is just before or after the NTP era rollover (2036), timestamps converted with a pivot time far
+     from them, and differences overflowing 32-bit seconds (or 64 bits once summed), which must saturate (ntp-timestamp.c).
+
+   Build and run on a host computer (only needs a copy of baseline.h for the type definitions):
+       gcc -O2 -Wall -o ntp-clock-test ntp-clock-test.c ntp-adev.c ntp-clock.c ntp-sync.c ntp-tempco.c ntp-timestamp.c -lm
+       ./ntp-clock-test
+   Exit code is 0 when every scenario passes, 1 otherwise.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include "ntp-clock.h"
+#include "ntp-sync.h"
+
+
+#define TEST_EPOCH     1792281600000000ll  // true UTC time at the beginning of each scenario (18-OCT-2026 00:00:00, in usec).
+#define TEST_BOOT             5000000ll    // Pico timer value at the beginning of each scenario (in usec).
+
+
+struct test_crystal
+{
+  INT32 DriftPpb;                // frequency error of the crystal (in ppb, positive when running fast).
+};
+
+
+
+/* Return the clock error (in usec) at the true time given. */
+static INT64 test_error(struct ntp_clock *Clock, struct test_crystal *Crystal, INT64 Time);
+
+/* Return the Pico timer value at the true time given (in usec since the beginning of the scenario). */
+static UINT64 test_local(struct test_crystal *Crystal, INT64 Time);
+
+/* Scenario: interleaved bursts with lost or inconsistent second replies. */
+static UINT8 test_burst(void);
+
+/* Scenario: one NTP sample per day. */
+static UINT8 test_daily(void);
+
+/* Scenario: NTP era rollover, pivot time far from the timestamp and differences overflowing 32 bits. */
+static UINT8 test_era(void);
+
+/* Scenario: inverse of the clock. */
+static UINT8 test_inverse(void);
+
+/* Scenario: time jump of the server. */
+static UINT8 test_jump(void);
+
+/* Scenario: PPS edges every second. */
+static UINT8 test_pps(void);
+
+/* Scenario: offset slewed by NTP samples. */
+static UINT8 test_slew(void);
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=main() */
+/* ============================================================================================================================================================= *\
+                                                                          Main program entry point.
+\* ============================================================================================================================================================= */
+int main(void)
+{
+  UINT8 Failures = 0;
+
+
+  Failures += test_pps();
+  Failures += test_slew();
+  Failures += test_daily();
+  Failures += test_jump();
+  Failures += test_inverse();
+  Failures += test_burst();
+  Failures += test_era();
+
+  printf("\n%s (%u scenario(s) failed)\n", (Failures == 0) ? "PASS" : "FAIL", Failures);
+
+  return (Failures == 0) ? 0 : 1;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_burst() */
+/* ============================================================================================================================================================= *\
+                                                     Scenario: interleaved bursts with lost or inconsistent second replies.
+                 NOTE: A burst of 2 requests every 64 seconds, the server taking 50 usec to send its reply: the second reply of one burst out of
+                       three is received (interleaved mode), lost (first exchange used 10 seconds later, see ntp_failed_handler()) or inconsistent
+                       (precise transmit timestamp before the receive timestamp). Each burst must be closed once, with its first exchange when
+                       the second reply failed, and the clock must converge without step.
+\* ============================================================================================================================================================= */
+static UINT8 test_burst(void)
+{
+  UINT8 Cycle;
+  UINT8 Errors;
+  UINT8 Fallbacks;
+  UINT8 Status;
+
+  INT64 Error;
+  INT64 Time;
+
+  UINT64 Complete;
+
+  ntp_timestamp_t Transmit;
+
+  struct ntp_burst Burst;
+
+  struct ntp_clock Clock;
+
+  struct ntp_exchange Exchange;
+  struct ntp_exchange First;
+
+  struct ntp_packet Info;
+
+  struct test_crystal Crystal = {-12000};
+
+
+  ntp_clock_init(&Clock);
+  ntp_clock_sample(&Clock, test_local(&Crystal, 0ll), TEST_EPOCH, NTP_SOURCE_NETWORK);
+  memset(&Burst, 0x00, sizeof(Burst));
+  memset(&Info, 0x00, sizeof(Info));
+
+  Errors    = 0;
+  Fallbacks = 0;
+  for (Cycle = 1; Cycle <= 60; ++Cycle)
+  {
+    /* First exchange: 10 msec each way, the transmit timestamp of the reply is the receive timestamp (sent 50 usec later). */
+    Time = (INT64)Cycle * 64000000ll;
+    memset(&First, 0x00, sizeof(First));
+    First.Send    = test_local(&Crystal, Time);
+    First.Receive = test_local(&Crystal, Time + 20050ll);
+    First.T2      = ntp_ts_from_unix_us(TEST_EPOCH + Time + 10000ll);
+    First.T3      = First.T2;
+    ntp_sync_exchange(&Clock, &First);
+    ntp_sync_burst_open(&Burst, &First, &Info);
+
+    /* Second reply received 40 msec later (as ntp_recv() does), or burst closed by the alarm 10 seconds later. */
+    Complete = test_local(&Crystal, Time + (((Cycle % 3) == 1) ? 10000000ll : 60000ll));
+    Transmit = ntp_ts_from_unix_us(TEST_EPOCH + Time + (((Cycle % 3) == 2) ? 9000ll : 10050ll));
+    Exchange = First;
+    Status   = NTP_SYNC_BOGUS;
+    if ((Cycle % 3) != 1) Status = ntp_sync_interleaved(&Clock, &Exchange, Transmit, Complete);
+    if (Status != NTP_SYNC_OK)
+    {
+      if ((ntp_sync_burst_close(&Burst, Complete, &Exchange) != NTP_SYNC_OK) || (Exchange.Offset != First.Offset) || (Exchange.Complete != Complete)) ++Errors;
+      ++Fallbacks;
+    }
+    if ((Status == NTP_SYNC_OK) != ((Cycle % 3) == 0)) ++Errors;
+    Burst.FlagOpen = FLAG_OFF;  // as ntp_recv() does once the second reply has been used.
+    if (ntp_sync_burst_close(&Burst, Complete, &Exchange) != NTP_SYNC_TIMEOUT) ++Errors;
+
+    ntp_sync_discipline(&Clock, &Exchange, FLAG_OFF);
+  }
+  Error = test_error(&Clock, &Crystal, Time + 32000000ll);
+
+  printf("Interleaved bursts:       steps: %u   first exchanges used: %u   frequency: %d ppb   error: %lld usec   errors: %u\n", Clock.StepCount, Fallbacks, Clock.FrequencyPpb, (long long)Error, Errors);
+
+  if ((Errors != 0) || (Fallbacks != 40) || (Clock.StepCount != 0) || (Clock.FrequencyPpb > -11000) || (Clock.FrequencyPpb < -13000) || (Error > 100) || (Error < -100))
+  {
+    printf("  FAIL: expected each burst closed once (with its first exchange 40 times), no step, a frequency within 1 ppm of -12000 ppb and an error within 100 usec.\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_daily() */
+/* ============================================================================================================================================================= *\
+                                                                      Scenario: one NTP sample per day.
+                       NOTE: A 10 ppm crystal drifts 864 msec per day, more than NTP_CLOCK_STEP_US: the second sample steps the clock, and must also
+                             measure the frequency error, so that the following samples are slewed.
+\* ============================================================================================================================================================= */
+static UINT8 test_daily(void)
+{
+  UINT8 Day;
+
+  INT64 Error;
+  INT64 Time;
+
+  struct ntp_clock Clock;
+
+  struct test_crystal Crystal = {10000};
+
+
+  ntp_clock_init(&Clock);
+
+  for (Day = 0; Day <= 10; ++Day)
+  {
+    Time = (INT64)Day * 86400000000ll;
+    ntp_clock_sample(&Clock, test_local(&Crystal, Time), TEST_EPOCH + Time, NTP_SOURCE_NETWORK);
+  }
+
+  /* Error just before the next daily sample. */
+  Error = test_error(&Clock, &Crystal, 11ll * 86400000000ll);
+
+  printf("Daily samples, 10 ppm:    steps: %u   frequency: %d ppb   error after 24 hours: %lld usec\n", Clock.StepCount, Clock.FrequencyPpb, (long long)Error);
+
+  if ((Clock.StepCount > 1) || (Clock.FrequencyPpb < 9900) || (Clock.FrequencyPpb > 10100) || (Error > 10000) || (Error < -10000))
+  {
+    printf("  FAIL: expected at most 1 step, a frequency within 100 ppb of 10000 ppb and an error within 10 msec.\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_era() */
+/* ============================================================================================================================================================= *\
+                                            Scenario: NTP era rollover, pivot time far from the timestamp and differences overflowing 32 bits.
+                 NOTE: Exchanges whose transmit timestamp is just before or just after the end of NTP era 0 (07-FEB-2036 06:28:16 UTC), with the
+                       clock set and never set (NTP_TS_PIVOT is then 10 years away), must give the offset of the server and its time. A timestamp
+                       must be converted back to the same time with a pivot up to 68 years away (and to another era beyond). Differences beyond
+                       2^31 seconds and sums of differences overflowing 64 bits must saturate with the right sign (see ntp-timestamp.c), also for
+                       a server 60 years off.
+\* ============================================================================================================================================================= */
+static UINT8 test_era(void)
+{
+  UINT8 Loop1UInt8;
+
+  UINT32 Errors;
+
+  INT64 Expected;
+  INT64 Request;
+  INT64 Server;
+
+  ntp_timestamp_t Timestamp;
+
+  struct ntp_clock Clock;
+
+  struct ntp_exchange Exchange;
+
+  static const INT64 Rollover   = 2085978496000000ll;  // end of NTP era 0 (in usec since 01-JAN-1970).
+  static const INT64 Transmit[] = {-1000000ll, -1000ll, -1ll, 0ll, 1ll, 1000ll, 1000000ll};
+  static const INT64 Pivot[]    = {0ll, 1000000000000000ll, 2085978496000000ll, 3786480000000000ll, 4102444800000000ll};
+  static const INT64 Time[]     = {TEST_EPOCH, 2208988800000000ll};
+
+
+  Errors = 0l;
+
+  /* Request sent 10 msec before the server receives it, reply sent 50 usec later and received 10 msec after. Server is 5 msec ahead. */
+  for (Loop1UInt8 = 0; Loop1UInt8 < (2 * (sizeof(Transmit) / sizeof(Transmit[0]))); ++Loop1UInt8)
+  {
+    Server  = Rollover + Transmit[Loop1UInt8 / 2];
+    Request = Server - 5000ll - 10050ll;
+
+    ntp_clock_init(&Clock);
+    if (Loop1UInt8 & 0x01) ntp_clock_sample(&Clock, TEST_BOOT, Request - 10000000ll, NTP_SOURCE_NETWORK);
+
+    memset(&Exchange, 0x00, sizeof(Exchange));
+    Exchange.Send    = TEST_BOOT + 10000000ull;
+    Exchange.Receive = Exchange.Send + 20050ull;
+    Exchange.T2      = ntp_ts_from_unix_us(Server - 50ll);
+    Exchange.T3      = ntp_ts_from_unix_us(Server);
+    ntp_sync_exchange(&Clock, &Exchange);
+
+    /* Era 1 starts at 0 seconds: check that the transmit timestamp is really on the side of the rollover it should be. */
+    if (((Exchange.T3 >> 32) < 0x80000000ull) != (Server >= Rollover)) ++Errors;
+
+    /* Clock never set: the transmit timestamp of the server is taken as the time of reception, the offset is then half the delay. */
+    Expected = (Loop1UInt8 & 0x01) ? 5000ll : 10000ll;
+    if ((Exchange.Offset < (Expected - 1ll)) || (Exchange.Offset > (Expected + 1ll)) || (Exchange.Delay < 19999l) || (Exchange.Delay > 20001l)) ++Errors;
+    if ((Exchange.LocalReceive + Exchange.Offset < Server + 10000ll - 1ll) || (Exchange.LocalReceive + Exchange.Offset > Server + 10000ll + 1ll)) ++Errors;
+  }
+
+  /* Pivot times from 1970 to 2100, for a timestamp of era 0 (2026) and of era 1 (2040). */
+  for (Loop1UInt8 = 0; Loop1UInt8 < (2 * (sizeof(Pivot) / sizeof(Pivot[0]))); ++Loop1UInt8)
+  {
+    Timestamp = ntp_ts_from_unix_us(Time[Loop1UInt8 & 0x01] + 123456ll);
+    Expected  = Time[Loop1UInt8 & 0x01] + 123456ll;
+
+    /* More than 68 years between the timestamp and the pivot time: the closest era is the next (or previous) one. */
+    if ((Expected - Pivot[Loop1UInt8 >> 1]) >  (0x7FFFFFFFll * 1000000ll)) Expected -= NTP_ERA_SECONDS * 1000000ll;
+    if ((Pivot[Loop1UInt8 >> 1] - Expected) >  (0x7FFFFFFFll * 1000000ll)) Expected += NTP_ERA_SECONDS * 1000000ll;
+
+    if (ntp_ts_to_unix_us(Timestamp, Pivot[Loop1UInt8 >> 1]) != Expected) ++Errors;
+  }
+
+  /* Differences beyond 2^31 seconds, and sums of differences beyond 2^63. */
+  if (ntp_tsdiff_to_us(ntp_tsdiff_from_us(0x7FFFFFFFll * 1000000ll)) != (0x7FFFFFFFll * 1000000ll)) ++Errors;
+  if (ntp_tsdiff_from_us(0x80000000ll * 1000000ll) != NTP_TSDIFF_MAX)       ++Errors;
+  if (ntp_tsdiff_from_us(-0x80000001ll * 1000000ll) != NTP_TSDIFF_MIN)      ++Errors;
+  if (ntp_tsdiff_add(NTP_TSDIFF_MAX, 1ll) != NTP_TSDIFF_MAX)                ++Errors;
+  if (ntp_tsdiff_add(NTP_TSDIFF_MIN, -1ll) != NTP_TSDIFF_MIN)               ++Errors;
+  if (ntp_tsdiff_add(1ll << 62, 1ll << 62) != NTP_TSDIFF_MAX)               ++Errors;
+  if (ntp_tsdiff_add(-(1ll << 62), -(1ll << 62)) != NTP_TSDIFF_MIN)         ++Errors;
+  if (ntp_tsdiff_sub(NTP_TSDIFF_MAX, -1ll) != NTP_TSDIFF_MAX)               ++Errors;
+  if (ntp_tsdiff_sub(NTP_TSDIFF_MIN, 1ll) != NTP_TSDIFF_MIN)                ++Errors;
+  if (ntp_tsdiff_sub(-(1ll << 62) - 1ll, 1ll << 62) != NTP_TSDIFF_MIN)      ++Errors;
+  if (ntp_tsdiff_sub(1ll << 62, -(1ll << 62)) != NTP_TSDIFF_MAX)            ++Errors;
+
+  /* Server 60 years ahead (then behind): (T2 - T1) + (T3 - T4) overflows 64 bits, the offset must saturate with the sign of the error. */
+  for (Loop1UInt8 = 0; Loop1UInt8 < 2; ++Loop1UInt8)
+  {
+    Server = TEST_EPOCH + ((Loop1UInt8 == 0) ? 1893456000000000ll : -1893456000000000ll);
+
+    ntp_clock_init(&Clock);
+    ntp_clock_sample(&Clock, TEST_BOOT, TEST_EPOCH, NTP_SOURCE_NETWORK);
+
+    memset(&Exchange, 0x00, sizeof(Exchange));
+    Exchange.Send    = TEST_BOOT;
+    Exchange.Receive = TEST_BOOT + 20050ull;
+    Exchange.T2      = ntp_ts_from_unix_us(Server + 10000ll);
+    Exchange.T3      = ntp_ts_from_unix_us(Server + 10050ll);
+    ntp_sync_exchange(&Clock, &Exchange);
+
+    Expected = ntp_tsdiff_to_us(((Loop1UInt8 == 0) ? NTP_TSDIFF_MAX : NTP_TSDIFF_MIN) / 2);
+    if ((Exchange.Offset != Expected) || (Exchange.Delay < 19999l) || (Exchange.Delay > 20001l)) ++Errors;
+  }
+
+  printf("NTP era and overflows:    errors: %lu\n", (unsigned long)Errors);
+
+  if (Errors != 0)
+  {
+    printf("  FAIL: expected exchanges across the era rollover, conversions with a pivot up to 68 years away and saturated differences.\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_error() */
+/* ============================================================================================================================================================= *\
+                                                                   Return the clock error (in usec) at the true time given.
+\* ============================================================================================================================================================= */
+static INT64 test_error(struct ntp_clock *Clock, struct test_crystal *Crystal, INT64 Time)
+{
+  return ntp_clock_get_utc_us(Clock, test_local(Crystal, Time)) - (TEST_EPOCH + Time);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_inverse() */
+/* ============================================================================================================================================================= *\
+                                                                       Scenario: inverse of the clock.
+                      NOTE: For each UTC time, ntp_clock_get_local_us() must return the first Pico timer value at which ntp_clock_get_utc_us() reaches
+                            it (an event scheduled at that time must neither fire early nor late), with the frequency correction and a slew in progress.
+\* ============================================================================================================================================================= */
+static UINT8 test_inverse(void)
+{
+  UINT8 Loop1UInt8;
+
+  UINT32 Errors;
+  UINT32 Loop2UInt32;
+
+  INT64 UTCTime;
+
+  UINT64 LocalTime;
+
+  struct ntp_clock Clock;
+
+  static const INT32 DriftPpb[] = {0, 250000, -250000, 12345};
+  static const INT64 Offset[]   = {0ll, 100000ll, -100000ll, 3000ll};
+
+
+  Errors = 0l;
+  for (Loop1UInt8 = 0; Loop1UInt8 < (sizeof(DriftPpb) / sizeof(DriftPpb[0])); ++Loop1UInt8)
+  {
+    ntp_clock_init(&Clock);
+    ntp_clock_sample(&Clock, TEST_BOOT, TEST_EPOCH, NTP_SOURCE_NETWORK);
+    Clock.FrequencyPpb  = DriftPpb[Loop1UInt8];
+    Clock.PendingOffset = Offset[Loop1UInt8];
+
+    /* Every usec around the base and around the end of the slew, then every 7.777 msec over 2 days. */
+    for (Loop2UInt32 = 0; Loop2UInt32 < 300000l; ++Loop2UInt32)
+    {
+      if (Loop2UInt32 < 20000l)
+        UTCTime = TEST_EPOCH - 10000ll + Loop2UInt32;
+      else if (Loop2UInt32 < 100000l)
+        UTCTime = TEST_EPOCH + 200000000ll - 40000ll + Loop2UInt32;
+      else
+        UTCTime = TEST_EPOCH + ((INT64)(Loop2UInt32 - 100000l) * 777777ll);
+
+      LocalTime = ntp_clock_get_local_us(&Clock, UTCTime);
+      if ((ntp_clock_get_utc_us(&Clock, LocalTime) < UTCTime) || (ntp_clock_get_utc_us(&Clock, LocalTime - 1) >= UTCTime)) ++Errors;
+    }
+  }
+
+  printf("Inverse of the clock:     errors: %lu\n", (unsigned long)Errors);
+
+  if (Errors != 0)
+  {
+    printf("  FAIL: expected ntp_clock_get_local_us() to return the first Pico timer value reaching each UTC time.\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_jump() */
+/* ============================================================================================================================================================= *\
+                                                                      Scenario: time jump of the server.
+                                  NOTE: A 5 second offset after one hour can't be the drift of a crystal: the frequency estimate must be kept.
+\* ============================================================================================================================================================= */
+static UINT8 test_jump(void)
+{
+  UINT8 Loop1UInt8;
+
+  INT32 FrequencyPpb;
+
+  INT64 Time;
+
+  struct ntp_clock Clock;
+
+  struct test_crystal Crystal = {-15000};
+
+
+  ntp_clock_init(&Clock);
+
+  /* Converge with a sample every 64 seconds for one hour. */
+  for (Loop1UInt8 = 0; Loop1UInt8 < 57; ++Loop1UInt8)
+  {
+    Time = (INT64)Loop1UInt8 * 64000000ll;
+    ntp_clock_sample(&Clock, test_local(&Crystal, Time), TEST_EPOCH + Time, NTP_SOURCE_NETWORK);
+  }
+  FrequencyPpb = Clock.FrequencyPpb;
+
+  /* Server is now 5 seconds ahead. */
+  Time += 64000000ll;
+  ntp_clock_sample(&Clock, test_local(&Crystal, Time), TEST_EPOCH + Time + 5000000ll, NTP_SOURCE_NETWORK);
+
+  printf("Time jump, -15 ppm:       steps: %u   frequency before: %d ppb   after: %d ppb\n", Clock.StepCount, FrequencyPpb, Clock.FrequencyPpb);
+
+  if ((Clock.StepCount != 1) || (Clock.FrequencyPpb != FrequencyPpb) || (FrequencyPpb > -14000) || (FrequencyPpb < -16000))
+  {
+    printf("  FAIL: expected 1 step, a frequency within 1 ppm of -15000 ppb and unchanged by the step.\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_local() */
+/* ============================================================================================================================================================= *\
+                                             Return the Pico timer value at the true time given (in usec since the beginning of the scenario).
+\* ============================================================================================================================================================= */
+static UINT64 test_local(struct test_crystal *Crystal, INT64 Time)
+{
+  return TEST_BOOT + (UINT64)(Time + ((Time * Crystal->DriftPpb) / 1000000000ll));
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_pps() */
+/* ============================================================================================================================================================= *\
+                                                                       Scenario: PPS edges every second.
+                         NOTE: The clock is set by NTP 10 msec off, then a PPS edge is received every second for 10 minutes. The 10 msec are slewed
+                               over 20 seconds (NTP_CLOCK_MAX_SLEW_PPM): during that time, the frequency estimate must not go beyond the error of
+                               the crystal (20 ppm) by more than a few ppm.
+\* ============================================================================================================================================================= */
+static UINT8 test_pps(void)
+{
+  UINT16 Second;
+
+  INT32 MaxPpb;
+  INT32 MinPpb;
+
+  INT64 Error;
+  INT64 Time;
+
+  struct ntp_clock Clock;
+
+  struct test_crystal Crystal = {20000};
+
+
+  ntp_clock_init(&Clock);
+  ntp_clock_sample(&Clock, test_local(&Crystal, 0ll), TEST_EPOCH + 10000ll, NTP_SOURCE_NETWORK);
+
+  MaxPpb = INT32_MIN;
+  MinPpb = INT32_MAX;
+  for (Second = 1; Second <= 600; ++Second)
+  {
+    Time = (INT64)Second * 1000000ll;
+    ntp_clock_sample(&Clock, test_local(&Crystal, Time), TEST_EPOCH + Time, NTP_SOURCE_PPS);
+    if (Clock.FrequencyPpb > MaxPpb) MaxPpb = Clock.FrequencyPpb;
+    if (Clock.FrequencyPpb < MinPpb) MinPpb = Clock.FrequencyPpb;
+  }
+  Error = test_error(&Clock, &Crystal, 600500000ll);
+
+  printf("PPS, 20 ppm, 10 msec off: steps: %u   frequency: %d ppb (range %d to %d)   error: %lld usec\n", Clock.StepCount, Clock.FrequencyPpb, MinPpb, MaxPpb, (long long)Error);
+
+  if ((Clock.StepCount != 0) || (MinPpb < 0) || (MaxPpb > 25000) || (Clock.FrequencyPpb < 19000) || (Clock.FrequencyPpb > 21000) || (Error > 5) || (Error < -5))
+  {
+    printf("  FAIL: expected no step, a frequency always between 0 and 25000 ppb and ending within 1 ppm of 20000 ppb, and an error within 5 usec.\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_slew() */
+/* ============================================================================================================================================================= *\
+                                                                   Scenario: offset slewed by NTP samples.
+                        NOTE: The clock is set 100 msec off, then corrected by NTP samples every 64 seconds. The offset takes 200 seconds to slew:
+                              the samples received in the meantime must not add the part still pending a second time (overshoot).
+\* ============================================================================================================================================================= */
+static UINT8 test_slew(void)
+{
+  UINT8 Loop1UInt8;
+
+  INT64 Error;
+  INT64 MaxError;
+  INT64 Time;
+
+  struct ntp_clock Clock;
+
+  struct test_crystal Crystal = {0};
+
+
+  ntp_clock_init(&Clock);
+  ntp_clock_sample(&Clock, test_local(&Crystal, 0ll), TEST_EPOCH - 100000ll, NTP_SOURCE_NETWORK);
+
+  MaxError = 0ll;
+  for (Loop1UInt8 = 1; Loop1UInt8 <= 30; ++Loop1UInt8)
+  {
+    Time = (INT64)Loop1UInt8 * 64000000ll;
+    ntp_clock_sample(&Clock, test_local(&Crystal, Time), TEST_EPOCH + Time, NTP_SOURCE_NETWORK);
+
+    /* Once the offset is slewed, the clock must not go past true time. */
+    Error = test_error(&Clock, &Crystal, Time + 32000000ll);
+    if ((Time >= 256000000ll) && (Error > MaxError))  MaxError = Error;
+    if ((Time >= 256000000ll) && (-Error > MaxError)) MaxError = -Error;
+  }
+
+  printf("Slew of 100 msec:         steps: %u   frequency: %d ppb   maximum error once slewed: %lld usec\n", Clock.StepCount, Clock.FrequencyPpb, (long long)MaxError);
+
+  if ((Clock.StepCount != 0) || (Clock.FrequencyPpb > 100) || (Clock.FrequencyPpb < -100) || (MaxError > 10))
+  {
+    printf("  FAIL: expected no step, a frequency within 100 ppb of 0 and an error within 10 usec once the offset is slewed.\n");
+    return 1;
+  }
+
+  return 0;
+}
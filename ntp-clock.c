@@ -0,0 +1,370 @@
+/* ============================================================================================================================================================= *\
+   ntp-clock.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.30
+
+   Disciplined clock used by Pico-NTP-Module (see ntp-clock.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+               1.10 - Optional temperature model of the crystal trained with each sample (see ntp-tempco.h), and frequency feed-forward.
+               1.20 - Optional frequency stability analyzer fed with the samples of one source (see ntp-adev.h).
+               1.30 - Samples measured earlier than the current time (NTP interleaved mode), slewed from the current time on.
+\* ============================================================================================================================================================= */
+
+#include "ntp-clock.h"
+
+
+
+/* Update the frequency estimate with the offset accumulated since the last sample. */
+static void ntp_clock_frequency(struct ntp_clock *Clock, UINT64 LocalTime, INT64 Offset, UINT8 Source, UINT8 Gain);
+
+/* Return the part of the pending offset already slewed after the elapsed time given. */
+static INT64 ntp_clock_get_slew(struct ntp_clock *Clock, INT64 Elapsed);
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_clock_adjust_frequency() */
+/* ============================================================================================================================================================= *\
+                               Change the frequency correction from the Pico timer value given on, without changing current time.
+                      NOTE: Used to feed forward a predictable change of the frequency error (temperature) between two samples. The base is moved to
+                            the time given first, as ntp_clock_sample() does, so that time before it is not affected.
+\* ============================================================================================================================================================= */
+void ntp_clock_adjust_frequency(struct ntp_clock *Clock, UINT64 LocalTime, INT32 DeltaPpb)
+{
+  INT64 Slew;
+  INT64 UTCTime;
+
+
+  if (Clock->FlagValid == FLAG_ON)
+  {
+    UTCTime = ntp_clock_get_utc_us(Clock, LocalTime);
+    Slew    = ntp_clock_get_slew(Clock, (INT64)(LocalTime - Clock->BaseLocal));
+
+    Clock->PendingOffset -= Slew;
+    Clock->BaseLocal      = LocalTime;
+    Clock->BaseUTC        = UTCTime;
+  }
+
+  Clock->FrequencyPpb += DeltaPpb;
+  if (Clock->FrequencyPpb >  NTP_CLOCK_MAX_FREQ_PPB) Clock->FrequencyPpb =  NTP_CLOCK_MAX_FREQ_PPB;
+  if (Clock->FrequencyPpb < -NTP_CLOCK_MAX_FREQ_PPB) Clock->FrequencyPpb = -NTP_CLOCK_MAX_FREQ_PPB;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_clock_frequency() */
+/* ============================================================================================================================================================= *\
+                                                Update the frequency estimate with the offset accumulated since the last sample.
+                  NOTE: Offset must be measured against the clock once the pending offset is slewed, so that it is only due to the frequency error
+                        of the crystal. It is not used when the previous sample came from another source (offsets between sources are phase
+                        differences), from the holdover clock (only accurate to the second), or when it is larger than the frequency correction
+                        limit over the interval (time jump, or offset of the sample that set the clock). Only 1 / Gain of the estimate is applied.
+\* ============================================================================================================================================================= */
+static void ntp_clock_frequency(struct ntp_clock *Clock, UINT64 LocalTime, INT64 Offset, UINT8 Source, UINT8 Gain)
+{
+  INT64 Elapsed;
+  INT64 FrequencyError;
+  INT64 Limit;
+
+
+  if ((Clock->FlagValid == FLAG_OFF) || (Source != Clock->Source) || (Source == NTP_SOURCE_HOLDOVER)) return;
+
+  Elapsed = (INT64)(LocalTime - Clock->LastSample);
+  if (Elapsed < NTP_CLOCK_MIN_INTERVAL) return;
+
+  /* Checked before scaling: a bogus offset (server timestamps days off) would overflow. Elapsed is then scaled to msec for the same reason. */
+  Limit = (Elapsed / 1000000000ll) * NTP_CLOCK_MAX_FREQ_PPB + (((Elapsed % 1000000000ll) * NTP_CLOCK_MAX_FREQ_PPB) / 1000000000ll);
+  if ((Offset > Limit) || (Offset < -Limit)) return;
+
+  FrequencyError = (Offset * 1000000ll) / (Elapsed / 1000ll);
+  if ((FrequencyError > NTP_CLOCK_MAX_FREQ_PPB) || (FrequencyError < -NTP_CLOCK_MAX_FREQ_PPB)) return;
+
+  Clock->FrequencyPpb -= (INT32)(FrequencyError / Gain);
+  if (Clock->FrequencyPpb >  NTP_CLOCK_MAX_FREQ_PPB) Clock->FrequencyPpb =  NTP_CLOCK_MAX_FREQ_PPB;
+  if (Clock->FrequencyPpb < -NTP_CLOCK_MAX_FREQ_PPB) Clock->FrequencyPpb = -NTP_CLOCK_MAX_FREQ_PPB;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_clock_get_local_us() */
+/* ============================================================================================================================================================= *\
+                                                 Return the Pico timer value corresponding to a UTC time (in usec since 01-JAN-1970).
+                        NOTE: Exact inverse of ntp_clock_get_utc_us(): return the first Pico timer value at which ntp_clock_get_utc_us() reaches
+                              UTCTime, so that an event scheduled at UTCTime never fires early. A first-order estimate is refined against
+                              ntp_clock_get_utc_us(), whose slope is always close to 1 (a few steps at most).
+\* ============================================================================================================================================================= */
+UINT64 ntp_clock_get_local_us(struct ntp_clock *Clock, INT64 UTCTime)
+{
+  UINT8 Loop1UInt8;
+
+  INT64 Elapsed;
+  INT64 Error;
+
+  UINT64 LocalTime;
+
+
+  if (Clock->FlagValid == FLAG_OFF) return 0ll;
+
+  Elapsed  = UTCTime - Clock->BaseUTC;
+  Elapsed += (Elapsed * Clock->FrequencyPpb) / 1000000000ll;
+  Elapsed -= ntp_clock_get_slew(Clock, Elapsed);
+  LocalTime = Clock->BaseLocal + Elapsed;
+
+  /* Refine the estimate (rounding of the frequency and slew corrections). */
+  for (Loop1UInt8 = 0; Loop1UInt8 < 4; ++Loop1UInt8)
+  {
+    Error = UTCTime - ntp_clock_get_utc_us(Clock, LocalTime);
+    if (Error == 0) break;
+    LocalTime += Error;
+  }
+
+  /* First Pico timer value reaching UTCTime (ntp_clock_get_utc_us() may hold a value for one usec or skip one). */
+  for (Loop1UInt8 = 0; (Loop1UInt8 < 8) && (ntp_clock_get_utc_us(Clock, LocalTime) < UTCTime); ++Loop1UInt8)
+    ++LocalTime;
+  for (Loop1UInt8 = 0; (Loop1UInt8 < 8) && (ntp_clock_get_utc_us(Clock, LocalTime - 1) >= UTCTime); ++Loop1UInt8)
+    --LocalTime;
+
+  return LocalTime;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_clock_get_pending() */
+/* ============================================================================================================================================================= *\
+                                               Return the part of the pending offset (in usec) still to be slewed at a Pico timer value.
+\* ============================================================================================================================================================= */
+INT64 ntp_clock_get_pending(struct ntp_clock *Clock, UINT64 LocalTime)
+{
+  if (Clock->FlagValid == FLAG_OFF) return 0ll;
+
+  return Clock->PendingOffset - ntp_clock_get_slew(Clock, (INT64)(LocalTime - Clock->BaseLocal));
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_clock_get_slew() */
+/* ============================================================================================================================================================= *\
+                                                 Return the part of the pending offset already slewed after the elapsed time given.
+                           NOTE: The pending offset is slewed at a maximum of NTP_CLOCK_MAX_SLEW_PPM so that the clock never jumps between two samples.
+\* ============================================================================================================================================================= */
+static INT64 ntp_clock_get_slew(struct ntp_clock *Clock, INT64 Elapsed)
+{
+  INT64 MaxSlew;
+  INT64 Slew;
+
+
+  MaxSlew = (Elapsed * NTP_CLOCK_MAX_SLEW_PPM) / 1000000ll;
+  if (MaxSlew < 0) MaxSlew = -MaxSlew;
+
+  Slew = Clock->PendingOffset;
+  if (Slew >  MaxSlew) Slew =  MaxSlew;
+  if (Slew < -MaxSlew) Slew = -MaxSlew;
+
+  return Slew;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_clock_get_utc_us() */
+/* ============================================================================================================================================================= *\
+                                                 Return UTC time (in usec since 01-JAN-1970) corresponding to a Pico timer value.
+                  NOTE: Monotonic only between two steps: while an offset is slewed, the time returned always moves forward, but a sample stepping
+                        the clock (offset larger than NTP_CLOCK_STEP_US) or a leap second folded into BaseUTC may move it backward. Pico-NTP-Module
+                        reports both to the observers of NTP_NOTIFY_STEP.
+\* ============================================================================================================================================================= */
+INT64 ntp_clock_get_utc_us(struct ntp_clock *Clock, UINT64 LocalTime)
+{
+  INT64 Elapsed;
+  INT64 UTCTime;
+
+
+  if (Clock->FlagValid == FLAG_OFF) return 0ll;
+
+  /* Elapsed time since last update, corrected for the frequency error of the crystal. */
+  Elapsed = (INT64)(LocalTime - Clock->BaseLocal);
+  UTCTime = Clock->BaseUTC + Elapsed - ((Elapsed * Clock->FrequencyPpb) / 1000000000ll);
+
+  return UTCTime + ntp_clock_get_slew(Clock, Elapsed);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_clock_init() */
+/* ============================================================================================================================================================= *\
+                                                                    Initialize a disciplined clock.
+\* ============================================================================================================================================================= */
+void ntp_clock_init(struct ntp_clock *Clock)
+{
+  Clock->FlagValid     = FLAG_OFF;
+  Clock->Source        = NTP_SOURCE_NONE;
+  Clock->BaseLocal     = 0ll;
+  Clock->BaseUTC       = 0ll;
+  Clock->PendingOffset = 0ll;
+  Clock->FrequencyPpb  = 0l;
+  Clock->LastOffset    = 0ll;
+  Clock->LastSample    = 0ll;
+  Clock->SampleCount   = 0l;
+  Clock->StepCount     = 0l;
+  Clock->Tempco        = NULL;
+  Clock->Adev          = NULL;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_clock_sample() */
+/* ============================================================================================================================================================= *\
+                                     Feed a new sample (Pico timer value and corresponding UTC time) to the disciplined clock.
+                   NOTE: Network samples and PPS samples go through the same estimator. Large offsets step the clock, small ones are slewed. The
+                         offset accumulated since the last sample (measured against the clock once the pending offset is slewed) refines the
+                         frequency estimate: fully when the clock is stepped, so that a long sync interval stops stepping on the next sample, as
+                         long as the estimate is a plausible crystal error (a larger one is a time jump). Return NTP_CLOCK_STEPPED or NTP_CLOCK_SLEWED.
+\* ============================================================================================================================================================= */
+UINT8 ntp_clock_sample(struct ntp_clock *Clock, UINT64 LocalTime, INT64 UTCTime, UINT8 Source)
+{
+  INT64 Elapsed;
+  INT64 Offset;
+  INT64 Predicted;
+  INT64 Target;
+
+
+  /* Current clock time, and clock time once the pending offset is slewed. */
+  Elapsed   = (INT64)(LocalTime - Clock->BaseLocal);
+  Predicted = ntp_clock_get_utc_us(Clock, LocalTime);
+  Target    = Clock->BaseUTC + Elapsed - ((Elapsed * Clock->FrequencyPpb) / 1000000000ll) + Clock->PendingOffset;
+  Offset    = UTCTime - Target;
+
+  ++Clock->SampleCount;
+
+  /* Time read from the holdover clock is not accurate enough to measure the frequency of the crystal. */
+  if ((Clock->Tempco != NULL) && (Source != NTP_SOURCE_HOLDOVER)) ntp_tempco_sample(Clock->Tempco, LocalTime, UTCTime);
+
+  /* Samples of different sources have different noise: only one of them is analyzed. */
+  if ((Clock->Adev != NULL) && (Source == Clock->Adev->Source)) ntp_adev_sample(Clock->Adev, LocalTime, UTCTime);
+
+
+  /* First sample or offset too large: step the clock. */
+  if ((Clock->FlagValid == FLAG_OFF) || ((UTCTime - Predicted) > NTP_CLOCK_STEP_US) || ((UTCTime - Predicted) < -NTP_CLOCK_STEP_US))
+  {
+    if (Clock->FlagValid == FLAG_ON)
+    {
+      ++Clock->StepCount;
+      ntp_clock_frequency(Clock, LocalTime, Offset, Source, 1);
+    }
+
+    Clock->FlagValid     = FLAG_ON;
+    Clock->Source        = Source;
+    Clock->BaseLocal     = LocalTime;
+    Clock->BaseUTC       = UTCTime;
+    Clock->PendingOffset = 0ll;
+    Clock->LastOffset    = Offset;
+    Clock->LastSample    = LocalTime;
+
+    return NTP_CLOCK_STEPPED;
+  }
+
+
+  /* Offset accumulated since the last sample is mostly due to the frequency error of the crystal. */
+  ntp_clock_frequency(Clock, LocalTime, Offset, Source, NTP_CLOCK_FREQ_GAIN);
+
+
+  /* Move the base to the current sample. Whatever was still pending, the clock is now slewed toward the time of this sample. */
+  Clock->Source        = Source;
+  Clock->PendingOffset = UTCTime - Predicted;
+  Clock->BaseLocal     = LocalTime;
+  Clock->BaseUTC       = Predicted;
+  Clock->LastOffset    = Offset;
+  Clock->LastSample    = LocalTime;
+
+  return NTP_CLOCK_SLEWED;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_clock_sample_late() */
+/* ============================================================================================================================================================= *\
+                                         Feed a sample measured earlier than the current Pico timer value to the disciplined clock.
+                NOTE: Used for NTP interleaved mode, where an exchange is completed by the next reply. The offset is measured against the clock
+                      as it will be once the offset still pending is slewed, and is slewed from CurrentTime on (with the frequency change since
+                      LocalTime), so that the clock doesn't jump when the sample arrives. Return NTP_CLOCK_STEPPED or NTP_CLOCK_SLEWED.
+\* ============================================================================================================================================================= */
+UINT8 ntp_clock_sample_late(struct ntp_clock *Clock, UINT64 LocalTime, INT64 UTCTime, UINT8 Source, UINT64 CurrentTime)
+{
+  INT64 Before;
+  INT64 Elapsed;
+  INT64 Offset;
+  INT64 Target;
+
+
+  if (Clock->FlagValid == FLAG_OFF) return ntp_clock_sample(Clock, LocalTime, UTCTime, Source);
+
+  /* Clock time at LocalTime once the pending offset is slewed. */
+  Elapsed = (INT64)(LocalTime - Clock->BaseLocal);
+  Target  = Clock->BaseUTC + Elapsed - ((Elapsed * Clock->FrequencyPpb) / 1000000000ll) + Clock->PendingOffset;
+  Offset  = UTCTime - Target;
+
+  /* Offset too large: step the clock, as ntp_clock_sample() does. */
+  if ((Offset > NTP_CLOCK_STEP_US) || (Offset < -NTP_CLOCK_STEP_US)) return ntp_clock_sample(Clock, LocalTime, UTCTime, Source);
+
+  ++Clock->SampleCount;
+
+  if ((Clock->Tempco != NULL) && (Source != NTP_SOURCE_HOLDOVER)) ntp_tempco_sample(Clock->Tempco, LocalTime, UTCTime);
+  if ((Clock->Adev != NULL) && (Source == Clock->Adev->Source)) ntp_adev_sample(Clock->Adev, LocalTime, UTCTime);
+
+  Before = ntp_clock_get_utc_us(Clock, CurrentTime);
+
+
+  /* Offset accumulated since the last sample is mostly due to the frequency error of the crystal. */
+  ntp_clock_frequency(Clock, LocalTime, Offset, Source, NTP_CLOCK_FREQ_GAIN);
+  Clock->Source = Source;
+
+
+  /* Move the base to the current time, keeping the current clock time: the offset and the frequency change since LocalTime are slewed from there. */
+  Elapsed = (INT64)(CurrentTime - LocalTime);
+  Target  = UTCTime + Elapsed - ((Elapsed * Clock->FrequencyPpb) / 1000000000ll);
+
+  Clock->PendingOffset = Target - Before;
+  Clock->BaseLocal     = CurrentTime;
+  Clock->BaseUTC       = Before;
+  Clock->LastOffset    = Offset;
+  Clock->LastSample    = LocalTime;
+
+  return NTP_CLOCK_SLEWED;
+}
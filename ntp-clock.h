@@ -0,0 +1,81 @@
+/* ============================================================================================================================================================= *\
+   ntp-clock.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.30
+
+   Disciplined clock used by Pico-NTP-Module. Maps the Pico's microsecond timer (time_us_64()) onto UTC time and estimates
+   the frequency error of the Pico's crystal from the samples it receives (NTP server replies or PPS edges).
+   This file doesn't depend on the Pico SDK so that it may also be compiled on a host computer.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+               1.10 - Optional temperature model of the crystal trained with each sample (see ntp-tempco.h), and frequency feed-forward.
+               1.20 - Optional frequency stability analyzer fed with the samples of one source (see ntp-adev.h).
+               1.30 - Samples measured earlier than the current time (NTP interleaved mode), slewed from the current time on.
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_CLOCK_H
+#define _NTP_CLOCK_H
+
+#include "baseline.h"
+#include "ntp-adev.h"
+#include "ntp-tempco.h"
+
+
+#define NTP_SOURCE_NONE            0   // no sample received so far.
+#define NTP_SOURCE_NETWORK         1   // sample computed from an NTP server reply.
+#define NTP_SOURCE_PPS             2   // sample from a pulse-per-second edge (GPS receiver).
+#define NTP_SOURCE_HOLDOVER        3   // time read from an external holdover clock at power-up (see ntp-holdover.h).
+
+#define NTP_CLOCK_STEP_US     128000   // offsets larger than this (in usec) are corrected by stepping the clock instead of slewing it.
+#define NTP_CLOCK_MAX_SLEW_PPM   500   // maximum rate at which an offset is slewed (in parts per million).
+#define NTP_CLOCK_MAX_FREQ_PPB 500000  // frequency correction limit (in parts per billion).
+#define NTP_CLOCK_FREQ_GAIN        4   // only a fraction (1 / NTP_CLOCK_FREQ_GAIN) of each new frequency estimate is applied.
+#define NTP_CLOCK_MIN_INTERVAL 500000  // minimum interval between two samples (in usec) to update the frequency estimate.
+
+#define NTP_CLOCK_SLEWED           0   // ntp_clock_sample() return code: offset will be slewed.
+#define NTP_CLOCK_STEPPED          1   // ntp_clock_sample() return code: clock has been stepped.
+
+
+struct ntp_clock
+{
+  UINT8  FlagValid;              // flag indicating that the clock has been set at least once.
+  UINT8  Source;                 // source of the last sample (NTP_SOURCE_xxx).
+  UINT64 BaseLocal;              // Pico timer (in usec since boot) at the last clock update.
+  INT64  BaseUTC;                // UTC time (in usec since 01-JAN-1970) corresponding to BaseLocal.
+  INT64  PendingOffset;          // part of the last offsets (in usec) that is still to be slewed.
+  INT32  FrequencyPpb;           // estimated frequency error of the Pico's crystal (in parts per billion, positive when Pico runs fast).
+  INT64  LastOffset;             // last offset measured (in usec).
+  UINT64 LastSample;             // Pico timer (in usec since boot) of the last sample.
+  UINT32 SampleCount;            // total number of samples received.
+  UINT32 StepCount;              // total number of clock steps.
+  struct ntp_tempco *Tempco;     // temperature model of the crystal trained with each sample (NULL if none).
+  struct ntp_adev *Adev;         // frequency stability analyzer fed with each sample of its source (NULL if none).
+};
+
+
+/* Change the frequency correction from the Pico timer value given on, without changing current time. */
+void ntp_clock_adjust_frequency(struct ntp_clock *Clock, UINT64 LocalTime, INT32 DeltaPpb);
+
+/* Return the Pico timer value corresponding to a UTC time (in usec since 01-JAN-1970). */
+UINT64 ntp_clock_get_local_us(struct ntp_clock *Clock, INT64 UTCTime);
+
+/* Return the part of the pending offset (in usec) still to be slewed at a Pico timer value. */
+INT64 ntp_clock_get_pending(struct ntp_clock *Clock, UINT64 LocalTime);
+
+/* Return UTC time (in usec since 01-JAN-1970) corresponding to a Pico timer value. */
+INT64 ntp_clock_get_utc_us(struct ntp_clock *Clock, UINT64 LocalTime);
+
+/* Initialize a disciplined clock. */
+void ntp_clock_init(struct ntp_clock *Clock);
+
+/* Feed a new sample (Pico timer value and corresponding UTC time) to the disciplined clock. */
+UINT8 ntp_clock_sample(struct ntp_clock *Clock, UINT64 LocalTime, INT64 UTCTime, UINT8 Source);
+
+/* Feed a sample measured earlier than the current Pico timer value to the disciplined clock. */
+UINT8 ntp_clock_sample_late(struct ntp_clock *Clock, UINT64 LocalTime, INT64 UTCTime, UINT8 Source, UINT64 CurrentTime);
+
+#endif  // _NTP_CLOCK_H
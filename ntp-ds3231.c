@@ -0,0 +1,273 @@
+/* ============================================================================================================================================================= *\
+   ntp-ds3231.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   DS3231 holdover clock driver (see ntp-ds3231.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include "ntp-ds3231.h"
+#include "Pico-NTP-Module.h"
+#include <time.h>
+
+
+
+/* Convert a BCD value to binary. */
+static UINT8 ntp_ds3231_from_bcd(UINT8 Value);
+
+/* Read the DS3231 time. */
+static UINT8 ntp_ds3231_read(void *Context, INT64 *UTCTime);
+
+/* Read consecutive DS3231 registers. */
+static UINT8 ntp_ds3231_read_registers(struct ntp_ds3231 *Ds3231, UINT8 Register, UINT8 *Buffer, UINT8 Length);
+
+/* Convert a binary value to BCD. */
+static UINT8 ntp_ds3231_to_bcd(UINT8 Value);
+
+/* Compensate a frequency error of the DS3231 through its aging offset register. */
+static UINT8 ntp_ds3231_trim(void *Context, INT32 FrequencyPpb);
+
+/* Set the DS3231 time. */
+static UINT8 ntp_ds3231_write(void *Context, INT64 UTCTime);
+
+/* Write consecutive DS3231 registers. */
+static UINT8 ntp_ds3231_write_registers(struct ntp_ds3231 *Ds3231, UINT8 Register, const UINT8 *Buffer, UINT8 Length);
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ds3231_from_bcd() */
+/* ============================================================================================================================================================= *\
+                                                                         Convert a BCD value to binary.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_ds3231_from_bcd(UINT8 Value)
+{
+  return ((Value >> 4) * 10) + (Value & 0x0F);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ds3231_init() */
+/* ============================================================================================================================================================= *\
+                                                      Initialize a DS3231 driver and the holdover interface pointing to it.
+\* ============================================================================================================================================================= */
+void ntp_ds3231_init(struct ntp_ds3231 *Ds3231, struct ntp_holdover *Holdover, i2c_inst_t *I2c)
+{
+  Ds3231->I2c       = I2c;
+  Ds3231->Address   = DS3231_ADDRESS;
+
+  Holdover->Name    = "DS3231";
+  Holdover->Context = Ds3231;
+  Holdover->Read    = ntp_ds3231_read;
+  Holdover->Write   = ntp_ds3231_write;
+  Holdover->Trim    = ntp_ds3231_trim;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ds3231_read() */
+/* ============================================================================================================================================================= *\
+                                                                             Read the DS3231 time.
+                   NOTE: The DS3231 only has a one-second resolution. The seconds register is polled until it changes (up to one second) so that
+                         the time returned is accurate to a few hundred usec. Return an error if the DS3231 oscillator has stopped since last write.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_ds3231_read(void *Context, INT64 *UTCTime)
+{
+  UINT8 Registers[7];
+  UINT8 Seconds;
+  UINT8 Status;
+
+  UINT64 Edge;
+  UINT64 Start;
+
+  struct tm TmTime;
+
+  struct ntp_ds3231 *Ds3231 = Context;
+
+
+  if (ntp_ds3231_read_registers(Ds3231, DS3231_STATUS, &Status, 1)) return 1;
+  if (Status & DS3231_STATUS_OSF) return 1;
+
+  /* Wait for the beginning of next DS3231 second. */
+  if (ntp_ds3231_read_registers(Ds3231, DS3231_SECONDS, &Seconds, 1)) return 1;
+  Start = time_us_64();
+  do
+  {
+    if (ntp_ds3231_read_registers(Ds3231, DS3231_SECONDS, &Registers[0], 1)) return 1;
+    if ((time_us_64() - Start) > DS3231_TIMEOUT) return 1;
+  } while (Registers[0] == Seconds);
+  Edge = time_us_64();
+
+  if (ntp_ds3231_read_registers(Ds3231, DS3231_SECONDS, Registers, sizeof(Registers))) return 1;
+
+  TmTime.tm_sec   = ntp_ds3231_from_bcd(Registers[0] & 0x7F);
+  TmTime.tm_min   = ntp_ds3231_from_bcd(Registers[1] & 0x7F);
+  TmTime.tm_hour  = ntp_ds3231_from_bcd(Registers[2] & 0x3F);
+  TmTime.tm_mday  = ntp_ds3231_from_bcd(Registers[4] & 0x3F);
+  TmTime.tm_mon   = ntp_ds3231_from_bcd(Registers[5] & 0x1F) - 1;
+  TmTime.tm_year  = ntp_ds3231_from_bcd(Registers[6]) + 100 + ((Registers[5] & DS3231_MONTH_CENTURY) ? 100 : 0);
+  TmTime.tm_isdst = 0;
+
+  *UTCTime = ((INT64)ntp_convert_tm_to_unix(&TmTime) * 1000000ll) + (INT64)(time_us_64() - Edge);
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ds3231_read_registers() */
+/* ============================================================================================================================================================= *\
+                                                                      Read consecutive DS3231 registers.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_ds3231_read_registers(struct ntp_ds3231 *Ds3231, UINT8 Register, UINT8 *Buffer, UINT8 Length)
+{
+  if (i2c_write_blocking(Ds3231->I2c, Ds3231->Address, &Register, 1, true) != 1) return 1;
+  if (i2c_read_blocking(Ds3231->I2c, Ds3231->Address, Buffer, Length, false) != Length) return 1;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ds3231_to_bcd() */
+/* ============================================================================================================================================================= *\
+                                                                         Convert a binary value to BCD.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_ds3231_to_bcd(UINT8 Value)
+{
+  return ((Value / 10) << 4) | (Value % 10);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ds3231_trim() */
+/* ============================================================================================================================================================= *\
+                                               Compensate a frequency error of the DS3231 through its aging offset register.
+                            NOTE: The DS3231 already compensates for temperature, the aging offset corrects the remaining error of its crystal.
+                                  A temperature conversion is started so that the new aging offset is applied right away.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_ds3231_trim(void *Context, INT32 FrequencyPpb)
+{
+  UINT8 Control;
+
+  INT16 Aging;
+
+  INT8 Register;
+
+  struct ntp_ds3231 *Ds3231 = Context;
+
+
+  if (ntp_ds3231_read_registers(Ds3231, DS3231_AGING, (UINT8 *)&Register, 1)) return 1;
+
+  /* Round to the nearest aging offset step. */
+  if (FrequencyPpb >= 0)
+    Aging = Register + ((FrequencyPpb + (DS3231_AGING_PPB / 2)) / DS3231_AGING_PPB);
+  else
+    Aging = Register + ((FrequencyPpb - (DS3231_AGING_PPB / 2)) / DS3231_AGING_PPB);
+  if (Aging >  127) Aging =  127;
+  if (Aging < -128) Aging = -128;
+  Register = (INT8)Aging;
+
+  if (ntp_ds3231_write_registers(Ds3231, DS3231_AGING, (UINT8 *)&Register, 1)) return 1;
+
+  if (ntp_ds3231_read_registers(Ds3231, DS3231_CONTROL, &Control, 1)) return 1;
+  Control |= DS3231_CONTROL_CONV;
+  if (ntp_ds3231_write_registers(Ds3231, DS3231_CONTROL, &Control, 1)) return 1;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ds3231_write() */
+/* ============================================================================================================================================================= *\
+                                                                            Set the DS3231 time.
+                       NOTE: The DS3231 restarts a full second when its seconds register is written, so this must be called on a second boundary.
+                             The oscillator stop flag is cleared afterward.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_ds3231_write(void *Context, INT64 UTCTime)
+{
+  UINT8 Registers[7];
+  UINT8 Status;
+
+  time_t Seconds;
+
+  struct tm TmTime;
+
+  struct ntp_ds3231 *Ds3231 = Context;
+
+
+  Seconds = (time_t)(UTCTime / 1000000ll);
+  gmtime_r(&Seconds, &TmTime);
+
+  Registers[0] = ntp_ds3231_to_bcd(TmTime.tm_sec);
+  Registers[1] = ntp_ds3231_to_bcd(TmTime.tm_min);
+  Registers[2] = ntp_ds3231_to_bcd(TmTime.tm_hour);     // 24-hour format.
+  Registers[3] = TmTime.tm_wday + 1;
+  Registers[4] = ntp_ds3231_to_bcd(TmTime.tm_mday);
+  Registers[5] = ntp_ds3231_to_bcd(TmTime.tm_mon + 1) | ((TmTime.tm_year >= 200) ? DS3231_MONTH_CENTURY : 0);
+  Registers[6] = ntp_ds3231_to_bcd(TmTime.tm_year % 100);
+
+  if (ntp_ds3231_write_registers(Ds3231, DS3231_SECONDS, Registers, sizeof(Registers))) return 1;
+
+  if (ntp_ds3231_read_registers(Ds3231, DS3231_STATUS, &Status, 1)) return 1;
+  Status &= ~DS3231_STATUS_OSF;
+  if (ntp_ds3231_write_registers(Ds3231, DS3231_STATUS, &Status, 1)) return 1;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ds3231_write_registers() */
+/* ============================================================================================================================================================= *\
+                                                                     Write consecutive DS3231 registers.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_ds3231_write_registers(struct ntp_ds3231 *Ds3231, UINT8 Register, const UINT8 *Buffer, UINT8 Length)
+{
+  UINT8 Loop1UInt8;
+  UINT8 Packet[8];
+
+
+  if (Length > (sizeof(Packet) - 1)) return 1;
+
+  Packet[0] = Register;
+  for (Loop1UInt8 = 0; Loop1UInt8 < Length; ++Loop1UInt8)
+    Packet[Loop1UInt8 + 1] = Buffer[Loop1UInt8];
+
+  if (i2c_write_blocking(Ds3231->I2c, Ds3231->Address, Packet, Length + 1, false) != (Length + 1)) return 1;
+
+  return 0;
+}
@@ -0,0 +1,49 @@
+/* ============================================================================================================================================================= *\
+   ntp-ds3231.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.00
+
+   DS3231 (temperature-compensated real-time clock) driver used as a holdover clock by Pico-NTP-Module (see ntp-holdover.h).
+   The DS3231 always keeps UTC time in 24-hour format. The I2C bus must be initialized by the caller.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_DS3231_H
+#define _NTP_DS3231_H
+
+#include "baseline.h"
+#include "hardware/i2c.h"
+#include "ntp-holdover.h"
+
+
+#define DS3231_ADDRESS           0x68  // DS3231 I2C address.
+
+#define DS3231_SECONDS           0x00  // first time-keeping register (seconds, minutes, hours, day, date, month / century, year).
+#define DS3231_CONTROL           0x0E  // control register.
+#define DS3231_STATUS            0x0F  // control / status register.
+#define DS3231_AGING             0x10  // aging offset register (signed, positive values slow the oscillator down).
+
+#define DS3231_CONTROL_CONV      0x20  // start a temperature conversion (also applies a new aging offset).
+#define DS3231_STATUS_OSF        0x80  // oscillator stop flag: time-keeping registers are not valid.
+#define DS3231_MONTH_CENTURY     0x80  // century bit of the month register.
+
+#define DS3231_AGING_PPB          100  // approximate frequency change (in ppb) for one LSB of the aging offset register.
+#define DS3231_TIMEOUT        1100000  // maximum time (in usec) to wait for the seconds register to change.
+
+
+struct ntp_ds3231
+{
+  i2c_inst_t *I2c;               // I2C bus where the DS3231 is connected.
+  UINT8       Address;           // I2C address of the DS3231.
+};
+
+
+/* Initialize a DS3231 driver and the holdover interface pointing to it. */
+void ntp_ds3231_init(struct ntp_ds3231 *Ds3231, struct ntp_holdover *Holdover, i2c_inst_t *I2c);
+
+#endif  // _NTP_DS3231_H
@@ -0,0 +1,1275 @@
+/* ============================================================================================================================================================= *\
+   ntp-dst-test.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Host computer regression test of the daylight saving time rules and calendar computations (ntp-dst.c).
+   Calendar: every day from 01-JAN-1970 to 31-DEC-2200 is checked against the C library (gmtime_r()): day-of-week, day-of-year,
+   number of days in the month and conversion to Unix time. The throughput of the day-of-week and day-of-year computations is printed.
+   DST: the UTC times of DST start and DST end computed by ntp_dst_get_changes() for each country are compared with a reference table
+   extracted from the IANA time zone database (tzdata 2025b) with zdump, for one representative time zone per country:
+       zdump -v -c 2000,2100 Europe/Paris
+   Each row keeps the first second of the change to summer time (isdst=1) and of the change back to normal time (isdst=0) of a year.
+   Years after 2037 are the rules of the database projected forward, as they are by the firmware.
+   Only the years since the rule of DstParameters[] has been in force are listed:
+   - Chile from 2019 (except 2022, DST started one week late), Cuba, Israel from 2013, Australia, New Zealand from 2008, North America from 2007,
+   - Paraguay from 2013 to 2023 (DST abolished in October 2024, not reflected in DstParameters[] yet),
+   - Palestine is not checked (changes decided every year).
+   Timer wheel: next occurrence computed by ntp_dst_next() for daily, weekly and monthly jobs, compared with the UTC times given by the
+   time zone database (Python zoneinfo) for America/Toronto and Australia/Sydney: local time skipped when DST starts (the job runs at
+   the change), local time repeated when DST ends (the job runs once, in summer time) and monthly jobs on the 31st of the month (last
+   day of shorter months, 29-FEB of a leap year).
+
+   Build and run on a host computer (only needs a copy of baseline.h for the type definitions):
+       gcc -O2 -Wall -o ntp-dst-test ntp-dst-test.c ntp-dst.c
+       ./ntp-dst-test
+   Exit code is 0 when every day and every change matches the reference, 1 otherwise.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+                    - Walk every day from 1970 to 2200 (moved from ntp_check_date() in the firmware), DST changes checked up to 2099.
+                    - Next occurrence of timer wheel jobs across DST changes and on the 31st of the month.
+\* ============================================================================================================================================================= */
+
+#include "ntp-dst.h"
+#include <time.h>
+
+
+struct test_change
+{
+  UINT8  Country;                // DST country (index in DstParameters[]).
+  INT16  DeltaTime;              // difference (in minutes) between local normal time and UTC in the reference time zone.
+  UINT16 Year;
+  INT64  Start;                  // UTC time (in seconds since 01-JAN-1970) when DST starts.
+  INT64  End;                    // UTC time (in seconds since 01-JAN-1970) when DST ends.
+};
+
+
+struct test_job
+{
+  const char *Name;
+  UINT8  Country;                // DST country (index in DstParameters[], 0 = no DST).
+  INT16  DeltaTime;              // difference (in minutes) between local normal time and UTC.
+  UINT8  Type;                   // NTP_JOB_DAILY, NTP_JOB_WEEKLY or NTP_JOB_MONTHLY.
+  UINT8  Day;                    // day-of-week (weekly job) or day-of-month (monthly job).
+  UINT8  Hour;                   // local wall time of the job.
+  UINT8  Minute;
+  INT64  From;                   // UTC time (in seconds since 01-JAN-1970) from which the next occurrence is computed.
+  INT64  Expected;               // UTC time (in seconds since 01-JAN-1970) of the next occurrence.
+};
+
+
+
+/* Verify calendar computations for every day of the range of years given. */
+static UINT32 test_calendar(UINT16 FirstYear, UINT16 LastYear);
+
+/* Verify the next occurrence of timer wheel jobs. */
+static UINT32 test_jobs(void);
+
+/* Print a UTC time with the difference found. */
+static void test_print(const UCHAR *Label, INT64 Time, INT64 Reference);
+
+
+
+/* Timer wheel jobs (DST changes of 2026: 08-MAR and 01-NOV in Toronto, 05-APR and 04-OCT in Sydney). */
+static const struct test_job Jobs[] =
+{
+  {"spring forward, before the change", 10, -300, NTP_JOB_DAILY,    0,  1, 30, 1772884800ll, 1772951400ll},
+  {"spring forward, skipped time",      10, -300, NTP_JOB_DAILY,    0,  2, 30, 1772884800ll, 1772953200ll},
+  {"spring forward, day after",         10, -300, NTP_JOB_DAILY,    0,  2, 30, 1772953200ll, 1773037800ll},
+  {"spring forward, after the change",  10, -300, NTP_JOB_DAILY,    0,  3,  0, 1772884800ll, 1772953200ll},
+  {"fall back, repeated time",          10, -300, NTP_JOB_DAILY,    0,  1, 30, 1793448000ll, 1793511000ll},
+  {"fall back, runs once",              10, -300, NTP_JOB_DAILY,    0,  1, 30, 1793511000ll, 1793601000ll},
+  {"fall back, after the change",       10, -300, NTP_JOB_DAILY,    0,  2,  0, 1793448000ll, 1793516400ll},
+  {"weekly on Sunday",                  10, -300, NTP_JOB_WEEKLY,   0, 10,  0, 1791979200ll, 1792332000ll},
+  {"southern, skipped time",             1,  600, NTP_JOB_DAILY,    0,  2, 30, 1790985600ll, 1791043200ll},
+  {"southern, repeated time",            1,  600, NTP_JOB_DAILY,    0,  2, 30, 1775260800ll, 1775316600ll},
+  {"31st of January",                   10, -300, NTP_JOB_MONTHLY, 31, 12,  0, 1768435200ll, 1769878800ll},
+  {"31st of February",                  10, -300, NTP_JOB_MONTHLY, 31, 12,  0, 1769878800ll, 1772298000ll},
+  {"31st of March",                     10, -300, NTP_JOB_MONTHLY, 31, 12,  0, 1772298000ll, 1774972800ll},
+  {"31st of April",                     10, -300, NTP_JOB_MONTHLY, 31, 12,  0, 1774972800ll, 1777564800ll},
+  {"31st of February, leap year",       10, -300, NTP_JOB_MONTHLY, 31, 12,  0, 1832950800ll, 1835456400ll},
+  {"31st of December",                  10, -300, NTP_JOB_MONTHLY, 31, 12,  0, 1796058000ll, 1798736400ll},
+  {"no DST",                             0, -300, NTP_JOB_DAILY,    0,  2, 30, 1772884800ll, 1772955000ll},
+};
+
+
+
+/* Reference changes extracted with zdump (see header). */
+static const struct test_change Reference[] =
+{
+
+  /* Australia/Sydney (normal time UTC+10:00). */
+  { 1,  600, 2008,  1223136000ll,  1207411200ll},
+  { 1,  600, 2009,  1254585600ll,  1238860800ll},
+  { 1,  600, 2010,  1286035200ll,  1270310400ll},
+  { 1,  600, 2011,  1317484800ll,  1301760000ll},
+  { 1,  600, 2012,  1349539200ll,  1333209600ll},
+  { 1,  600, 2013,  1380988800ll,  1365264000ll},
+  { 1,  600, 2014,  1412438400ll,  1396713600ll},
+  { 1,  600, 2015,  1443888000ll,  1428163200ll},
+  { 1,  600, 2016,  1475337600ll,  1459612800ll},
+  { 1,  600, 2017,  1506787200ll,  1491062400ll},
+  { 1,  600, 2018,  1538841600ll,  1522512000ll},
+  { 1,  600, 2019,  1570291200ll,  1554566400ll},
+  { 1,  600, 2020,  1601740800ll,  1586016000ll},
+  { 1,  600, 2021,  1633190400ll,  1617465600ll},
+  { 1,  600, 2022,  1664640000ll,  1648915200ll},
+  { 1,  600, 2023,  1696089600ll,  1680364800ll},
+  { 1,  600, 2024,  1728144000ll,  1712419200ll},
+  { 1,  600, 2025,  1759593600ll,  1743868800ll},
+  { 1,  600, 2026,  1791043200ll,  1775318400ll},
+  { 1,  600, 2027,  1822492800ll,  1806768000ll},
+  { 1,  600, 2028,  1853942400ll,  1838217600ll},
+  { 1,  600, 2029,  1885996800ll,  1869667200ll},
+  { 1,  600, 2030,  1917446400ll,  1901721600ll},
+  { 1,  600, 2031,  1948896000ll,  1933171200ll},
+  { 1,  600, 2032,  1980345600ll,  1964620800ll},
+  { 1,  600, 2033,  2011795200ll,  1996070400ll},
+  { 1,  600, 2034,  2043244800ll,  2027520000ll},
+  { 1,  600, 2035,  2075299200ll,  2058969600ll},
+  { 1,  600, 2036,  2106748800ll,  2091024000ll},
+  { 1,  600, 2037,  2138198400ll,  2122473600ll},
+  { 1,  600, 2038,  2169648000ll,  2153923200ll},
+  { 1,  600, 2039,  2201097600ll,  2185372800ll},
+  { 1,  600, 2040,  2233152000ll,  2216822400ll},
+  { 1,  600, 2041,  2264601600ll,  2248876800ll},
+  { 1,  600, 2042,  2296051200ll,  2280326400ll},
+  { 1,  600, 2043,  2327500800ll,  2311776000ll},
+  { 1,  600, 2044,  2358950400ll,  2343225600ll},
+  { 1,  600, 2045,  2390400000ll,  2374675200ll},
+  { 1,  600, 2046,  2422454400ll,  2406124800ll},
+  { 1,  600, 2047,  2453904000ll,  2438179200ll},
+  { 1,  600, 2048,  2485353600ll,  2469628800ll},
+  { 1,  600, 2049,  2516803200ll,  2501078400ll},
+  { 1,  600, 2050,  2548252800ll,  2532528000ll},
+  { 1,  600, 2051,  2579702400ll,  2563977600ll},
+  { 1,  600, 2052,  2611756800ll,  2596032000ll},
+  { 1,  600, 2053,  2643206400ll,  2627481600ll},
+  { 1,  600, 2054,  2674656000ll,  2658931200ll},
+  { 1,  600, 2055,  2706105600ll,  2690380800ll},
+  { 1,  600, 2056,  2737555200ll,  2721830400ll},
+  { 1,  600, 2057,  2769609600ll,  2753280000ll},
+  { 1,  600, 2058,  2801059200ll,  2785334400ll},
+  { 1,  600, 2059,  2832508800ll,  2816784000ll},
+  { 1,  600, 2060,  2863958400ll,  2848233600ll},
+  { 1,  600, 2061,  2895408000ll,  2879683200ll},
+  { 1,  600, 2062,  2926857600ll,  2911132800ll},
+  { 1,  600, 2063,  2958912000ll,  2942582400ll},
+  { 1,  600, 2064,  2990361600ll,  2974636800ll},
+  { 1,  600, 2065,  3021811200ll,  3006086400ll},
+  { 1,  600, 2066,  3053260800ll,  3037536000ll},
+  { 1,  600, 2067,  3084710400ll,  3068985600ll},
+  { 1,  600, 2068,  3116764800ll,  3100435200ll},
+  { 1,  600, 2069,  3148214400ll,  3132489600ll},
+  { 1,  600, 2070,  3179664000ll,  3163939200ll},
+  { 1,  600, 2071,  3211113600ll,  3195388800ll},
+  { 1,  600, 2072,  3242563200ll,  3226838400ll},
+  { 1,  600, 2073,  3274012800ll,  3258288000ll},
+  { 1,  600, 2074,  3306067200ll,  3289737600ll},
+  { 1,  600, 2075,  3337516800ll,  3321792000ll},
+  { 1,  600, 2076,  3368966400ll,  3353241600ll},
+  { 1,  600, 2077,  3400416000ll,  3384691200ll},
+  { 1,  600, 2078,  3431865600ll,  3416140800ll},
+  { 1,  600, 2079,  3463315200ll,  3447590400ll},
+  { 1,  600, 2080,  3495369600ll,  3479644800ll},
+  { 1,  600, 2081,  3526819200ll,  3511094400ll},
+  { 1,  600, 2082,  3558268800ll,  3542544000ll},
+  { 1,  600, 2083,  3589718400ll,  3573993600ll},
+  { 1,  600, 2084,  3621168000ll,  3605443200ll},
+  { 1,  600, 2085,  3653222400ll,  3636892800ll},
+  { 1,  600, 2086,  3684672000ll,  3668947200ll},
+  { 1,  600, 2087,  3716121600ll,  3700396800ll},
+  { 1,  600, 2088,  3747571200ll,  3731846400ll},
+  { 1,  600, 2089,  3779020800ll,  3763296000ll},
+  { 1,  600, 2090,  3810470400ll,  3794745600ll},
+  { 1,  600, 2091,  3842524800ll,  3826195200ll},
+  { 1,  600, 2092,  3873974400ll,  3858249600ll},
+  { 1,  600, 2093,  3905424000ll,  3889699200ll},
+  { 1,  600, 2094,  3936873600ll,  3921148800ll},
+  { 1,  600, 2095,  3968323200ll,  3952598400ll},
+  { 1,  600, 2096,  4000377600ll,  3984048000ll},
+  { 1,  600, 2097,  4031827200ll,  4016102400ll},
+  { 1,  600, 2098,  4063276800ll,  4047552000ll},
+  { 1,  600, 2099,  4094726400ll,  4079001600ll},
+
+  /* Australia/Lord_Howe (normal time UTC+10:30). */
+  { 2,  630, 2008,  1223134200ll,  1207407600ll},
+  { 2,  630, 2009,  1254583800ll,  1238857200ll},
+  { 2,  630, 2010,  1286033400ll,  1270306800ll},
+  { 2,  630, 2011,  1317483000ll,  1301756400ll},
+  { 2,  630, 2012,  1349537400ll,  1333206000ll},
+  { 2,  630, 2013,  1380987000ll,  1365260400ll},
+  { 2,  630, 2014,  1412436600ll,  1396710000ll},
+  { 2,  630, 2015,  1443886200ll,  1428159600ll},
+  { 2,  630, 2016,  1475335800ll,  1459609200ll},
+  { 2,  630, 2017,  1506785400ll,  1491058800ll},
+  { 2,  630, 2018,  1538839800ll,  1522508400ll},
+  { 2,  630, 2019,  1570289400ll,  1554562800ll},
+  { 2,  630, 2020,  1601739000ll,  1586012400ll},
+  { 2,  630, 2021,  1633188600ll,  1617462000ll},
+  { 2,  630, 2022,  1664638200ll,  1648911600ll},
+  { 2,  630, 2023,  1696087800ll,  1680361200ll},
+  { 2,  630, 2024,  1728142200ll,  1712415600ll},
+  { 2,  630, 2025,  1759591800ll,  1743865200ll},
+  { 2,  630, 2026,  1791041400ll,  1775314800ll},
+  { 2,  630, 2027,  1822491000ll,  1806764400ll},
+  { 2,  630, 2028,  1853940600ll,  1838214000ll},
+  { 2,  630, 2029,  1885995000ll,  1869663600ll},
+  { 2,  630, 2030,  1917444600ll,  1901718000ll},
+  { 2,  630, 2031,  1948894200ll,  1933167600ll},
+  { 2,  630, 2032,  1980343800ll,  1964617200ll},
+  { 2,  630, 2033,  2011793400ll,  1996066800ll},
+  { 2,  630, 2034,  2043243000ll,  2027516400ll},
+  { 2,  630, 2035,  2075297400ll,  2058966000ll},
+  { 2,  630, 2036,  2106747000ll,  2091020400ll},
+  { 2,  630, 2037,  2138196600ll,  2122470000ll},
+  { 2,  630, 2038,  2169646200ll,  2153919600ll},
+  { 2,  630, 2039,  2201095800ll,  2185369200ll},
+  { 2,  630, 2040,  2233150200ll,  2216818800ll},
+  { 2,  630, 2041,  2264599800ll,  2248873200ll},
+  { 2,  630, 2042,  2296049400ll,  2280322800ll},
+  { 2,  630, 2043,  2327499000ll,  2311772400ll},
+  { 2,  630, 2044,  2358948600ll,  2343222000ll},
+  { 2,  630, 2045,  2390398200ll,  2374671600ll},
+  { 2,  630, 2046,  2422452600ll,  2406121200ll},
+  { 2,  630, 2047,  2453902200ll,  2438175600ll},
+  { 2,  630, 2048,  2485351800ll,  2469625200ll},
+  { 2,  630, 2049,  2516801400ll,  2501074800ll},
+  { 2,  630, 2050,  2548251000ll,  2532524400ll},
+  { 2,  630, 2051,  2579700600ll,  2563974000ll},
+  { 2,  630, 2052,  2611755000ll,  2596028400ll},
+  { 2,  630, 2053,  2643204600ll,  2627478000ll},
+  { 2,  630, 2054,  2674654200ll,  2658927600ll},
+  { 2,  630, 2055,  2706103800ll,  2690377200ll},
+  { 2,  630, 2056,  2737553400ll,  2721826800ll},
+  { 2,  630, 2057,  2769607800ll,  2753276400ll},
+  { 2,  630, 2058,  2801057400ll,  2785330800ll},
+  { 2,  630, 2059,  2832507000ll,  2816780400ll},
+  { 2,  630, 2060,  2863956600ll,  2848230000ll},
+  { 2,  630, 2061,  2895406200ll,  2879679600ll},
+  { 2,  630, 2062,  2926855800ll,  2911129200ll},
+  { 2,  630, 2063,  2958910200ll,  2942578800ll},
+  { 2,  630, 2064,  2990359800ll,  2974633200ll},
+  { 2,  630, 2065,  3021809400ll,  3006082800ll},
+  { 2,  630, 2066,  3053259000ll,  3037532400ll},
+  { 2,  630, 2067,  3084708600ll,  3068982000ll},
+  { 2,  630, 2068,  3116763000ll,  3100431600ll},
+  { 2,  630, 2069,  3148212600ll,  3132486000ll},
+  { 2,  630, 2070,  3179662200ll,  3163935600ll},
+  { 2,  630, 2071,  3211111800ll,  3195385200ll},
+  { 2,  630, 2072,  3242561400ll,  3226834800ll},
+  { 2,  630, 2073,  3274011000ll,  3258284400ll},
+  { 2,  630, 2074,  3306065400ll,  3289734000ll},
+  { 2,  630, 2075,  3337515000ll,  3321788400ll},
+  { 2,  630, 2076,  3368964600ll,  3353238000ll},
+  { 2,  630, 2077,  3400414200ll,  3384687600ll},
+  { 2,  630, 2078,  3431863800ll,  3416137200ll},
+  { 2,  630, 2079,  3463313400ll,  3447586800ll},
+  { 2,  630, 2080,  3495367800ll,  3479641200ll},
+  { 2,  630, 2081,  3526817400ll,  3511090800ll},
+  { 2,  630, 2082,  3558267000ll,  3542540400ll},
+  { 2,  630, 2083,  3589716600ll,  3573990000ll},
+  { 2,  630, 2084,  3621166200ll,  3605439600ll},
+  { 2,  630, 2085,  3653220600ll,  3636889200ll},
+  { 2,  630, 2086,  3684670200ll,  3668943600ll},
+  { 2,  630, 2087,  3716119800ll,  3700393200ll},
+  { 2,  630, 2088,  3747569400ll,  3731842800ll},
+  { 2,  630, 2089,  3779019000ll,  3763292400ll},
+  { 2,  630, 2090,  3810468600ll,  3794742000ll},
+  { 2,  630, 2091,  3842523000ll,  3826191600ll},
+  { 2,  630, 2092,  3873972600ll,  3858246000ll},
+  { 2,  630, 2093,  3905422200ll,  3889695600ll},
+  { 2,  630, 2094,  3936871800ll,  3921145200ll},
+  { 2,  630, 2095,  3968321400ll,  3952594800ll},
+  { 2,  630, 2096,  4000375800ll,  3984044400ll},
+  { 2,  630, 2097,  4031825400ll,  4016098800ll},
+  { 2,  630, 2098,  4063275000ll,  4047548400ll},
+  { 2,  630, 2099,  4094724600ll,  4078998000ll},
+
+  /* America/Santiago (normal time UTC-4:00). */
+  { 3, -240, 2019,  1567915200ll,  1554606000ll},
+  { 3, -240, 2020,  1599364800ll,  1586055600ll},
+  { 3, -240, 2021,  1630814400ll,  1617505200ll},
+  { 3, -240, 2023,  1693713600ll,  1680404400ll},
+  { 3, -240, 2024,  1725768000ll,  1712458800ll},
+  { 3, -240, 2025,  1757217600ll,  1743908400ll},
+  { 3, -240, 2026,  1788667200ll,  1775358000ll},
+  { 3, -240, 2027,  1820116800ll,  1806807600ll},
+  { 3, -240, 2028,  1851566400ll,  1838257200ll},
+  { 3, -240, 2029,  1883016000ll,  1870311600ll},
+  { 3, -240, 2030,  1915070400ll,  1901761200ll},
+  { 3, -240, 2031,  1946520000ll,  1933210800ll},
+  { 3, -240, 2032,  1977969600ll,  1964660400ll},
+  { 3, -240, 2033,  2009419200ll,  1996110000ll},
+  { 3, -240, 2034,  2040868800ll,  2027559600ll},
+  { 3, -240, 2035,  2072318400ll,  2059614000ll},
+  { 3, -240, 2036,  2104372800ll,  2091063600ll},
+  { 3, -240, 2037,  2135822400ll,  2122513200ll},
+  { 3, -240, 2038,  2167272000ll,  2153962800ll},
+  { 3, -240, 2039,  2198721600ll,  2185412400ll},
+  { 3, -240, 2040,  2230171200ll,  2217466800ll},
+  { 3, -240, 2041,  2262225600ll,  2248916400ll},
+  { 3, -240, 2042,  2293675200ll,  2280366000ll},
+  { 3, -240, 2043,  2325124800ll,  2311815600ll},
+  { 3, -240, 2044,  2356574400ll,  2343265200ll},
+  { 3, -240, 2045,  2388024000ll,  2374714800ll},
+  { 3, -240, 2046,  2419473600ll,  2406769200ll},
+  { 3, -240, 2047,  2451528000ll,  2438218800ll},
+  { 3, -240, 2048,  2482977600ll,  2469668400ll},
+  { 3, -240, 2049,  2514427200ll,  2501118000ll},
+  { 3, -240, 2050,  2545876800ll,  2532567600ll},
+  { 3, -240, 2051,  2577326400ll,  2564017200ll},
+  { 3, -240, 2052,  2609380800ll,  2596071600ll},
+  { 3, -240, 2053,  2640830400ll,  2627521200ll},
+  { 3, -240, 2054,  2672280000ll,  2658970800ll},
+  { 3, -240, 2055,  2703729600ll,  2690420400ll},
+  { 3, -240, 2056,  2735179200ll,  2721870000ll},
+  { 3, -240, 2057,  2766628800ll,  2753924400ll},
+  { 3, -240, 2058,  2798683200ll,  2785374000ll},
+  { 3, -240, 2059,  2830132800ll,  2816823600ll},
+  { 3, -240, 2060,  2861582400ll,  2848273200ll},
+  { 3, -240, 2061,  2893032000ll,  2879722800ll},
+  { 3, -240, 2062,  2924481600ll,  2911172400ll},
+  { 3, -240, 2063,  2955931200ll,  2943226800ll},
+  { 3, -240, 2064,  2987985600ll,  2974676400ll},
+  { 3, -240, 2065,  3019435200ll,  3006126000ll},
+  { 3, -240, 2066,  3050884800ll,  3037575600ll},
+  { 3, -240, 2067,  3082334400ll,  3069025200ll},
+  { 3, -240, 2068,  3113784000ll,  3101079600ll},
+  { 3, -240, 2069,  3145838400ll,  3132529200ll},
+  { 3, -240, 2070,  3177288000ll,  3163978800ll},
+  { 3, -240, 2071,  3208737600ll,  3195428400ll},
+  { 3, -240, 2072,  3240187200ll,  3226878000ll},
+  { 3, -240, 2073,  3271636800ll,  3258327600ll},
+  { 3, -240, 2074,  3303086400ll,  3290382000ll},
+  { 3, -240, 2075,  3335140800ll,  3321831600ll},
+  { 3, -240, 2076,  3366590400ll,  3353281200ll},
+  { 3, -240, 2077,  3398040000ll,  3384730800ll},
+  { 3, -240, 2078,  3429489600ll,  3416180400ll},
+  { 3, -240, 2079,  3460939200ll,  3447630000ll},
+  { 3, -240, 2080,  3492993600ll,  3479684400ll},
+  { 3, -240, 2081,  3524443200ll,  3511134000ll},
+  { 3, -240, 2082,  3555892800ll,  3542583600ll},
+  { 3, -240, 2083,  3587342400ll,  3574033200ll},
+  { 3, -240, 2084,  3618792000ll,  3605482800ll},
+  { 3, -240, 2085,  3650241600ll,  3637537200ll},
+  { 3, -240, 2086,  3682296000ll,  3668986800ll},
+  { 3, -240, 2087,  3713745600ll,  3700436400ll},
+  { 3, -240, 2088,  3745195200ll,  3731886000ll},
+  { 3, -240, 2089,  3776644800ll,  3763335600ll},
+  { 3, -240, 2090,  3808094400ll,  3794785200ll},
+  { 3, -240, 2091,  3839544000ll,  3826839600ll},
+  { 3, -240, 2092,  3871598400ll,  3858289200ll},
+  { 3, -240, 2093,  3903048000ll,  3889738800ll},
+  { 3, -240, 2094,  3934497600ll,  3921188400ll},
+  { 3, -240, 2095,  3965947200ll,  3952638000ll},
+  { 3, -240, 2096,  3997396800ll,  3984692400ll},
+  { 3, -240, 2097,  4029451200ll,  4016142000ll},
+  { 3, -240, 2098,  4060900800ll,  4047591600ll},
+  { 3, -240, 2099,  4092350400ll,  4079041200ll},
+
+  /* America/Havana (normal time UTC-5:00). */
+  { 4, -300, 2013,  1362891600ll,  1383454800ll},
+  { 4, -300, 2014,  1394341200ll,  1414904400ll},
+  { 4, -300, 2015,  1425790800ll,  1446354000ll},
+  { 4, -300, 2016,  1457845200ll,  1478408400ll},
+  { 4, -300, 2017,  1489294800ll,  1509858000ll},
+  { 4, -300, 2018,  1520744400ll,  1541307600ll},
+  { 4, -300, 2019,  1552194000ll,  1572757200ll},
+  { 4, -300, 2020,  1583643600ll,  1604206800ll},
+  { 4, -300, 2021,  1615698000ll,  1636261200ll},
+  { 4, -300, 2022,  1647147600ll,  1667710800ll},
+  { 4, -300, 2023,  1678597200ll,  1699160400ll},
+  { 4, -300, 2024,  1710046800ll,  1730610000ll},
+  { 4, -300, 2025,  1741496400ll,  1762059600ll},
+  { 4, -300, 2026,  1772946000ll,  1793509200ll},
+  { 4, -300, 2027,  1805000400ll,  1825563600ll},
+  { 4, -300, 2028,  1836450000ll,  1857013200ll},
+  { 4, -300, 2029,  1867899600ll,  1888462800ll},
+  { 4, -300, 2030,  1899349200ll,  1919912400ll},
+  { 4, -300, 2031,  1930798800ll,  1951362000ll},
+  { 4, -300, 2032,  1962853200ll,  1983416400ll},
+  { 4, -300, 2033,  1994302800ll,  2014866000ll},
+  { 4, -300, 2034,  2025752400ll,  2046315600ll},
+  { 4, -300, 2035,  2057202000ll,  2077765200ll},
+  { 4, -300, 2036,  2088651600ll,  2109214800ll},
+  { 4, -300, 2037,  2120101200ll,  2140664400ll},
+  { 4, -300, 2038,  2152155600ll,  2172718800ll},
+  { 4, -300, 2039,  2183605200ll,  2204168400ll},
+  { 4, -300, 2040,  2215054800ll,  2235618000ll},
+  { 4, -300, 2041,  2246504400ll,  2267067600ll},
+  { 4, -300, 2042,  2277954000ll,  2298517200ll},
+  { 4, -300, 2043,  2309403600ll,  2329966800ll},
+  { 4, -300, 2044,  2341458000ll,  2362021200ll},
+  { 4, -300, 2045,  2372907600ll,  2393470800ll},
+  { 4, -300, 2046,  2404357200ll,  2424920400ll},
+  { 4, -300, 2047,  2435806800ll,  2456370000ll},
+  { 4, -300, 2048,  2467256400ll,  2487819600ll},
+  { 4, -300, 2049,  2499310800ll,  2519874000ll},
+  { 4, -300, 2050,  2530760400ll,  2551323600ll},
+  { 4, -300, 2051,  2562210000ll,  2582773200ll},
+  { 4, -300, 2052,  2593659600ll,  2614222800ll},
+  { 4, -300, 2053,  2625109200ll,  2645672400ll},
+  { 4, -300, 2054,  2656558800ll,  2677122000ll},
+  { 4, -300, 2055,  2688613200ll,  2709176400ll},
+  { 4, -300, 2056,  2720062800ll,  2740626000ll},
+  { 4, -300, 2057,  2751512400ll,  2772075600ll},
+  { 4, -300, 2058,  2782962000ll,  2803525200ll},
+  { 4, -300, 2059,  2814411600ll,  2834974800ll},
+  { 4, -300, 2060,  2846466000ll,  2867029200ll},
+  { 4, -300, 2061,  2877915600ll,  2898478800ll},
+  { 4, -300, 2062,  2909365200ll,  2929928400ll},
+  { 4, -300, 2063,  2940814800ll,  2961378000ll},
+  { 4, -300, 2064,  2972264400ll,  2992827600ll},
+  { 4, -300, 2065,  3003714000ll,  3024277200ll},
+  { 4, -300, 2066,  3035768400ll,  3056331600ll},
+  { 4, -300, 2067,  3067218000ll,  3087781200ll},
+  { 4, -300, 2068,  3098667600ll,  3119230800ll},
+  { 4, -300, 2069,  3130117200ll,  3150680400ll},
+  { 4, -300, 2070,  3161566800ll,  3182130000ll},
+  { 4, -300, 2071,  3193016400ll,  3213579600ll},
+  { 4, -300, 2072,  3225070800ll,  3245634000ll},
+  { 4, -300, 2073,  3256520400ll,  3277083600ll},
+  { 4, -300, 2074,  3287970000ll,  3308533200ll},
+  { 4, -300, 2075,  3319419600ll,  3339982800ll},
+  { 4, -300, 2076,  3350869200ll,  3371432400ll},
+  { 4, -300, 2077,  3382923600ll,  3403486800ll},
+  { 4, -300, 2078,  3414373200ll,  3434936400ll},
+  { 4, -300, 2079,  3445822800ll,  3466386000ll},
+  { 4, -300, 2080,  3477272400ll,  3497835600ll},
+  { 4, -300, 2081,  3508722000ll,  3529285200ll},
+  { 4, -300, 2082,  3540171600ll,  3560734800ll},
+  { 4, -300, 2083,  3572226000ll,  3592789200ll},
+  { 4, -300, 2084,  3603675600ll,  3624238800ll},
+  { 4, -300, 2085,  3635125200ll,  3655688400ll},
+  { 4, -300, 2086,  3666574800ll,  3687138000ll},
+  { 4, -300, 2087,  3698024400ll,  3718587600ll},
+  { 4, -300, 2088,  3730078800ll,  3750642000ll},
+  { 4, -300, 2089,  3761528400ll,  3782091600ll},
+  { 4, -300, 2090,  3792978000ll,  3813541200ll},
+  { 4, -300, 2091,  3824427600ll,  3844990800ll},
+  { 4, -300, 2092,  3855877200ll,  3876440400ll},
+  { 4, -300, 2093,  3887326800ll,  3907890000ll},
+  { 4, -300, 2094,  3919381200ll,  3939944400ll},
+  { 4, -300, 2095,  3950830800ll,  3971394000ll},
+  { 4, -300, 2096,  3982280400ll,  4002843600ll},
+  { 4, -300, 2097,  4013730000ll,  4034293200ll},
+  { 4, -300, 2098,  4045179600ll,  4065742800ll},
+  { 4, -300, 2099,  4076629200ll,  4097192400ll},
+
+  /* Europe/Paris (normal time UTC+1:00). */
+  { 5,   60, 2000,   954032400ll,   972781200ll},
+  { 5,   60, 2001,   985482000ll,  1004230800ll},
+  { 5,   60, 2002,  1017536400ll,  1035680400ll},
+  { 5,   60, 2003,  1048986000ll,  1067130000ll},
+  { 5,   60, 2004,  1080435600ll,  1099184400ll},
+  { 5,   60, 2005,  1111885200ll,  1130634000ll},
+  { 5,   60, 2006,  1143334800ll,  1162083600ll},
+  { 5,   60, 2007,  1174784400ll,  1193533200ll},
+  { 5,   60, 2008,  1206838800ll,  1224982800ll},
+  { 5,   60, 2009,  1238288400ll,  1256432400ll},
+  { 5,   60, 2010,  1269738000ll,  1288486800ll},
+  { 5,   60, 2011,  1301187600ll,  1319936400ll},
+  { 5,   60, 2012,  1332637200ll,  1351386000ll},
+  { 5,   60, 2013,  1364691600ll,  1382835600ll},
+  { 5,   60, 2014,  1396141200ll,  1414285200ll},
+  { 5,   60, 2015,  1427590800ll,  1445734800ll},
+  { 5,   60, 2016,  1459040400ll,  1477789200ll},
+  { 5,   60, 2017,  1490490000ll,  1509238800ll},
+  { 5,   60, 2018,  1521939600ll,  1540688400ll},
+  { 5,   60, 2019,  1553994000ll,  1572138000ll},
+  { 5,   60, 2020,  1585443600ll,  1603587600ll},
+  { 5,   60, 2021,  1616893200ll,  1635642000ll},
+  { 5,   60, 2022,  1648342800ll,  1667091600ll},
+  { 5,   60, 2023,  1679792400ll,  1698541200ll},
+  { 5,   60, 2024,  1711846800ll,  1729990800ll},
+  { 5,   60, 2025,  1743296400ll,  1761440400ll},
+  { 5,   60, 2026,  1774746000ll,  1792890000ll},
+  { 5,   60, 2027,  1806195600ll,  1824944400ll},
+  { 5,   60, 2028,  1837645200ll,  1856394000ll},
+  { 5,   60, 2029,  1869094800ll,  1887843600ll},
+  { 5,   60, 2030,  1901149200ll,  1919293200ll},
+  { 5,   60, 2031,  1932598800ll,  1950742800ll},
+  { 5,   60, 2032,  1964048400ll,  1982797200ll},
+  { 5,   60, 2033,  1995498000ll,  2014246800ll},
+  { 5,   60, 2034,  2026947600ll,  2045696400ll},
+  { 5,   60, 2035,  2058397200ll,  2077146000ll},
+  { 5,   60, 2036,  2090451600ll,  2108595600ll},
+  { 5,   60, 2037,  2121901200ll,  2140045200ll},
+  { 5,   60, 2038,  2153350800ll,  2172099600ll},
+  { 5,   60, 2039,  2184800400ll,  2203549200ll},
+  { 5,   60, 2040,  2216250000ll,  2234998800ll},
+  { 5,   60, 2041,  2248304400ll,  2266448400ll},
+  { 5,   60, 2042,  2279754000ll,  2297898000ll},
+  { 5,   60, 2043,  2311203600ll,  2329347600ll},
+  { 5,   60, 2044,  2342653200ll,  2361402000ll},
+  { 5,   60, 2045,  2374102800ll,  2392851600ll},
+  { 5,   60, 2046,  2405552400ll,  2424301200ll},
+  { 5,   60, 2047,  2437606800ll,  2455750800ll},
+  { 5,   60, 2048,  2469056400ll,  2487200400ll},
+  { 5,   60, 2049,  2500506000ll,  2519254800ll},
+  { 5,   60, 2050,  2531955600ll,  2550704400ll},
+  { 5,   60, 2051,  2563405200ll,  2582154000ll},
+  { 5,   60, 2052,  2595459600ll,  2613603600ll},
+  { 5,   60, 2053,  2626909200ll,  2645053200ll},
+  { 5,   60, 2054,  2658358800ll,  2676502800ll},
+  { 5,   60, 2055,  2689808400ll,  2708557200ll},
+  { 5,   60, 2056,  2721258000ll,  2740006800ll},
+  { 5,   60, 2057,  2752707600ll,  2771456400ll},
+  { 5,   60, 2058,  2784762000ll,  2802906000ll},
+  { 5,   60, 2059,  2816211600ll,  2834355600ll},
+  { 5,   60, 2060,  2847661200ll,  2866410000ll},
+  { 5,   60, 2061,  2879110800ll,  2897859600ll},
+  { 5,   60, 2062,  2910560400ll,  2929309200ll},
+  { 5,   60, 2063,  2942010000ll,  2960758800ll},
+  { 5,   60, 2064,  2974064400ll,  2992208400ll},
+  { 5,   60, 2065,  3005514000ll,  3023658000ll},
+  { 5,   60, 2066,  3036963600ll,  3055712400ll},
+  { 5,   60, 2067,  3068413200ll,  3087162000ll},
+  { 5,   60, 2068,  3099862800ll,  3118611600ll},
+  { 5,   60, 2069,  3131917200ll,  3150061200ll},
+  { 5,   60, 2070,  3163366800ll,  3181510800ll},
+  { 5,   60, 2071,  3194816400ll,  3212960400ll},
+  { 5,   60, 2072,  3226266000ll,  3245014800ll},
+  { 5,   60, 2073,  3257715600ll,  3276464400ll},
+  { 5,   60, 2074,  3289165200ll,  3307914000ll},
+  { 5,   60, 2075,  3321219600ll,  3339363600ll},
+  { 5,   60, 2076,  3352669200ll,  3370813200ll},
+  { 5,   60, 2077,  3384118800ll,  3402867600ll},
+  { 5,   60, 2078,  3415568400ll,  3434317200ll},
+  { 5,   60, 2079,  3447018000ll,  3465766800ll},
+  { 5,   60, 2080,  3479072400ll,  3497216400ll},
+  { 5,   60, 2081,  3510522000ll,  3528666000ll},
+  { 5,   60, 2082,  3541971600ll,  3560115600ll},
+  { 5,   60, 2083,  3573421200ll,  3592170000ll},
+  { 5,   60, 2084,  3604870800ll,  3623619600ll},
+  { 5,   60, 2085,  3636320400ll,  3655069200ll},
+  { 5,   60, 2086,  3668374800ll,  3686518800ll},
+  { 5,   60, 2087,  3699824400ll,  3717968400ll},
+  { 5,   60, 2088,  3731274000ll,  3750022800ll},
+  { 5,   60, 2089,  3762723600ll,  3781472400ll},
+  { 5,   60, 2090,  3794173200ll,  3812922000ll},
+  { 5,   60, 2091,  3825622800ll,  3844371600ll},
+  { 5,   60, 2092,  3857677200ll,  3875821200ll},
+  { 5,   60, 2093,  3889126800ll,  3907270800ll},
+  { 5,   60, 2094,  3920576400ll,  3939325200ll},
+  { 5,   60, 2095,  3952026000ll,  3970774800ll},
+  { 5,   60, 2096,  3983475600ll,  4002224400ll},
+  { 5,   60, 2097,  4015530000ll,  4033674000ll},
+  { 5,   60, 2098,  4046979600ll,  4065123600ll},
+  { 5,   60, 2099,  4078429200ll,  4096573200ll},
+
+  /* Asia/Jerusalem (normal time UTC+2:00). */
+  { 6,  120, 2013,  1364515200ll,  1382828400ll},
+  { 6,  120, 2014,  1395964800ll,  1414278000ll},
+  { 6,  120, 2015,  1427414400ll,  1445727600ll},
+  { 6,  120, 2016,  1458864000ll,  1477782000ll},
+  { 6,  120, 2017,  1490313600ll,  1509231600ll},
+  { 6,  120, 2018,  1521763200ll,  1540681200ll},
+  { 6,  120, 2019,  1553817600ll,  1572130800ll},
+  { 6,  120, 2020,  1585267200ll,  1603580400ll},
+  { 6,  120, 2021,  1616716800ll,  1635634800ll},
+  { 6,  120, 2022,  1648166400ll,  1667084400ll},
+  { 6,  120, 2023,  1679616000ll,  1698534000ll},
+  { 6,  120, 2024,  1711670400ll,  1729983600ll},
+  { 6,  120, 2025,  1743120000ll,  1761433200ll},
+  { 6,  120, 2026,  1774569600ll,  1792882800ll},
+  { 6,  120, 2027,  1806019200ll,  1824937200ll},
+  { 6,  120, 2028,  1837468800ll,  1856386800ll},
+  { 6,  120, 2029,  1868918400ll,  1887836400ll},
+  { 6,  120, 2030,  1900972800ll,  1919286000ll},
+  { 6,  120, 2031,  1932422400ll,  1950735600ll},
+  { 6,  120, 2032,  1963872000ll,  1982790000ll},
+  { 6,  120, 2033,  1995321600ll,  2014239600ll},
+  { 6,  120, 2034,  2026771200ll,  2045689200ll},
+  { 6,  120, 2035,  2058220800ll,  2077138800ll},
+  { 6,  120, 2036,  2090275200ll,  2108588400ll},
+  { 6,  120, 2037,  2121724800ll,  2140038000ll},
+  { 6,  120, 2038,  2153174400ll,  2172092400ll},
+  { 6,  120, 2039,  2184624000ll,  2203542000ll},
+  { 6,  120, 2040,  2216073600ll,  2234991600ll},
+  { 6,  120, 2041,  2248128000ll,  2266441200ll},
+  { 6,  120, 2042,  2279577600ll,  2297890800ll},
+  { 6,  120, 2043,  2311027200ll,  2329340400ll},
+  { 6,  120, 2044,  2342476800ll,  2361394800ll},
+  { 6,  120, 2045,  2373926400ll,  2392844400ll},
+  { 6,  120, 2046,  2405376000ll,  2424294000ll},
+  { 6,  120, 2047,  2437430400ll,  2455743600ll},
+  { 6,  120, 2048,  2468880000ll,  2487193200ll},
+  { 6,  120, 2049,  2500329600ll,  2519247600ll},
+  { 6,  120, 2050,  2531779200ll,  2550697200ll},
+  { 6,  120, 2051,  2563228800ll,  2582146800ll},
+  { 6,  120, 2052,  2595283200ll,  2613596400ll},
+  { 6,  120, 2053,  2626732800ll,  2645046000ll},
+  { 6,  120, 2054,  2658182400ll,  2676495600ll},
+  { 6,  120, 2055,  2689632000ll,  2708550000ll},
+  { 6,  120, 2056,  2721081600ll,  2739999600ll},
+  { 6,  120, 2057,  2752531200ll,  2771449200ll},
+  { 6,  120, 2058,  2784585600ll,  2802898800ll},
+  { 6,  120, 2059,  2816035200ll,  2834348400ll},
+  { 6,  120, 2060,  2847484800ll,  2866402800ll},
+  { 6,  120, 2061,  2878934400ll,  2897852400ll},
+  { 6,  120, 2062,  2910384000ll,  2929302000ll},
+  { 6,  120, 2063,  2941833600ll,  2960751600ll},
+  { 6,  120, 2064,  2973888000ll,  2992201200ll},
+  { 6,  120, 2065,  3005337600ll,  3023650800ll},
+  { 6,  120, 2066,  3036787200ll,  3055705200ll},
+  { 6,  120, 2067,  3068236800ll,  3087154800ll},
+  { 6,  120, 2068,  3099686400ll,  3118604400ll},
+  { 6,  120, 2069,  3131740800ll,  3150054000ll},
+  { 6,  120, 2070,  3163190400ll,  3181503600ll},
+  { 6,  120, 2071,  3194640000ll,  3212953200ll},
+  { 6,  120, 2072,  3226089600ll,  3245007600ll},
+  { 6,  120, 2073,  3257539200ll,  3276457200ll},
+  { 6,  120, 2074,  3288988800ll,  3307906800ll},
+  { 6,  120, 2075,  3321043200ll,  3339356400ll},
+  { 6,  120, 2076,  3352492800ll,  3370806000ll},
+  { 6,  120, 2077,  3383942400ll,  3402860400ll},
+  { 6,  120, 2078,  3415392000ll,  3434310000ll},
+  { 6,  120, 2079,  3446841600ll,  3465759600ll},
+  { 6,  120, 2080,  3478896000ll,  3497209200ll},
+  { 6,  120, 2081,  3510345600ll,  3528658800ll},
+  { 6,  120, 2082,  3541795200ll,  3560108400ll},
+  { 6,  120, 2083,  3573244800ll,  3592162800ll},
+  { 6,  120, 2084,  3604694400ll,  3623612400ll},
+  { 6,  120, 2085,  3636144000ll,  3655062000ll},
+  { 6,  120, 2086,  3668198400ll,  3686511600ll},
+  { 6,  120, 2087,  3699648000ll,  3717961200ll},
+  { 6,  120, 2088,  3731097600ll,  3750015600ll},
+  { 6,  120, 2089,  3762547200ll,  3781465200ll},
+  { 6,  120, 2090,  3793996800ll,  3812914800ll},
+  { 6,  120, 2091,  3825446400ll,  3844364400ll},
+  { 6,  120, 2092,  3857500800ll,  3875814000ll},
+  { 6,  120, 2093,  3888950400ll,  3907263600ll},
+  { 6,  120, 2094,  3920400000ll,  3939318000ll},
+  { 6,  120, 2095,  3951849600ll,  3970767600ll},
+  { 6,  120, 2096,  3983299200ll,  4002217200ll},
+  { 6,  120, 2097,  4015353600ll,  4033666800ll},
+  { 6,  120, 2098,  4046803200ll,  4065116400ll},
+  { 6,  120, 2099,  4078252800ll,  4096566000ll},
+
+  /* Asia/Beirut (normal time UTC+2:00). */
+  { 7,  120, 2000,   954021600ll,   972766800ll},
+  { 7,  120, 2001,   985471200ll,  1004216400ll},
+  { 7,  120, 2002,  1017525600ll,  1035666000ll},
+  { 7,  120, 2003,  1048975200ll,  1067115600ll},
+  { 7,  120, 2004,  1080424800ll,  1099170000ll},
+  { 7,  120, 2005,  1111874400ll,  1130619600ll},
+  { 7,  120, 2006,  1143324000ll,  1162069200ll},
+  { 7,  120, 2007,  1174773600ll,  1193518800ll},
+  { 7,  120, 2008,  1206828000ll,  1224968400ll},
+  { 7,  120, 2009,  1238277600ll,  1256418000ll},
+  { 7,  120, 2010,  1269727200ll,  1288472400ll},
+  { 7,  120, 2011,  1301176800ll,  1319922000ll},
+  { 7,  120, 2012,  1332626400ll,  1351371600ll},
+  { 7,  120, 2013,  1364680800ll,  1382821200ll},
+  { 7,  120, 2014,  1396130400ll,  1414270800ll},
+  { 7,  120, 2015,  1427580000ll,  1445720400ll},
+  { 7,  120, 2016,  1459029600ll,  1477774800ll},
+  { 7,  120, 2017,  1490479200ll,  1509224400ll},
+  { 7,  120, 2018,  1521928800ll,  1540674000ll},
+  { 7,  120, 2019,  1553983200ll,  1572123600ll},
+  { 7,  120, 2020,  1585432800ll,  1603573200ll},
+  { 7,  120, 2021,  1616882400ll,  1635627600ll},
+  { 7,  120, 2022,  1648332000ll,  1667077200ll},
+  { 7,  120, 2023,  1679781600ll,  1698526800ll},
+  { 7,  120, 2024,  1711836000ll,  1729976400ll},
+  { 7,  120, 2025,  1743285600ll,  1761426000ll},
+  { 7,  120, 2026,  1774735200ll,  1792875600ll},
+  { 7,  120, 2027,  1806184800ll,  1824930000ll},
+  { 7,  120, 2028,  1837634400ll,  1856379600ll},
+  { 7,  120, 2029,  1869084000ll,  1887829200ll},
+  { 7,  120, 2030,  1901138400ll,  1919278800ll},
+  { 7,  120, 2031,  1932588000ll,  1950728400ll},
+  { 7,  120, 2032,  1964037600ll,  1982782800ll},
+  { 7,  120, 2033,  1995487200ll,  2014232400ll},
+  { 7,  120, 2034,  2026936800ll,  2045682000ll},
+  { 7,  120, 2035,  2058386400ll,  2077131600ll},
+  { 7,  120, 2036,  2090440800ll,  2108581200ll},
+  { 7,  120, 2037,  2121890400ll,  2140030800ll},
+  { 7,  120, 2038,  2153340000ll,  2172085200ll},
+  { 7,  120, 2039,  2184789600ll,  2203534800ll},
+  { 7,  120, 2040,  2216239200ll,  2234984400ll},
+  { 7,  120, 2041,  2248293600ll,  2266434000ll},
+  { 7,  120, 2042,  2279743200ll,  2297883600ll},
+  { 7,  120, 2043,  2311192800ll,  2329333200ll},
+  { 7,  120, 2044,  2342642400ll,  2361387600ll},
+  { 7,  120, 2045,  2374092000ll,  2392837200ll},
+  { 7,  120, 2046,  2405541600ll,  2424286800ll},
+  { 7,  120, 2047,  2437596000ll,  2455736400ll},
+  { 7,  120, 2048,  2469045600ll,  2487186000ll},
+  { 7,  120, 2049,  2500495200ll,  2519240400ll},
+  { 7,  120, 2050,  2531944800ll,  2550690000ll},
+  { 7,  120, 2051,  2563394400ll,  2582139600ll},
+  { 7,  120, 2052,  2595448800ll,  2613589200ll},
+  { 7,  120, 2053,  2626898400ll,  2645038800ll},
+  { 7,  120, 2054,  2658348000ll,  2676488400ll},
+  { 7,  120, 2055,  2689797600ll,  2708542800ll},
+  { 7,  120, 2056,  2721247200ll,  2739992400ll},
+  { 7,  120, 2057,  2752696800ll,  2771442000ll},
+  { 7,  120, 2058,  2784751200ll,  2802891600ll},
+  { 7,  120, 2059,  2816200800ll,  2834341200ll},
+  { 7,  120, 2060,  2847650400ll,  2866395600ll},
+  { 7,  120, 2061,  2879100000ll,  2897845200ll},
+  { 7,  120, 2062,  2910549600ll,  2929294800ll},
+  { 7,  120, 2063,  2941999200ll,  2960744400ll},
+  { 7,  120, 2064,  2974053600ll,  2992194000ll},
+  { 7,  120, 2065,  3005503200ll,  3023643600ll},
+  { 7,  120, 2066,  3036952800ll,  3055698000ll},
+  { 7,  120, 2067,  3068402400ll,  3087147600ll},
+  { 7,  120, 2068,  3099852000ll,  3118597200ll},
+  { 7,  120, 2069,  3131906400ll,  3150046800ll},
+  { 7,  120, 2070,  3163356000ll,  3181496400ll},
+  { 7,  120, 2071,  3194805600ll,  3212946000ll},
+  { 7,  120, 2072,  3226255200ll,  3245000400ll},
+  { 7,  120, 2073,  3257704800ll,  3276450000ll},
+  { 7,  120, 2074,  3289154400ll,  3307899600ll},
+  { 7,  120, 2075,  3321208800ll,  3339349200ll},
+  { 7,  120, 2076,  3352658400ll,  3370798800ll},
+  { 7,  120, 2077,  3384108000ll,  3402853200ll},
+  { 7,  120, 2078,  3415557600ll,  3434302800ll},
+  { 7,  120, 2079,  3447007200ll,  3465752400ll},
+  { 7,  120, 2080,  3479061600ll,  3497202000ll},
+  { 7,  120, 2081,  3510511200ll,  3528651600ll},
+  { 7,  120, 2082,  3541960800ll,  3560101200ll},
+  { 7,  120, 2083,  3573410400ll,  3592155600ll},
+  { 7,  120, 2084,  3604860000ll,  3623605200ll},
+  { 7,  120, 2085,  3636309600ll,  3655054800ll},
+  { 7,  120, 2086,  3668364000ll,  3686504400ll},
+  { 7,  120, 2087,  3699813600ll,  3717954000ll},
+  { 7,  120, 2088,  3731263200ll,  3750008400ll},
+  { 7,  120, 2089,  3762712800ll,  3781458000ll},
+  { 7,  120, 2090,  3794162400ll,  3812907600ll},
+  { 7,  120, 2091,  3825612000ll,  3844357200ll},
+  { 7,  120, 2092,  3857666400ll,  3875806800ll},
+  { 7,  120, 2093,  3889116000ll,  3907256400ll},
+  { 7,  120, 2094,  3920565600ll,  3939310800ll},
+  { 7,  120, 2095,  3952015200ll,  3970760400ll},
+  { 7,  120, 2096,  3983464800ll,  4002210000ll},
+  { 7,  120, 2097,  4015519200ll,  4033659600ll},
+  { 7,  120, 2098,  4046968800ll,  4065109200ll},
+  { 7,  120, 2099,  4078418400ll,  4096558800ll},
+
+  /* Europe/Chisinau (normal time UTC+2:00). */
+  { 8,  120, 2000,   954028800ll,   972777600ll},
+  { 8,  120, 2001,   985478400ll,  1004227200ll},
+  { 8,  120, 2002,  1017532800ll,  1035676800ll},
+  { 8,  120, 2003,  1048982400ll,  1067126400ll},
+  { 8,  120, 2004,  1080432000ll,  1099180800ll},
+  { 8,  120, 2005,  1111881600ll,  1130630400ll},
+  { 8,  120, 2006,  1143331200ll,  1162080000ll},
+  { 8,  120, 2007,  1174780800ll,  1193529600ll},
+  { 8,  120, 2008,  1206835200ll,  1224979200ll},
+  { 8,  120, 2009,  1238284800ll,  1256428800ll},
+  { 8,  120, 2010,  1269734400ll,  1288483200ll},
+  { 8,  120, 2011,  1301184000ll,  1319932800ll},
+  { 8,  120, 2012,  1332633600ll,  1351382400ll},
+  { 8,  120, 2013,  1364688000ll,  1382832000ll},
+  { 8,  120, 2014,  1396137600ll,  1414281600ll},
+  { 8,  120, 2015,  1427587200ll,  1445731200ll},
+  { 8,  120, 2016,  1459036800ll,  1477785600ll},
+  { 8,  120, 2017,  1490486400ll,  1509235200ll},
+  { 8,  120, 2018,  1521936000ll,  1540684800ll},
+  { 8,  120, 2019,  1553990400ll,  1572134400ll},
+  { 8,  120, 2020,  1585440000ll,  1603584000ll},
+  { 8,  120, 2021,  1616889600ll,  1635638400ll},
+  { 8,  120, 2022,  1648339200ll,  1667088000ll},
+  { 8,  120, 2023,  1679788800ll,  1698537600ll},
+  { 8,  120, 2024,  1711843200ll,  1729987200ll},
+  { 8,  120, 2025,  1743292800ll,  1761436800ll},
+  { 8,  120, 2026,  1774742400ll,  1792886400ll},
+  { 8,  120, 2027,  1806192000ll,  1824940800ll},
+  { 8,  120, 2028,  1837641600ll,  1856390400ll},
+  { 8,  120, 2029,  1869091200ll,  1887840000ll},
+  { 8,  120, 2030,  1901145600ll,  1919289600ll},
+  { 8,  120, 2031,  1932595200ll,  1950739200ll},
+  { 8,  120, 2032,  1964044800ll,  1982793600ll},
+  { 8,  120, 2033,  1995494400ll,  2014243200ll},
+  { 8,  120, 2034,  2026944000ll,  2045692800ll},
+  { 8,  120, 2035,  2058393600ll,  2077142400ll},
+  { 8,  120, 2036,  2090448000ll,  2108592000ll},
+  { 8,  120, 2037,  2121897600ll,  2140041600ll},
+  { 8,  120, 2038,  2153347200ll,  2172096000ll},
+  { 8,  120, 2039,  2184796800ll,  2203545600ll},
+  { 8,  120, 2040,  2216246400ll,  2234995200ll},
+  { 8,  120, 2041,  2248300800ll,  2266444800ll},
+  { 8,  120, 2042,  2279750400ll,  2297894400ll},
+  { 8,  120, 2043,  2311200000ll,  2329344000ll},
+  { 8,  120, 2044,  2342649600ll,  2361398400ll},
+  { 8,  120, 2045,  2374099200ll,  2392848000ll},
+  { 8,  120, 2046,  2405548800ll,  2424297600ll},
+  { 8,  120, 2047,  2437603200ll,  2455747200ll},
+  { 8,  120, 2048,  2469052800ll,  2487196800ll},
+  { 8,  120, 2049,  2500502400ll,  2519251200ll},
+  { 8,  120, 2050,  2531952000ll,  2550700800ll},
+  { 8,  120, 2051,  2563401600ll,  2582150400ll},
+  { 8,  120, 2052,  2595456000ll,  2613600000ll},
+  { 8,  120, 2053,  2626905600ll,  2645049600ll},
+  { 8,  120, 2054,  2658355200ll,  2676499200ll},
+  { 8,  120, 2055,  2689804800ll,  2708553600ll},
+  { 8,  120, 2056,  2721254400ll,  2740003200ll},
+  { 8,  120, 2057,  2752704000ll,  2771452800ll},
+  { 8,  120, 2058,  2784758400ll,  2802902400ll},
+  { 8,  120, 2059,  2816208000ll,  2834352000ll},
+  { 8,  120, 2060,  2847657600ll,  2866406400ll},
+  { 8,  120, 2061,  2879107200ll,  2897856000ll},
+  { 8,  120, 2062,  2910556800ll,  2929305600ll},
+  { 8,  120, 2063,  2942006400ll,  2960755200ll},
+  { 8,  120, 2064,  2974060800ll,  2992204800ll},
+  { 8,  120, 2065,  3005510400ll,  3023654400ll},
+  { 8,  120, 2066,  3036960000ll,  3055708800ll},
+  { 8,  120, 2067,  3068409600ll,  3087158400ll},
+  { 8,  120, 2068,  3099859200ll,  3118608000ll},
+  { 8,  120, 2069,  3131913600ll,  3150057600ll},
+  { 8,  120, 2070,  3163363200ll,  3181507200ll},
+  { 8,  120, 2071,  3194812800ll,  3212956800ll},
+  { 8,  120, 2072,  3226262400ll,  3245011200ll},
+  { 8,  120, 2073,  3257712000ll,  3276460800ll},
+  { 8,  120, 2074,  3289161600ll,  3307910400ll},
+  { 8,  120, 2075,  3321216000ll,  3339360000ll},
+  { 8,  120, 2076,  3352665600ll,  3370809600ll},
+  { 8,  120, 2077,  3384115200ll,  3402864000ll},
+  { 8,  120, 2078,  3415564800ll,  3434313600ll},
+  { 8,  120, 2079,  3447014400ll,  3465763200ll},
+  { 8,  120, 2080,  3479068800ll,  3497212800ll},
+  { 8,  120, 2081,  3510518400ll,  3528662400ll},
+  { 8,  120, 2082,  3541968000ll,  3560112000ll},
+  { 8,  120, 2083,  3573417600ll,  3592166400ll},
+  { 8,  120, 2084,  3604867200ll,  3623616000ll},
+  { 8,  120, 2085,  3636316800ll,  3655065600ll},
+  { 8,  120, 2086,  3668371200ll,  3686515200ll},
+  { 8,  120, 2087,  3699820800ll,  3717964800ll},
+  { 8,  120, 2088,  3731270400ll,  3750019200ll},
+  { 8,  120, 2089,  3762720000ll,  3781468800ll},
+  { 8,  120, 2090,  3794169600ll,  3812918400ll},
+  { 8,  120, 2091,  3825619200ll,  3844368000ll},
+  { 8,  120, 2092,  3857673600ll,  3875817600ll},
+  { 8,  120, 2093,  3889123200ll,  3907267200ll},
+  { 8,  120, 2094,  3920572800ll,  3939321600ll},
+  { 8,  120, 2095,  3952022400ll,  3970771200ll},
+  { 8,  120, 2096,  3983472000ll,  4002220800ll},
+  { 8,  120, 2097,  4015526400ll,  4033670400ll},
+  { 8,  120, 2098,  4046976000ll,  4065120000ll},
+  { 8,  120, 2099,  4078425600ll,  4096569600ll},
+
+  /* Pacific/Auckland (normal time UTC+12:00). */
+  { 9,  720, 2008,  1222524000ll,  1207404000ll},
+  { 9,  720, 2009,  1253973600ll,  1238853600ll},
+  { 9,  720, 2010,  1285423200ll,  1270303200ll},
+  { 9,  720, 2011,  1316872800ll,  1301752800ll},
+  { 9,  720, 2012,  1348927200ll,  1333202400ll},
+  { 9,  720, 2013,  1380376800ll,  1365256800ll},
+  { 9,  720, 2014,  1411826400ll,  1396706400ll},
+  { 9,  720, 2015,  1443276000ll,  1428156000ll},
+  { 9,  720, 2016,  1474725600ll,  1459605600ll},
+  { 9,  720, 2017,  1506175200ll,  1491055200ll},
+  { 9,  720, 2018,  1538229600ll,  1522504800ll},
+  { 9,  720, 2019,  1569679200ll,  1554559200ll},
+  { 9,  720, 2020,  1601128800ll,  1586008800ll},
+  { 9,  720, 2021,  1632578400ll,  1617458400ll},
+  { 9,  720, 2022,  1664028000ll,  1648908000ll},
+  { 9,  720, 2023,  1695477600ll,  1680357600ll},
+  { 9,  720, 2024,  1727532000ll,  1712412000ll},
+  { 9,  720, 2025,  1758981600ll,  1743861600ll},
+  { 9,  720, 2026,  1790431200ll,  1775311200ll},
+  { 9,  720, 2027,  1821880800ll,  1806760800ll},
+  { 9,  720, 2028,  1853330400ll,  1838210400ll},
+  { 9,  720, 2029,  1885384800ll,  1869660000ll},
+  { 9,  720, 2030,  1916834400ll,  1901714400ll},
+  { 9,  720, 2031,  1948284000ll,  1933164000ll},
+  { 9,  720, 2032,  1979733600ll,  1964613600ll},
+  { 9,  720, 2033,  2011183200ll,  1996063200ll},
+  { 9,  720, 2034,  2042632800ll,  2027512800ll},
+  { 9,  720, 2035,  2074687200ll,  2058962400ll},
+  { 9,  720, 2036,  2106136800ll,  2091016800ll},
+  { 9,  720, 2037,  2137586400ll,  2122466400ll},
+  { 9,  720, 2038,  2169036000ll,  2153916000ll},
+  { 9,  720, 2039,  2200485600ll,  2185365600ll},
+  { 9,  720, 2040,  2232540000ll,  2216815200ll},
+  { 9,  720, 2041,  2263989600ll,  2248869600ll},
+  { 9,  720, 2042,  2295439200ll,  2280319200ll},
+  { 9,  720, 2043,  2326888800ll,  2311768800ll},
+  { 9,  720, 2044,  2358338400ll,  2343218400ll},
+  { 9,  720, 2045,  2389788000ll,  2374668000ll},
+  { 9,  720, 2046,  2421842400ll,  2406117600ll},
+  { 9,  720, 2047,  2453292000ll,  2438172000ll},
+  { 9,  720, 2048,  2484741600ll,  2469621600ll},
+  { 9,  720, 2049,  2516191200ll,  2501071200ll},
+  { 9,  720, 2050,  2547640800ll,  2532520800ll},
+  { 9,  720, 2051,  2579090400ll,  2563970400ll},
+  { 9,  720, 2052,  2611144800ll,  2596024800ll},
+  { 9,  720, 2053,  2642594400ll,  2627474400ll},
+  { 9,  720, 2054,  2674044000ll,  2658924000ll},
+  { 9,  720, 2055,  2705493600ll,  2690373600ll},
+  { 9,  720, 2056,  2736943200ll,  2721823200ll},
+  { 9,  720, 2057,  2768997600ll,  2753272800ll},
+  { 9,  720, 2058,  2800447200ll,  2785327200ll},
+  { 9,  720, 2059,  2831896800ll,  2816776800ll},
+  { 9,  720, 2060,  2863346400ll,  2848226400ll},
+  { 9,  720, 2061,  2894796000ll,  2879676000ll},
+  { 9,  720, 2062,  2926245600ll,  2911125600ll},
+  { 9,  720, 2063,  2958300000ll,  2942575200ll},
+  { 9,  720, 2064,  2989749600ll,  2974629600ll},
+  { 9,  720, 2065,  3021199200ll,  3006079200ll},
+  { 9,  720, 2066,  3052648800ll,  3037528800ll},
+  { 9,  720, 2067,  3084098400ll,  3068978400ll},
+  { 9,  720, 2068,  3116152800ll,  3100428000ll},
+  { 9,  720, 2069,  3147602400ll,  3132482400ll},
+  { 9,  720, 2070,  3179052000ll,  3163932000ll},
+  { 9,  720, 2071,  3210501600ll,  3195381600ll},
+  { 9,  720, 2072,  3241951200ll,  3226831200ll},
+  { 9,  720, 2073,  3273400800ll,  3258280800ll},
+  { 9,  720, 2074,  3305455200ll,  3289730400ll},
+  { 9,  720, 2075,  3336904800ll,  3321784800ll},
+  { 9,  720, 2076,  3368354400ll,  3353234400ll},
+  { 9,  720, 2077,  3399804000ll,  3384684000ll},
+  { 9,  720, 2078,  3431253600ll,  3416133600ll},
+  { 9,  720, 2079,  3462703200ll,  3447583200ll},
+  { 9,  720, 2080,  3494757600ll,  3479637600ll},
+  { 9,  720, 2081,  3526207200ll,  3511087200ll},
+  { 9,  720, 2082,  3557656800ll,  3542536800ll},
+  { 9,  720, 2083,  3589106400ll,  3573986400ll},
+  { 9,  720, 2084,  3620556000ll,  3605436000ll},
+  { 9,  720, 2085,  3652610400ll,  3636885600ll},
+  { 9,  720, 2086,  3684060000ll,  3668940000ll},
+  { 9,  720, 2087,  3715509600ll,  3700389600ll},
+  { 9,  720, 2088,  3746959200ll,  3731839200ll},
+  { 9,  720, 2089,  3778408800ll,  3763288800ll},
+  { 9,  720, 2090,  3809858400ll,  3794738400ll},
+  { 9,  720, 2091,  3841912800ll,  3826188000ll},
+  { 9,  720, 2092,  3873362400ll,  3858242400ll},
+  { 9,  720, 2093,  3904812000ll,  3889692000ll},
+  { 9,  720, 2094,  3936261600ll,  3921141600ll},
+  { 9,  720, 2095,  3967711200ll,  3952591200ll},
+  { 9,  720, 2096,  3999765600ll,  3984040800ll},
+  { 9,  720, 2097,  4031215200ll,  4016095200ll},
+  { 9,  720, 2098,  4062664800ll,  4047544800ll},
+  { 9,  720, 2099,  4094114400ll,  4078994400ll},
+
+  /* America/New_York (normal time UTC-5:00). */
+  {10, -300, 2007,  1173596400ll,  1194156000ll},
+  {10, -300, 2008,  1205046000ll,  1225605600ll},
+  {10, -300, 2009,  1236495600ll,  1257055200ll},
+  {10, -300, 2010,  1268550000ll,  1289109600ll},
+  {10, -300, 2011,  1299999600ll,  1320559200ll},
+  {10, -300, 2012,  1331449200ll,  1352008800ll},
+  {10, -300, 2013,  1362898800ll,  1383458400ll},
+  {10, -300, 2014,  1394348400ll,  1414908000ll},
+  {10, -300, 2015,  1425798000ll,  1446357600ll},
+  {10, -300, 2016,  1457852400ll,  1478412000ll},
+  {10, -300, 2017,  1489302000ll,  1509861600ll},
+  {10, -300, 2018,  1520751600ll,  1541311200ll},
+  {10, -300, 2019,  1552201200ll,  1572760800ll},
+  {10, -300, 2020,  1583650800ll,  1604210400ll},
+  {10, -300, 2021,  1615705200ll,  1636264800ll},
+  {10, -300, 2022,  1647154800ll,  1667714400ll},
+  {10, -300, 2023,  1678604400ll,  1699164000ll},
+  {10, -300, 2024,  1710054000ll,  1730613600ll},
+  {10, -300, 2025,  1741503600ll,  1762063200ll},
+  {10, -300, 2026,  1772953200ll,  1793512800ll},
+  {10, -300, 2027,  1805007600ll,  1825567200ll},
+  {10, -300, 2028,  1836457200ll,  1857016800ll},
+  {10, -300, 2029,  1867906800ll,  1888466400ll},
+  {10, -300, 2030,  1899356400ll,  1919916000ll},
+  {10, -300, 2031,  1930806000ll,  1951365600ll},
+  {10, -300, 2032,  1962860400ll,  1983420000ll},
+  {10, -300, 2033,  1994310000ll,  2014869600ll},
+  {10, -300, 2034,  2025759600ll,  2046319200ll},
+  {10, -300, 2035,  2057209200ll,  2077768800ll},
+  {10, -300, 2036,  2088658800ll,  2109218400ll},
+  {10, -300, 2037,  2120108400ll,  2140668000ll},
+  {10, -300, 2038,  2152162800ll,  2172722400ll},
+  {10, -300, 2039,  2183612400ll,  2204172000ll},
+  {10, -300, 2040,  2215062000ll,  2235621600ll},
+  {10, -300, 2041,  2246511600ll,  2267071200ll},
+  {10, -300, 2042,  2277961200ll,  2298520800ll},
+  {10, -300, 2043,  2309410800ll,  2329970400ll},
+  {10, -300, 2044,  2341465200ll,  2362024800ll},
+  {10, -300, 2045,  2372914800ll,  2393474400ll},
+  {10, -300, 2046,  2404364400ll,  2424924000ll},
+  {10, -300, 2047,  2435814000ll,  2456373600ll},
+  {10, -300, 2048,  2467263600ll,  2487823200ll},
+  {10, -300, 2049,  2499318000ll,  2519877600ll},
+  {10, -300, 2050,  2530767600ll,  2551327200ll},
+  {10, -300, 2051,  2562217200ll,  2582776800ll},
+  {10, -300, 2052,  2593666800ll,  2614226400ll},
+  {10, -300, 2053,  2625116400ll,  2645676000ll},
+  {10, -300, 2054,  2656566000ll,  2677125600ll},
+  {10, -300, 2055,  2688620400ll,  2709180000ll},
+  {10, -300, 2056,  2720070000ll,  2740629600ll},
+  {10, -300, 2057,  2751519600ll,  2772079200ll},
+  {10, -300, 2058,  2782969200ll,  2803528800ll},
+  {10, -300, 2059,  2814418800ll,  2834978400ll},
+  {10, -300, 2060,  2846473200ll,  2867032800ll},
+  {10, -300, 2061,  2877922800ll,  2898482400ll},
+  {10, -300, 2062,  2909372400ll,  2929932000ll},
+  {10, -300, 2063,  2940822000ll,  2961381600ll},
+  {10, -300, 2064,  2972271600ll,  2992831200ll},
+  {10, -300, 2065,  3003721200ll,  3024280800ll},
+  {10, -300, 2066,  3035775600ll,  3056335200ll},
+  {10, -300, 2067,  3067225200ll,  3087784800ll},
+  {10, -300, 2068,  3098674800ll,  3119234400ll},
+  {10, -300, 2069,  3130124400ll,  3150684000ll},
+  {10, -300, 2070,  3161574000ll,  3182133600ll},
+  {10, -300, 2071,  3193023600ll,  3213583200ll},
+  {10, -300, 2072,  3225078000ll,  3245637600ll},
+  {10, -300, 2073,  3256527600ll,  3277087200ll},
+  {10, -300, 2074,  3287977200ll,  3308536800ll},
+  {10, -300, 2075,  3319426800ll,  3339986400ll},
+  {10, -300, 2076,  3350876400ll,  3371436000ll},
+  {10, -300, 2077,  3382930800ll,  3403490400ll},
+  {10, -300, 2078,  3414380400ll,  3434940000ll},
+  {10, -300, 2079,  3445830000ll,  3466389600ll},
+  {10, -300, 2080,  3477279600ll,  3497839200ll},
+  {10, -300, 2081,  3508729200ll,  3529288800ll},
+  {10, -300, 2082,  3540178800ll,  3560738400ll},
+  {10, -300, 2083,  3572233200ll,  3592792800ll},
+  {10, -300, 2084,  3603682800ll,  3624242400ll},
+  {10, -300, 2085,  3635132400ll,  3655692000ll},
+  {10, -300, 2086,  3666582000ll,  3687141600ll},
+  {10, -300, 2087,  3698031600ll,  3718591200ll},
+  {10, -300, 2088,  3730086000ll,  3750645600ll},
+  {10, -300, 2089,  3761535600ll,  3782095200ll},
+  {10, -300, 2090,  3792985200ll,  3813544800ll},
+  {10, -300, 2091,  3824434800ll,  3844994400ll},
+  {10, -300, 2092,  3855884400ll,  3876444000ll},
+  {10, -300, 2093,  3887334000ll,  3907893600ll},
+  {10, -300, 2094,  3919388400ll,  3939948000ll},
+  {10, -300, 2095,  3950838000ll,  3971397600ll},
+  {10, -300, 2096,  3982287600ll,  4002847200ll},
+  {10, -300, 2097,  4013737200ll,  4034296800ll},
+  {10, -300, 2098,  4045186800ll,  4065746400ll},
+  {10, -300, 2099,  4076636400ll,  4097196000ll},
+
+  /* America/Asuncion (normal time UTC-4:00). */
+  {12, -240, 2013,  1381032000ll,  1364094000ll},
+  {12, -240, 2014,  1412481600ll,  1395543600ll},
+  {12, -240, 2015,  1443931200ll,  1426993200ll},
+  {12, -240, 2016,  1475380800ll,  1459047600ll},
+  {12, -240, 2017,  1506830400ll,  1490497200ll},
+  {12, -240, 2018,  1538884800ll,  1521946800ll},
+  {12, -240, 2019,  1570334400ll,  1553396400ll},
+  {12, -240, 2020,  1601784000ll,  1584846000ll},
+  {12, -240, 2021,  1633233600ll,  1616900400ll},
+  {12, -240, 2022,  1664683200ll,  1648350000ll},
+  {12, -240, 2023,  1696132800ll,  1679799600ll}
+};
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=main() */
+/* ============================================================================================================================================================= *\
+                                                                          Main program entry point.
+\* ============================================================================================================================================================= */
+int main(void)
+{
+  UINT16 Loop1UInt16;
+
+  UINT32 Errors;
+
+  INT64 EndTime;
+  INT64 StartTime;
+
+
+  Errors  = test_calendar(1970, 2200);
+  Errors += test_jobs();
+  for (Loop1UInt16 = 0; Loop1UInt16 < (sizeof(Reference) / sizeof(Reference[0])); ++Loop1UInt16)
+  {
+    if (ntp_dst_get_changes(Reference[Loop1UInt16].Country, Reference[Loop1UInt16].Year, Reference[Loop1UInt16].DeltaTime, &StartTime, &EndTime) != 0)
+    {
+      printf("Country %2u   %4u: DST changes not found\n", Reference[Loop1UInt16].Country, Reference[Loop1UInt16].Year);
+      ++Errors;
+      continue;
+    }
+
+    if ((StartTime != Reference[Loop1UInt16].Start) || (EndTime != Reference[Loop1UInt16].End))
+    {
+      printf("Country %2u   %4u:\n", Reference[Loop1UInt16].Country, Reference[Loop1UInt16].Year);
+      test_print((const UCHAR *)"start", StartTime, Reference[Loop1UInt16].Start);
+      test_print((const UCHAR *)"end",   EndTime,   Reference[Loop1UInt16].End);
+      ++Errors;
+    }
+  }
+
+  printf("\n%s (%u change(s) checked, %lu error(s))\n", (Errors == 0) ? "PASS" : "FAIL", Loop1UInt16, (unsigned long)Errors);
+
+  return (Errors == 0) ? 0 : 1;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_calendar() */
+/* ============================================================================================================================================================= *\
+                                             Verify calendar computations for every day of the range of years given.
+                     NOTE: Each day is checked against the C library (gmtime_r()): day-of-week, day-of-year, number of days in the month and
+                           conversion of its midnight to Unix time. Throughput of ntp_get_day_of_week() and ntp_get_day_of_year() is also measured.
+                           Return the number of errors.
+\* ============================================================================================================================================================= */
+static UINT32 test_calendar(UINT16 FirstYear, UINT16 LastYear)
+{
+  UINT8 DayOfMonth;
+  UINT8 Month;
+
+  UINT16 Year;
+
+  UINT32 Days;
+  UINT32 Errors;
+
+  double Elapsed;
+
+  time_t UnixTime;
+
+  volatile UINT32 Sum;
+
+  struct timespec EndTime;
+  struct timespec StartTime;
+  struct tm Today;
+  struct tm Tomorrow;
+
+
+  if (FirstYear < 1970) FirstYear = 1970;
+
+
+  /* Walk every day since 01-JAN-1970 (the reference being the C library), up to the end of the last year. */
+  Days     = 0;
+  Errors   = 0;
+  UnixTime = 0;
+  gmtime_r(&UnixTime, &Tomorrow);
+  while ((Tomorrow.tm_year + 1900) <= LastYear)
+  {
+    Today     = Tomorrow;
+    UnixTime += 86400;
+    gmtime_r(&UnixTime, &Tomorrow);
+
+    DayOfMonth = Today.tm_mday;
+    Month      = Today.tm_mon + 1;
+    Year       = Today.tm_year + 1900;
+    if (Year < FirstYear) continue;
+    ++Days;
+
+    if (ntp_get_day_of_week(DayOfMonth, Month, Year) != Today.tm_wday)
+    {
+      if (++Errors <= 10) printf("%2.2u-%2.2u-%4.4u: day-of-week %u instead of %u\n", DayOfMonth, Month, Year, ntp_get_day_of_week(DayOfMonth, Month, Year), Today.tm_wday);
+    }
+
+    if (ntp_get_day_of_year(DayOfMonth, Month, Year) != (Today.tm_yday + 1))
+    {
+      if (++Errors <= 10) printf("%2.2u-%2.2u-%4.4u: day-of-year %u instead of %u\n", DayOfMonth, Month, Year, ntp_get_day_of_year(DayOfMonth, Month, Year), Today.tm_yday + 1);
+    }
+
+    if (ntp_convert_tm_to_unix(&Today) != (UINT64)(UnixTime - 86400))
+    {
+      if (++Errors <= 10) printf("%2.2u-%2.2u-%4.4u: Unix time %llu instead of %lld\n", DayOfMonth, Month, Year, (unsigned long long)ntp_convert_tm_to_unix(&Today), (long long)(UnixTime - 86400));
+    }
+
+    /* Last day of a month: it must be the number of days in this month. */
+    if ((Tomorrow.tm_mday == 1) && (ntp_get_month_days(Month, Year) != DayOfMonth))
+    {
+      if (++Errors <= 10) printf("%2.2u-%4.4u: %u days instead of %u\n", Month, Year, ntp_get_month_days(Month, Year), DayOfMonth);
+    }
+  }
+
+
+  /* Throughput of the day-of-week and day-of-year computations, for all days of the range. */
+  Sum = 0;
+  clock_gettime(CLOCK_MONOTONIC, &StartTime);
+  for (Year = FirstYear; Year <= LastYear; ++Year)
+  {
+    for (Month = 1; Month <= 12; ++Month)
+    {
+      for (DayOfMonth = 1; DayOfMonth <= ntp_get_month_days(Month, Year); ++DayOfMonth)
+      {
+        Sum += ntp_get_day_of_week(DayOfMonth, Month, Year);
+        Sum += ntp_get_day_of_year(DayOfMonth, Month, Year);
+      }
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &EndTime);
+  Elapsed = (double)(EndTime.tv_sec - StartTime.tv_sec) + ((double)(EndTime.tv_nsec - StartTime.tv_nsec) / 1e9);
+
+  printf("Calendar %4u to %4u: %lu days checked, %lu error(s)", FirstYear, LastYear, (unsigned long)Days, (unsigned long)Errors);
+  if (Elapsed > 0.0) printf("   (%.0f days/s)", (double)Days / Elapsed);
+  printf("\n");
+
+  return Errors;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_jobs() */
+/* ============================================================================================================================================================= *\
+                                                               Verify the next occurrence of timer wheel jobs.
+                                                                    NOTE: Return the number of errors.
+\* ============================================================================================================================================================= */
+static UINT32 test_jobs(void)
+{
+  UINT16 Loop1UInt16;
+
+  UINT32 Errors;
+
+  INT64 FireTime;
+
+  struct ntp_dst_zone Zone;
+
+
+  Errors = 0;
+  for (Loop1UInt16 = 0; Loop1UInt16 < (sizeof(Jobs) / sizeof(Jobs[0])); ++Loop1UInt16)
+  {
+    memset(&Zone, 0, sizeof(Zone));
+    Zone.Country      = Jobs[Loop1UInt16].Country;
+    Zone.DeltaTime    = Jobs[Loop1UInt16].DeltaTime;
+    Zone.ShiftMinutes = 60;
+
+    FireTime = ntp_dst_next(&Zone, Jobs[Loop1UInt16].Type, Jobs[Loop1UInt16].Day, Jobs[Loop1UInt16].Hour, Jobs[Loop1UInt16].Minute, 0, Jobs[Loop1UInt16].From);
+    if (FireTime != Jobs[Loop1UInt16].Expected)
+    {
+      printf("Job <%s>:\n", Jobs[Loop1UInt16].Name);
+      test_print((const UCHAR *)"next", FireTime, Jobs[Loop1UInt16].Expected);
+      ++Errors;
+    }
+  }
+  printf("Timer wheel: %u job(s) checked, %lu error(s)\n", Loop1UInt16, (unsigned long)Errors);
+
+  return Errors;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_print() */
+/* ============================================================================================================================================================= *\
+                                                                 Print a UTC time with the difference found.
+\* ============================================================================================================================================================= */
+static void test_print(const UCHAR *Label, INT64 Time, INT64 Reference)
+{
+  UCHAR String[32];
+
+  time_t UnixTime;
+
+  struct tm TmTime;
+
+
+  UnixTime = (time_t)Time;
+  gmtime_r(&UnixTime, &TmTime);
+  strftime((char *)String, sizeof(String), "%d-%b-%Y %H:%M:%S", &TmTime);
+
+  printf("  %-5s %s UTC   (%+lld minutes from reference)\n", Label, String, (long long)((Time - Reference) / 60));
+
+  return;
+}
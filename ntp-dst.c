@@ -0,0 +1,447 @@
+/* ============================================================================================================================================================= *\
+   ntp-dst.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Daylight saving time rules and changes, calendar computations (see ntp-dst.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include "ntp-dst.h"
+
+
+
+/* Return the number of days since 01-JAN-1970 of the date given. */
+static INT32 ntp_dst_days(UINT8 DayOfMonth, UINT8 Month, UINT16 Year);
+
+
+
+/* Daylight saving time (DST) parameters for all countries of the world (or almost). */
+struct dst_parameters DstParameters[25] =
+{
+  { 0,  0,  0,  0, 24,  0,  0,  0,  0,  0,  0,  0, 60, NTP_DST_LOCAL},  //  0 - Dummy
+  {10,  0,  1,  7,  2,  0,  4,  0,  1,  7,  3,  0, 60, NTP_DST_LOCAL},  //  1 - Australia
+  {10,  0,  1,  7,  2,  0,  4,  0,  1,  7,  2,  0, 30, NTP_DST_LOCAL},  //  2 - Australia-Howe
+  { 9,  6,  1,  7, 24,  0,  4,  6,  1,  7, 24,  0, 60, NTP_DST_LOCAL},  //  3 - Chile           (StartHour and EndHour changes at 24h00, will change at 00h00 the day after)
+  { 3,  0,  8, 14,  0,  0, 11,  0,  1,  7,  1,  0, 60, NTP_DST_LOCAL},  //  4 - Cuba
+  { 3,  0, 25, 31,  1,  0, 10,  0, 25, 31,  1,  0, 60, NTP_DST_UTC},    //  5 - European Union  (StartHour and EndHour are based on UTC time)
+  { 3,  5, 23, 29,  2,  0, 10,  0, 25, 31,  2,  0, 60, NTP_DST_LOCAL},  //  6 - Israel
+  { 3,  0, 25, 31,  0,  0, 10,  0, 25, 31,  0,  0, 60, NTP_DST_LOCAL},  //  7 - Lebanon
+  { 3,  0, 25, 31,  2,  0, 10,  0, 25, 31,  3,  0, 60, NTP_DST_LOCAL},  //  8 - Moldova
+  { 9,  0, 24, 30,  2,  0,  4,  0,  1,  7,  3,  0, 60, NTP_DST_LOCAL},  //  9 - New-Zealand     (changes at 02h00 normal time, that is 03h00 summer time for DST end)
+  { 3,  0,  8, 14,  2,  0, 11,  0,  1,  7,  2,  0, 60, NTP_DST_LOCAL},  // 10 - North America
+  { 3,  6, 24, 30,  2,  0, 10,  6, 24, 30,  2,  0, 60, NTP_DST_LOCAL},  // 11 - Palestine
+  {10,  0,  1,  7,  0,  0,  3,  0, 22, 28,  0,  0, 60, NTP_DST_LOCAL},  // 12 - Paraguay
+};
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_convert_human_to_tm() */
+/* ============================================================================================================================================================= *\
+                                                                  Convert "HumanTime" to "tm_time".
+\* ============================================================================================================================================================= */
+void ntp_convert_human_to_tm(struct human_time *HumanTime, struct tm *TmTime)
+{
+  TmTime->tm_mday  = HumanTime->DayOfMonth;     // tm_mday: 1 to 31
+  TmTime->tm_mon   = HumanTime->Month - 1;      // tm_mon:  months since January (0 to 11)
+  TmTime->tm_year  = HumanTime->Year - 1900;    // tm_year: years since 1900
+  TmTime->tm_wday  = HumanTime->DayOfWeek;      // tm_wday: Sunday = 0 (...)  Saturday = 6
+  TmTime->tm_yday  = HumanTime->DayOfYear - 1;  // tm_yday: 0 to 365
+  TmTime->tm_hour  = HumanTime->Hour;           // tm_hour: 0 to 23
+  TmTime->tm_min   = HumanTime->Minute;         // tm_min:  0 to 59
+  TmTime->tm_sec   = HumanTime->Second;         // tm_sec:  0 to 59
+  TmTime->tm_isdst = 0;                         // tm_isdst: (if < 0 means not used)   (if > 0 means FLAG_ON)   (if = 0 means FLAG_OFF)
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_convert_human_to_unix() */
+/* ============================================================================================================================================================= *\
+                                                                  Convert "HumanTime" to "Unix Time".
+                                                         NOTE: Unix Time is based on UTC time, not local time.
+\* ============================================================================================================================================================= */
+UINT64 ntp_convert_human_to_unix(struct human_time *HumanTime)
+{
+  UINT64 UnixTime;
+
+  struct tm TempTime;
+
+
+  ntp_convert_human_to_tm(HumanTime, &TempTime);
+  UnixTime = ntp_convert_tm_to_unix(&TempTime);
+
+  return UnixTime;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_convert_tm_to_unix() */
+/* ============================================================================================================================================================= *\
+                                                                     Convert "TmTime" to "Unix Time".
+                                                         NOTE: Unix Time is based on UTC time, not local time.
+                         Computed from the date and time fields (tm_wday, tm_yday and tm_isdst are ignored), so that the result doesn't depend
+                         on the time zone of the C library as with mktime(). Fields must be in their normal range (no normalization).
+\* ============================================================================================================================================================= */
+UINT64 ntp_convert_tm_to_unix(struct tm *TmTime)
+{
+  INT64 UnixTime;
+
+
+  UnixTime  = (INT64)ntp_dst_days(TmTime->tm_mday, TmTime->tm_mon + 1, TmTime->tm_year + 1900) * 86400ll;
+  UnixTime += ((INT64)TmTime->tm_hour * 3600ll) + ((INT64)TmTime->tm_min * 60ll) + TmTime->tm_sec;
+
+  return (UINT64)UnixTime;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_dst_days() */
+/* ============================================================================================================================================================= *\
+                                                          Return the number of days since 01-JAN-1970 of the date given.
+                                   NOTE: Proleptic Gregorian calendar, with years starting in March so that February 29th is the last day.
+\* ============================================================================================================================================================= */
+static INT32 ntp_dst_days(UINT8 DayOfMonth, UINT8 Month, UINT16 Year)
+{
+  INT32 Era;
+  INT32 DayOfEra;
+  INT32 MarchYear;
+  INT32 YearOfEra;
+
+
+  MarchYear = (INT32)Year - (Month <= 2);
+  Era       = MarchYear / 400;
+  YearOfEra = MarchYear - (Era * 400);
+  DayOfEra  = (YearOfEra * 365) + (YearOfEra / 4) - (YearOfEra / 100) + ((((153 * (Month + ((Month > 2) ? -3 : 9))) + 2) / 5) + DayOfMonth - 1);
+
+  return (Era * 146097) + DayOfEra - 719468;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_dst_find_day() */
+/* ============================================================================================================================================================= *\
+                     Return the day-of-month of a daylight saving time change (first day-of-week given, within the days-of-month given).
+                                                               NOTE: Return 0 if no such day has been found.
+\* ============================================================================================================================================================= */
+UINT8 ntp_dst_find_day(UINT8 Month, UINT8 DayOfWeek, UINT8 DayOfMonthLow, UINT8 DayOfMonthHigh, UINT16 Year)
+{
+  UINT8 Loop1UInt8;
+
+
+  if ((Month < 1) || (Month > 12)) return 0;
+
+  /* 01-JAN-1970 was a Thursday (day-of-week 4). */
+  for (Loop1UInt8 = DayOfMonthLow; Loop1UInt8 <= DayOfMonthHigh; ++Loop1UInt8)
+    if (((((ntp_dst_days(Loop1UInt8, Month, Year) + 4) % 7) + 7) % 7) == DayOfWeek) return Loop1UInt8;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_dst_get_changes() */
+/* ============================================================================================================================================================= *\
+                        Return the UTC times (in seconds since 01-JAN-1970) when daylight saving time starts and ends during the year given.
+                   NOTE: DeltaTime is the difference (in minutes) between local normal time and UTC. DST starts during normal time and ends
+                         during summer time, so ShiftMinutes is also taken into account for the end of a change given in local time.
+                         Return 0 if both changes have been found.
+\* ============================================================================================================================================================= */
+UINT8 ntp_dst_get_changes(UINT8 Country, UINT16 Year, INT16 DeltaTime, INT64 *StartTime, INT64 *EndTime)
+{
+  UINT8 EndDoM;
+  UINT8 StartDoM;
+
+  struct dst_parameters *Parameters;
+
+
+  if ((Country == 0) || (Country > MAX_DST_COUNTRIES)) return 1;
+  Parameters = &DstParameters[Country];
+
+  StartDoM = ntp_dst_find_day(Parameters->StartMonth, Parameters->StartDayOfWeek, Parameters->StartDayOfMonthLow, Parameters->StartDayOfMonthHigh, Year);
+  EndDoM   = ntp_dst_find_day(Parameters->EndMonth,   Parameters->EndDayOfWeek,   Parameters->EndDayOfMonthLow,   Parameters->EndDayOfMonthHigh,   Year);
+  if ((StartDoM == 0) || (EndDoM == 0)) return 1;
+
+  *StartTime = ((INT64)ntp_dst_days(StartDoM, Parameters->StartMonth, Year) * 86400ll) + ((INT64)Parameters->StartHour * 3600ll);
+  *EndTime   = ((INT64)ntp_dst_days(EndDoM,   Parameters->EndMonth,   Year) * 86400ll) + ((INT64)Parameters->EndHour   * 3600ll);
+
+  if (Parameters->HourBase == NTP_DST_LOCAL)
+  {
+    *StartTime -= ((INT64)DeltaTime * 60ll);
+    *EndTime   -= ((INT64)(DeltaTime + Parameters->ShiftMinutes) * 60ll);
+  }
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_dst_is_summer() */
+/* ============================================================================================================================================================= *\
+                             Return FLAG_ON if daylight saving time is active at the UTC time given (in seconds since 01-JAN-1970).
+                  NOTE: Same transitions as ntp_dst_get_changes(), computed for the year of the time given and kept in the zone until another
+                        year is needed. The caller must set Year to 0 when it changes Country or DeltaTime.
+\* ============================================================================================================================================================= */
+UINT8 ntp_dst_is_summer(struct ntp_dst_zone *Zone, INT64 UTCTime)
+{
+  UINT16 Year;
+
+  time_t Seconds;
+
+  struct tm TmTime;
+
+
+  if ((Zone->Country == 0) || (Zone->Country > MAX_DST_COUNTRIES)) return FLAG_OFF;
+
+  Seconds = (time_t)UTCTime;
+  gmtime_r(&Seconds, &TmTime);
+  Year = TmTime.tm_year + 1900;
+
+  if (Year != Zone->Year)
+  {
+    Zone->Year  = Year;
+    Zone->Start = 0ll;
+    Zone->End   = 0ll;
+
+    if (ntp_dst_get_changes(Zone->Country, Year, Zone->DeltaTime, &Zone->Start, &Zone->End) != 0) return FLAG_OFF;
+  }
+
+  if (Zone->Start == Zone->End) return FLAG_OFF;
+
+  /* Northern country: DST between start and end. Southern country: DST except between end and start. */
+  if (DstParameters[Zone->Country].StartMonth < DstParameters[Zone->Country].EndMonth)
+    return (((UTCTime >= Zone->Start) && (UTCTime < Zone->End)) ? FLAG_ON : FLAG_OFF);
+  else
+    return (((UTCTime >= Zone->End) && (UTCTime < Zone->Start)) ? FLAG_OFF : FLAG_ON);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_dst_next() */
+/* ============================================================================================================================================================= *\
+                  Return the first UTC time (in seconds since 01-JAN-1970) after the one given when a daily, weekly or monthly local wall time happens.
+                  NOTE: Type is NTP_JOB_DAILY, NTP_JOB_WEEKLY (Day is the day-of-week, Sunday = 0) or NTP_JOB_MONTHLY (Day is the day-of-month,
+                        the last day of a month having fewer days is used). Local days are checked one after the other from the local date of
+                        the time given (at most 62 days for a monthly job).
+\* ============================================================================================================================================================= */
+INT64 ntp_dst_next(struct ntp_dst_zone *Zone, UINT8 Type, UINT8 Day, UINT8 Hour, UINT8 Minute, UINT8 Second, INT64 UTCTime)
+{
+  UINT8 DayOfMonth;
+  UINT8 Loop1UInt8;
+
+  INT64 FireTime;
+  INT64 LocalDay;
+  INT64 LocalTime;
+
+  time_t Seconds;
+
+  struct tm TmTime;
+
+
+  LocalTime = UTCTime + (Zone->DeltaTime * 60);
+  if (ntp_dst_is_summer(Zone, UTCTime)) LocalTime += (Zone->ShiftMinutes * 60);
+  LocalDay = LocalTime / 86400ll;
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < 64; ++Loop1UInt8, ++LocalDay)
+  {
+    Seconds = (time_t)(LocalDay * 86400ll);
+    gmtime_r(&Seconds, &TmTime);
+
+    if ((Type == NTP_JOB_WEEKLY) && (TmTime.tm_wday != Day)) continue;
+
+    if (Type == NTP_JOB_MONTHLY)
+    {
+      DayOfMonth = ntp_get_month_days(TmTime.tm_mon + 1, TmTime.tm_year + 1900);
+      if (Day < DayOfMonth) DayOfMonth = Day;
+      if (TmTime.tm_mday != DayOfMonth) continue;
+    }
+
+    FireTime = ntp_dst_to_utc(Zone, (LocalDay * 86400ll) + (Hour * 3600l) + (Minute * 60) + Second);
+    if (FireTime > UTCTime) return FireTime;
+  }
+
+  /* Not reached with a valid rule. */
+  return UTCTime + 86400ll;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_dst_to_utc() */
+/* ============================================================================================================================================================= *\
+                        Return the UTC time (in seconds since 01-JAN-1970) when a local wall time (in seconds since 01-JAN-1970) happens.
+                  NOTE: Wall time repeated at the end of DST: the first occurrence (summer time) is returned, so that a job runs only once.
+                        Wall time skipped at the start of DST: the start of DST is returned, so that a job is never lost.
+\* ============================================================================================================================================================= */
+INT64 ntp_dst_to_utc(struct ntp_dst_zone *Zone, INT64 WallTime)
+{
+  INT64 Standard;
+  INT64 Summer;
+
+
+  Standard = WallTime - (Zone->DeltaTime * 60);
+  Summer   = Standard - (Zone->ShiftMinutes * 60);
+
+  if (ntp_dst_is_summer(Zone, Summer)) return Summer;
+
+  if (ntp_dst_is_summer(Zone, Standard) == FLAG_OFF) return Standard;
+
+  /* Only a wall time skipped at DST start is valid neither in summer time nor in normal time: Start is the one of its year. */
+  return Zone->Start;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_day_of_week() */
+/* ============================================================================================================================================================= *\
+                                               Return the day-of-week for the specified date. Sunday =  (...) Saturday =
+\* ============================================================================================================================================================= */
+UINT8 ntp_get_day_of_week(UINT8 DayOfMonth, UINT8 Month, UINT16 Year)
+{
+  UINT8 DayOfWeek;
+  UINT8 Table[12] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+
+
+  if ((Month < 1) || (Month > 12)) return 0;
+
+  Year -= Month < 3;
+  DayOfWeek = ((Year + (Year / 4) - (Year / 100) + (Year / 400) + Table[Month - 1] + DayOfMonth) % 7);
+
+  return DayOfWeek;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_day_of_year() */
+/* ============================================================================================================================================================= *\
+                                                          Determine the day-of-year of date given in argument.
+            NOTE: We shouldn't use log_info() in this function since the timestamp is not available when get_day_of_year() is called from ds3231_init()
+\* ============================================================================================================================================================= */
+UINT16 ntp_get_day_of_year(UINT8 DayOfMonth, UINT8 Month, UINT16 Year)
+{
+  UINT8 Loop1UInt8;
+  UINT8 MonthDays;
+
+  UINT16 TargetDayOfYear;
+
+
+  /// if (DebugBitMask & DEBUG_NTP) printf("[%4u]   DayOfMonth %u   Month: %u   Year: %u\r", __LINE__, DayOfMonth, Month, Year);
+  if ((Month < 1) || (Month > 12)) return 0;
+
+
+  /* Initializations. */
+  TargetDayOfYear = 0;
+
+  /* Add up all complete months. */
+  for (Loop1UInt8 = 1; Loop1UInt8 < Month; ++Loop1UInt8)
+  {
+    MonthDays = ntp_get_month_days(Loop1UInt8, Year);
+    TargetDayOfYear += MonthDays;
+
+    /// if (DebugBitMask & DEBUG_NTP)
+    ///   printf("[%4u]   Adding month %2u [%3s]   Number of days: %2u   (cumulative: %3u)\r", __LINE__, Loop1UInt8, ntp_get_short_month(Loop1UInt8), MonthDays, TargetDayOfYear);
+  }
+
+  /* Then add days of the last, partial month. */
+  /// if (DebugBitMask & DEBUG_NTP)
+  ///   printf("[%4u]   Final DayNumber after adding final partial month: (%u + %u) = %3u\r\r\r", __LINE__, TargetDayOfYear, DayOfMonth, TargetDayOfYear + DayOfMonth);
+
+  TargetDayOfYear += DayOfMonth;
+
+  return TargetDayOfYear;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_get_month_days() */
+/* ============================================================================================================================================================= *\
+                            Return the number of days of a specific month, given the specified year (to know if it is a leap year or not).
+\* ============================================================================================================================================================= */
+UINT8 ntp_get_month_days(UINT8 MonthNumber, UINT16 TargetYear)
+{
+  UINT8 NumberOfDays;
+
+
+  switch (MonthNumber)
+  {
+    case (1):
+    case (3):
+    case (5):
+    case (7):
+    case (8):
+    case (10):
+    case (12):
+      NumberOfDays = 31;
+    break;
+
+    case (4):
+    case (6):
+    case (9):
+    case (11):
+      NumberOfDays = 30;
+    break;
+
+    case 2:
+      /* February, we must check if it is a leap year. */
+      if (((TargetYear % 4 == 0) && (TargetYear % 100 != 0)) || (TargetYear % 400 == 0))
+      {
+        /* This is a leap year. */
+        NumberOfDays = 29;
+      }
+      else
+      {
+        /* Not a leap year. */
+        NumberOfDays = 28;
+      }
+    break;
+
+    default:
+      /* Invalid month number. */
+      NumberOfDays = 0;
+    break;
+  }
+
+  return NumberOfDays;
+}
@@ -0,0 +1,120 @@
+/* ============================================================================================================================================================= *\
+   ntp-dst.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.00
+
+   Daylight saving time (DST) rules of the countries supported by Pico-NTP-Module, and computation of the UTC times when DST starts
+   and ends during a given year. Next occurrence of a daily, weekly or monthly local wall time (used by the timer wheel of Pico-NTP-Module).
+   Calendar computations (day-of-week, day-of-year, days in a month, conversions to Unix time).
+   This file doesn't depend on the Pico SDK so that it may also be compiled on a host computer (see ntp-dst-test.c).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release (moved from Pico-NTP-Module.c), change hour of a country given in local time or in UTC.
+                    - Calendar computations also moved from Pico-NTP-Module.c, checked every day from 1970 to 2200 by ntp-dst-test.c.
+                    - Next occurrence of a local wall time across DST changes moved from the timer wheel of Pico-NTP-Module.c (ntp_dst_next()).
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_DST_H
+#define _NTP_DST_H
+
+#include "baseline.h"
+#include <time.h>
+
+
+#define MAX_DST_COUNTRIES         12   // must be adjusted if more countries are added to DstParameters[].
+
+#define NTP_DST_LOCAL              0   // StartHour and EndHour are local time (normal time for DST start, summer time for DST end).
+#define NTP_DST_UTC                1   // StartHour and EndHour are UTC time (same instant in every time zone of the country).
+
+#define NTP_JOB_DAILY              0   // every day, at the local time given.
+#define NTP_JOB_WEEKLY             1   // every week, on the day-of-week given (Sunday = 0).
+#define NTP_JOB_MONTHLY            2   // every month, on the day-of-month given (last day of the month if it has fewer days).
+
+
+/* Daylight saving time (DST) parameters for all countries of the world (or almost). */
+struct dst_parameters
+{
+  UINT8  StartMonth;
+  UINT8  StartDayOfWeek;
+  int8_t StartDayOfMonthLow;
+  int8_t StartDayOfMonthHigh;
+  UINT8  StartHour;
+  UINT16 StartDayOfYear;
+  UINT8  EndMonth;
+  UINT8  EndDayOfWeek;
+  int8_t EndDayOfMonthLow;
+  int8_t EndDayOfMonthHigh;
+  UINT8  EndHour;
+  UINT16 EndDayOfYear;
+  UINT8  ShiftMinutes;
+  UINT8  HourBase;               // NTP_DST_LOCAL or NTP_DST_UTC.
+};
+
+extern struct dst_parameters DstParameters[25];
+
+
+/* Structure to contain time stamp under "human" format instead of "tm" standard. */
+struct human_time
+{
+  UINT8 FlagDst;
+  UINT8 Hour;
+  UINT8 Minute;
+  UINT8 Second;
+  UINT8 DayOfWeek;
+  UINT8 DayOfMonth;
+  UINT8 Month;
+  UINT16 Year;
+  UINT16 DayOfYear;
+};
+
+
+/* Time zone of a local wall time, with the DST changes of the last year used (see ntp_dst_next()). */
+struct ntp_dst_zone
+{
+  UINT8  Country;                // DST country (index in DstParameters[], 0 = no DST).
+  INT16  DeltaTime;              // difference (in minutes) between local normal time and UTC.
+  INT16  ShiftMinutes;           // difference (in minutes) between summer time and normal time.
+  UINT16 Year;                   // year of the DST changes below (0 = not computed yet).
+  INT64  Start;                  // UTC time (in seconds since 01-JAN-1970) when DST starts during Year.
+  INT64  End;                    // UTC time (in seconds since 01-JAN-1970) when DST ends during Year.
+};
+
+
+/* Convert "HumanTime" to "tm_time". */
+void ntp_convert_human_to_tm(struct human_time *HumanTime, struct tm *TmTime);
+
+/* Convert "HumanTime" to "Unix Time". */
+UINT64 ntp_convert_human_to_unix(struct human_time *HumanTime);
+
+/* Convert "TmTime" to "Unix Time". */
+UINT64 ntp_convert_tm_to_unix(struct tm *TmTime);
+
+
+/* Return the day-of-month of a daylight saving time change (first day-of-week given, within the days-of-month given). */
+UINT8 ntp_dst_find_day(UINT8 Month, UINT8 DayOfWeek, UINT8 DayOfMonthLow, UINT8 DayOfMonthHigh, UINT16 Year);
+
+/* Return the UTC times (in seconds since 01-JAN-1970) when daylight saving time starts and ends during the year given. */
+UINT8 ntp_dst_get_changes(UINT8 Country, UINT16 Year, INT16 DeltaTime, INT64 *StartTime, INT64 *EndTime);
+
+/* Return FLAG_ON if daylight saving time is active at the UTC time given (in seconds since 01-JAN-1970). */
+UINT8 ntp_dst_is_summer(struct ntp_dst_zone *Zone, INT64 UTCTime);
+
+/* Return the first UTC time (in seconds since 01-JAN-1970) after the one given when a daily, weekly or monthly local wall time happens. */
+INT64 ntp_dst_next(struct ntp_dst_zone *Zone, UINT8 Type, UINT8 Day, UINT8 Hour, UINT8 Minute, UINT8 Second, INT64 UTCTime);
+
+/* Return the UTC time (in seconds since 01-JAN-1970) when a local wall time (in seconds since 01-JAN-1970) happens. */
+INT64 ntp_dst_to_utc(struct ntp_dst_zone *Zone, INT64 WallTime);
+
+/* Return the day-of-week for the specified date. Sunday =  (...) Saturday =  */
+UINT8 ntp_get_day_of_week(UINT8 DayOfMonth, UINT8 Month, UINT16 Year);
+
+/* Determine the day-of-year of date given in argument. */
+UINT16 ntp_get_day_of_year(UINT8 DayOfMonth, UINT8 Month, UINT16 Year);
+
+/* Return the number of days of a specific month, given the specified year (to know if it is a leap year or not). */
+UINT8 ntp_get_month_days(UINT8 MonthNumber, UINT16 TargetYear);
+
+#endif  // _NTP_DST_H
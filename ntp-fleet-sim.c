@@ -0,0 +1,1335 @@
+/* ============================================================================================================================================================= *\
+   ntp-fleet-sim.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.20
+
+   Host computer simulation of a fleet of Pico-NTP-Module clients synchronizing against local NTP server(s).
+   Each virtual client has its own crystal frequency error, Wi-Fi delay distribution, packet loss and reboot schedule, and runs the same
+   disciplined clock (ntp-clock.c) and the same timestamp arithmetic (ntp-timestamp.c) as the Pico. The poll / retry policy of
+   ntp_get_time() is reproduced with the same parameters (NTP_REFRESH, NTP_SCAN_FACTOR, NTP_RETRY and NTP_RESEND_TIME), which may be
+   changed from the command line to evaluate a new policy before it is deployed.
+   Everything is driven by an event queue and a virtual clock, so that days of operation of thousands of clients are simulated in seconds.
+
+   The simulator reports:
+   - accuracy distribution of the fleet (difference between each client's clock and true time, sampled periodically),
+   - queries per second received by the servers, including the peak following a simulated power cut ("thundering herd"),
+   - convergence time (from boot to the first time a client's error is within a given threshold),
+   - optionally, firing error of events scheduled at the same UTC instant on every client (ntp_schedule_at()): each client maps the
+     instant onto its Pico timer, re-maps it after each clock update, and the true time at which its timer reaches it is compared to
+     the instant (and to the other clients),
+   - optionally, the effect of a daily temperature cycle on the crystal of each client (frequency error following a quadratic curve of
+     temperature), with or without the temperature compensation of ntp_tempco_init() (ntp-tempco.c, trained by the disciplined clock).
+
+   Build and run on a host computer (only needs a copy of baseline.h for the type definitions):
+       gcc -O2 -o ntp-fleet-sim ntp-fleet-sim.c ntp-adev.c ntp-clock.c ntp-tempco.c ntp-timestamp.c -lm
+       ./ntp-fleet-sim -n 2000 -h 48 -c 24
+       ./ntp-fleet-sim -n 200 -h 24 -a 600 -L 300     (synchronized event every 10 minutes, scheduled 5 minutes ahead)
+       ./ntp-fleet-sim -n 200 -h 96 -m 0 -c -1 -k 20 -p 900 -s 8 -i 900 [-K]   (20 degree C daily swing, one request every 2 hours, [compensated])
+   Run "./ntp-fleet-sim -?" for the list of options.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+               1.10 - Add firing error benchmark of ntp_schedule_at().
+               1.20 - Add synthetic temperature traces and crystal temperature compensation (ntp-tempco.c).
+\* ============================================================================================================================================================= */
+
+#include <math.h>
+#include <unistd.h>
+
+#include "ntp-clock.h"
+#include "ntp-tempco.h"
+#include "ntp-timestamp.h"
+
+
+/* Default policy, same as Pico-NTP-Module.h. */
+#define SIM_REFRESH               3600   // interval between two calls to ntp_get_time() (in seconds).
+#define SIM_SCAN_FACTOR             24   // number of calls to ntp_get_time() for each NTP request when healthy.
+#define SIM_RETRY                  600   // delay before retrying after a failed request (in seconds).
+#define SIM_RESEND_TIME             10   // delay before declaring a request lost (in seconds).
+
+#define SIM_EPOCH      1792281600000000ll  // true UTC time at the beginning of the simulation (18-OCT-2026 00:00:00, in usec).
+#define SIM_MAX_SERVERS             16   // maximum number of NTP servers.
+#define SIM_SERVER_TIME             50   // time taken by a server to answer a request (in usec).
+#define SIM_BUCKETS                  7   // number of buckets in the accuracy distribution.
+
+#define SIM_TEMP_STEP               60   // interval between two temperature changes (and sensor readings) of the clients (in seconds).
+#define SIM_TEMP_TURNOVER         25.0   // temperature (in degree C) the crystal curve is centered on.
+#define SIM_TEMP_SLOPE           150.0   // standard deviation of the linear temperature coefficient of the crystals (in ppb / degree C).
+#define SIM_TEMP_CURVATURE        35.0   // maximum quadratic temperature coefficient of the crystals (in ppb / degree C^2, always negative).
+#define SIM_TEMP_NOISE             0.5   // standard deviation of the temperature sensor noise (in degree C).
+
+#define SIM_EVENT_POWER_UP           0   // client is powered up.
+#define SIM_EVENT_BOOT               8   // client's Wi-Fi is connected and it calls ntp_get_time() for the first time.
+#define SIM_EVENT_GET_TIME           1   // client's UpdateTime is reached and it calls ntp_get_time().
+#define SIM_EVENT_SERVER             2   // request arrives at a server.
+#define SIM_EVENT_REPLY              3   // reply arrives at the client.
+#define SIM_EVENT_TIMEOUT            4   // request is declared lost (ntp_failed_handler()).
+#define SIM_EVENT_REBOOT             5   // client is restarted.
+#define SIM_EVENT_POWER_CUT          6   // all clients are switched off.
+#define SIM_EVENT_SAMPLE             7   // accuracy of the whole fleet is measured.
+#define SIM_EVENT_SCHEDULE           9   // every client calls ntp_schedule_at() for the next synchronized event.
+#define SIM_EVENT_FIRE              10   // alarm armed by a client for a scheduled event expires.
+#define SIM_EVENT_TEMPERATURE       11   // temperature of every client changes (and is read by clients compensating their crystal).
+
+
+struct sim_client
+{
+  struct ntp_clock Clock;        // disciplined clock, exactly as in struct_ntp.
+  INT32  DriftPpb;               // frequency error of the client's crystal (in parts per billion, positive when running fast).
+  UINT32 DelayMin;               // minimum one-way network delay (in usec).
+  UINT32 DelayMean;              // mean of the exponential part of the one-way network delay (Wi-Fi retries, power save, etc.).
+  UINT16 LossPermil;             // packet loss probability (per thousand, in each direction).
+  UINT8  FlagUp;                 // client is powered on.
+  UINT8  FlagHealth;             // last NTP request succeeded.
+  UINT8  FlagPending;            // an NTP request is in flight.
+  UINT8  FlagConverged;          // client's error has been within threshold since last boot.
+  UINT8  ScanCount;              // number of calls to ntp_get_time() since last NTP request.
+  UINT32 Generation;             // incremented at each boot, so that events from a previous boot are ignored.
+  UINT32 Request;                // number of the request in flight.
+  INT64  BootTime;               // true time (in usec) at which the Pico timer started (power-up).
+  INT64  UpdateTime;             // true time (in usec) of next call to ntp_get_time().
+  UINT64 Send;                   // Pico timer value when the request in flight was sent.
+  UINT8  FlagFire;               // a synchronized event is scheduled (ntp_schedule_at()).
+  INT64  FireUTC;                // UTC time (in usec since 01-JAN-1970) of the scheduled event.
+  UINT64 FireLocal;              // Pico timer value the alarm is armed for.
+  UINT32 FireArm;                // incremented each time the alarm is armed, so that an alarm re-mapped since is ignored.
+  INT32  BaseDriftPpb;           // frequency error of the crystal at SIM_TEMP_TURNOVER (DriftPpb when temperature is not simulated).
+  double Slope;                  // linear temperature coefficient of the crystal (in ppb / degree C).
+  double Curvature;              // quadratic temperature coefficient of the crystal (in ppb / degree C^2).
+  double TempMean;               // mean temperature of the client's location (in degree C).
+  double TempPhase;              // shift of the client's daily temperature cycle (in seconds).
+  INT64  DriftTime;              // true time (in usec) since which DriftPpb applies.
+  UINT64 DriftLocal;             // Pico timer value at DriftTime.
+  struct ntp_tempco Tempco;      // temperature model of the crystal (when compensation is simulated).
+};
+
+
+struct sim_event
+{
+  INT64  Time;                   // true time of the event (in usec since beginning of simulation).
+  UINT32 Client;                 // client (or server for SIM_EVENT_SERVER requests) concerned.
+  UINT32 Generation;             // client generation when the event was scheduled.
+  UINT32 Request;                // request number for SIM_EVENT_SERVER, SIM_EVENT_REPLY and SIM_EVENT_TIMEOUT.
+  UINT8  Type;                   // SIM_EVENT_xxx.
+  UINT8  Server;                 // server handling the request.
+  INT64  T2;                     // server receive time (in usec since 01-JAN-1970).
+  INT64  T3;                     // server transmit time (in usec since 01-JAN-1970).
+};
+
+
+struct sim_config
+{
+  UINT32 Clients;                // number of virtual clients.
+  UINT32 Servers;                // number of NTP servers (clients pick one at random for each request, as with a DNS pool).
+  UINT32 Capacity;               // maximum number of requests answered by each server per second (0 = unlimited).
+  UINT32 Hours;                  // duration of the simulation.
+  UINT32 Stagger;                // clients initially boot at random during this period (in seconds).
+  INT32  PowerCut;               // hour at which all clients lose power (-1 = no power cut).
+  UINT32 Outage;                 // duration of the power cut (in seconds).
+  UINT32 BootMin;                // minimum time from power-up to Wi-Fi connected (in seconds).
+  UINT32 BootSpread;             // random part of the time from power-up to Wi-Fi connected (in seconds).
+  UINT32 BootJitter;             // random delay added before the first NTP request after boot (policy under test, in seconds).
+  UINT32 RebootHours;            // mean time between two reboots of a client (0 = no reboots).
+  double DriftPpm;               // standard deviation of the crystal frequency error (in ppm).
+  double JitterMs;               // maximum mean of the exponential part of the Wi-Fi delay (in msec).
+  double LossPercent;            // maximum packet loss probability (in percent).
+  UINT32 Threshold;              // error within which a client is considered converged (in usec).
+  UINT32 SampleInterval;         // interval between two accuracy measurements (in seconds).
+  UINT32 Refresh;                // policy: NTP_REFRESH.
+  UINT32 ScanFactor;             // policy: NTP_SCAN_FACTOR.
+  UINT32 Retry;                  // policy: NTP_RETRY.
+  UINT32 ResendTime;             // policy: NTP_RESEND_TIME.
+  UINT64 Seed;                   // random number generator seed.
+  UINT32 FireInterval;           // interval between two synchronized events (in seconds, 0 = none).
+  UINT32 FireLead;               // synchronized events are scheduled this long before their instant (in seconds).
+  double TempSwing;              // daily temperature swing (peak to peak, in degree C, 0 = constant temperature).
+  UINT8  FlagTempco;             // clients compensate their crystal for temperature (ntp_tempco_init()).
+};
+
+
+struct sim_stats
+{
+  UINT32 *Queries;               // number of requests received by all servers, for each second of the simulation.
+  UINT64  Requests;              // requests sent by the clients.
+  UINT64  Replies;               // replies received by the clients.
+  UINT64  Lost;                  // requests or replies lost on the network.
+  UINT64  Dropped;               // requests dropped by a server over capacity.
+  UINT64  Timeouts;              // requests declared lost by the clients.
+  UINT64  Boots;                 // client boots.
+  UINT64  Steps;                 // clock steps after the first sync following a boot.
+  UINT64  Buckets[SIM_BUCKETS + 1];  // accuracy distribution over all samples (last entry: clients not synchronized).
+  double *Convergence;           // convergence time of each boot (in seconds).
+  UINT32  ConvergenceCount;
+  UINT32  ConvergenceSize;
+  INT64  *Errors;                // absolute errors of the current accuracy sample (in usec).
+  UINT32  ServerSecond[SIM_MAX_SERVERS];  // second during which each server received its last request.
+  UINT32  ServerQueries[SIM_MAX_SERVERS]; // number of requests received by each server during that second.
+  INT64  *FireErrors;            // firing error of each scheduled event (true time of firing - instant, in usec).
+  UINT32  FireCount;
+  UINT32  FireSize;
+  UINT64  FireRemaps;            // alarms armed again after a clock update.
+  INT64   FireInstant;           // instant of the synchronized event whose firings are being collected.
+  INT64   FireFirst;             // earliest and latest firing (true time) of the clients for that event.
+  INT64   FireLast;
+  UINT32  FireEvents;            // number of synchronized events that fired on at least one client.
+  INT64   FireSpreadSum;         // sum and maximum of the fleet spread (latest - earliest firing) of each event.
+  INT64   FireSpreadMax;
+  UINT64  TempcoErrors;          // number of clients whose frequency error has been measured at the end of the simulation.
+  double  TempcoSum;             // sum of the absolute residual frequency error of those clients (in ppb).
+};
+
+
+
+/* qsort() comparison function for absolute errors. */
+static int sim_compare_error(const void *ErrorA, const void *ErrorB);
+
+/* qsort() comparison function for convergence times. */
+static int sim_compare_seconds(const void *SecondsA, const void *SecondsB);
+
+/* Dispatch one event. */
+static void sim_dispatch(struct sim_event *Event);
+
+/* Return a random delay following an exponential distribution of the mean given. */
+static double sim_exponential(double Mean);
+
+/* Client arms (or re-arms) the alarm of its scheduled event. */
+static void sim_fire_arm(UINT32 ClientNumber, INT64 Time);
+
+/* Record the firing of a scheduled event. */
+static void sim_fire_record(INT64 Time, INT64 Instant);
+
+/* Return the Pico timer value of a client at the true time given. */
+static UINT64 sim_get_local(struct sim_client *Client, INT64 Time);
+
+/* Return the true temperature (in degree C) of a client at the true time given. */
+static double sim_get_temperature(struct sim_client *Client, INT64 Time);
+
+/* Client calls ntp_get_time(). */
+static void sim_get_time(UINT32 ClientNumber, INT64 Time);
+
+/* Return the true time at which the Pico timer of a client reaches the value given. */
+static INT64 sim_get_true(struct sim_client *Client, UINT64 LocalTime);
+
+/* Remove the earliest event from the queue. Return 0 when the queue is empty. */
+static UINT8 sim_pop(struct sim_event *Event);
+
+/* Add an event to the queue. */
+static void sim_push(struct sim_event *Event);
+
+/* Return a random number between 0 and 1 (excluded). */
+static double sim_random(void);
+
+/* Return a random number following a normal distribution. */
+static double sim_random_normal(void);
+
+/* Record a convergence time. */
+static void sim_record_convergence(double Seconds);
+
+/* Display the final report. */
+static void sim_report(void);
+
+/* Measure the accuracy of the whole fleet and display one line of results. */
+static void sim_sample(INT64 Time);
+
+/* Change the temperature of every client, hence the frequency of its crystal. */
+static void sim_temperature(INT64 Time);
+
+/* Schedule an event. */
+static void sim_schedule(INT64 Time, UINT8 Type, UINT32 ClientNumber, UINT32 Request);
+
+/* Boot a client (power-up or reboot). */
+static void sim_start_client(UINT32 ClientNumber, INT64 Time);
+
+/* Display command line options. */
+static void sim_usage(UCHAR *Name);
+
+
+
+/* Global variables. */
+static struct sim_config Config = {2000, 1, 0, 48, 3600, 24, 60, 3, 5, 0, 168, 10.0, 20.0, 2.0, 10000, 3600, SIM_REFRESH, SIM_SCAN_FACTOR, SIM_RETRY, SIM_RESEND_TIME, 1, 0, 300, 0.0, FLAG_OFF};
+
+static struct sim_client *Clients;
+static struct sim_event  *Queue;
+static struct sim_stats   Stats;
+
+static UINT32 QueueCount;
+static UINT32 QueueSize;
+static UINT64 RandomState;
+
+static const UCHAR *BucketName[SIM_BUCKETS + 1] = {"< 100 us", "< 1 ms", "< 10 ms", "< 100 ms", "< 1 s", "< 10 s", ">= 10 s", "unsynchronized"};
+static const INT64  BucketLimit[SIM_BUCKETS]    = {100ll, 1000ll, 10000ll, 100000ll, 1000000ll, 10000000ll, INT64_MAX};
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=main() */
+/* ============================================================================================================================================================= *\
+                                                                          Main program entry point.
+\* ============================================================================================================================================================= */
+int main(int argc, char *argv[])
+{
+  INT Option;
+
+  UINT32 Loop1UInt32;
+
+  INT64 Duration;
+
+  struct sim_client *Client;
+
+  struct sim_event Event;
+
+
+  while ((Option = getopt(argc, argv, "n:S:q:h:g:c:o:b:B:j:m:f:d:l:e:i:p:s:r:t:x:a:L:k:K")) != -1)
+  {
+    switch (Option)
+    {
+      case ('n'): Config.Clients        = strtoul(optarg, NULL, 10); break;
+      case ('S'): Config.Servers        = strtoul(optarg, NULL, 10); break;
+      case ('q'): Config.Capacity       = strtoul(optarg, NULL, 10); break;
+      case ('h'): Config.Hours          = strtoul(optarg, NULL, 10); break;
+      case ('g'): Config.Stagger        = strtoul(optarg, NULL, 10); break;
+      case ('c'): Config.PowerCut       = strtol(optarg, NULL, 10);  break;
+      case ('o'): Config.Outage         = strtoul(optarg, NULL, 10); break;
+      case ('b'): Config.BootMin        = strtoul(optarg, NULL, 10); break;
+      case ('B'): Config.BootSpread     = strtoul(optarg, NULL, 10); break;
+      case ('j'): Config.BootJitter     = strtoul(optarg, NULL, 10); break;
+      case ('m'): Config.RebootHours    = strtoul(optarg, NULL, 10); break;
+      case ('f'): Config.DriftPpm       = strtod(optarg, NULL);      break;
+      case ('d'): Config.JitterMs       = strtod(optarg, NULL);      break;
+      case ('l'): Config.LossPercent    = strtod(optarg, NULL);      break;
+      case ('e'): Config.Threshold      = strtoul(optarg, NULL, 10); break;
+      case ('i'): Config.SampleInterval = strtoul(optarg, NULL, 10); break;
+      case ('p'): Config.Refresh        = strtoul(optarg, NULL, 10); break;
+      case ('s'): Config.ScanFactor     = strtoul(optarg, NULL, 10); break;
+      case ('r'): Config.Retry          = strtoul(optarg, NULL, 10); break;
+      case ('t'): Config.ResendTime     = strtoul(optarg, NULL, 10); break;
+      case ('x'): Config.Seed           = strtoull(optarg, NULL, 10); break;
+      case ('a'): Config.FireInterval   = strtoul(optarg, NULL, 10); break;
+      case ('L'): Config.FireLead       = strtoul(optarg, NULL, 10); break;
+      case ('k'): Config.TempSwing      = strtod(optarg, NULL);      break;
+      case ('K'): Config.FlagTempco     = FLAG_ON;                   break;
+
+      default:
+        sim_usage(argv[0]);
+        return 1;
+    }
+  }
+
+  if ((Config.Clients == 0) || (Config.Servers == 0) || (Config.Servers > SIM_MAX_SERVERS) || (Config.Hours == 0) || (Config.SampleInterval == 0) || (Config.Refresh == 0) || (Config.ScanFactor == 0))
+  {
+    sim_usage(argv[0]);
+    return 1;
+  }
+
+
+  /* Allocate the fleet and the statistics. */
+  RandomState = Config.Seed ? Config.Seed : 1;
+  Duration    = (INT64)Config.Hours * 3600ll * 1000000ll;
+  Clients     = calloc(Config.Clients, sizeof(struct sim_client));
+  Stats.Queries = calloc((Duration / 1000000ll) + 1, sizeof(UINT32));
+  Stats.Errors  = calloc(Config.Clients, sizeof(INT64));
+  if ((Clients == NULL) || (Stats.Queries == NULL) || (Stats.Errors == NULL))
+  {
+    printf("Not enough memory for %u clients.\n", Config.Clients);
+    return 1;
+  }
+
+
+  /* Draw the characteristics of each client and schedule its first boot. */
+  for (Loop1UInt32 = 0; Loop1UInt32 < Config.Clients; ++Loop1UInt32)
+  {
+    Client = &Clients[Loop1UInt32];
+    Client->DriftPpb   = (INT32)(sim_random_normal() * Config.DriftPpm * 1000.0);
+    Client->DelayMin   = 1000 + (UINT32)(sim_random() * 4000.0);
+    Client->DelayMean  = (UINT32)(sim_random() * Config.JitterMs * 1000.0);
+    Client->LossPermil = (UINT16)(sim_random() * Config.LossPercent * 10.0);
+    Client->BaseDriftPpb = Client->DriftPpb;
+    if ((Config.TempSwing > 0.0) || (Config.FlagTempco))
+    {
+      Client->Slope     = sim_random_normal() * SIM_TEMP_SLOPE;
+      Client->Curvature = -sim_random() * SIM_TEMP_CURVATURE;
+      Client->TempMean  = 15.0 + (sim_random_normal() * 5.0);
+      Client->TempPhase = (sim_random() - 0.5) * 7200.0;
+    }
+    sim_schedule((INT64)(sim_random() * Config.Stagger * 1000000.0), SIM_EVENT_POWER_UP, Loop1UInt32, 0);
+  }
+
+  if (Config.PowerCut >= 0) sim_schedule((INT64)Config.PowerCut * 3600ll * 1000000ll, SIM_EVENT_POWER_CUT, 0, 0);
+  sim_schedule((INT64)Config.SampleInterval * 1000000ll, SIM_EVENT_SAMPLE, 0, 0);
+  if (Config.FireInterval) sim_schedule((INT64)Config.FireInterval * 1000000ll, SIM_EVENT_SCHEDULE, 0, 0);
+  if ((Config.TempSwing > 0.0) || (Config.FlagTempco)) sim_schedule(SIM_TEMP_STEP * 1000000ll, SIM_EVENT_TEMPERATURE, 0, 0);
+
+
+  printf("Simulating %u clients against %u server(s) for %u hours (refresh: %u s   scan factor: %u   retry: %u s   resend: %u s   boot jitter: %u s)\n\n",
+         Config.Clients, Config.Servers, Config.Hours, Config.Refresh, Config.ScanFactor, Config.Retry, Config.ResendTime, Config.BootJitter);
+  printf("  Time    Synced      p50 (us)      p95 (us)      p99 (us)      max (us)   Peak QPS\n");
+
+
+  /* Main event loop. */
+  while (sim_pop(&Event))
+  {
+    if (Event.Time > Duration) break;
+    sim_dispatch(&Event);
+  }
+
+  sim_report();
+
+  free(Clients);
+  free(Queue);
+  free(Stats.Queries);
+  free(Stats.Errors);
+  free(Stats.Convergence);
+  free(Stats.FireErrors);
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_compare_error() */
+/* ============================================================================================================================================================= *\
+                                                                 qsort() comparison function for absolute errors.
+\* ============================================================================================================================================================= */
+static int sim_compare_error(const void *ErrorA, const void *ErrorB)
+{
+  if (*(const INT64 *)ErrorA < *(const INT64 *)ErrorB) return -1;
+  if (*(const INT64 *)ErrorA > *(const INT64 *)ErrorB) return 1;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_compare_seconds() */
+/* ============================================================================================================================================================= *\
+                                                                qsort() comparison function for convergence times.
+\* ============================================================================================================================================================= */
+static int sim_compare_seconds(const void *SecondsA, const void *SecondsB)
+{
+  if (*(const double *)SecondsA < *(const double *)SecondsB) return -1;
+  if (*(const double *)SecondsA > *(const double *)SecondsB) return 1;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_dispatch() */
+/* ============================================================================================================================================================= *\
+                                                                                Dispatch one event.
+                    NOTE: Events scheduled before a client reboots (or before its next call to ntp_get_time() has been rescheduled) are simply ignored.
+\* ============================================================================================================================================================= */
+static void sim_dispatch(struct sim_event *Event)
+{
+  UINT32 Loop1UInt32;
+  UINT32 Second;
+
+  INT64 Delay;
+  INT64 LocalReceive;
+  INT64 PivotTime;
+  INT64 UTCTime;
+
+  UINT64 LocalTime;
+
+  ntp_timestamp_t T1;
+  ntp_timestamp_t T2;
+  ntp_timestamp_t T3;
+  ntp_timestamp_t T4;
+
+  ntp_tsdiff_t Offset;
+
+  UINT64 Receive;
+
+  struct sim_client *Client;
+
+
+  Client = &Clients[Event->Client];
+
+  switch (Event->Type)
+  {
+    case (SIM_EVENT_BOOT):
+      if ((Event->Generation != Client->Generation) || (Client->FlagUp == FLAG_OFF)) break;
+      sim_get_time(Event->Client, Event->Time);
+    break;
+
+
+    case (SIM_EVENT_GET_TIME):
+      if ((Event->Generation != Client->Generation) || (Client->FlagUp == FLAG_OFF) || (Event->Time != Client->UpdateTime)) break;
+      sim_get_time(Event->Client, Event->Time);
+    break;
+
+
+    case (SIM_EVENT_SERVER):
+      /* Requests are counted even if the client has rebooted since: the server doesn't know. */
+      Second = (UINT32)(Event->Time / 1000000ll);
+      ++Stats.Queries[Second];
+
+      /* Server over capacity for this second drops the request (rate limiting). Events are processed in time order. */
+      if (Stats.ServerSecond[Event->Server] != Second)
+      {
+        Stats.ServerSecond[Event->Server]  = Second;
+        Stats.ServerQueries[Event->Server] = 0;
+      }
+      if ((Config.Capacity != 0) && (++Stats.ServerQueries[Event->Server] > Config.Capacity))
+      {
+        ++Stats.Dropped;
+        break;
+      }
+
+      /* Reply may also be lost on the way back. */
+      if ((sim_random() * 1000.0) < Client->LossPermil)
+      {
+        ++Stats.Lost;
+        break;
+      }
+
+      Event->T2 = SIM_EPOCH + Event->Time;
+      Event->T3 = Event->T2 + SIM_SERVER_TIME;
+      Delay     = Client->DelayMin + (INT64)sim_exponential(Client->DelayMean);
+      Event->Type  = SIM_EVENT_REPLY;
+      Event->Time += SIM_SERVER_TIME + Delay;
+      sim_push(Event);
+    break;
+
+
+    case (SIM_EVENT_REPLY):
+      if ((Event->Generation != Client->Generation) || (Client->FlagUp == FLAG_OFF) || (Client->FlagPending == FLAG_OFF) || (Event->Request != Client->Request)) break;
+
+      ++Stats.Replies;
+      Client->FlagPending = FLAG_OFF;
+      Client->FlagHealth  = FLAG_ON;
+      Receive = sim_get_local(Client, Event->Time);
+
+      /* Same computation as ntp_result(). */
+      if (Client->Clock.FlagValid)
+        PivotTime = ntp_clock_get_utc_us(&Client->Clock, Receive);
+      else
+        PivotTime = NTP_TS_PIVOT * 1000000ll;
+
+      T2 = ntp_ts_from_unix_us(Event->T2);
+      T3 = ntp_ts_from_unix_us(Event->T3);
+
+      if (Client->Clock.FlagValid)
+        LocalReceive = PivotTime;
+      else
+        LocalReceive = ntp_ts_to_unix_us(T3, PivotTime);
+      T4 = ntp_ts_from_unix_us(LocalReceive);
+      T1 = ntp_ts_from_unix_us(LocalReceive - (INT64)(Receive - Client->Send));
+
+      Offset = ntp_tsdiff_add(ntp_ts_diff(T2, T1), ntp_ts_diff(T3, T4)) / 2;
+
+      if ((ntp_clock_sample(&Client->Clock, Receive, LocalReceive + ntp_tsdiff_to_us(Offset), NTP_SOURCE_NETWORK) == NTP_CLOCK_STEPPED) && (Client->Clock.SampleCount > 1)) ++Stats.Steps;
+
+      /* Same as ntp_schedule_remap(): a pending event follows the clock update. */
+      if ((Client->FlagFire) && (ntp_clock_get_local_us(&Client->Clock, Client->FireUTC) != Client->FireLocal))
+      {
+        ++Stats.FireRemaps;
+        sim_fire_arm(Event->Client, Event->Time);
+      }
+
+      /* Convergence: first time the client's error is within threshold since boot. */
+      UTCTime = ntp_clock_get_utc_us(&Client->Clock, Receive) - (SIM_EPOCH + Event->Time);
+      if (UTCTime < 0) UTCTime = -UTCTime;
+      if ((Client->FlagConverged == FLAG_OFF) && (UTCTime <= Config.Threshold))
+      {
+        Client->FlagConverged = FLAG_ON;
+        sim_record_convergence((double)(Event->Time - Client->BootTime) / 1000000.0);
+      }
+    break;
+
+
+    case (SIM_EVENT_TIMEOUT):
+      if ((Event->Generation != Client->Generation) || (Client->FlagUp == FLAG_OFF) || (Client->FlagPending == FLAG_OFF) || (Event->Request != Client->Request)) break;
+
+      /* Same as ntp_failed_handler(): health is lost and a new request is made after NTP_RETRY. */
+      ++Stats.Timeouts;
+      Client->FlagPending = FLAG_OFF;
+      Client->FlagHealth  = FLAG_OFF;
+      Client->UpdateTime  = Event->Time + ((INT64)Config.Retry * 1000000ll);
+      sim_schedule(Client->UpdateTime, SIM_EVENT_GET_TIME, Event->Client, 0);
+    break;
+
+
+    case (SIM_EVENT_POWER_UP):
+      if (Event->Generation != Client->Generation) break;
+      sim_start_client(Event->Client, Event->Time);
+    break;
+
+
+    case (SIM_EVENT_REBOOT):
+      if ((Event->Generation != Client->Generation) || (Client->FlagUp == FLAG_OFF)) break;
+      sim_start_client(Event->Client, Event->Time);
+    break;
+
+
+    case (SIM_EVENT_POWER_CUT):
+      /* Every client goes down, then powers up again when power comes back. */
+      for (Loop1UInt32 = 0; Loop1UInt32 < Config.Clients; ++Loop1UInt32)
+      {
+        Clients[Loop1UInt32].FlagUp = FLAG_OFF;
+        ++Clients[Loop1UInt32].Generation;
+        sim_schedule(Event->Time + ((INT64)Config.Outage * 1000000ll), SIM_EVENT_POWER_UP, Loop1UInt32, 0);
+      }
+    break;
+
+
+    case (SIM_EVENT_SAMPLE):
+      sim_sample(Event->Time);
+      sim_schedule(Event->Time + ((INT64)Config.SampleInterval * 1000000ll), SIM_EVENT_SAMPLE, 0, 0);
+    break;
+
+
+    case (SIM_EVENT_SCHEDULE):
+      /* Every synchronized client schedules the same UTC instant, FireLead seconds ahead (one event at a time: clients still waiting for the previous one skip it). */
+      for (Loop1UInt32 = 0; Loop1UInt32 < Config.Clients; ++Loop1UInt32)
+      {
+        if ((Clients[Loop1UInt32].FlagUp == FLAG_OFF) || (Clients[Loop1UInt32].Clock.FlagValid == FLAG_OFF) || (Clients[Loop1UInt32].FlagFire)) continue;
+        Clients[Loop1UInt32].FlagFire = FLAG_ON;
+        Clients[Loop1UInt32].FireUTC  = SIM_EPOCH + Event->Time + ((INT64)Config.FireLead * 1000000ll);
+        sim_fire_arm(Loop1UInt32, Event->Time);
+      }
+      sim_schedule(Event->Time + ((INT64)Config.FireInterval * 1000000ll), SIM_EVENT_SCHEDULE, 0, 0);
+    break;
+
+
+    case (SIM_EVENT_FIRE):
+      if ((Event->Generation != Client->Generation) || (Client->FlagUp == FLAG_OFF) || (Client->FlagFire == FLAG_OFF) || (Event->Request != Client->FireArm)) break;
+
+      /* Same as ntp_schedule_handler(): if the clock has been stepped back since, the alarm is armed again. */
+      LocalTime = sim_get_local(Client, Event->Time);
+      if (ntp_clock_get_local_us(&Client->Clock, Client->FireUTC) > LocalTime)
+      {
+        sim_fire_arm(Event->Client, Event->Time);
+        break;
+      }
+
+      Client->FlagFire = FLAG_OFF;
+      sim_fire_record(Event->Time, Client->FireUTC);
+    break;
+
+
+    case (SIM_EVENT_TEMPERATURE):
+      sim_temperature(Event->Time);
+      sim_schedule(Event->Time + (SIM_TEMP_STEP * 1000000ll), SIM_EVENT_TEMPERATURE, 0, 0);
+    break;
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_exponential() */
+/* ============================================================================================================================================================= *\
+                                                        Return a random delay following an exponential distribution of the mean given.
+\* ============================================================================================================================================================= */
+static double sim_exponential(double Mean)
+{
+  return -Mean * log(1.0 - sim_random());
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_fire_arm() */
+/* ============================================================================================================================================================= *\
+                                                   Client arms (or re-arms) the alarm of its scheduled event.
+                         NOTE: Same mapping as ntp_schedule_at(): the instant is converted to a Pico timer value with the disciplined clock,
+                               and the alarm expires when the Pico timer (running at the crystal frequency) reaches it.
+\* ============================================================================================================================================================= */
+static void sim_fire_arm(UINT32 ClientNumber, INT64 Time)
+{
+  UINT64 LocalNow;
+
+  struct sim_client *Client;
+
+  struct sim_event Event;
+
+
+  Client = &Clients[ClientNumber];
+
+  LocalNow          = sim_get_local(Client, Time);
+  Client->FireLocal = ntp_clock_get_local_us(&Client->Clock, Client->FireUTC);
+  ++Client->FireArm;
+
+  memset(&Event, 0, sizeof(Event));
+  Event.Time       = (Client->FireLocal > LocalNow) ? sim_get_true(Client, Client->FireLocal) : Time;
+  Event.Client     = ClientNumber;
+  Event.Generation = Client->Generation;
+  Event.Request    = Client->FireArm;
+  Event.Type       = SIM_EVENT_FIRE;
+  sim_push(&Event);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_fire_record() */
+/* ============================================================================================================================================================= *\
+                                                             Record the firing of a scheduled event.
+                  NOTE: Firings of the same event are processed in time order: the fleet spread of an event is complete when the first firing
+                        of the next one (or a call with Instant = 0) is recorded.
+\* ============================================================================================================================================================= */
+static void sim_fire_record(INT64 Time, INT64 Instant)
+{
+  if (Instant != Stats.FireInstant)
+  {
+    if (Stats.FireInstant != 0)
+    {
+      ++Stats.FireEvents;
+      Stats.FireSpreadSum += Stats.FireLast - Stats.FireFirst;
+      if ((Stats.FireLast - Stats.FireFirst) > Stats.FireSpreadMax) Stats.FireSpreadMax = Stats.FireLast - Stats.FireFirst;
+    }
+    Stats.FireInstant = Instant;
+    Stats.FireFirst   = Time;
+    Stats.FireLast    = Time;
+  }
+  if (Instant == 0) return;
+
+  if (Time < Stats.FireFirst) Stats.FireFirst = Time;
+  if (Time > Stats.FireLast)  Stats.FireLast  = Time;
+
+  if (Stats.FireCount == Stats.FireSize)
+  {
+    Stats.FireSize = Stats.FireSize ? (Stats.FireSize * 2) : 4096;
+    Stats.FireErrors = realloc(Stats.FireErrors, Stats.FireSize * sizeof(INT64));
+    if (Stats.FireErrors == NULL)
+    {
+      printf("Not enough memory for firing errors.\n");
+      exit(1);
+    }
+  }
+
+  Stats.FireErrors[Stats.FireCount++] = (SIM_EPOCH + Time) - Instant;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_get_local() */
+/* ============================================================================================================================================================= *\
+                                                              Return the Pico timer value of a client at the true time given.
+\* ============================================================================================================================================================= */
+static UINT64 sim_get_local(struct sim_client *Client, INT64 Time)
+{
+  INT64 Elapsed;
+
+
+  Elapsed = Time - Client->DriftTime;
+
+  return Client->DriftLocal + (UINT64)(Elapsed + ((Elapsed * Client->DriftPpb) / 1000000000ll));
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_get_temperature() */
+/* ============================================================================================================================================================= *\
+                                          Return the true temperature (in degree C) of a client at the true time given.
+                         NOTE: Daily sine cycle around the mean temperature of the client, coldest at about 04:00 and hottest at about 16:00.
+\* ============================================================================================================================================================= */
+static double sim_get_temperature(struct sim_client *Client, INT64 Time)
+{
+  double Seconds;
+
+
+  Seconds = ((double)Time / 1000000.0) + Client->TempPhase;
+
+  return Client->TempMean + ((Config.TempSwing / 2.0) * sin((2.0 * M_PI * (Seconds - 36000.0)) / 86400.0));
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_get_time() */
+/* ============================================================================================================================================================= *\
+                                                                          Client calls ntp_get_time().
+                           NOTE: Same decision as ntp_get_time(): when healthy, only one call out of NTP_SCAN_FACTOR sends a request to the server.
+\* ============================================================================================================================================================= */
+static void sim_get_time(UINT32 ClientNumber, INT64 Time)
+{
+  INT64 Delay;
+
+  struct sim_client *Client;
+
+  struct sim_event Event;
+
+
+  Client = &Clients[ClientNumber];
+
+  Client->UpdateTime = Time + ((INT64)Config.Refresh * 1000000ll);
+  sim_schedule(Client->UpdateTime, SIM_EVENT_GET_TIME, ClientNumber, 0);
+
+  if ((Client->FlagHealth) && (Client->ScanCount < Config.ScanFactor))
+  {
+    ++Client->ScanCount;
+    return;
+  }
+
+
+  /* Read cycle. */
+  Client->ScanCount   = 1;
+  Client->FlagPending = FLAG_ON;
+  Client->Send        = sim_get_local(Client, Time);
+  ++Client->Request;
+  ++Stats.Requests;
+
+  sim_schedule(Time + ((INT64)Config.ResendTime * 1000000ll), SIM_EVENT_TIMEOUT, ClientNumber, Client->Request);
+
+  if ((sim_random() * 1000.0) < Client->LossPermil)
+  {
+    ++Stats.Lost;
+    return;
+  }
+
+  Delay = Client->DelayMin + (INT64)sim_exponential(Client->DelayMean);
+
+  memset(&Event, 0, sizeof(Event));
+  Event.Time       = Time + Delay;
+  Event.Client     = ClientNumber;
+  Event.Generation = Client->Generation;
+  Event.Request    = Client->Request;
+  Event.Type       = SIM_EVENT_SERVER;
+  Event.Server     = (UINT8)(sim_random() * Config.Servers);
+  sim_push(&Event);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_get_true() */
+/* ============================================================================================================================================================= *\
+                                        Return the true time at which the Pico timer of a client reaches the value given.
+                                   NOTE: Inverse of sim_get_local(), rounded up to the first usec at which the timer has reached the value.
+\* ============================================================================================================================================================= */
+static INT64 sim_get_true(struct sim_client *Client, UINT64 LocalTime)
+{
+  INT64 Time;
+
+
+  Time = Client->DriftTime + (INT64)(((double)(INT64)(LocalTime - Client->DriftLocal) * 1000000000.0) / (1000000000.0 + Client->DriftPpb));
+  while (sim_get_local(Client, Time) < LocalTime) ++Time;
+
+  return Time;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_pop() */
+/* ============================================================================================================================================================= *\
+                                                            Remove the earliest event from the queue. Return 0 when the queue is empty.
+                                                                  NOTE: The queue is a binary heap ordered on event time.
+\* ============================================================================================================================================================= */
+static UINT8 sim_pop(struct sim_event *Event)
+{
+  UINT32 Child;
+  UINT32 Parent;
+
+  struct sim_event Last;
+
+
+  if (QueueCount == 0) return 0;
+
+  *Event = Queue[0];
+  Last   = Queue[--QueueCount];
+
+  Parent = 0;
+  while ((Child = (2 * Parent) + 1) < QueueCount)
+  {
+    if (((Child + 1) < QueueCount) && (Queue[Child + 1].Time < Queue[Child].Time)) ++Child;
+    if (Last.Time <= Queue[Child].Time) break;
+    Queue[Parent] = Queue[Child];
+    Parent = Child;
+  }
+  Queue[Parent] = Last;
+
+  return 1;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_push() */
+/* ============================================================================================================================================================= *\
+                                                                             Add an event to the queue.
+\* ============================================================================================================================================================= */
+static void sim_push(struct sim_event *Event)
+{
+  UINT32 Child;
+  UINT32 Parent;
+
+
+  if (QueueCount == QueueSize)
+  {
+    QueueSize = QueueSize ? (QueueSize * 2) : 4096;
+    Queue = realloc(Queue, QueueSize * sizeof(struct sim_event));
+    if (Queue == NULL)
+    {
+      printf("Not enough memory for event queue.\n");
+      exit(1);
+    }
+  }
+
+  Child = QueueCount++;
+  while (Child > 0)
+  {
+    Parent = (Child - 1) / 2;
+    if (Queue[Parent].Time <= Event->Time) break;
+    Queue[Child] = Queue[Parent];
+    Child = Parent;
+  }
+  Queue[Child] = *Event;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_random() */
+/* ============================================================================================================================================================= *\
+                                                                 Return a random number between 0 and 1 (excluded).
+                                             NOTE: xorshift64* generator, so that a given seed always gives the same simulation.
+\* ============================================================================================================================================================= */
+static double sim_random(void)
+{
+  RandomState ^= RandomState >> 12;
+  RandomState ^= RandomState << 25;
+  RandomState ^= RandomState >> 27;
+
+  return (double)((RandomState * 0x2545F4914F6CDD1Dull) >> 11) / 9007199254740992.0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_random_normal() */
+/* ============================================================================================================================================================= *\
+                                                                Return a random number following a normal distribution.
+\* ============================================================================================================================================================= */
+static double sim_random_normal(void)
+{
+  return sqrt(-2.0 * log(1.0 - sim_random())) * cos(2.0 * M_PI * sim_random());
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_record_convergence() */
+/* ============================================================================================================================================================= *\
+                                                                             Record a convergence time.
+\* ============================================================================================================================================================= */
+static void sim_record_convergence(double Seconds)
+{
+  if (Stats.ConvergenceCount == Stats.ConvergenceSize)
+  {
+    Stats.ConvergenceSize = Stats.ConvergenceSize ? (Stats.ConvergenceSize * 2) : 4096;
+    Stats.Convergence = realloc(Stats.Convergence, Stats.ConvergenceSize * sizeof(double));
+    if (Stats.Convergence == NULL)
+    {
+      printf("Not enough memory for convergence times.\n");
+      exit(1);
+    }
+  }
+
+  Stats.Convergence[Stats.ConvergenceCount++] = Seconds;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_report() */
+/* ============================================================================================================================================================= *\
+                                                                            Display the final report.
+\* ============================================================================================================================================================= */
+static void sim_report(void)
+{
+  UINT8 Loop1UInt8;
+
+  UINT32 Loop1UInt32;
+  UINT32 PeakQueries;
+  UINT32 PeakSecond;
+  UINT32 Seconds;
+
+  UINT64 TotalSamples;
+
+  double Mean;
+
+
+  printf("\nAccuracy distribution (all samples):\n");
+  TotalSamples = 0;
+  for (Loop1UInt8 = 0; Loop1UInt8 <= SIM_BUCKETS; ++Loop1UInt8)
+    TotalSamples += Stats.Buckets[Loop1UInt8];
+  for (Loop1UInt8 = 0; Loop1UInt8 <= SIM_BUCKETS; ++Loop1UInt8)
+    printf("  %-15s %10llu   %6.2f %%\n", BucketName[Loop1UInt8], (unsigned long long)Stats.Buckets[Loop1UInt8], TotalSamples ? (100.0 * Stats.Buckets[Loop1UInt8]) / TotalSamples : 0.0);
+
+
+  /* Server load. */
+  Seconds     = Config.Hours * 3600;
+  PeakQueries = 0;
+  PeakSecond  = 0;
+  for (Loop1UInt32 = 0; Loop1UInt32 < Seconds; ++Loop1UInt32)
+  {
+    if (Stats.Queries[Loop1UInt32] > PeakQueries)
+    {
+      PeakQueries = Stats.Queries[Loop1UInt32];
+      PeakSecond  = Loop1UInt32;
+    }
+  }
+
+  printf("\nServer load:\n");
+  printf("  Requests sent:        %10llu   (%.2f per second on average)\n", (unsigned long long)Stats.Requests, (double)Stats.Requests / Seconds);
+  printf("  Peak:                 %10u   requests in one second (all servers), at %02u:%02u:%02u\n", PeakQueries, PeakSecond / 3600, (PeakSecond / 60) % 60, PeakSecond % 60);
+  printf("  Dropped by servers:   %10llu\n", (unsigned long long)Stats.Dropped);
+  printf("  Lost on network:      %10llu\n", (unsigned long long)Stats.Lost);
+  printf("  Client timeouts:      %10llu\n", (unsigned long long)Stats.Timeouts);
+  printf("  Replies received:     %10llu\n", (unsigned long long)Stats.Replies);
+  printf("  Client boots:         %10llu\n", (unsigned long long)Stats.Boots);
+  printf("  Clock steps:          %10llu   (after first sync)\n", (unsigned long long)Stats.Steps);
+
+
+  /* Synchronized events. */
+  if (Config.FireInterval)
+  {
+    sim_fire_record(0ll, 0ll);  // close the last event.
+    printf("\nSynchronized events (ntp_schedule_at() every %u s, %u s ahead):\n", Config.FireInterval, Config.FireLead);
+    if (Stats.FireCount == 0)
+    {
+      printf("  No event fired.\n");
+    }
+    else
+    {
+      Mean = 0.0;
+      for (Loop1UInt32 = 0; Loop1UInt32 < Stats.FireCount; ++Loop1UInt32)
+      {
+        Mean += Stats.FireErrors[Loop1UInt32];
+        if (Stats.FireErrors[Loop1UInt32] < 0) Stats.FireErrors[Loop1UInt32] = -Stats.FireErrors[Loop1UInt32];
+      }
+      qsort(Stats.FireErrors, Stats.FireCount, sizeof(INT64), sim_compare_error);
+      printf("  Fired:  %u   (re-mapped after a clock update: %llu)   mean error: %.1f us\n", Stats.FireCount, (unsigned long long)Stats.FireRemaps, Mean / Stats.FireCount);
+      printf("  |error|  p50: %8lld us   p95: %8lld us   p99: %8lld us   max: %8lld us\n",
+             (long long)Stats.FireErrors[(Stats.FireCount * 50) / 100], (long long)Stats.FireErrors[(Stats.FireCount * 95) / 100],
+             (long long)Stats.FireErrors[(Stats.FireCount * 99) / 100], (long long)Stats.FireErrors[Stats.FireCount - 1]);
+      printf("  Fleet spread (latest - earliest firing of an event)   mean: %.1f us   max: %lld us\n", (double)Stats.FireSpreadSum / Stats.FireEvents, (long long)Stats.FireSpreadMax);
+    }
+  }
+
+
+  /* Residual frequency error: difference between the frequency correction of the disciplined clock and the true error of the crystal. */
+  if ((Config.TempSwing > 0.0) || (Config.FlagTempco))
+  {
+    printf("\nCrystal temperature (daily swing: %.1f degree C   compensation: %s):\n", Config.TempSwing, Config.FlagTempco ? "on" : "off");
+    for (Loop1UInt32 = 0; Loop1UInt32 < Config.Clients; ++Loop1UInt32)
+    {
+      if ((Clients[Loop1UInt32].FlagUp == FLAG_OFF) || (Clients[Loop1UInt32].Clock.FlagValid == FLAG_OFF)) continue;
+      Stats.TempcoSum += fabs((double)(Clients[Loop1UInt32].Clock.FrequencyPpb - Clients[Loop1UInt32].DriftPpb));
+      ++Stats.TempcoErrors;
+    }
+    if (Stats.TempcoErrors)
+      printf("  Mean |frequency error| of the disciplined clocks at the end: %.1f ppb   (%llu clients)\n", Stats.TempcoSum / Stats.TempcoErrors, (unsigned long long)Stats.TempcoErrors);
+  }
+
+
+  /* Convergence times. */
+  printf("\nConvergence time (boot to error within %u us):\n", Config.Threshold);
+  if (Stats.ConvergenceCount == 0)
+  {
+    printf("  No client converged.\n");
+    return;
+  }
+  qsort(Stats.Convergence, Stats.ConvergenceCount, sizeof(double), sim_compare_seconds);
+  printf("  Converged:  %u out of %llu boots\n", Stats.ConvergenceCount, (unsigned long long)Stats.Boots);
+  printf("  p50: %10.1f s   p90: %10.1f s   p99: %10.1f s   max: %10.1f s\n",
+         Stats.Convergence[(Stats.ConvergenceCount * 50) / 100], Stats.Convergence[(Stats.ConvergenceCount * 90) / 100],
+         Stats.Convergence[(Stats.ConvergenceCount * 99) / 100], Stats.Convergence[Stats.ConvergenceCount - 1]);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_sample() */
+/* ============================================================================================================================================================= *\
+                                                       Measure the accuracy of the whole fleet and display one line of results.
+                              NOTE: Peak QPS is the highest number of requests received by all servers during one second of the last sample interval.
+\* ============================================================================================================================================================= */
+static void sim_sample(INT64 Time)
+{
+  UINT8 Loop1UInt8;
+
+  UINT32 Count;
+  UINT32 Loop1UInt32;
+  UINT32 PeakQueries;
+  UINT32 Second;
+
+  INT64 Error;
+
+  struct sim_client *Client;
+
+
+  Count = 0;
+  for (Loop1UInt32 = 0; Loop1UInt32 < Config.Clients; ++Loop1UInt32)
+  {
+    Client = &Clients[Loop1UInt32];
+    if ((Client->FlagUp == FLAG_OFF) || (Client->Clock.FlagValid == FLAG_OFF))
+    {
+      ++Stats.Buckets[SIM_BUCKETS];
+      continue;
+    }
+
+    Error = ntp_clock_get_utc_us(&Client->Clock, sim_get_local(Client, Time)) - (SIM_EPOCH + Time);
+    if (Error < 0) Error = -Error;
+    Stats.Errors[Count++] = Error;
+
+    for (Loop1UInt8 = 0; Loop1UInt8 < SIM_BUCKETS; ++Loop1UInt8)
+      if (Error < BucketLimit[Loop1UInt8]) break;
+    ++Stats.Buckets[Loop1UInt8];
+  }
+
+  PeakQueries = 0;
+  for (Second = (UINT32)(Time / 1000000ll) - Config.SampleInterval; Second < (UINT32)(Time / 1000000ll); ++Second)
+    if (Stats.Queries[Second] > PeakQueries) PeakQueries = Stats.Queries[Second];
+
+  printf("%3lld:%02lld  %8u", Time / 3600000000ll, (Time / 60000000ll) % 60, Count);
+  if (Count)
+  {
+    qsort(Stats.Errors, Count, sizeof(INT64), sim_compare_error);
+    printf("  %12lld  %12lld  %12lld  %12lld", (long long)Stats.Errors[(Count * 50) / 100], (long long)Stats.Errors[(Count * 95) / 100], (long long)Stats.Errors[(Count * 99) / 100], (long long)Stats.Errors[Count - 1]);
+  }
+  else
+  {
+    printf("  %12s  %12s  %12s  %12s", "-", "-", "-", "-");
+  }
+  printf("  %9u\n", PeakQueries);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_schedule() */
+/* ============================================================================================================================================================= *\
+                                                                                Schedule an event.
+\* ============================================================================================================================================================= */
+static void sim_schedule(INT64 Time, UINT8 Type, UINT32 ClientNumber, UINT32 Request)
+{
+  struct sim_event Event;
+
+
+  memset(&Event, 0, sizeof(Event));
+  Event.Time       = Time;
+  Event.Type       = Type;
+  Event.Client     = ClientNumber;
+  Event.Generation = Clients[ClientNumber].Generation;
+  Event.Request    = Request;
+  sim_push(&Event);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_start_client() */
+/* ============================================================================================================================================================= *\
+                                                                      Boot a client (power-up or reboot).
+                       NOTE: Pico timer and disciplined clock restart from zero, as after ntp_init(). The first call to ntp_get_time() happens once
+                             Wi-Fi is connected, after the optional boot jitter. Next reboot of the client is also scheduled.
+\* ============================================================================================================================================================= */
+static void sim_start_client(UINT32 ClientNumber, INT64 Time)
+{
+  INT64 Boot;
+
+  struct sim_client *Client;
+
+
+  Client = &Clients[ClientNumber];
+
+  ++Client->Generation;
+  ++Stats.Boots;
+  Client->FlagUp        = FLAG_ON;
+  Client->FlagHealth    = FLAG_OFF;
+  Client->FlagPending   = FLAG_OFF;
+  Client->FlagConverged = FLAG_OFF;
+  Client->FlagFire      = FLAG_OFF;
+  Client->ScanCount     = 0;
+  Client->BootTime      = Time;
+  Client->DriftTime     = Time;
+  Client->DriftLocal    = 0ll;
+  ntp_clock_init(&Client->Clock);
+
+  /* Same as ntp_tempco_init(): the model starts from scratch at each boot, with a first temperature reading. */
+  if (Config.FlagTempco)
+  {
+    ntp_tempco_reset(&Client->Tempco);
+    ntp_tempco_temperature(&Client->Tempco, 0ll, (INT32)((sim_get_temperature(Client, Time) + (sim_random_normal() * SIM_TEMP_NOISE)) * 1000.0));
+    Client->Clock.Tempco = &Client->Tempco;
+  }
+
+  Boot = (INT64)((Config.BootMin + (sim_random() * Config.BootSpread) + (sim_random() * Config.BootJitter)) * 1000000.0);
+  sim_schedule(Time + Boot, SIM_EVENT_BOOT, ClientNumber, 0);
+
+  if (Config.RebootHours) sim_schedule(Time + (INT64)(sim_exponential(Config.RebootHours * 3600.0) * 1000000.0), SIM_EVENT_REBOOT, ClientNumber, 0);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_temperature() */
+/* ============================================================================================================================================================= *\
+                                           Change the temperature of every client, hence the frequency of its crystal.
+                  NOTE: The Pico timer mapping is re-based at each change, so that the frequency error of the crystal is piecewise constant.
+                        Clients compensating their crystal fit the measurement of their last sample, then read the temperature (with sensor
+                        noise) and feed the change forward, as the main loop does (ntp_tempco_update()). A pending
+                        scheduled event follows the clock update, as with ntp_schedule_remap().
+\* ============================================================================================================================================================= */
+static void sim_temperature(INT64 Time)
+{
+  INT32 Correction;
+
+  UINT32 Loop1UInt32;
+
+  UINT64 LocalTime;
+
+  double Temperature;
+
+  struct sim_client *Client;
+
+
+  for (Loop1UInt32 = 0; Loop1UInt32 < Config.Clients; ++Loop1UInt32)
+  {
+    Client = &Clients[Loop1UInt32];
+    if (Client->FlagUp == FLAG_OFF) continue;
+
+    LocalTime          = sim_get_local(Client, Time);
+    Temperature        = sim_get_temperature(Client, Time);
+    Client->DriftLocal = LocalTime;
+    Client->DriftTime  = Time;
+    Client->DriftPpb   = Client->BaseDriftPpb + (INT32)((Client->Slope * (Temperature - SIM_TEMP_TURNOVER)) + (Client->Curvature * (Temperature - SIM_TEMP_TURNOVER) * (Temperature - SIM_TEMP_TURNOVER)));
+
+    if (Config.FlagTempco)
+    {
+      ntp_tempco_fit(&Client->Tempco);
+      ntp_tempco_temperature(&Client->Tempco, LocalTime, (INT32)((Temperature + (sim_random_normal() * SIM_TEMP_NOISE)) * 1000.0));
+      Correction = ntp_tempco_correction(&Client->Tempco);
+      if (Correction != 0)
+      {
+        ntp_clock_adjust_frequency(&Client->Clock, LocalTime, Correction);
+        if ((Client->FlagFire) && (ntp_clock_get_local_us(&Client->Clock, Client->FireUTC) != Client->FireLocal)) ++Stats.FireRemaps;
+      }
+    }
+
+    /* True time of a pending alarm changes with the frequency of the crystal. */
+    if (Client->FlagFire) sim_fire_arm(Loop1UInt32, Time);
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=sim_usage() */
+/* ============================================================================================================================================================= *\
+                                                                          Display command line options.
+\* ============================================================================================================================================================= */
+static void sim_usage(UCHAR *Name)
+{
+  printf("Usage: %s [options]\n", Name);
+  printf("  Fleet:\n");
+  printf("    -n <count>    number of clients                                   (default: %u)\n",   Config.Clients);
+  printf("    -f <ppm>      standard deviation of crystal frequency error        (default: %.1f)\n", Config.DriftPpm);
+  printf("    -d <msec>     maximum mean of random Wi-Fi delay                   (default: %.1f)\n", Config.JitterMs);
+  printf("    -l <percent>  maximum packet loss                                  (default: %.1f)\n", Config.LossPercent);
+  printf("    -m <hours>    mean time between reboots of a client, 0 = never      (default: %u)\n",   Config.RebootHours);
+  printf("    -g <sec>      initial boots are spread over this period            (default: %u)\n",   Config.Stagger);
+  printf("    -b <sec>      minimum time from power-up to Wi-Fi connected        (default: %u)\n",   Config.BootMin);
+  printf("    -B <sec>      random part of time from power-up to Wi-Fi connected (default: %u)\n",   Config.BootSpread);
+  printf("  Servers:\n");
+  printf("    -S <count>    number of NTP servers (max %u)                       (default: %u)\n",   SIM_MAX_SERVERS, Config.Servers);
+  printf("    -q <qps>      requests answered per second by a server, 0 = no limit (default: %u)\n", Config.Capacity);
+  printf("  Scenario:\n");
+  printf("    -h <hours>    duration of the simulation                           (default: %u)\n",   Config.Hours);
+  printf("    -c <hour>     hour of the power cut, -1 = none                     (default: %d)\n",   Config.PowerCut);
+  printf("    -o <sec>      duration of the power cut                            (default: %u)\n",   Config.Outage);
+  printf("    -e <usec>     convergence threshold                                (default: %u)\n",   Config.Threshold);
+  printf("    -i <sec>      interval between accuracy samples                    (default: %u)\n",   Config.SampleInterval);
+  printf("    -a <sec>      interval between synchronized events, 0 = none       (default: %u)\n",   Config.FireInterval);
+  printf("    -L <sec>      synchronized events are scheduled this long ahead    (default: %u)\n",   Config.FireLead);
+  printf("    -k <deg C>    daily temperature swing (peak to peak), 0 = constant  (default: %.1f)\n", Config.TempSwing);
+  printf("    -K            compensate crystals for temperature (ntp_tempco_init())\n");
+  printf("    -x <seed>     random number generator seed                         (default: %llu)\n", (unsigned long long)Config.Seed);
+  printf("  Policy:\n");
+  printf("    -p <sec>      NTP_REFRESH                                          (default: %u)\n",   Config.Refresh);
+  printf("    -s <count>    NTP_SCAN_FACTOR                                      (default: %u)\n",   Config.ScanFactor);
+  printf("    -r <sec>      NTP_RETRY                                            (default: %u)\n",   Config.Retry);
+  printf("    -t <sec>      NTP_RESEND_TIME                                      (default: %u)\n",   Config.ResendTime);
+  printf("    -j <sec>      random delay before first request after boot         (default: %u)\n",   Config.BootJitter);
+
+  return;
+}
@@ -0,0 +1,152 @@
+/* ============================================================================================================================================================= *\
+   ntp-format-test.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Host computer regression test of the date and time formatting (ntp-format.c). Each template of the table below is compiled by
+   ntp_format_compile() and applied to a human time with the English language table; the return code of the compilation and the
+   string produced are compared with the expected ones. Also checked: a compiled template doesn't depend on the memory of its source
+   text, templates exceeding NTP_FORMAT_MAX_TEXT or NTP_FORMAT_MAX_OPS are rejected, and results are truncated to the buffer size.
+
+   Build and run on a host computer (only needs a copy of baseline.h for the type definitions):
+       gcc -O2 -Wall -Wno-pointer-sign -o ntp-format-test ntp-format-test.c ntp-format.c
+       ./ntp-format-test
+   Exit code is 0 when every check passes, 1 otherwise.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include "ntp-format.h"
+
+#include "ntp-lang-english.h"
+static const UCHAR *const NamesEnglish[NTP_NAME_COUNT] = NTP_LANGUAGE_NAMES;
+#include "ntp-lang-undef.h"
+
+
+struct test_format
+{
+  const UCHAR *Template;
+  UINT8  Hour;                   // hour of the human time formatted (other fields are those of TestTime).
+  UINT8  HourMode;               // H12 or H24, used by %K.
+  UINT8  Status;                 // expected return code of ntp_format_compile().
+  const UCHAR *Expected;         // expected result.
+};
+
+
+
+/* Check the result of a template. */
+static UINT8 test_check(const UCHAR *Label, UINT8 Status, UINT8 ExpectedStatus, const UCHAR *Result, const UCHAR *Expected);
+
+
+
+/* Sunday 18-OCT-2026, 14:05:09. */
+static const struct human_time TestTime = {0, 14, 5, 9, 0, 18, 10, 2026, 291};
+
+/* Templates and expected results. */
+static const struct test_format Reference[] =
+{
+  {"%A %e-%b-%Y   %H:%M:%S",  14, H24, NTP_FORMAT_OK, "Sunday 18-OCT-2026   14:05:09"},
+  {"%a %d %B %y",             14, H24, NTP_FORMAT_OK, "SUN 18 October 26"},
+  {"Day %j of %Y",            14, H24, NTP_FORMAT_OK, "Day 291 of 2026"},
+  {"%m/%d %I:%M %p",          14, H24, NTP_FORMAT_OK, "10/18 02:05 PM"},
+  {"%I:%M %p",                 0, H24, NTP_FORMAT_OK, "12:05 AM"},
+  {"%I:%M %p",                12, H24, NTP_FORMAT_OK, "12:05 PM"},
+  {"%K:%M",                   23, H12, NTP_FORMAT_OK, "11:05"},
+  {"%K:%M",                   23, H24, NTP_FORMAT_OK, "23:05"},
+  {"100%% %Q %",              14, H24, NTP_FORMAT_OK, "100% %Q %"},
+  {"%%%H%%",                  14, H24, NTP_FORMAT_OK, "%14%"},
+  {"",                        14, H24, NTP_FORMAT_OK, ""},
+  {"No conversion",           14, H24, NTP_FORMAT_OK, "No conversion"},
+  {"%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d",     14, H24, NTP_FORMAT_OK,       "18-18-18-18-18-18-18-18-18-18-18-18-18-18-18-18"},
+  {"%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d-%d",  14, H24, NTP_FORMAT_TOO_MANY,  ""},
+  {"This template is far too long to be kept in a compiled format....",  14, H24, NTP_FORMAT_TOO_LONG, ""}
+};
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=main() */
+/* ============================================================================================================================================================= *\
+                                                                          Main program entry point.
+\* ============================================================================================================================================================= */
+int main(void)
+{
+  UCHAR Result[80];
+  UCHAR Template[NTP_FORMAT_MAX_TEXT];
+
+  UINT8 Status;
+
+  UINT16 Errors;
+  UINT16 Length;
+  UINT16 Loop1UInt16;
+
+  struct human_time HumanTime;
+  struct ntp_format Format;
+
+
+  Errors = 0;
+  for (Loop1UInt16 = 0; Loop1UInt16 < (sizeof(Reference) / sizeof(Reference[0])); ++Loop1UInt16)
+  {
+    HumanTime      = TestTime;
+    HumanTime.Hour = Reference[Loop1UInt16].Hour;
+    Status = ntp_format_compile(&Format, Reference[Loop1UInt16].Template);
+    ntp_format_apply(Result, sizeof(Result), &Format, &HumanTime, NamesEnglish, Reference[Loop1UInt16].HourMode);
+    Errors += test_check(Reference[Loop1UInt16].Template, Status, Reference[Loop1UInt16].Status, Result, Reference[Loop1UInt16].Expected);
+  }
+
+
+  /* The source text of a template may be modified (or freed) once compiled. */
+  strcpy((char *)Template, "%H:%M:%S");
+  Status = ntp_format_compile(&Format, Template);
+  strcpy((char *)Template, "xxxxxxxxxxxxxxxxxxxxxxxx");
+  ntp_format_apply(Result, sizeof(Result), &Format, &TestTime, NamesEnglish, H24);
+  Errors += test_check((const UCHAR *)"source text overwritten", Status, NTP_FORMAT_OK, Result, (const UCHAR *)"14:05:09");
+
+  /* Out of range day-of-week and month give a blank name. */
+  HumanTime           = TestTime;
+  HumanTime.DayOfWeek = 9;
+  HumanTime.Month     = 13;
+  Status = ntp_format_compile(&Format, (const UCHAR *)"[%a][%A][%b][%B]");
+  ntp_format_apply(Result, sizeof(Result), &Format, &HumanTime, NamesEnglish, H24);
+  Errors += test_check((const UCHAR *)"names out of range", Status, NTP_FORMAT_OK, Result, (const UCHAR *)"[ ][ ][ ][ ]");
+
+  /* Result truncated to the buffer size. */
+  Status = ntp_format_compile(&Format, (const UCHAR *)"%A %e-%b-%Y");
+  Length = ntp_format_apply(Result, 8, &Format, &TestTime, NamesEnglish, H24);
+  Errors += test_check((const UCHAR *)"truncated to 8 bytes", Status, NTP_FORMAT_OK, Result, (const UCHAR *)"Sunday ");
+  if (Length != 7)
+  {
+    printf("truncated to 8 bytes: %u characters written instead of 7\n", Length);
+    ++Errors;
+  }
+
+  printf("\n%s (%u template(s) checked, %u error(s))\n", (Errors == 0) ? "PASS" : "FAIL", Loop1UInt16 + 3, Errors);
+
+  return (Errors == 0) ? 0 : 1;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_check() */
+/* ============================================================================================================================================================= *\
+                                                                     Check the result of a template.
+                                                               NOTE: Return 1 if it doesn't match, 0 otherwise.
+\* ============================================================================================================================================================= */
+static UINT8 test_check(const UCHAR *Label, UINT8 Status, UINT8 ExpectedStatus, const UCHAR *Result, const UCHAR *Expected)
+{
+  if ((Status == ExpectedStatus) && (strcmp((const char *)Result, (const char *)Expected) == 0)) return 0;
+
+  printf("<%s>: status %u, <%s> instead of status %u, <%s>\n", Label, Status, Result, ExpectedStatus, Expected);
+
+  return 1;
+}
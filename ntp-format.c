@@ -0,0 +1,313 @@
+/* ============================================================================================================================================================= *\
+   ntp-format.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Formatting of date and time according to strftime-like templates (see ntp-format.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include "ntp-format.h"
+
+
+
+/* Append an operation to a compiled format template. */
+static UINT8 ntp_format_add_op(struct ntp_format *Format, UINT8 Type, UINT16 Offset, UINT16 Length);
+
+/* Append a number, padded to the width given, to a string being formatted. */
+static UINT16 ntp_format_number(UCHAR *Buffer, UINT16 BufferSize, UINT16 Length, UINT16 Value, UINT8 Width, UCHAR Pad);
+
+/* Append text (up to MaxLength characters or its end of string) to a string being formatted. */
+static UINT16 ntp_format_text(UCHAR *Buffer, UINT16 BufferSize, UINT16 Length, const UCHAR *Text, UINT16 MaxLength);
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_format_add_op() */
+/* ============================================================================================================================================================= *\
+                                                               Append an operation to a compiled format template.
+                              NOTE: Empty literal text is skipped. Return NTP_FORMAT_TOO_MANY if NTP_FORMAT_MAX_OPS operations are already used.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_format_add_op(struct ntp_format *Format, UINT8 Type, UINT16 Offset, UINT16 Length)
+{
+  if ((Type == NTP_FORMAT_LITERAL) && (Length == 0)) return NTP_FORMAT_OK;
+  if (Format->OpCount >= NTP_FORMAT_MAX_OPS) return NTP_FORMAT_TOO_MANY;
+
+  Format->Op[Format->OpCount].Type   = Type;
+  Format->Op[Format->OpCount].Offset = Offset;
+  Format->Op[Format->OpCount].Length = Length;
+  ++Format->OpCount;
+
+  return NTP_FORMAT_OK;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_format_apply() */
+/* ============================================================================================================================================================= *\
+                                   Format a human time in a string, according to a compiled template and the language table given.
+                  NOTE: Names is a language table (NTP_NAME_COUNT names, see NTP_LANGUAGE_NAMES), HourMode (H12 or H24) is used by %K.
+                        A format whose compilation failed gives an empty string. Result is truncated to BufferSize - 1 characters.
+                        Return the number of characters written.
+\* ============================================================================================================================================================= */
+UINT16 ntp_format_apply(UCHAR *Buffer, UINT16 BufferSize, const struct ntp_format *Format, const struct human_time *HumanTime, const UCHAR *const *Names, UINT8 HourMode)
+{
+  const UCHAR *Name;
+
+  UINT8 Hour;
+  UINT8 Loop1UInt8;
+
+  UINT16 Length;
+
+  const struct ntp_format_op *Op;
+
+
+  if ((Buffer == NULL) || (BufferSize == 0)) return 0;
+
+  Length = 0;
+  for (Loop1UInt8 = 0; Loop1UInt8 < Format->OpCount; ++Loop1UInt8)
+  {
+    Op   = &Format->Op[Loop1UInt8];
+    Name = NULL;
+
+    switch (Op->Type)
+    {
+      case (NTP_FORMAT_LITERAL):
+        Length = ntp_format_text(Buffer, BufferSize, Length, &Format->Template[Op->Offset], Op->Length);
+      break;
+
+      case (NTP_FORMAT_YEAR):
+        Length = ntp_format_number(Buffer, BufferSize, Length, HumanTime->Year, 4, '0');
+      break;
+
+      case (NTP_FORMAT_YEAR2):
+        Length = ntp_format_number(Buffer, BufferSize, Length, HumanTime->Year % 100, 2, '0');
+      break;
+
+      case (NTP_FORMAT_MONTH):
+        Length = ntp_format_number(Buffer, BufferSize, Length, HumanTime->Month, 2, '0');
+      break;
+
+      case (NTP_FORMAT_DAY):
+        Length = ntp_format_number(Buffer, BufferSize, Length, HumanTime->DayOfMonth, 2, '0');
+      break;
+
+      case (NTP_FORMAT_DAY_SPACE):
+        Length = ntp_format_number(Buffer, BufferSize, Length, HumanTime->DayOfMonth, 2, ' ');
+      break;
+
+      case (NTP_FORMAT_DAY_OF_YEAR):
+        Length = ntp_format_number(Buffer, BufferSize, Length, HumanTime->DayOfYear, 3, '0');
+      break;
+
+      case (NTP_FORMAT_HOUR):
+      case (NTP_FORMAT_HOUR12):
+      case (NTP_FORMAT_HOUR24):
+        Hour = HumanTime->Hour;
+        if ((Op->Type == NTP_FORMAT_HOUR12) || ((Op->Type == NTP_FORMAT_HOUR) && (HourMode == H12)))
+        {
+          Hour %= 12;
+          if (Hour == 0) Hour = 12;
+        }
+        Length = ntp_format_number(Buffer, BufferSize, Length, Hour, 2, '0');
+      break;
+
+      case (NTP_FORMAT_MINUTE):
+        Length = ntp_format_number(Buffer, BufferSize, Length, HumanTime->Minute, 2, '0');
+      break;
+
+      case (NTP_FORMAT_SECOND):
+        Length = ntp_format_number(Buffer, BufferSize, Length, HumanTime->Second, 2, '0');
+      break;
+
+      case (NTP_FORMAT_AM_PM):
+        Name = Names[(HumanTime->Hour < 12) ? NTP_NAME_AM : NTP_NAME_PM];
+      break;
+
+      case (NTP_FORMAT_DAY_NAME):
+        Name = (HumanTime->DayOfWeek < 7) ? Names[NTP_NAME_DAY + HumanTime->DayOfWeek] : (const UCHAR *)" ";
+      break;
+
+      case (NTP_FORMAT_DAY_SHORT):
+        Name = (HumanTime->DayOfWeek < 7) ? Names[NTP_NAME_SHORT_DAY + HumanTime->DayOfWeek] : (const UCHAR *)" ";
+      break;
+
+      case (NTP_FORMAT_MONTH_NAME):
+        Name = Names[NTP_NAME_MONTH + ((HumanTime->Month <= 12) ? HumanTime->Month : 0)];
+      break;
+
+      case (NTP_FORMAT_MONTH_SHORT):
+        Name = Names[NTP_NAME_SHORT_MONTH + ((HumanTime->Month <= 12) ? HumanTime->Month : 0)];
+      break;
+    }
+
+    if (Name != NULL) Length = ntp_format_text(Buffer, BufferSize, Length, Name, 0xFFFF);
+  }
+
+  Buffer[Length] = 0x00;
+
+  return Length;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_format_compile() */
+/* ============================================================================================================================================================= *\
+                                                              Compile a format template into a list of operations.
+                  NOTE: The template is copied into Format, which may then be used as long as needed (the template itself may be discarded).
+                        Conversion specifications: %a %A (short / long day name), %b %B (short / long month name), %d %e (day of month, zero / space
+                        padded), %H (hour 00-23), %I (hour 01-12), %K (hour in the mode selected by ntp_format_set_hour_mode()), %j (day of year),
+                        %m (month), %M (minute), %p (AM / PM), %S (second), %y %Y (2-digit / 4-digit year) and %% (percent sign). Unknown conversion
+                        specifications are kept as literal text. Return NTP_FORMAT_OK, or NTP_FORMAT_TOO_LONG / NTP_FORMAT_TOO_MANY (Format then
+                        gives an empty string).
+\* ============================================================================================================================================================= */
+UINT8 ntp_format_compile(struct ntp_format *Format, const UCHAR *Template)
+{
+  UINT8 Status;
+  UINT8 Type;
+
+  UINT16 Index;
+  UINT16 Start;
+
+
+  Format->Template[0] = 0x00;
+  Format->OpCount     = 0;
+
+  for (Index = 0; Template[Index] != 0x00; ++Index)
+    if (Index >= (NTP_FORMAT_MAX_TEXT - 1)) return NTP_FORMAT_TOO_LONG;
+  memcpy(Format->Template, Template, Index + 1);
+  Template = Format->Template;
+
+  Status = NTP_FORMAT_OK;
+  Index  = 0;
+  Start = 0;  // beginning of current literal text.
+  while (Template[Index] != 0x00)
+  {
+    if ((Template[Index] != '%') || (Template[Index + 1] == 0x00))
+    {
+      ++Index;
+      continue;
+    }
+
+    switch (Template[Index + 1])
+    {
+      case ('%'): Type = NTP_FORMAT_PERCENT;     break;
+      case ('a'): Type = NTP_FORMAT_DAY_SHORT;   break;
+      case ('A'): Type = NTP_FORMAT_DAY_NAME;    break;
+      case ('b'): Type = NTP_FORMAT_MONTH_SHORT; break;
+      case ('B'): Type = NTP_FORMAT_MONTH_NAME;  break;
+      case ('d'): Type = NTP_FORMAT_DAY;         break;
+      case ('e'): Type = NTP_FORMAT_DAY_SPACE;   break;
+      case ('H'): Type = NTP_FORMAT_HOUR24;      break;
+      case ('I'): Type = NTP_FORMAT_HOUR12;      break;
+      case ('j'): Type = NTP_FORMAT_DAY_OF_YEAR; break;
+      case ('K'): Type = NTP_FORMAT_HOUR;        break;
+      case ('m'): Type = NTP_FORMAT_MONTH;       break;
+      case ('M'): Type = NTP_FORMAT_MINUTE;      break;
+      case ('p'): Type = NTP_FORMAT_AM_PM;       break;
+      case ('S'): Type = NTP_FORMAT_SECOND;      break;
+      case ('y'): Type = NTP_FORMAT_YEAR2;       break;
+      case ('Y'): Type = NTP_FORMAT_YEAR;        break;
+      default:    Type = NTP_FORMAT_LITERAL;     break;
+    }
+
+    /* Unknown conversion specification: keep it as literal text. */
+    if (Type == NTP_FORMAT_LITERAL)
+    {
+      ++Index;
+      continue;
+    }
+
+    if (Type == NTP_FORMAT_PERCENT)
+    {
+      /* "%%": first '%' ends current literal text, second one is skipped. */
+      Status |= ntp_format_add_op(Format, NTP_FORMAT_LITERAL, Start, Index + 1 - Start);
+    }
+    else
+    {
+      Status |= ntp_format_add_op(Format, NTP_FORMAT_LITERAL, Start, Index - Start);
+      Status |= ntp_format_add_op(Format, Type, Index, 2);
+    }
+    Index += 2;
+    Start  = Index;
+  }
+  Status |= ntp_format_add_op(Format, NTP_FORMAT_LITERAL, Start, Index - Start);
+
+  if (Status != NTP_FORMAT_OK)
+  {
+    Format->Template[0] = 0x00;
+    Format->OpCount     = 0;
+  }
+
+  return Status;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_format_number() */
+/* ============================================================================================================================================================= *\
+                                                        Append a number, padded to the width given, to a string being formatted.
+\* ============================================================================================================================================================= */
+static UINT16 ntp_format_number(UCHAR *Buffer, UINT16 BufferSize, UINT16 Length, UINT16 Value, UINT8 Width, UCHAR Pad)
+{
+  UCHAR Digits[5];
+
+  UINT8 Count;
+
+
+  /* Digits are produced from the least significant one. */
+  Count = 0;
+  do
+  {
+    Digits[Count++] = '0' + (Value % 10);
+    Value /= 10;
+  } while ((Value != 0) && (Count < sizeof(Digits)));
+
+  while ((Width > Count) && (Length < (BufferSize - 1)))
+  {
+    Buffer[Length++] = Pad;
+    --Width;
+  }
+
+  while ((Count > 0) && (Length < (BufferSize - 1)))
+    Buffer[Length++] = Digits[--Count];
+
+  return Length;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_format_text() */
+/* ============================================================================================================================================================= *\
+                                            Append text (up to MaxLength characters or its end of string) to a string being formatted.
+\* ============================================================================================================================================================= */
+static UINT16 ntp_format_text(UCHAR *Buffer, UINT16 BufferSize, UINT16 Length, const UCHAR *Text, UINT16 MaxLength)
+{
+  while ((MaxLength > 0) && (*Text != 0x00) && (Length < (BufferSize - 1)))
+  {
+    Buffer[Length++] = *Text++;
+    --MaxLength;
+  }
+
+  return Length;
+}
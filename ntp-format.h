@@ -0,0 +1,98 @@
+/* ============================================================================================================================================================= *\
+   ntp-format.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.00
+
+   Formatting of date and time according to strftime-like templates, used by ntp_format() of Pico-NTP-Module. A template is compiled once
+   by ntp_format_compile() into a list of operations kept by the caller (struct ntp_format, the template text being copied into it), then
+   applied to any number of human times. Day and month names are taken from a language table given by the caller.
+   This file doesn't depend on the Pico SDK so that it may also be compiled on a host computer (see ntp-format-test.c).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release (moved from Pico-NTP-Module.c): explicit compilation, overflow of a template reported to the caller.
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_FORMAT_H
+#define _NTP_FORMAT_H
+
+#include "baseline.h"
+#include "ntp-dst.h"
+
+
+#define H12  1  // time display mode is 12 hours.
+#define H24  2  // time display mode is 24 hours.
+
+#define NTP_FORMAT_MAX_OPS      32   // maximum number of operations (literal texts and conversions) in a compiled template.
+#define NTP_FORMAT_MAX_TEXT     64   // maximum length of a template, including its end of string.
+
+#define NTP_FORMAT_OK            0   // ntp_format_compile() return codes.
+#define NTP_FORMAT_TOO_LONG      1   // template longer than NTP_FORMAT_MAX_TEXT - 1 characters.
+#define NTP_FORMAT_TOO_MANY      2   // template needs more than NTP_FORMAT_MAX_OPS operations.
+
+#define NTP_FORMAT_LITERAL       0   // ntp_format() operations.
+#define NTP_FORMAT_PERCENT       1
+#define NTP_FORMAT_YEAR          2
+#define NTP_FORMAT_YEAR2         3
+#define NTP_FORMAT_MONTH         4
+#define NTP_FORMAT_MONTH_NAME    5
+#define NTP_FORMAT_MONTH_SHORT   6
+#define NTP_FORMAT_DAY           7
+#define NTP_FORMAT_DAY_SPACE     8
+#define NTP_FORMAT_DAY_NAME      9
+#define NTP_FORMAT_DAY_SHORT    10
+#define NTP_FORMAT_DAY_OF_YEAR  11
+#define NTP_FORMAT_HOUR         12
+#define NTP_FORMAT_HOUR12       13
+#define NTP_FORMAT_HOUR24       14
+#define NTP_FORMAT_MINUTE       15
+#define NTP_FORMAT_SECOND       16
+#define NTP_FORMAT_AM_PM        17
+
+/* Position of each name in a language table. */
+#define NTP_NAME_SHORT_DAY     0   // 7 short day names (3 letters), Sunday first.
+#define NTP_NAME_DAY           7   // 7 day names, Sunday first.
+#define NTP_NAME_SHORT_MONTH  14   // 13 short month names (3 letters), index 0 is not a month.
+#define NTP_NAME_MONTH        27   // 13 month names, index 0 is not a month.
+#define NTP_NAME_AM           40   // before noon.
+#define NTP_NAME_PM           41   // after noon.
+#define NTP_NAME_COUNT        42   // number of names in a language table.
+
+/* Initializer of a language table, from the names defined by a language file (see ntp-lang-english.h and ntp-lang-undef.h). */
+#define NTP_LANGUAGE_NAMES                                                                                                      \
+{                                                                                                                               \
+  $SUN, $MON, $TUE, $WED, $THU, $FRI, $SAT,                                                                                     \
+  $SUNDAY, $MONDAY, $TUESDAY, $WEDNESDAY, $THURSDAY, $FRIDAY, $SATURDAY,                                                        \
+  " ", $JAN, $FEB, $MAR, $APR, $MAY, $JUN, $JUL, $AUG, $SEP, $OCT, $NOV, $DEC,                                                  \
+  " ", $JANUARY, $FEBRUARY, $MARCH, $APRIL, $MMAY, $JUNE, $JULY, $AUGUST, $SEPTEMBER, $OCTOBER, $NOVEMBER, $DECEMBER,           \
+  $AM, $PM                                                                                                                      \
+}
+
+
+/* One operation of a compiled ntp_format() template. */
+struct ntp_format_op
+{
+  UINT8  Type;                   // NTP_FORMAT_xxx.
+  UINT8  Length;                 // length of literal text (or of conversion specification).
+  UINT8  Offset;                 // position in the template.
+};
+
+
+/* Compiled ntp_format() template. */
+struct ntp_format
+{
+  UCHAR  Template[NTP_FORMAT_MAX_TEXT];  // copy of the template this format has been compiled from.
+  UINT8  OpCount;                // number of operations (0 if compilation failed).
+  struct ntp_format_op Op[NTP_FORMAT_MAX_OPS];
+};
+
+
+/* Format a human time in a string, according to a compiled template and the language table given. */
+UINT16 ntp_format_apply(UCHAR *Buffer, UINT16 BufferSize, const struct ntp_format *Format, const struct human_time *HumanTime, const UCHAR *const *Names, UINT8 HourMode);
+
+/* Compile a format template into a list of operations. */
+UINT8 ntp_format_compile(struct ntp_format *Format, const UCHAR *Template);
+
+#endif  // _NTP_FORMAT_H
@@ -0,0 +1,707 @@
+/* ============================================================================================================================================================= *\
+   ntp-fuzz.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Fuzz driver of the NTP reply receive path on a host computer. Each input is a UDP payload, preceded by a few control bytes, which
+   goes through the same steps as in ntp_recv(): the payload is split in a chain of buffers (as lwIP may deliver it), copied with the
+   contract of pbuf_copy_partial(), parsed by ntp_packet_parse(), checked against the origin timestamp of the pending request and by
+   ntp_auth_verify() and
+   ntp_sync_check(), then turned into an exchange (basic or interleaved mode) fed to a disciplined clock by ntp_sync_discipline().
+   ntp_recv() itself needs lwIP and the Pico SDK: only the network stack calls are emulated here, every function called on the packet is
+   the one running on the Pico, including the MD5 / SHA-1 digest of the MAC (ntp-auth.c). The layout returned by the parser is also checked
+   (MAC and extension fields within the packet), since ntp_auth_verify() reads the MAC from it without further checks.
+
+   Input format:
+       byte 0      control: bits 0-2 number of buffers in the chain minus one, bit 3 interleaved request pending, bit 4 PPS locked,
+                   bit 5 reply echoes the origin timestamp of the request, bit 6 clock already set, bit 7 client authenticates
+                   replies (key ID 1 (MD5) for a 16-byte digest, key ID 2 (SHA-1) otherwise).
+       bytes 1-n   length of each buffer of the chain but the last one (n = number of buffers minus one).
+       remainder   UDP payload.
+
+   Build with libFuzzer (clang), AddressSanitizer and UndefinedBehaviorSanitizer, then run from the seed corpus:
+       clang -g -O1 -fsanitize=fuzzer,address,undefined -o ntp-fuzz ntp-fuzz.c ntp-adev.c ntp-auth.c ntp-clock.c ntp-packet.c ntp-sync.c ntp-tempco.c ntp-timestamp.c -lm
+       ./ntp-fuzz -max_len=256 ntp-fuzz-corpus
+   Without libFuzzer (gcc or clang), NTP_FUZZ_MAIN adds a main() that replays files, mutates the seed corpus at random, writes the seed
+   corpus again or measures the throughput of the receive path:
+       gcc -g -O1 -fsanitize=address,undefined -DNTP_FUZZ_MAIN -o ntp-fuzz ntp-fuzz.c ntp-adev.c ntp-auth.c ntp-clock.c ntp-packet.c ntp-sync.c ntp-tempco.c ntp-timestamp.c -lm
+       ./ntp-fuzz crash-1234 ...         replay files (crash reproducers or corpus files).
+       ./ntp-fuzz -r 10000000            run 10 million inputs mutated at random from the seeds.
+       ./ntp-fuzz -s ntp-fuzz-corpus     write the seed corpus.
+       ./ntp-fuzz -b 10000000            throughput of the parser and of the whole receive path (build with -O2, without sanitizers).
+   Both builds only need a copy of baseline.h for the type definitions.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release: MACs verified by ntp_auth_verify() with the keys of the seeds.
+\* ============================================================================================================================================================= */
+
+#include <time.h>
+
+#include "ntp-auth.h"
+#include "ntp-packet.h"
+#include "ntp-sync.h"
+
+
+#define FUZZ_MAX_BUFFERS           8   // maximum number of buffers in a chain.
+#define FUZZ_MAX_INPUT           512   // longest input used by the random mutations.
+#define FUZZ_BOOT_US       5000000ull  // Pico timer when the request has been sent (in usec).
+#define FUZZ_TIME_US  1792281600000000ll  // UTC time used to set the clock (18-OCT-2026 00:00:00, in usec).
+
+#define FUZZ_CHAIN_MASK         0x07   // control byte.
+#define FUZZ_INTERLEAVED        0x08
+#define FUZZ_PPS                0x10
+#define FUZZ_ECHO               0x20
+#define FUZZ_CLOCK_SET          0x40
+#define FUZZ_AUTH               0x80
+
+#define FUZZ_KEY_MD5               1   // key IDs of the key table.
+#define FUZZ_KEY_SHA1              2
+
+
+/* Buffer of a chain, with the fields of an lwIP pbuf used by ntp_recv(). */
+struct fuzz_pbuf
+{
+  struct fuzz_pbuf *next;
+  UINT8  *payload;
+  UINT16 tot_len;                // length of this buffer and of all the following ones.
+  UINT16 len;                    // length of this buffer.
+};
+
+
+/* Seed inputs. */
+struct fuzz_seed
+{
+  const char *Name;
+  UINT8 Control;
+  UINT8 Mode;
+  UINT8 Stratum;
+  UINT8 Extensions;              // number of 16-byte extension fields.
+  UINT8 DigestLength;            // 0 (no MAC), 16 (MD5) or 20 (SHA-1).
+  UINT8 FlagForged;              // the MAC is signed, then one byte of the digest is changed.
+  INT16 Trim;                    // bytes added to (or removed from) the payload.
+};
+
+
+
+/* Add the keys of the seeds to the key table. */
+static void fuzz_add_keys(void);
+
+/* Check the layout returned by the parser. */
+static void fuzz_check_layout(const struct ntp_packet *Info, UINT16 PacketLength);
+
+/* Copy bytes from a chain of buffers, same contract as lwIP pbuf_copy_partial(). */
+static UINT16 fuzz_copy_partial(const struct fuzz_pbuf *Buffer, UINT8 *Destination, UINT16 Length, UINT16 Offset);
+
+/* Process one UDP payload delivered as a chain of buffers, as ntp_recv() does. */
+static void fuzz_recv(struct fuzz_pbuf *Chain, UINT8 Control);
+
+#ifdef NTP_FUZZ_MAIN
+/* Measure the throughput of the parser and of the whole receive path. */
+static void fuzz_benchmark(UINT32 Count);
+
+/* Build a seed input. */
+static UINT16 fuzz_make_seed(const struct fuzz_seed *Seed, UINT8 *Input);
+
+/* Run inputs mutated at random from the seeds. */
+static void fuzz_random(UINT32 Count);
+
+/* Replay an input file. */
+static void fuzz_replay(const char *FileName);
+
+/* Write the seed corpus in the directory given. */
+static void fuzz_write_seeds(const char *Directory);
+#endif  // NTP_FUZZ_MAIN
+
+/* libFuzzer entry point. */
+int LLVMFuzzerTestOneInput(const UINT8 *Data, size_t Size);
+
+
+
+#ifdef NTP_FUZZ_MAIN
+static const struct fuzz_seed Seeds[] =
+{
+  {"reply",             FUZZ_ECHO | FUZZ_CLOCK_SET,                           4, 2, 0,  0, 0,   0},
+  {"reply-first",       FUZZ_ECHO,                                            4, 2, 0,  0, 0,   0},
+  {"reply-md5",         FUZZ_ECHO | FUZZ_CLOCK_SET | FUZZ_AUTH,               4, 2, 0, 16, 0,   0},
+  {"reply-sha1-ext",    FUZZ_ECHO | FUZZ_CLOCK_SET | FUZZ_AUTH,               4, 1, 2, 20, 0,   0},
+  {"reply-bad-mac",     FUZZ_ECHO | FUZZ_CLOCK_SET | FUZZ_AUTH,               4, 2, 0, 20, 1,   0},
+  {"reply-unsigned",    FUZZ_ECHO | FUZZ_CLOCK_SET | FUZZ_AUTH,               4, 2, 0,  0, 0,   0},
+  {"reply-chained",     FUZZ_ECHO | FUZZ_CLOCK_SET | FUZZ_AUTH | 0x03,        4, 2, 1, 20, 0,   0},
+  {"reply-interleaved", FUZZ_ECHO | FUZZ_CLOCK_SET | FUZZ_INTERLEAVED,        4, 2, 0,  0, 0,   0},
+  {"reply-pps",         FUZZ_ECHO | FUZZ_CLOCK_SET | FUZZ_PPS,                4, 2, 0,  0, 0,   0},
+  {"kiss-of-death",     FUZZ_ECHO | FUZZ_CLOCK_SET,                           4, 0, 0,  0, 0,   0},
+  {"broadcast",         FUZZ_CLOCK_SET,                                       5, 2, 0,  0, 0,   0},
+  {"wrong-origin",      FUZZ_CLOCK_SET,                                       4, 2, 0,  0, 0,   0},
+  {"short",             FUZZ_ECHO | FUZZ_CLOCK_SET | 0x01,                    4, 2, 0,  0, 0,  -1},
+  {"long",              FUZZ_ECHO | FUZZ_CLOCK_SET | FUZZ_AUTH | 0x07,        4, 2, 4, 20, 0,   4},
+  {"bad-trailer",       FUZZ_ECHO | FUZZ_CLOCK_SET,                           4, 2, 1,  0, 0,  12},
+};
+#endif  // NTP_FUZZ_MAIN
+
+
+
+
+
+#ifdef NTP_FUZZ_MAIN
+/* $PAGE */
+/* $TITLE=main() */
+/* ============================================================================================================================================================= *\
+                                                                          Main program entry point.
+\* ============================================================================================================================================================= */
+int main(int argc, char *argv[])
+{
+  int Loop1Int;
+
+
+  if (argc < 2)
+  {
+    printf("Usage: %s file ... | -r count | -s directory | -b count\n", argv[0]);
+    return 1;
+  }
+
+  if ((strcmp(argv[1], "-r") == 0) && (argc == 3))
+  {
+    fuzz_random((UINT32)strtoul(argv[2], NULL, 10));
+    return 0;
+  }
+
+  if ((strcmp(argv[1], "-s") == 0) && (argc == 3))
+  {
+    fuzz_write_seeds(argv[2]);
+    return 0;
+  }
+
+  if ((strcmp(argv[1], "-b") == 0) && (argc == 3))
+  {
+    fuzz_benchmark((UINT32)strtoul(argv[2], NULL, 10));
+    return 0;
+  }
+
+  for (Loop1Int = 1; Loop1Int < argc; ++Loop1Int)
+    fuzz_replay(argv[Loop1Int]);
+  printf("%d input(s) replayed\n", argc - 1);
+
+  return 0;
+}
+#endif  // NTP_FUZZ_MAIN
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=fuzz_add_keys() */
+/* ============================================================================================================================================================= *\
+                                                                 Add the keys of the seeds to the key table.
+                                                        NOTE: Keys are only added on the first call, the table being static.
+\* ============================================================================================================================================================= */
+static void fuzz_add_keys(void)
+{
+  static UINT8 FlagAdded = FLAG_OFF;
+
+  static const UINT8 KeyMd5[]  = "Pico-NTP-MD5";
+  static const UINT8 KeySha1[] = "Pico-NTP-SHA1-key";
+
+
+  if (FlagAdded) return;
+
+  ntp_auth_add_key(FUZZ_KEY_MD5,  NTP_AUTH_MD5,  KeyMd5,  sizeof(KeyMd5) - 1);
+  ntp_auth_add_key(FUZZ_KEY_SHA1, NTP_AUTH_SHA1, KeySha1, sizeof(KeySha1) - 1);
+  FlagAdded = FLAG_ON;
+
+  return;
+}
+
+
+
+
+
+#ifdef NTP_FUZZ_MAIN
+/* $PAGE */
+/* $TITLE=fuzz_benchmark() */
+/* ============================================================================================================================================================= *\
+                                                     Measure the throughput of the parser and of the whole receive path.
+                            NOTE: Inputs are the seeds, with a few bytes of the header changed for each packet so that the results vary.
+\* ============================================================================================================================================================= */
+static void fuzz_benchmark(UINT32 Count)
+{
+  UINT8 Input[sizeof(Seeds) / sizeof(Seeds[0])][FUZZ_MAX_INPUT];
+  UINT8 Seed;
+
+  UINT16 Length[sizeof(Seeds) / sizeof(Seeds[0])];
+
+  UINT32 Loop1UInt32;
+  UINT32 Packets;
+
+  double Elapsed;
+
+  volatile UINT32 Sum;
+
+  clock_t Start;
+
+  struct fuzz_pbuf Buffer;
+
+  struct ntp_packet Info;
+
+
+  for (Seed = 0; Seed < (sizeof(Seeds) / sizeof(Seeds[0])); ++Seed)
+    Length[Seed] = fuzz_make_seed(&Seeds[Seed], Input[Seed]);
+
+  /* Parser alone, on the payload of each seed. */
+  Sum   = 0;
+  Start = clock();
+  for (Loop1UInt32 = 0; Loop1UInt32 < Count; ++Loop1UInt32)
+  {
+    Seed = Loop1UInt32 % (sizeof(Seeds) / sizeof(Seeds[0]));
+    Input[Seed][1 + (Seeds[Seed].Control & FUZZ_CHAIN_MASK) + 2] = (UINT8)Loop1UInt32;
+    Sum += ntp_packet_parse(&Input[Seed][1 + (Seeds[Seed].Control & FUZZ_CHAIN_MASK)], Length[Seed] - 1 - (Seeds[Seed].Control & FUZZ_CHAIN_MASK), &Info);
+    Sum += Info.Stratum;
+  }
+  Elapsed = (double)(clock() - Start) / CLOCKS_PER_SEC;
+  printf("ntp_packet_parse(): %lu packets in %.3f sec (%.2f million packets per second)\n", (unsigned long)Count, Elapsed, (Elapsed > 0.0) ? (Count / Elapsed / 1e6) : 0.0);
+
+  /* Whole receive path, single buffer. */
+  Packets = 0;
+  Start   = clock();
+  for (Loop1UInt32 = 0; Loop1UInt32 < Count; ++Loop1UInt32)
+  {
+    Seed = Loop1UInt32 % (sizeof(Seeds) / sizeof(Seeds[0]));
+    Input[Seed][1 + (Seeds[Seed].Control & FUZZ_CHAIN_MASK) + 2] = (UINT8)Loop1UInt32;
+    Buffer.next    = NULL;
+    Buffer.payload = &Input[Seed][1 + (Seeds[Seed].Control & FUZZ_CHAIN_MASK)];
+    Buffer.len     = Length[Seed] - 1 - (Seeds[Seed].Control & FUZZ_CHAIN_MASK);
+    Buffer.tot_len = Buffer.len;
+    fuzz_recv(&Buffer, Seeds[Seed].Control & ~FUZZ_CHAIN_MASK);
+    ++Packets;
+  }
+  Elapsed = (double)(clock() - Start) / CLOCKS_PER_SEC;
+  printf("Receive path:       %lu packets in %.3f sec (%.2f million packets per second)\n", (unsigned long)Packets, Elapsed, (Elapsed > 0.0) ? (Packets / Elapsed / 1e6) : 0.0);
+
+  return;
+}
+#endif  // NTP_FUZZ_MAIN
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=fuzz_check_layout() */
+/* ============================================================================================================================================================= *\
+                                                                    Check the layout returned by the parser.
+                                        NOTE: Aborts (reported as a crash by libFuzzer) if the MAC is not entirely within the packet.
+\* ============================================================================================================================================================= */
+static void fuzz_check_layout(const struct ntp_packet *Info, UINT16 PacketLength)
+{
+  if ((PacketLength < NTP_MSG_LEN) || (PacketLength > NTP_MAX_PACKET_LEN)) abort();
+  if ((Info->MacOffset < NTP_MSG_LEN) || (Info->MacOffset > PacketLength)) abort();
+  if ((Info->ExtensionCount * NTP_MIN_EXTENSION_LEN) > (Info->MacOffset - NTP_MSG_LEN)) abort();
+
+  if (Info->DigestLength == 0)
+  {
+    if ((Info->MacOffset != PacketLength) || (Info->KeyId != 0)) abort();
+  }
+  else
+  {
+    if ((Info->DigestLength != 16) && (Info->DigestLength != NTP_MAX_DIGEST_LEN)) abort();
+    if ((Info->MacOffset + NTP_KEY_ID_LEN + Info->DigestLength) != PacketLength) abort();
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=fuzz_copy_partial() */
+/* ============================================================================================================================================================= *\
+                                                  Copy bytes from a chain of buffers, same contract as lwIP pbuf_copy_partial().
+                                                             NOTE: Return the number of bytes copied.
+\* ============================================================================================================================================================= */
+static UINT16 fuzz_copy_partial(const struct fuzz_pbuf *Buffer, UINT8 *Destination, UINT16 Length, UINT16 Offset)
+{
+  UINT16 Copied;
+  UINT16 Part;
+
+
+  Copied = 0;
+  for (; (Buffer != NULL) && (Length > 0); Buffer = Buffer->next)
+  {
+    if (Offset >= Buffer->len)
+    {
+      Offset -= Buffer->len;
+      continue;
+    }
+
+    Part = Buffer->len - Offset;
+    if (Part > Length) Part = Length;
+    memcpy(&Destination[Copied], &Buffer->payload[Offset], Part);
+    Copied += Part;
+    Length -= Part;
+    Offset  = 0;
+  }
+
+  return Copied;
+}
+
+
+
+
+
+#ifdef NTP_FUZZ_MAIN
+/* $PAGE */
+/* $TITLE=fuzz_make_seed() */
+/* ============================================================================================================================================================= *\
+                                                                              Build a seed input.
+                                 NOTE: Return the length of the input (control bytes and payload). Input must hold FUZZ_MAX_INPUT bytes.
+\* ============================================================================================================================================================= */
+static UINT16 fuzz_make_seed(const struct fuzz_seed *Seed, UINT8 *Input)
+{
+  UINT8 Buffers;
+  UINT8 Loop1UInt8;
+  UINT8 *Payload;
+
+  UINT16 PayloadLength;
+
+  ntp_timestamp_t Receive;
+
+
+  memset(Input, 0, FUZZ_MAX_INPUT);
+  Buffers  = (Seed->Control & FUZZ_CHAIN_MASK) + 1;
+  Input[0] = Seed->Control;
+  Payload  = &Input[Buffers];
+
+  /* Header: leap indicator none, version 4, mode and stratum of the seed. Origin is the transmit timestamp of our request. */
+  Receive  = ntp_ts_from_unix_us(FUZZ_TIME_US + 20000ll);
+  Payload[0] = (UINT8)(0x20 | Seed->Mode);
+  Payload[1] = Seed->Stratum;
+  Payload[2] = 6;
+  Payload[3] = (UINT8)-20;
+  Payload[7] = 0x10;                                    // root delay and dispersion: 1/4096 sec.
+  Payload[11] = 0x10;
+  memcpy(&Payload[12], "GPS\0", 4);
+  ntp_ts_to_packet(ntp_ts_from_unix_us(FUZZ_TIME_US - 60000000ll), &Payload[16]);
+  ntp_ts_to_packet(ntp_ts_from_unix_us(FUZZ_TIME_US), &Payload[24]);
+  ntp_ts_to_packet(Receive, &Payload[32]);
+  ntp_ts_to_packet(ntp_ts_add(Receive, ntp_ts_diff(ntp_ts_from_unix_us(100ll), ntp_ts_from_unix_us(0ll))), &Payload[40]);
+  PayloadLength = NTP_MSG_LEN;
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < Seed->Extensions; ++Loop1UInt8)
+  {
+    Payload[PayloadLength + 1] = 0x04;                  // field type (unassigned) and length.
+    Payload[PayloadLength + 3] = NTP_MIN_EXTENSION_LEN;
+    PayloadLength += NTP_MIN_EXTENSION_LEN;
+  }
+
+  if (Seed->DigestLength)
+  {
+    fuzz_add_keys();
+    PayloadLength = ntp_auth_sign((Seed->DigestLength == NTP_MAX_DIGEST_LEN) ? FUZZ_KEY_SHA1 : FUZZ_KEY_MD5, Payload, PayloadLength);
+    if (Seed->FlagForged) Payload[PayloadLength - 1] ^= 0x01;
+  }
+  PayloadLength = (UINT16)(PayloadLength + Seed->Trim);
+
+  /* Buffers of the chain (all but the last one) are of equal length. */
+  for (Loop1UInt8 = 1; Loop1UInt8 < Buffers; ++Loop1UInt8)
+    Input[Loop1UInt8] = (UINT8)(PayloadLength / Buffers);
+
+  return Buffers + PayloadLength;
+}
+#endif  // NTP_FUZZ_MAIN
+
+
+
+
+
+#ifdef NTP_FUZZ_MAIN
+/* $PAGE */
+/* $TITLE=fuzz_random() */
+/* ============================================================================================================================================================= *\
+                                                             Run inputs mutated at random from the seeds.
+                                 NOTE: A few random bytes of a seed are replaced, and its length changed, for each input (fixed sequence).
+\* ============================================================================================================================================================= */
+static void fuzz_random(UINT32 Count)
+{
+  UINT8 Input[FUZZ_MAX_INPUT];
+  UINT8 Loop1UInt8;
+  UINT8 Mutations;
+  UINT8 Seed;
+
+  INT16 Delta;
+
+  UINT16 Length;
+
+  UINT32 Loop1UInt32;
+  UINT32 Random;
+
+
+  Random = 12345;
+  for (Loop1UInt32 = 0; Loop1UInt32 < Count; ++Loop1UInt32)
+  {
+    Seed   = Loop1UInt32 % (sizeof(Seeds) / sizeof(Seeds[0]));
+    Length = fuzz_make_seed(&Seeds[Seed], Input);
+
+    Random    = (Random * 1103515245u) + 12345u;
+    Mutations = 1 + ((Random >> 16) % 8);
+    for (Loop1UInt8 = 0; Loop1UInt8 < Mutations; ++Loop1UInt8)
+    {
+      Random = (Random * 1103515245u) + 12345u;
+      Input[((Random >> 8) & 0xFFFF) % (Length + 16)] = (UINT8)(Random >> 24);
+    }
+
+    /* One input out of four is also shortened or lengthened by up to 16 bytes. */
+    Random = (Random * 1103515245u) + 12345u;
+    Delta  = (INT16)((Random >> 20) % 33) - 16;
+    if ((((Random >> 16) % 4) == 0) && ((Length + Delta) >= 0)) Length = (UINT16)(Length + Delta);
+
+    LLVMFuzzerTestOneInput(Input, Length);
+  }
+  printf("%lu input(s) run\n", (unsigned long)Count);
+
+  return;
+}
+#endif  // NTP_FUZZ_MAIN
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=fuzz_recv() */
+/* ============================================================================================================================================================= *\
+                                                Process one UDP payload delivered as a chain of buffers, as ntp_recv() does.
+                NOTE: The request has been sent at FUZZ_BOOT_US and the reply is received 40 msec later. In interleaved mode, the request is
+                      the second one of a burst, the first reply having been received just before it was sent.
+\* ============================================================================================================================================================= */
+static void fuzz_recv(struct fuzz_pbuf *Chain, UINT8 Control)
+{
+  UINT8 AuthStatus;
+  UINT8 FlagInterleaved;
+  UINT8 Packet[NTP_MAX_PACKET_LEN];
+  UINT8 ParseStatus;
+  UINT8 ReplyStatus;
+
+  UINT16 PacketLength;
+
+  UINT32 KeyId;
+
+  ntp_timestamp_t Origin;
+
+  struct ntp_clock Clock;
+
+  struct ntp_burst Burst;
+
+  struct ntp_exchange Current;
+  struct ntp_exchange Exchange;
+  struct ntp_exchange Previous;
+
+  struct ntp_packet Info;
+
+
+  fuzz_add_keys();
+  ntp_clock_init(&Clock);
+  if (Control & FUZZ_CLOCK_SET) ntp_clock_sample(&Clock, FUZZ_BOOT_US - 64000000ull, FUZZ_TIME_US - 64000000ll, NTP_SOURCE_NETWORK);
+
+  /* Same copy as ntp_recv(): the parser never reads beyond PacketLength. */
+  PacketLength = 0;
+  if (Chain->tot_len <= NTP_MAX_PACKET_LEN) PacketLength = fuzz_copy_partial(Chain, Packet, Chain->tot_len, 0);
+  ParseStatus = ntp_packet_parse(Packet, PacketLength, &Info);
+  if (ParseStatus != NTP_PACKET_OK) return;
+  fuzz_check_layout(&Info, PacketLength);
+
+  /* Broadcasts are handled by ntp_broadcast_recv(), outside of the request / reply path. */
+  if (Info.Mode == 0x05) return;
+
+  /* Previous exchange (first one of the burst), completed by an interleaved reply. */
+  memset(&Previous, 0, sizeof(Previous));
+  Previous.Send    = FUZZ_BOOT_US - 41000ull;
+  Previous.Receive = FUZZ_BOOT_US - 1000ull;
+  Previous.T2      = ntp_ts_from_unix_us(FUZZ_TIME_US - 21000ll);
+  Previous.T3      = Previous.T2;
+  ntp_sync_exchange(&Clock, &Previous);
+  ntp_sync_burst_open(&Burst, &Previous, &Info);
+
+  /* Origin timestamp of the pending request: echoed by the reply, or our receive timestamp of the previous reply in interleaved mode. */
+  Origin = ntp_ts_from_unix_us(FUZZ_TIME_US);
+  if (Control & FUZZ_ECHO)
+  {
+    Origin = Info.Origin;
+    if (Control & FUZZ_INTERLEAVED)
+    {
+      Previous.T4 = Info.Origin;
+      Origin      = Info.Origin + 1;
+    }
+  }
+
+  FlagInterleaved = ((Control & FUZZ_INTERLEAVED) && (Info.Origin == Previous.T4) && (Info.Origin != Origin)) ? FLAG_ON : FLAG_OFF;
+  if ((Info.Origin != Origin) && (!FlagInterleaved)) return;
+
+  /* Same authentication as ntp_recv(), with the key ID configured by the client. */
+  KeyId = 0;
+  if (Control & FUZZ_AUTH) KeyId = (Info.DigestLength == 16) ? FUZZ_KEY_MD5 : FUZZ_KEY_SHA1;
+  AuthStatus  = ntp_auth_verify(KeyId, Packet, &Info);
+  ReplyStatus = ntp_sync_check(&Info, AuthStatus);
+  if (ReplyStatus != NTP_SYNC_OK) return;
+
+  Current.Send    = FUZZ_BOOT_US;
+  Current.Receive = FUZZ_BOOT_US + 40000ull;
+  Current.T2      = Info.Receive;
+  Current.T3      = (FlagInterleaved) ? Info.Receive : Info.Transmit;
+  ntp_sync_exchange(&Clock, &Current);
+
+  Exchange = Current;
+  if (FlagInterleaved)
+  {
+    /* As in ntp_recv(): if the interleaved reply is inconsistent, the first exchange of the burst is used in basic mode. */
+    Exchange = Previous;
+    if (ntp_sync_interleaved(&Clock, &Exchange, Info.Transmit, Current.Receive) != NTP_SYNC_OK)
+    {
+      Exchange = Current;
+      ntp_sync_burst_close(&Burst, Current.Receive, &Exchange);
+    }
+  }
+
+  ntp_sync_discipline(&Clock, &Exchange, (Control & FUZZ_PPS) ? FLAG_ON : FLAG_OFF);
+  ntp_clock_get_utc_us(&Clock, Current.Receive + 1000000ull);
+
+  return;
+}
+
+
+
+
+
+#ifdef NTP_FUZZ_MAIN
+/* $PAGE */
+/* $TITLE=fuzz_replay() */
+/* ============================================================================================================================================================= *\
+                                                                             Replay an input file.
+\* ============================================================================================================================================================= */
+static void fuzz_replay(const char *FileName)
+{
+  UINT8 Input[FUZZ_MAX_INPUT];
+
+  size_t Length;
+
+  FILE *File;
+
+
+  File = fopen(FileName, "rb");
+  if (File == NULL)
+  {
+    printf("Failed to open %s\n", FileName);
+    return;
+  }
+  Length = fread(Input, 1, sizeof(Input), File);
+  fclose(File);
+
+  LLVMFuzzerTestOneInput(Input, Length);
+
+  return;
+}
+#endif  // NTP_FUZZ_MAIN
+
+
+
+
+
+#ifdef NTP_FUZZ_MAIN
+/* $PAGE */
+/* $TITLE=fuzz_write_seeds() */
+/* ============================================================================================================================================================= *\
+                                                              Write the seed corpus in the directory given.
+                                                       NOTE: The directory must exist. One file per seed, named after it.
+\* ============================================================================================================================================================= */
+static void fuzz_write_seeds(const char *Directory)
+{
+  char FileName[256];
+
+  UINT8 Input[FUZZ_MAX_INPUT];
+  UINT8 Seed;
+
+  UINT16 Length;
+
+  FILE *File;
+
+
+  for (Seed = 0; Seed < (sizeof(Seeds) / sizeof(Seeds[0])); ++Seed)
+  {
+    Length = fuzz_make_seed(&Seeds[Seed], Input);
+    snprintf(FileName, sizeof(FileName), "%s/%s", Directory, Seeds[Seed].Name);
+
+    File = fopen(FileName, "wb");
+    if (File == NULL)
+    {
+      printf("Failed to create %s\n", FileName);
+      continue;
+    }
+    fwrite(Input, 1, Length, File);
+    fclose(File);
+  }
+  printf("%u seed(s) written to %s\n", Seed, Directory);
+
+  return;
+}
+#endif  // NTP_FUZZ_MAIN
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=LLVMFuzzerTestOneInput() */
+/* ============================================================================================================================================================= *\
+                                                                            libFuzzer entry point.
+                   NOTE: Each buffer of the chain is allocated on its own, so that AddressSanitizer reports any read beyond one of them.
+\* ============================================================================================================================================================= */
+int LLVMFuzzerTestOneInput(const UINT8 *Data, size_t Size)
+{
+  UINT8 Buffers;
+  UINT8 Control;
+  UINT8 Loop1UInt8;
+
+  size_t Length;
+  size_t Offset;
+  size_t Remaining;
+
+  struct fuzz_pbuf Chain[FUZZ_MAX_BUFFERS];
+
+
+  if (Size < 1) return 0;
+  Control = Data[0];
+  Buffers = (Control & FUZZ_CHAIN_MASK) + 1;
+  if (Size < Buffers) return 0;
+
+  /* lwIP lengths are 16-bit. */
+  Remaining = Size - Buffers;
+  if (Remaining > 0xFFFF) return 0;
+
+  Offset = Buffers;
+  for (Loop1UInt8 = 0; Loop1UInt8 < Buffers; ++Loop1UInt8)
+  {
+    Length = (Loop1UInt8 == (Buffers - 1)) ? Remaining : (Data[1 + Loop1UInt8] % (Remaining + 1));
+
+    Chain[Loop1UInt8].payload = malloc((Length > 0) ? Length : 1);
+    if (Chain[Loop1UInt8].payload == NULL) abort();
+    memcpy(Chain[Loop1UInt8].payload, &Data[Offset], Length);
+    Chain[Loop1UInt8].len     = (UINT16)Length;
+    Chain[Loop1UInt8].tot_len = (UINT16)Remaining;
+    Chain[Loop1UInt8].next    = (Loop1UInt8 == (Buffers - 1)) ? NULL : &Chain[Loop1UInt8 + 1];
+
+    Offset    += Length;
+    Remaining -= Length;
+  }
+
+  fuzz_recv(&Chain[0], Control);
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < Buffers; ++Loop1UInt8)
+    free(Chain[Loop1UInt8].payload);
+
+  return 0;
+}
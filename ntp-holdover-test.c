@@ -0,0 +1,194 @@
+/* ============================================================================================================================================================= *\
+   ntp-holdover-test.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Host computer regression test of the holdover clock (ntp-holdover.c), driven through the RAM mock holdover clock as Pico-NTP-Module
+   drives a DS3231. The mock runs 2 ppm fast on its own time base, the Pico crystal 20 ppm fast:
+   - the mock can't be read before it has been written (battery changed),
+   - after a power cycle one hour after it has been written, the time read from the mock seeds the disciplined clock (ntp-clock.c),
+   - during a one-day NTP outage, the mock is fed to the disciplined clock every 2 hours (as ntp_holdover_feed() does): the error of
+     the disciplined clock must remain bounded by the error of the mock plus the drift of the crystal over one feed interval,
+   - when NTP is back, ntp_holdover_measure() must estimate the frequency error of the mock accumulated across the outage and trim it,
+   - once trimmed and written again, the mock must stay within 1 msec of the true time over another day, and a new measurement must
+     find no frequency error left.
+
+   Build and run on a host computer (only needs a copy of baseline.h for the type definitions):
+       gcc -O2 -Wall -o ntp-holdover-test ntp-holdover-test.c ntp-adev.c ntp-clock.c ntp-holdover.c ntp-tempco.c -lm
+       ./ntp-holdover-test
+   Exit code is 0 when every check passes, 1 otherwise.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include "ntp-clock.h"
+#include "ntp-holdover.h"
+
+
+#define TEST_EPOCH     1792281600000000ll  // true UTC time at the beginning of the test (18-OCT-2026 00:00:00, in usec).
+#define TEST_BOOT             5000000ll    // Pico timer value at the beginning of the test (in usec).
+#define TEST_CRYSTAL_PPB        20000l     // frequency error of the Pico crystal (in ppb, positive when running fast).
+#define TEST_MOCK_PPB            2000l     // frequency error of the mock holdover clock (in ppb, positive when running fast).
+#define TEST_HOUR          3600000000ll    // one hour (in usec).
+#define TEST_FEED          7200000000ll    // interval between two samples of the holdover clock fed during an NTP outage (NTP_HOLDOVER_FEED).
+
+
+
+/* Check a value against its limits. */
+static UINT8 test_check(const char *Label, INT64 Value, INT64 Minimum, INT64 Maximum);
+
+/* Return the Pico timer value at the true time given (in usec since the beginning of the test). */
+static UINT64 test_local(INT64 Time);
+
+/* Time base of the mock holdover clock: true time since the beginning of the test (its own oscillator). */
+static UINT64 test_timer(void);
+
+
+
+/* True time (in usec since the beginning of the test). */
+static INT64 TestTime;
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=main() */
+/* ============================================================================================================================================================= *\
+                                                                          Main program entry point.
+\* ============================================================================================================================================================= */
+int main(void)
+{
+  UINT8 Errors;
+
+  INT32 DriftPpb;
+
+  INT64 HoldoverTime;
+  INT64 MaxError;
+  INT64 Offset;
+  INT64 WriteTime;
+
+  struct ntp_clock Clock;
+
+  struct ntp_holdover Holdover;
+
+  struct ntp_holdover_mock Mock;
+
+
+  Errors = 0;
+  ntp_holdover_mock_init(&Mock, &Holdover, test_timer, TEST_MOCK_PPB);
+
+  /* A holdover clock never written (battery changed) can't be read. */
+  TestTime = 0ll;
+  Errors  += test_check("read before first write", Holdover.Read(Holdover.Context, &HoldoverTime), 1, 1);
+
+  /* First NTP sync: the holdover clock is written on the second boundary. */
+  Holdover.Write(Holdover.Context, TEST_EPOCH);
+  WriteTime = TestTime;
+
+
+  /* Power cycle one hour later: the disciplined clock is seeded from the holdover clock (see ntp_holdover_init()), 2 ppm x 1 hour off. */
+  TestTime = TEST_HOUR;
+  ntp_clock_init(&Clock);
+  Errors += test_check("read after write", Holdover.Read(Holdover.Context, &HoldoverTime), 0, 0);
+  ntp_clock_sample(&Clock, test_local(TestTime), HoldoverTime, NTP_SOURCE_HOLDOVER);
+  Offset  = ntp_clock_get_utc_us(&Clock, test_local(TestTime)) - (TEST_EPOCH + TestTime);
+  printf("Seeding:       clock valid: %u   error: %lld usec\n", Clock.FlagValid, (long long)Offset);
+  Errors += test_check("clock seeded", Clock.FlagValid, FLAG_ON, FLAG_ON);
+  Errors += test_check("seeding error (usec)", Offset, 7100ll, 7300ll);
+
+
+  /* NTP outage for one day: the holdover clock is fed to the disciplined clock every TEST_FEED. The error just before each feed is the
+     error of the mock at the previous feed plus the drift of the crystal since then (20 ppm x 2 hours = 144 msec). */
+  MaxError = 0ll;
+  for (TestTime = TEST_HOUR + TEST_FEED; TestTime <= (WriteTime + (25 * TEST_HOUR)); TestTime += TEST_FEED)
+  {
+    Offset = ntp_clock_get_utc_us(&Clock, test_local(TestTime)) - (TEST_EPOCH + TestTime);
+    if (Offset > MaxError)  MaxError = Offset;
+    if (-Offset > MaxError) MaxError = -Offset;
+
+    Holdover.Read(Holdover.Context, &HoldoverTime);
+    ntp_clock_sample(&Clock, test_local(TestTime), HoldoverTime, NTP_SOURCE_HOLDOVER);
+  }
+  printf("Outage:        largest error of the disciplined clock: %lld usec\n", (long long)MaxError);
+  Errors += test_check("outage error (usec)", MaxError, 0ll, 144000ll + ((25 * TEST_HOUR * TEST_MOCK_PPB) / 1000000000ll) + 1000ll);
+
+
+  /* NTP is back one day after the write: measure the frequency error of the holdover clock against it (Pico timer elapsed), and trim it. */
+  TestTime = WriteTime + (24 * TEST_HOUR);
+  Holdover.Read(Holdover.Context, &HoldoverTime);
+  Errors += test_check("measure and trim", ntp_holdover_measure(&Holdover, HoldoverTime, TEST_EPOCH + TestTime, (INT64)(test_local(TestTime) - test_local(WriteTime)), &Offset, &DriftPpb), 0, 0);
+  printf("Measurement:   offset: %lld usec   drift: %ld ppb   trim: %ld ppb\n", (long long)Offset, (long)DriftPpb, (long)Mock.TrimPpb);
+  Errors += test_check("offset after one day (usec)", Offset, 172000ll, 173600ll);
+  Errors += test_check("drift (ppb)", DriftPpb, TEST_MOCK_PPB - 50l, TEST_MOCK_PPB + 50l);
+  Errors += test_check("trim (ppb)", Mock.TrimPpb, DriftPpb, DriftPpb);
+  Holdover.Write(Holdover.Context, TEST_EPOCH + TestTime);
+  WriteTime = TestTime;
+
+
+  /* Trimmed holdover clock, one more day without NTP. */
+  TestTime = WriteTime + (24 * TEST_HOUR);
+  Holdover.Read(Holdover.Context, &HoldoverTime);
+  Offset = HoldoverTime - (TEST_EPOCH + TestTime);
+  printf("Trimmed:       offset after one day: %lld usec\n", (long long)Offset);
+  Errors += test_check("trimmed offset (usec)", Offset, -1000ll, 1000ll);
+
+  ntp_holdover_measure(&Holdover, HoldoverTime, TEST_EPOCH + TestTime, (INT64)(test_local(TestTime) - test_local(WriteTime)), &Offset, &DriftPpb);
+  Errors += test_check("drift left (ppb)", DriftPpb, -50l, 50l);
+
+  printf("\n%s (%u error(s))\n", (Errors == 0) ? "PASS" : "FAIL", Errors);
+
+  return (Errors == 0) ? 0 : 1;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_check() */
+/* ============================================================================================================================================================= *\
+                                                                      Check a value against its limits.
+                                                         NOTE: Return 1 if it is out of limits, 0 otherwise.
+\* ============================================================================================================================================================= */
+static UINT8 test_check(const char *Label, INT64 Value, INT64 Minimum, INT64 Maximum)
+{
+  if ((Value >= Minimum) && (Value <= Maximum)) return 0;
+
+  printf("  FAIL: %s: %lld instead of %lld to %lld\n", Label, (long long)Value, (long long)Minimum, (long long)Maximum);
+
+  return 1;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_local() */
+/* ============================================================================================================================================================= *\
+                                            Return the Pico timer value at the true time given (in usec since the beginning of the test).
+\* ============================================================================================================================================================= */
+static UINT64 test_local(INT64 Time)
+{
+  return (UINT64)(TEST_BOOT + Time + ((Time * TEST_CRYSTAL_PPB) / 1000000000ll));
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=test_timer() */
+/* ============================================================================================================================================================= *\
+                                       Time base of the mock holdover clock: true time since the beginning of the test (its own oscillator).
+\* ============================================================================================================================================================= */
+static UINT64 test_timer(void)
+{
+  return (UINT64)TestTime;
+}
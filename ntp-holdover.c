@@ -0,0 +1,168 @@
+/* ============================================================================================================================================================= *\
+   ntp-holdover.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Frequency measurement of the holdover clock and RAM "mock" holdover clock (see ntp-holdover.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include "ntp-holdover.h"
+
+
+
+/* Return the mock clock time (in usec since 01-JAN-1970) for the time base value given. */
+static INT64 ntp_holdover_mock_get(struct ntp_holdover_mock *Mock, UINT64 LocalTime);
+
+/* Read the mock clock. */
+static UINT8 ntp_holdover_mock_read(void *Context, INT64 *UTCTime);
+
+/* Compensate a frequency error of the mock clock. */
+static UINT8 ntp_holdover_mock_trim(void *Context, INT32 FrequencyPpb);
+
+/* Set the mock clock. */
+static UINT8 ntp_holdover_mock_write(void *Context, INT64 UTCTime);
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_holdover_measure() */
+/* ============================================================================================================================================================= *\
+                                        Measure the frequency error of the holdover clock since it has been written, and trim it.
+                  NOTE: HoldoverTime is read from the holdover clock and UTCTime from the disciplined clock at the same instant, Elapsed (in usec)
+                        is the time since the holdover clock has been written. The offset accumulated since then is due to the frequency error of
+                        the holdover clock: it is returned in Offset (in usec) and DriftPpb (in ppb, positive when the holdover clock runs fast),
+                        and compensated through Trim() if the driver supports it. Return 0 on success, 1 if Trim() failed.
+\* ============================================================================================================================================================= */
+UINT8 ntp_holdover_measure(struct ntp_holdover *Holdover, INT64 HoldoverTime, INT64 UTCTime, INT64 Elapsed, INT64 *Offset, INT32 *DriftPpb)
+{
+  *Offset   = HoldoverTime - UTCTime;
+  *DriftPpb = (Elapsed > 0ll) ? (INT32)((*Offset * 1000000000ll) / Elapsed) : 0l;
+
+  if (Holdover->Trim != NULL)
+    if (Holdover->Trim(Holdover->Context, *DriftPpb) != 0) return 1;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_holdover_mock_get() */
+/* ============================================================================================================================================================= *\
+                                                Return the mock clock time (in usec since 01-JAN-1970) for the time base value given.
+\* ============================================================================================================================================================= */
+static INT64 ntp_holdover_mock_get(struct ntp_holdover_mock *Mock, UINT64 LocalTime)
+{
+  INT64 Elapsed;
+
+
+  Elapsed = (INT64)(LocalTime - Mock->BaseLocal);
+
+  return Mock->BaseUTC + Elapsed + ((Elapsed * (Mock->FrequencyPpb - Mock->TrimPpb)) / 1000000000ll);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_holdover_mock_init() */
+/* ============================================================================================================================================================= *\
+                                                   Initialize a RAM holdover clock and the holdover interface pointing to it.
+                              NOTE: The mock clock is invalid (Read() fails) until it is written, exactly like an external clock after a battery change.
+\* ============================================================================================================================================================= */
+void ntp_holdover_mock_init(struct ntp_holdover_mock *Mock, struct ntp_holdover *Holdover, UINT64 (*Timer)(void), INT32 FrequencyPpb)
+{
+  Mock->Timer        = Timer;
+  Mock->FlagValid    = FLAG_OFF;
+  Mock->FrequencyPpb = FrequencyPpb;
+  Mock->TrimPpb      = 0l;
+  Mock->BaseLocal    = 0ll;
+  Mock->BaseUTC      = 0ll;
+
+  Holdover->Name     = "Mock";
+  Holdover->Context  = Mock;
+  Holdover->Read     = ntp_holdover_mock_read;
+  Holdover->Write    = ntp_holdover_mock_write;
+  Holdover->Trim     = ntp_holdover_mock_trim;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_holdover_mock_read() */
+/* ============================================================================================================================================================= *\
+                                                                           Read the mock clock.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_holdover_mock_read(void *Context, INT64 *UTCTime)
+{
+  struct ntp_holdover_mock *Mock = Context;
+
+
+  if (Mock->FlagValid == FLAG_OFF) return 1;
+
+  *UTCTime = ntp_holdover_mock_get(Mock, Mock->Timer());
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_holdover_mock_trim() */
+/* ============================================================================================================================================================= *\
+                                                                Compensate a frequency error of the mock clock.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_holdover_mock_trim(void *Context, INT32 FrequencyPpb)
+{
+  UINT64 LocalTime;
+
+  struct ntp_holdover_mock *Mock = Context;
+
+
+  /* Move the base to current time first, so that the new trim only applies from now on. */
+  LocalTime       = Mock->Timer();
+  Mock->BaseUTC   = ntp_holdover_mock_get(Mock, LocalTime);
+  Mock->BaseLocal = LocalTime;
+  Mock->TrimPpb  += FrequencyPpb;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_holdover_mock_write() */
+/* ============================================================================================================================================================= *\
+                                                                             Set the mock clock.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_holdover_mock_write(void *Context, INT64 UTCTime)
+{
+  struct ntp_holdover_mock *Mock = Context;
+
+
+  Mock->BaseLocal = Mock->Timer();
+  Mock->BaseUTC   = UTCTime;
+  Mock->FlagValid = FLAG_ON;
+
+  return 0;
+}
@@ -0,0 +1,53 @@
+/* ============================================================================================================================================================= *\
+   ntp-holdover.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.00
+
+   Interface to an external battery-backed clock (for example a DS3231) used by Pico-NTP-Module as a holdover source:
+   it is read at power-up to get the time right away, written after good NTP syncs and its frequency error is learned against NTP.
+   Also contains the frequency measurement of the holdover clock and a RAM "mock" holdover clock, which don't depend on the Pico SDK
+   so that they may be compiled on a host computer (see ntp-holdover-test.c).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_HOLDOVER_H
+#define _NTP_HOLDOVER_H
+
+#include "baseline.h"
+
+
+/* Holdover clock driver. All functions receive the driver's Context and return 0 on success. */
+struct ntp_holdover
+{
+  UCHAR *Name;                                       // name of the holdover clock (for display purposes).
+  void  *Context;                                    // driver private data.
+  UINT8 (*Read)(void *Context, INT64 *UTCTime);      // read UTC time (in usec since 01-JAN-1970) at the time of return.
+  UINT8 (*Write)(void *Context, INT64 UTCTime);      // set UTC time (always a whole second, called right on the second boundary, in thread context).
+  UINT8 (*Trim)(void *Context, INT32 FrequencyPpb);  // compensate a frequency error (in ppb, positive when the clock runs fast). May be NULL.
+};
+
+
+/* RAM holdover clock, with a simulated frequency error. */
+struct ntp_holdover_mock
+{
+  UINT64 (*Timer)(void);         // time base (in usec): time_us_64() on the Pico, or a simulated timer.
+  UINT8  FlagValid;              // flag indicating that the mock clock has been written at least once.
+  INT32  FrequencyPpb;           // simulated frequency error (in ppb, positive when the mock clock runs fast).
+  INT32  TrimPpb;                // cumulative frequency correction received through Trim().
+  UINT64 BaseLocal;              // time base value at the last write (or trim).
+  INT64  BaseUTC;                // UTC time (in usec since 01-JAN-1970) corresponding to BaseLocal.
+};
+
+
+/* Measure the frequency error of the holdover clock since it has been written, and trim it. */
+UINT8 ntp_holdover_measure(struct ntp_holdover *Holdover, INT64 HoldoverTime, INT64 UTCTime, INT64 Elapsed, INT64 *Offset, INT32 *DriftPpb);
+
+/* Initialize a RAM holdover clock and the holdover interface pointing to it. */
+void ntp_holdover_mock_init(struct ntp_holdover_mock *Mock, struct ntp_holdover *Holdover, UINT64 (*Timer)(void), INT32 FrequencyPpb);
+
+#endif  // _NTP_HOLDOVER_H
@@ -0,0 +1,50 @@
+/* Dny v tydnu (kratky format) - Maximalne 3 znaky. */
+#define $SUN "NED"
+#define $MON "PON"
+#define $TUE "UTE"
+#define $WED "STR"
+#define $THU "CTV"
+#define $FRI "PAT"
+#define $SAT "SOB"
+
+/* Dny v tydnu (dlouhy format) - Maximalne 12 znaku. */
+#define $SUNDAY    "Nedele"
+#define $MONDAY    "Pondeli"
+#define $TUESDAY   "Utery"
+#define $WEDNESDAY "Streda"
+#define $THURSDAY  "Ctvrtek"
+#define $FRIDAY    "Patek"
+#define $SATURDAY  "Sobota"
+
+/* Mesice (kratky format) - Maximalne 3 znaky. */
+#define $JAN "LED"
+#define $FEB "UNO"
+#define $MAR "BRE"
+#define $APR "DUB"
+#define $MAY "KVE"
+#define $JUN "CER"
+#define $JUL "CVC"
+#define $AUG "SRP"
+#define $SEP "ZAR"
+#define $OCT "RIJ"
+#define $NOV "LIS"
+#define $DEC "PRO"
+
+/* Mesice - Maximalne 12 znaku. */
+#define $JANUARY   "Leden"
+#define $FEBRUARY  "Unor"
+#define $MARCH     "Brezen"
+#define $APRIL     "Duben"
+#define $MMAY      "Kveten"
+#define $JUNE      "Cerven"
+#define $JULY      "Cervenec"
+#define $AUGUST    "Srpen"
+#define $SEPTEMBER "Zari"
+#define $OCTOBER   "Rijen"
+#define $NOVEMBER  "Listopad"
+#define $DECEMBER  "Prosinec"
+
+/* Dopoledne / odpoledne (12hodinovy format). */
+#define $AM "DOP"
+#define $PM "ODP"
+
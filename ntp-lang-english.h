@@ -44,3 +44,7 @@
 #define $NOVEMBER  "November"
 #define $DECEMBER  "December"
 
+/* Before noon / after noon (12-hour format). */
+#define $AM "AM"
+#define $PM "PM"
+
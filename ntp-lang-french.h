@@ -44,3 +44,7 @@
 #define $NOVEMBER  "Novembre"
 #define $DECEMBER  "Decembre"
 
+/* Avant midi / apres midi (format 12 heures). */
+#define $AM "AM"
+#define $PM "PM"
+
@@ -0,0 +1,50 @@
+/* Wochentage (Kurzform) - Maximal 3 Zeichen. */
+#define $SUN "SON"
+#define $MON "MON"
+#define $TUE "DIE"
+#define $WED "MIT"
+#define $THU "DON"
+#define $FRI "FRE"
+#define $SAT "SAM"
+
+/* Wochentage (Langform) - Maximal 12 Zeichen. */
+#define $SUNDAY    "Sonntag"
+#define $MONDAY    "Montag"
+#define $TUESDAY   "Dienstag"
+#define $WEDNESDAY "Mittwoch"
+#define $THURSDAY  "Donnerstag"
+#define $FRIDAY    "Freitag"
+#define $SATURDAY  "Samstag"
+
+/* Monate (Kurzform) - Maximal 3 Zeichen. */
+#define $JAN "JAN"
+#define $FEB "FEB"
+#define $MAR "MAR"
+#define $APR "APR"
+#define $MAY "MAI"
+#define $JUN "JUN"
+#define $JUL "JUL"
+#define $AUG "AUG"
+#define $SEP "SEP"
+#define $OCT "OKT"
+#define $NOV "NOV"
+#define $DEC "DEZ"
+
+/* Monate - Maximal 12 Zeichen. */
+#define $JANUARY   "Januar"
+#define $FEBRUARY  "Februar"
+#define $MARCH     "Maerz"
+#define $APRIL     "April"
+#define $MMAY      "Mai"
+#define $JUNE      "Juni"
+#define $JULY      "Juli"
+#define $AUGUST    "August"
+#define $SEPTEMBER "September"
+#define $OCTOBER   "Oktober"
+#define $NOVEMBER  "November"
+#define $DECEMBER  "Dezember"
+
+/* Vormittag / Nachmittag (12-Stunden-Format). */
+#define $AM "AM"
+#define $PM "PM"
+
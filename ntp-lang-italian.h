@@ -0,0 +1,50 @@
+/* Giorni della settimana (formato breve) - Massimo 3 caratteri. */
+#define $SUN "DOM"
+#define $MON "LUN"
+#define $TUE "MAR"
+#define $WED "MER"
+#define $THU "GIO"
+#define $FRI "VEN"
+#define $SAT "SAB"
+
+/* Giorni della settimana (formato lungo) - Massimo 12 caratteri. */
+#define $SUNDAY    "Domenica"
+#define $MONDAY    "Lunedi"
+#define $TUESDAY   "Martedi"
+#define $WEDNESDAY "Mercoledi"
+#define $THURSDAY  "Giovedi"
+#define $FRIDAY    "Venerdi"
+#define $SATURDAY  "Sabato"
+
+/* Mesi (formato breve) - Massimo 3 caratteri. */
+#define $JAN "GEN"
+#define $FEB "FEB"
+#define $MAR "MAR"
+#define $APR "APR"
+#define $MAY "MAG"
+#define $JUN "GIU"
+#define $JUL "LUG"
+#define $AUG "AGO"
+#define $SEP "SET"
+#define $OCT "OTT"
+#define $NOV "NOV"
+#define $DEC "DIC"
+
+/* Mesi - Massimo 12 caratteri. */
+#define $JANUARY   "Gennaio"
+#define $FEBRUARY  "Febbraio"
+#define $MARCH     "Marzo"
+#define $APRIL     "Aprile"
+#define $MMAY      "Maggio"
+#define $JUNE      "Giugno"
+#define $JULY      "Luglio"
+#define $AUGUST    "Agosto"
+#define $SEPTEMBER "Settembre"
+#define $OCTOBER   "Ottobre"
+#define $NOVEMBER  "Novembre"
+#define $DECEMBER  "Dicembre"
+
+/* Antimeridiane / pomeridiane (formato 12 ore). */
+#define $AM "AM"
+#define $PM "PM"
+
@@ -0,0 +1,50 @@
+/* Dias de la semana (formato corto) - Maximo 3 caracteres. */
+#define $SUN "DOM"
+#define $MON "LUN"
+#define $TUE "MAR"
+#define $WED "MIE"
+#define $THU "JUE"
+#define $FRI "VIE"
+#define $SAT "SAB"
+
+/* Dias de la semana (formato largo) - Maximo 12 caracteres. */
+#define $SUNDAY    "Domingo"
+#define $MONDAY    "Lunes"
+#define $TUESDAY   "Martes"
+#define $WEDNESDAY "Miercoles"
+#define $THURSDAY  "Jueves"
+#define $FRIDAY    "Viernes"
+#define $SATURDAY  "Sabado"
+
+/* Meses (formato corto) - Maximo 3 caracteres. */
+#define $JAN "ENE"
+#define $FEB "FEB"
+#define $MAR "MAR"
+#define $APR "ABR"
+#define $MAY "MAY"
+#define $JUN "JUN"
+#define $JUL "JUL"
+#define $AUG "AGO"
+#define $SEP "SEP"
+#define $OCT "OCT"
+#define $NOV "NOV"
+#define $DEC "DIC"
+
+/* Meses - Maximo 12 caracteres. */
+#define $JANUARY   "Enero"
+#define $FEBRUARY  "Febrero"
+#define $MARCH     "Marzo"
+#define $APRIL     "Abril"
+#define $MMAY      "Mayo"
+#define $JUNE      "Junio"
+#define $JULY      "Julio"
+#define $AUGUST    "Agosto"
+#define $SEPTEMBER "Septiembre"
+#define $OCTOBER   "Octubre"
+#define $NOVEMBER  "Noviembre"
+#define $DECEMBER  "Diciembre"
+
+/* Antes / despues del mediodia (formato 12 horas). */
+#define $AM "AM"
+#define $PM "PM"
+
@@ -0,0 +1,46 @@
+/* Undefine all names of a language file, so that the next language file may be included (see language table in Pico-NTP-Module.c). */
+#undef $SUN
+#undef $MON
+#undef $TUE
+#undef $WED
+#undef $THU
+#undef $FRI
+#undef $SAT
+
+#undef $SUNDAY
+#undef $MONDAY
+#undef $TUESDAY
+#undef $WEDNESDAY
+#undef $THURSDAY
+#undef $FRIDAY
+#undef $SATURDAY
+
+#undef $JAN
+#undef $FEB
+#undef $MAR
+#undef $APR
+#undef $MAY
+#undef $JUN
+#undef $JUL
+#undef $AUG
+#undef $SEP
+#undef $OCT
+#undef $NOV
+#undef $DEC
+
+#undef $JANUARY
+#undef $FEBRUARY
+#undef $MARCH
+#undef $APRIL
+#undef $MMAY
+#undef $JUNE
+#undef $JULY
+#undef $AUGUST
+#undef $SEPTEMBER
+#undef $OCTOBER
+#undef $NOVEMBER
+#undef $DECEMBER
+
+#undef $AM
+#undef $PM
+
@@ -0,0 +1,77 @@
+/* ============================================================================================================================================================= *\
+   ntp-log-decode.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Host computer program decoding the events sent by ntp_log_drain() (see ntp-log.h). Reads the Pico's USB CDC output (or a capture of it)
+   on stdin and writes it to stdout with event lines translated to text. Other lines are copied as is.
+
+   Build and run on a host computer (only needs a copy of baseline.h for the type definitions):
+       gcc -O2 -o ntp-log-decode ntp-log-decode.c ntp-log.c
+       ./ntp-log-decode < /dev/ttyACM0
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ntp-log.h"
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=main() */
+/* ============================================================================================================================================================= *\
+                                                                          Main program entry point.
+\* ============================================================================================================================================================= */
+int main(void)
+{
+  UCHAR Line[256];
+  UCHAR Text[160];
+
+  unsigned int  Category;
+  unsigned int  Id;
+  unsigned long Arg[NTP_LOG_ARGS];
+  unsigned long Timestamp;
+
+  UINT8 Loop1UInt8;
+
+  size_t Length;
+
+  struct ntp_log_event Event;
+
+
+  while (fgets((char *)Line, sizeof(Line), stdin) != NULL)
+  {
+    /* ntp_log_drain() ends its lines with a <CR> only. */
+    Length = strcspn((char *)Line, "\r\n");
+    Line[Length] = 0x00;
+
+    if ((strncmp((char *)Line, NTP_LOG_TAG, strlen(NTP_LOG_TAG)) != 0) ||
+        (sscanf((char *)&Line[strlen(NTP_LOG_TAG)], "%lx %x %x %lx %lx %lx", &Timestamp, &Id, &Category, &Arg[0], &Arg[1], &Arg[2]) != 6))
+    {
+      printf("%s\n", Line);
+      continue;
+    }
+
+    memset(&Event, 0, sizeof(Event));
+    Event.Timestamp = (UINT32)Timestamp;
+    Event.Id        = (UINT16)Id;
+    Event.Category  = (UINT8)Category;
+    for (Loop1UInt8 = 0; Loop1UInt8 < NTP_LOG_ARGS; ++Loop1UInt8)
+      Event.Arg[Loop1UInt8] = (INT32)(UINT32)Arg[Loop1UInt8];
+
+    ntp_log_decode(&Event, Text, sizeof(Text));
+    printf("%s\n", Text);
+  }
+
+  return 0;
+}
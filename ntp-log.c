@@ -0,0 +1,306 @@
+/* ============================================================================================================================================================= *\
+   ntp-log.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Event log used by Pico-NTP-Module (see ntp-log.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include <stdio.h>
+
+#include "ntp-log.h"
+
+/* On the Pico, a slot of the ring buffer is reserved with interrupts disabled for a few instructions (Cortex-M0+ has no atomic increment).
+   A hardware spin lock is also held so that both cores may log events (see ntp_core1_start()). */
+#if PICO_ON_DEVICE
+#include "hardware/sync.h"
+#define NTP_LOG_LOCK(Mask)    Mask = spin_lock_blocking(LogLock)
+#define NTP_LOG_UNLOCK(Mask)  spin_unlock(LogLock, Mask)
+#else   // PICO_ON_DEVICE
+#define NTP_LOG_LOCK(Mask)    Mask = 0
+#define NTP_LOG_UNLOCK(Mask)  (void)Mask
+#endif  // PICO_ON_DEVICE
+
+
+
+/* Expand the template of an event in the buffer given. */
+static INT ntp_log_expand(const struct ntp_log_event *Event, UCHAR *Buffer, INT BufferSize);
+
+/* Return the time base (in usec) used when no timer has been given. */
+static UINT32 ntp_log_no_timer(void);
+
+
+
+/* Global variables. */
+static struct ntp_log_event LogBuffer[NTP_LOG_SIZE];
+
+static volatile UINT32 LogHead;  // position of the next event to be written.
+static UINT32 LogTail;           // position of the next event to be drained.
+static UINT32 LogLost;           // events overwritten before being drained, not reported yet.
+
+static volatile UINT8 LogMask;   // categories of events currently logged.
+
+static UINT32 (*LogTimer)(void) = ntp_log_no_timer;
+
+#if PICO_ON_DEVICE
+static spin_lock_t *LogLock;     // hardware spin lock claimed by ntp_log_init().
+#endif  // PICO_ON_DEVICE
+
+/* Event templates: "$n" is replaced by argument n in decimal, "#n" by argument n in hexadecimal (the templates are never used as printf formats). */
+static const UCHAR *const EventText[NTP_EVENT_COUNT] =
+{
+  "$0 event(s) lost",                                                      // NTP_EVENT_LOST
+  "NTP request sent (origin: #0   IPv$1)",                                 // NTP_EVENT_REQUEST
+  "NTP reply: offset $0 usec   round-trip: $1 usec   stratum: $2",         // NTP_EVENT_REPLY
+  "Malformed or bogus NTP reply ignored (parser status: $0)",              // NTP_EVENT_BOGUS
+  "NTP reply rejected: mode $0   stratum $1   authentication $2",          // NTP_EVENT_INVALID
+  "No NTP reply (alarm $0   families pending: $1)",                        // NTP_EVENT_FAILED
+  "Authentication failed (key ID $0   reason $1)",                         // NTP_EVENT_AUTH
+  "Clock stepped by $0 usec (source $1)",                                  // NTP_EVENT_STEP
+  "Leap second applied ($0)",                                              // NTP_EVENT_LEAP
+  "PPS edge rejected ($0 usec from second boundary)",                      // NTP_EVENT_PPS_REJECT
+  "RTC re-aligned (drift: $0 usec)",                                       // NTP_EVENT_RTC_ALIGN
+  "Holdover clock offset: $0 usec   drift: $1 ppb",                        // NTP_EVENT_HOLDOVER
+  "IPv$0 selected (round-trip IPv6: $1 usec   IPv4: $2 usec)",             // NTP_EVENT_FAMILY
+  "NTP broadcast: offset $0 usec   one-way: $1 usec   stratum: $2",        // NTP_EVENT_BROADCAST
+  "Holdover clock fed ($0 sec since last sample)",                         // NTP_EVENT_HOLDOVER_FEED
+  "NTP packet received: $0 bytes   port: $1   server address match: $2",   // NTP_EVENT_RECEIVE
+};
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_log_decode() */
+/* ============================================================================================================================================================= *\
+                                                                       Decode an event in a text string.
+                                                  NOTE: Result is truncated to BufferSize - 1 characters. Return its length.
+\* ============================================================================================================================================================= */
+UINT16 ntp_log_decode(const struct ntp_log_event *Event, UCHAR *Buffer, UINT16 BufferSize)
+{
+  INT Length;
+
+
+  if (BufferSize == 0) return 0;
+
+  Length = snprintf((char *)Buffer, BufferSize, "[%10lu] ", (unsigned long)Event->Timestamp);
+  if ((Length < 0) || (Length >= BufferSize)) return (BufferSize - 1);
+
+  if (Event->Id < NTP_EVENT_COUNT)
+    Length += ntp_log_expand(Event, &Buffer[Length], BufferSize - Length);
+  else
+    Length += snprintf((char *)&Buffer[Length], BufferSize - Length, "Unknown event %u: %ld %ld %ld", Event->Id, (long)Event->Arg[0], (long)Event->Arg[1], (long)Event->Arg[2]);
+
+  if (Length >= BufferSize) Length = BufferSize - 1;
+
+  return (UINT16)Length;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_log_drain() */
+/* ============================================================================================================================================================= *\
+                                                                   Send events waiting in the ring buffer to stdout.
+                NOTE: To be called from the idle loop (never from an interrupt handler). Each event is sent as a single text line beginning with
+                      NTP_LOG_TAG, that ntp-log-decode.c translates on the host computer. Events overwritten before being drained are reported as
+                      an NTP_EVENT_LOST event. Return the number of events sent.
+\* ============================================================================================================================================================= */
+UINT16 ntp_log_drain(UINT16 MaxEvents)
+{
+  UINT16 Count;
+
+  UINT32 Head;
+
+  struct ntp_log_event Event;
+
+
+  Count = 0;
+  while (Count < MaxEvents)
+  {
+    Head = LogHead;
+    if (LogTail == Head) break;
+
+    /* Writers went around the ring buffer: skip events that have been overwritten. */
+    if ((Head - LogTail) > NTP_LOG_SIZE)
+    {
+      LogLost += (Head - LogTail) - NTP_LOG_SIZE;
+      LogTail  = Head - NTP_LOG_SIZE;
+    }
+
+    /* Copy the event, then make sure that it was complete and has not been overwritten while we were copying it. */
+    Event = LogBuffer[LogTail & (NTP_LOG_SIZE - 1)];
+    __asm volatile ("" ::: "memory");
+    if (Event.Sequence == 0) break;  // still being written by an interrupt handler.
+    if ((Event.Sequence != (LogTail + 1)) || (LogBuffer[LogTail & (NTP_LOG_SIZE - 1)].Sequence != Event.Sequence))
+    {
+      ++LogLost;
+      ++LogTail;
+      continue;
+    }
+    ++LogTail;
+
+    if (LogLost)
+    {
+      printf("%s %8.8lX %4.4X %2.2X %8.8lX 0 0\r", NTP_LOG_TAG, (unsigned long)Event.Timestamp, NTP_EVENT_LOST, NTP_LOG_ALL, (unsigned long)LogLost);
+      LogLost = 0;
+    }
+
+    printf("%s %8.8lX %4.4X %2.2X %8.8lX %8.8lX %8.8lX\r", NTP_LOG_TAG, (unsigned long)Event.Timestamp, Event.Id, Event.Category, (unsigned long)Event.Arg[0], (unsigned long)Event.Arg[1], (unsigned long)Event.Arg[2]);
+    ++Count;
+  }
+
+  return Count;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_log_enable() */
+/* ============================================================================================================================================================= *\
+                                                                  Select categories of events to be logged.
+\* ============================================================================================================================================================= */
+void ntp_log_enable(UINT8 CategoryMask)
+{
+  LogMask = CategoryMask;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_log_event() */
+/* ============================================================================================================================================================= *\
+                                                                    Record an event in the ring buffer.
+                  NOTE: Never blocks: when the ring buffer is full, the oldest event is overwritten. Costs a few hundred nanoseconds on the Pico,
+                        and only a test of the category mask when the category is disabled. May be called from interrupt handlers.
+\* ============================================================================================================================================================= */
+void ntp_log_event(UINT8 Category, UINT16 Id, INT32 Arg0, INT32 Arg1, INT32 Arg2)
+{
+  UINT32 Index;
+  UINT32 Mask;
+
+  struct ntp_log_event *Slot;
+
+
+  if ((LogMask & Category) == 0) return;
+
+  NTP_LOG_LOCK(Mask);
+  Index = LogHead++;
+  NTP_LOG_UNLOCK(Mask);
+
+  Slot = &LogBuffer[Index & (NTP_LOG_SIZE - 1)];
+  Slot->Sequence  = 0;
+  __asm volatile ("" ::: "memory");
+  Slot->Timestamp = LogTimer();
+  Slot->Id        = Id;
+  Slot->Category  = Category;
+  Slot->Arg[0]    = Arg0;
+  Slot->Arg[1]    = Arg1;
+  Slot->Arg[2]    = Arg2;
+  __asm volatile ("" ::: "memory");
+  Slot->Sequence  = Index + 1;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_log_expand() */
+/* ============================================================================================================================================================= *\
+                                                               Expand the template of an event in the buffer given.
+                 NOTE: Only literal formats are given to snprintf(), so that a template can't be taken for a printf format. A placeholder
+                       with an argument number beyond NTP_LOG_ARGS is copied as is. Return the length that the whole text would have.
+\* ============================================================================================================================================================= */
+static INT ntp_log_expand(const struct ntp_log_event *Event, UCHAR *Buffer, INT BufferSize)
+{
+  UCHAR Field[16];
+
+  const UCHAR *Template;
+
+  INT Length;
+  INT Loop1Int;
+
+
+  Length   = 0;
+  Template = EventText[Event->Id];
+  while (*Template)
+  {
+    if (((*Template == '$') || (*Template == '#')) && (Template[1] >= '0') && (Template[1] < ('0' + NTP_LOG_ARGS)))
+    {
+      if (*Template == '$')
+        snprintf((char *)Field, sizeof(Field), "%ld", (long)Event->Arg[Template[1] - '0']);
+      else
+        snprintf((char *)Field, sizeof(Field), "0x%8.8lX", (unsigned long)(UINT32)Event->Arg[Template[1] - '0']);
+      Template += 2;
+    }
+    else
+    {
+      Field[0] = *Template++;
+      Field[1] = 0x00;
+    }
+
+    for (Loop1Int = 0; Field[Loop1Int]; ++Loop1Int, ++Length)
+      if (Length < (BufferSize - 1)) Buffer[Length] = Field[Loop1Int];
+  }
+
+  if (BufferSize > 0) Buffer[(Length < BufferSize) ? Length : (BufferSize - 1)] = 0x00;
+
+  return Length;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_log_init() */
+/* ============================================================================================================================================================= *\
+                                                                         Initialize the event log.
+                                           NOTE: Timer is the time base (in usec) used to timestamp events: time_us_32() on the Pico.
+\* ============================================================================================================================================================= */
+void ntp_log_init(UINT32 (*Timer)(void), UINT8 CategoryMask)
+{
+  LogMask  = 0;
+#if PICO_ON_DEVICE
+  if (LogLock == NULL) LogLock = spin_lock_init(spin_lock_claim_unused(true));
+#endif  // PICO_ON_DEVICE
+  LogTimer = (Timer != NULL) ? Timer : ntp_log_no_timer;
+  LogTail  = LogHead;
+  LogLost  = 0;
+  LogMask  = CategoryMask;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_log_no_timer() */
+/* ============================================================================================================================================================= *\
+                                                          Return the time base (in usec) used when no timer has been given.
+\* ============================================================================================================================================================= */
+static UINT32 ntp_log_no_timer(void)
+{
+  return 0;
+}
@@ -0,0 +1,84 @@
+/* ============================================================================================================================================================= *\
+   ntp-log.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.00
+
+   Event log used by Pico-NTP-Module. Events are small binary records (event ID, category, timestamp and three arguments) written in a
+   ring buffer by ntp_log_event(), which never blocks and may be called from interrupt handlers and lwIP callbacks. The ring buffer is
+   drained from the idle loop by ntp_log_drain(), which sends one compact text line per event; lines are decoded on the host computer
+   by ntp-log-decode.c (or on the Pico itself with ntp_log_decode()). Each category of events may be enabled or disabled at run time.
+   This file doesn't depend on the Pico SDK so that it may also be compiled on a host computer.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_LOG_H
+#define _NTP_LOG_H
+
+#include "baseline.h"
+
+
+#define NTP_LOG_SIZE             128   // number of events in the ring buffer (must be a power of 2).
+#define NTP_LOG_ARGS               3   // number of arguments of an event.
+#define NTP_LOG_TAG        "#NTPLOG"   // beginning of the lines sent by ntp_log_drain().
+
+/* Categories of events (bit mask given to ntp_log_enable()). */
+#define NTP_LOG_SYNC            0x01   // NTP requests and replies.
+#define NTP_LOG_AUTH            0x02   // authentication.
+#define NTP_LOG_CLOCK           0x04   // disciplined clock and leap seconds.
+#define NTP_LOG_PPS             0x08   // PPS input.
+#define NTP_LOG_RTC             0x10   // Pico's real-time clock.
+#define NTP_LOG_HOLDOVER        0x20   // holdover clock.
+#define NTP_LOG_ALL             0xFF
+
+/* Events. */
+#define NTP_EVENT_LOST             0   // events overwritten before being drained.
+#define NTP_EVENT_REQUEST          1   // NTP request sent.
+#define NTP_EVENT_REPLY            2   // valid NTP reply received.
+#define NTP_EVENT_BOGUS            3   // malformed or bogus NTP reply ignored.
+#define NTP_EVENT_INVALID          4   // NTP reply rejected (mode, stratum, leap indicator or authentication).
+#define NTP_EVENT_FAILED           5   // no reply received.
+#define NTP_EVENT_AUTH             6   // MAC missing or invalid.
+#define NTP_EVENT_STEP             7   // disciplined clock stepped.
+#define NTP_EVENT_LEAP             8   // leap second applied.
+#define NTP_EVENT_PPS_REJECT       9   // PPS edge rejected.
+#define NTP_EVENT_RTC_ALIGN       10   // Pico's real-time clock re-aligned.
+#define NTP_EVENT_HOLDOVER        11   // holdover clock measured.
+#define NTP_EVENT_FAMILY          12   // address family with the shortest round-trip delay changed.
+#define NTP_EVENT_BROADCAST       13   // broadcast NTP packet used.
+#define NTP_EVENT_HOLDOVER_FEED   14   // time read from the holdover clock fed to the disciplined clock.
+#define NTP_EVENT_RECEIVE         15   // NTP packet received.
+#define NTP_EVENT_COUNT           16
+
+
+struct ntp_log_event
+{
+  UINT32 Sequence;               // position of the event in the log plus one, written last (0 while the event is being written).
+  UINT32 Timestamp;              // Pico timer (in usec, lower 32 bits) when the event occurred.
+  UINT16 Id;                     // event (NTP_EVENT_xxx).
+  UINT8  Category;               // category of the event (NTP_LOG_xxx).
+  UINT8  Reserved;
+  INT32  Arg[NTP_LOG_ARGS];      // event arguments.
+};
+
+
+/* Decode an event in a text string. */
+UINT16 ntp_log_decode(const struct ntp_log_event *Event, UCHAR *Buffer, UINT16 BufferSize);
+
+/* Send events waiting in the ring buffer to stdout. */
+UINT16 ntp_log_drain(UINT16 MaxEvents);
+
+/* Select categories of events to be logged. */
+void ntp_log_enable(UINT8 CategoryMask);
+
+/* Record an event in the ring buffer. */
+void ntp_log_event(UINT8 Category, UINT16 Id, INT32 Arg0, INT32 Arg1, INT32 Arg2);
+
+/* Initialize the event log. */
+void ntp_log_init(UINT32 (*Timer)(void), UINT8 CategoryMask);
+
+#endif  // _NTP_LOG_H
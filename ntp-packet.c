@@ -0,0 +1,117 @@
+/* ============================================================================================================================================================= *\
+   ntp-packet.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Parser for NTP packets (see ntp-packet.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include <string.h>
+
+#include "ntp-packet.h"
+
+
+
+/* Read a 32-bit big-endian value. */
+static UINT32 ntp_packet_get32(const UINT8 *Buffer);
+
+/* Convert a 16.16 fixed-point number of seconds to usec. */
+static UINT32 ntp_packet_get_short_us(const UINT8 *Buffer);
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_packet_get32() */
+/* ============================================================================================================================================================= *\
+                                                                         Read a 32-bit big-endian value.
+\* ============================================================================================================================================================= */
+static UINT32 ntp_packet_get32(const UINT8 *Buffer)
+{
+  return ((UINT32)Buffer[0] << 24) | ((UINT32)Buffer[1] << 16) | ((UINT32)Buffer[2] << 8) | Buffer[3];
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_packet_get_short_us() */
+/* ============================================================================================================================================================= *\
+                                                             Convert a 16.16 fixed-point number of seconds to usec.
+\* ============================================================================================================================================================= */
+static UINT32 ntp_packet_get_short_us(const UINT8 *Buffer)
+{
+  return (UINT32)(((UINT64)ntp_packet_get32(Buffer) * 1000000ull) >> 16);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_packet_parse() */
+/* ============================================================================================================================================================= *\
+                                                                              Parse an NTP packet.
+                   NOTE: Only the packet format is checked here: header, extension fields (skipped over, so that NTS support may be added later)
+                         and MAC (20 or 24 bytes at the end of the packet, RFC 7822). Checking the content (mode, stratum, origin timestamp and
+                         MAC digest) is up to the caller. Return NTP_PACKET_OK or the reason why the packet has been rejected.
+\* ============================================================================================================================================================= */
+UINT8 ntp_packet_parse(const UINT8 *Packet, UINT16 PacketLength, struct ntp_packet *Info)
+{
+  UINT16 ExtensionLength;
+  UINT16 Offset;
+
+
+  memset(Info, 0, sizeof(struct ntp_packet));
+
+  if (PacketLength < NTP_MSG_LEN)        return NTP_PACKET_SHORT;
+  if (PacketLength > NTP_MAX_PACKET_LEN) return NTP_PACKET_LONG;
+
+
+  /* Header. */
+  Info->LeapIndicator  = Packet[0] >> 6;
+  Info->Version        = (Packet[0] >> 3) & 0x07;
+  Info->Mode           = Packet[0] & 0x07;
+  Info->Stratum        = Packet[1];
+  Info->Poll           = (INT8)Packet[2];
+  Info->Precision      = (INT8)Packet[3];
+  Info->RootDelay      = ntp_packet_get_short_us(&Packet[4]);
+  Info->RootDispersion = ntp_packet_get_short_us(&Packet[8]);
+  Info->ReferenceId    = ntp_packet_get32(&Packet[12]);
+  Info->Reference      = ntp_ts_from_packet(&Packet[16]);
+  Info->Origin         = ntp_ts_from_packet(&Packet[24]);
+  Info->Receive        = ntp_ts_from_packet(&Packet[32]);
+  Info->Transmit       = ntp_ts_from_packet(&Packet[40]);
+
+
+  /* Skip over extension fields, if any. A remaining length of 24 bytes or less can only be a MAC. */
+  Offset = NTP_MSG_LEN;
+  while ((PacketLength - Offset) > (NTP_KEY_ID_LEN + NTP_MAX_DIGEST_LEN))
+  {
+    ExtensionLength = ((UINT16)Packet[Offset + 2] << 8) | Packet[Offset + 3];
+    if ((ExtensionLength < NTP_MIN_EXTENSION_LEN) || (ExtensionLength % 4) || (ExtensionLength > (PacketLength - Offset))) return NTP_PACKET_EXTENSION;
+    Offset += ExtensionLength;
+    ++Info->ExtensionCount;
+  }
+
+
+  /* MAC, if any. */
+  Info->MacOffset = Offset;
+  if (Offset == PacketLength) return NTP_PACKET_OK;
+
+  if (((PacketLength - Offset) != (NTP_KEY_ID_LEN + 16)) && ((PacketLength - Offset) != (NTP_KEY_ID_LEN + 20))) return NTP_PACKET_MAC;
+
+  Info->KeyId        = ntp_packet_get32(&Packet[Offset]);
+  Info->DigestLength = PacketLength - Offset - NTP_KEY_ID_LEN;
+
+  return NTP_PACKET_OK;
+}
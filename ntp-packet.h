@@ -0,0 +1,71 @@
+/* ============================================================================================================================================================= *\
+   ntp-packet.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.10
+
+   Parser for NTP packets received by Pico-NTP-Module: 48-byte header, optional extension fields (RFC 7822) and optional MAC (key ID + digest).
+   The parser works on a plain buffer, never reads outside of the length given and keeps no state, so that it may be compiled on a host
+   computer and driven with arbitrary packet contents (fuzzing, benchmarks).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+               1.10 - Leap indicator values moved here from Pico-NTP-Module.h (also used by ntp-sync.c).
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_PACKET_H
+#define _NTP_PACKET_H
+
+#include "baseline.h"
+#include "ntp-timestamp.h"
+
+
+#define NTP_MSG_LEN               48   // length of NTP header (without extension fields and without MAC).
+#define NTP_KEY_ID_LEN             4   // length of the key identifier field of the MAC.
+#define NTP_MAX_DIGEST_LEN        20   // length of the longest digest supported (SHA-1).
+#define NTP_MAX_EXTENSION_LEN     64   // room reserved for extension fields between NTP header and MAC.
+#define NTP_MAX_PACKET_LEN       (NTP_MSG_LEN + NTP_MAX_EXTENSION_LEN + NTP_KEY_ID_LEN + NTP_MAX_DIGEST_LEN)
+#define NTP_MIN_EXTENSION_LEN     16   // length of the shortest extension field (RFC 7822).
+
+#define NTP_LEAP_NONE              0   // leap indicator: no warning.
+#define NTP_LEAP_INSERT            1   // leap indicator: last minute of the day has 61 seconds.
+#define NTP_LEAP_DELETE            2   // leap indicator: last minute of the day has 59 seconds.
+#define NTP_LEAP_ALARM             3   // leap indicator: server clock is not synchronized.
+
+#define NTP_MAX_STRATUM           15   // highest stratum of a synchronized server (16 = unsynchronized).
+
+#define NTP_PACKET_OK              0   // ntp_packet_parse() return codes.
+#define NTP_PACKET_SHORT           1   // shorter than an NTP header.
+#define NTP_PACKET_LONG            2   // longer than NTP_MAX_PACKET_LEN.
+#define NTP_PACKET_EXTENSION       3   // malformed extension field.
+#define NTP_PACKET_MAC             4   // trailing bytes are neither an extension field nor a MAC.
+
+
+struct ntp_packet
+{
+  UINT8  LeapIndicator;          // leap indicator (NTP_LEAP_xxx).
+  UINT8  Version;                // NTP version number.
+  UINT8  Mode;                   // association mode (4 = server).
+  UINT8  Stratum;                // stratum of the sender (0 = kiss-o'-death or unspecified).
+  INT8   Poll;                   // poll interval (log2 seconds).
+  INT8   Precision;              // precision of the sender's clock (log2 seconds).
+  UINT32 RootDelay;              // round-trip delay from the sender to its reference clock (in usec).
+  UINT32 RootDispersion;         // maximum error of the sender relative to its reference clock (in usec).
+  UINT32 ReferenceId;            // reference identifier (or kiss code).
+  ntp_timestamp_t Reference;     // time the sender's clock was last set.
+  ntp_timestamp_t Origin;        // our transmit timestamp, echoed by the server (T1).
+  ntp_timestamp_t Receive;       // time the request arrived at the server (T2).
+  ntp_timestamp_t Transmit;      // time the reply left the server (T3).
+  UINT8  ExtensionCount;         // number of extension fields.
+  UINT16 MacOffset;              // offset of the MAC in the packet (equal to packet length if there is no MAC).
+  UINT8  DigestLength;           // length of the MAC digest (0 if there is no MAC).
+  UINT32 KeyId;                  // key identifier of the MAC (0 if there is no MAC).
+};
+
+
+/* Parse an NTP packet. */
+UINT8 ntp_packet_parse(const UINT8 *Packet, UINT16 PacketLength, struct ntp_packet *Info);
+
+#endif  // _NTP_PACKET_H
@@ -0,0 +1,849 @@
+/* ============================================================================================================================================================= *\
+   ntp-replay.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.10
+
+   Host computer program replaying NTP traces through the same code as the Pico: reply checks and exchange timestamps (ntp-sync.c),
+   disciplined clock (ntp-clock.c) and timestamp arithmetic (ntp-timestamp.c). Algorithm changes may then be benchmarked on real field
+   data (build this program against the current and the modified sources and compare the reports or the CSV files written with -c).
+
+   Two kinds of input are accepted:
+   - the Pico's USB CDC output (or a capture of it) containing the lines sent by ntp_trace_drain() (see ntp-trace.h), other lines being
+     ignored. The replay starts from the first snapshot of the disciplined clock and, as long as the code is unchanged, is bit-exact:
+     the timestamps, offset and round-trip delay of each exchange and the following snapshots are compared with the values recorded on
+     the Pico and any difference is reported (exit code 2).
+   - a packet capture (classic pcap format, option -p) taken on the network between a client and its NTP server(s). Each request
+     (mode 3) is paired with the reply (mode 4) echoing its transmit timestamp, and the capture timestamps are used as the client's
+     local timer (Send and Receive), starting from a clock that has never been set. Each exchange disciplines the clock. Interleaved
+     replies (echoing the receive timestamp of the request) complete the previous exchange with the precise transmit timestamp.
+
+   Build and run on a host computer (only needs a copy of baseline.h for the type definitions):
+       gcc -O2 -o ntp-replay ntp-replay.c ntp-adev.c ntp-clock.c ntp-packet.c ntp-sync.c ntp-tempco.c ntp-timestamp.c ntp-trace.c -lm
+       ./ntp-replay -c replay.csv trace.txt
+       ./ntp-replay -p -a 192.168.0.50 capture.pcap
+   Run "./ntp-replay -?" for the list of options.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+               1.10 - Exchanges of NTP interleaved mode, in traces and in packet captures.
+                    - Packets of a capture classified by their NTP mode, clients using port 123 as source port being supported.
+\* ============================================================================================================================================================= */
+
+#include <math.h>
+#include <unistd.h>
+
+#include "ntp-clock.h"
+#include "ntp-packet.h"
+#include "ntp-sync.h"
+#include "ntp-timestamp.h"
+#include "ntp-trace.h"
+
+
+#define REPLAY_LINE_LEN           512   // longest line read from a trace.
+#define REPLAY_PENDING             64   // requests of a packet capture waiting for their reply.
+#define REPLAY_SNAP_LEN          2048   // longest packet read from a packet capture.
+#define REPLAY_NTP_PORT           123
+
+#define REPLAY_PCAP_MAGIC_US  0xA1B2C3D4   // pcap file with timestamps in usec.
+#define REPLAY_PCAP_MAGIC_NS  0xA1B23C4D   // pcap file with timestamps in nsec.
+
+#define REPLAY_LINK_NULL            0   // BSD loopback.
+#define REPLAY_LINK_ETHERNET        1
+#define REPLAY_LINK_RAW           101   // raw IPv4 or IPv6.
+#define REPLAY_LINK_SLL           113   // Linux "any" interface.
+#define REPLAY_LINK_SLL2          276   // Linux "any" interface, version 2.
+
+
+struct replay_config
+{
+  UINT8  FlagPcap;               // input is a packet capture.
+  UINT8  FlagResync;             // restore the disciplined clock from each snapshot instead of only comparing.
+  UINT8  FlagVerbose;            // print one line per record replayed.
+  UINT32 Client;                 // packet capture: only requests from this IPv4 address (network byte order, 0 = all).
+  FILE  *Csv;                    // one line per offset fed to the disciplined clock (NULL if none).
+};
+
+
+/* Request of a packet capture waiting for its reply. */
+struct replay_request
+{
+  UINT8  FlagPending;
+  UINT8  FlagIPv6;
+  ntp_timestamp_t Origin;        // origin timestamp of the request (interleaved mode: receive timestamp of the previous reply by the server).
+  ntp_timestamp_t Receive;       // receive timestamp of the request (interleaved mode: echoed as origin timestamp by the server).
+  ntp_timestamp_t Transmit;      // transmit timestamp of the request, echoed as origin timestamp by the server (basic mode).
+  UINT64 Send;                   // capture time of the request (in usec).
+};
+
+
+struct replay_stats
+{
+  UINT8  FlagStarted;            // flag indicating that the disciplined clock has been restored from a snapshot.
+  UINT32 Records;                // records read.
+  UINT32 Malformed;              // trace lines that could not be decoded.
+  UINT32 Skipped;                // records before the first snapshot (or after records have been lost).
+  UINT32 Lost;                   // records overwritten on the Pico before being sent.
+  UINT32 Snapshots;              // snapshots compared with the replayed clock.
+  UINT32 Restores;               // snapshots the replayed clock has been restored from.
+  UINT32 Replies;                // valid NTP replies.
+  UINT32 Interleaved;            // valid NTP replies in interleaved mode.
+  UINT32 Invalid[NTP_SYNC_TIMEOUT + 1];  // invalid NTP replies, by status.
+  UINT32 Timeouts;               // requests without reply.
+  UINT32 Used;                   // offsets fed to the disciplined clock.
+  UINT32 Unused;                 // offsets ignored because PPS was locked.
+  UINT32 Steps;                  // clock steps.
+  UINT32 Samples[NTP_SOURCE_HOLDOVER + 1];  // other samples fed to the disciplined clock, by source.
+  UINT32 Adjusts;                // frequency feed-forward.
+  UINT32 Leaps;                  // leap seconds.
+  UINT32 ExchangeErrors;         // exchanges whose timestamps, offset or delay differ from the ones recorded.
+  UINT32 StateErrors;            // snapshots that differ from the replayed clock.
+  double OffsetSum;              // sum of the offsets used (in usec), without the first one.
+  double OffsetSquares;          // sum of the squared offsets used (in usec^2), without the first one.
+  UINT32 OffsetCount;
+  INT64  OffsetMax;              // largest offset used (in usec, absolute value), without the first one.
+};
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=Function prototypes. */
+/* ============================================================================================================================================================= *\
+                                                                          Function prototypes.
+\* ============================================================================================================================================================= */
+/* Replay an NTP reply. */
+static void replay_exchange(struct ntp_trace_record *Record);
+
+/* Read a packet capture and replay the NTP exchanges found. */
+static INT replay_pcap(FILE *File);
+
+/* Read a 32-bit value of a pcap header in the byte order of the capture. */
+static UINT32 replay_pcap_32(const UINT8 *Buffer, UINT8 FlagSwap);
+
+/* Replay one NTP packet of a packet capture. */
+static void replay_pcap_packet(struct replay_request *Request, UINT64 CaptureTime, const UINT8 *Packet, UINT16 Length, UINT32 Client, UINT32 Server, UINT8 FlagIPv6, UINT8 FlagReply);
+
+/* Replay one trace record. */
+static void replay_record(struct ntp_trace_record *Record);
+
+/* Print the summary of the replay. */
+static void replay_report(void);
+
+/* Read a trace (lines sent by ntp_trace_drain()) and replay its records. */
+static INT replay_trace(FILE *File);
+
+/* Display command line options. */
+static void replay_usage(UCHAR *Name);
+
+
+
+
+
+/* ============================================================================================================================================================= *\
+                                                                            Global variables.
+\* ============================================================================================================================================================= */
+static struct replay_config Config = {FLAG_OFF, FLAG_OFF, FLAG_OFF, 0, NULL};
+static struct replay_stats  Stats;
+static struct ntp_clock     Clock;
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=main() */
+/* ============================================================================================================================================================= *\
+                                                                          Main program entry point.
+\* ============================================================================================================================================================= */
+int main(int argc, char *argv[])
+{
+  INT Option;
+  INT ReturnCode;
+
+  unsigned int Byte[4];
+
+  UINT8 Address[4];
+  UINT8 Loop1UInt8;
+
+  FILE *File;
+
+
+  while ((Option = getopt(argc, argv, "pa:c:rv")) != -1)
+  {
+    switch (Option)
+    {
+      case ('p'): Config.FlagPcap    = FLAG_ON; break;
+      case ('r'): Config.FlagResync  = FLAG_ON; break;
+      case ('v'): Config.FlagVerbose = FLAG_ON; break;
+
+      case ('a'):
+        if (sscanf(optarg, "%u.%u.%u.%u", &Byte[0], &Byte[1], &Byte[2], &Byte[3]) != 4)
+        {
+          fprintf(stderr, "Invalid IPv4 address: %s\n", optarg);
+          return 1;
+        }
+        for (Loop1UInt8 = 0; Loop1UInt8 < 4; ++Loop1UInt8)
+          Address[Loop1UInt8] = (UINT8)Byte[Loop1UInt8];
+        memcpy(&Config.Client, Address, sizeof(Config.Client));
+      break;
+
+      case ('c'):
+        Config.Csv = fopen(optarg, "w");
+        if (Config.Csv == NULL)
+        {
+          fprintf(stderr, "Can't create %s\n", optarg);
+          return 1;
+        }
+        fprintf(Config.Csv, "cycle,receive_us,utc_us,offset_us,delay_us,frequency_ppb,result\n");
+      break;
+
+      default:
+        replay_usage((UCHAR *)argv[0]);
+      return 1;
+    }
+  }
+
+  if (optind < argc)
+  {
+    File = fopen(argv[optind], (Config.FlagPcap) ? "rb" : "r");
+    if (File == NULL)
+    {
+      fprintf(stderr, "Can't open %s\n", argv[optind]);
+      return 1;
+    }
+  }
+  else
+    File = stdin;
+
+  memset(&Stats, 0x00, sizeof(Stats));
+  ntp_clock_init(&Clock);
+
+  /* A packet capture starts from a clock that has never been set, a trace from its first snapshot. */
+  if (Config.FlagPcap)
+  {
+    Stats.FlagStarted = FLAG_ON;
+    ReturnCode = replay_pcap(File);
+  }
+  else
+    ReturnCode = replay_trace(File);
+
+  if (File != stdin)       fclose(File);
+  if (Config.Csv != NULL) fclose(Config.Csv);
+  if (ReturnCode != 0) return ReturnCode;
+
+  replay_report();
+
+  return ((Stats.ExchangeErrors != 0) || (Stats.StateErrors != 0)) ? 2 : 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=replay_exchange() */
+/* ============================================================================================================================================================= *\
+                                                                          Replay an NTP reply.
+                 NOTE: The exchange is computed again from the replayed clock and compared with the values recorded (traces only). The reply
+                       flagged as the first valid one of its read cycle is fed to the disciplined clock, as ntp_recv() does on the Pico.
+\* ============================================================================================================================================================= */
+static void replay_exchange(struct ntp_trace_record *Record)
+{
+  UINT8 Result;
+
+  struct ntp_exchange Exchange;
+
+
+  if (Record->Data.Exchange.Status != NTP_SYNC_OK)
+  {
+    ++Stats.Invalid[(Record->Data.Exchange.Status <= NTP_SYNC_TIMEOUT) ? Record->Data.Exchange.Status : NTP_SYNC_BOGUS];
+    if (Config.FlagVerbose) printf("[%6u] Invalid reply, status %u (mode %u, stratum %u)\n", Record->Cycle, Record->Data.Exchange.Status, Record->Data.Exchange.Mode, Record->Data.Exchange.Stratum);
+    return;
+  }
+  ++Stats.Replies;
+
+  memset(&Exchange, 0x00, sizeof(Exchange));
+  Exchange.Send    = Record->Data.Exchange.Send;
+  Exchange.Receive = Record->Data.Exchange.Receive;
+  Exchange.T2      = Record->Data.Exchange.T2;
+  Exchange.T3      = Record->Data.Exchange.T3;
+  if (Record->Flags & NTP_TRACE_FLAG_INTERLEAVED)
+  {
+    /* Previous exchange: T1 and T4 have been read from the clock when its reply has been received. */
+    ++Stats.Interleaved;
+    Exchange.T1 = Record->Data.Exchange.T1;
+    Exchange.T4 = Record->Data.Exchange.T4;
+    ntp_sync_interleaved(&Clock, &Exchange, Record->Data.Exchange.T3, Record->Data.Exchange.Complete);
+  }
+  else
+  {
+    /* First exchange of a burst whose second reply failed: used in basic mode, slewed from the time the burst has been closed. */
+    ntp_sync_exchange(&Clock, &Exchange);
+    if (Record->Data.Exchange.Complete > Exchange.Receive) Exchange.Complete = Record->Data.Exchange.Complete;
+  }
+
+  if ((!Config.FlagPcap) &&
+      ((Exchange.T1 != Record->Data.Exchange.T1) || (Exchange.T4 != Record->Data.Exchange.T4) || (Exchange.Offset != Record->Data.Exchange.Offset) || (Exchange.Delay != Record->Data.Exchange.Delay)))
+  {
+    ++Stats.ExchangeErrors;
+    if (Config.FlagVerbose)
+      printf("[%6u] Exchange differs: offset %lld usec (recorded %lld), delay %d usec (recorded %d)\n", Record->Cycle, (long long)Exchange.Offset, (long long)Record->Data.Exchange.Offset, Exchange.Delay, Record->Data.Exchange.Delay);
+  }
+
+  if ((Record->Flags & NTP_TRACE_FLAG_FIRST) == 0) return;
+
+  Result = ntp_sync_discipline(&Clock, &Exchange, (Record->Flags & NTP_TRACE_FLAG_PPS) ? FLAG_ON : FLAG_OFF);
+  if (Result == NTP_SYNC_UNUSED)
+  {
+    ++Stats.Unused;
+  }
+  else
+  {
+    ++Stats.Used;
+    if (Result == NTP_CLOCK_STEPPED) ++Stats.Steps;
+
+    /* The first offset only measures how far the clock was before being set. */
+    if (Stats.Used > 1)
+    {
+      Stats.OffsetSum     += (double)Exchange.Offset;
+      Stats.OffsetSquares += (double)Exchange.Offset * (double)Exchange.Offset;
+      ++Stats.OffsetCount;
+      if (llabs(Exchange.Offset) > Stats.OffsetMax) Stats.OffsetMax = llabs(Exchange.Offset);
+    }
+  }
+
+  if (Config.FlagVerbose)
+    printf("[%6u] %s: offset %8lld usec   delay %6d usec   frequency %7d ppb   %s\n", Record->Cycle, (Record->Flags & NTP_TRACE_FLAG_INTERLEAVED) ? "Interleaved" : "Reply", (long long)Exchange.Offset, Exchange.Delay, Clock.FrequencyPpb,
+           (Result == NTP_SYNC_UNUSED) ? "unused (PPS)" : ((Result == NTP_CLOCK_STEPPED) ? "stepped" : "slewed"));
+
+  if (Config.Csv != NULL)
+    fprintf(Config.Csv, "%u,%llu,%lld,%lld,%d,%d,%s\n", Record->Cycle, (unsigned long long)Exchange.Receive, (long long)ntp_clock_get_utc_us(&Clock, Exchange.Receive),
+            (long long)Exchange.Offset, Exchange.Delay, Clock.FrequencyPpb, (Result == NTP_SYNC_UNUSED) ? "unused" : ((Result == NTP_CLOCK_STEPPED) ? "stepped" : "slewed"));
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=replay_pcap() */
+/* ============================================================================================================================================================= *\
+                                                          Read a packet capture and replay the NTP exchanges found.
+                 NOTE: Link types supported: Ethernet (with or without VLAN tag), raw IP, Linux cooked capture (v1 and v2) and BSD loopback.
+                       IPv6 extension headers and IPv4 fragments are not supported (NTP packets are never fragmented).
+\* ============================================================================================================================================================= */
+static INT replay_pcap(FILE *File)
+{
+  UINT8 Header[24];
+  UINT8 FlagIPv6;
+  UINT8 FlagNsec;
+  UINT8 FlagSwap;
+  UINT8 Mode;
+  UINT8 Packet[REPLAY_SNAP_LEN];
+
+  UINT16 Loop1UInt16;
+  UINT16 Protocol;
+  UINT16 SourcePort;
+  UINT16 DestinationPort;
+
+  UINT32 Captured;
+  UINT32 Client;
+  UINT32 Ip;
+  UINT32 LinkType;
+  UINT32 Magic;
+  UINT32 Server;
+  UINT32 Udp;
+
+  UINT64 CaptureTime;
+
+  struct replay_request Request[REPLAY_PENDING];
+
+
+  if (fread(Header, 1, sizeof(Header), File) != sizeof(Header))
+  {
+    fprintf(stderr, "Not a pcap file\n");
+    return 1;
+  }
+
+  Magic    = ((UINT32)Header[0] << 24) | ((UINT32)Header[1] << 16) | ((UINT32)Header[2] << 8) | Header[3];
+  FlagSwap = FLAG_OFF;
+  if ((Magic == REPLAY_PCAP_MAGIC_US) || (Magic == REPLAY_PCAP_MAGIC_NS))
+    FlagSwap = FLAG_ON;   // big endian file.
+  else
+    Magic = ((UINT32)Header[3] << 24) | ((UINT32)Header[2] << 16) | ((UINT32)Header[1] << 8) | Header[0];
+
+  if ((Magic != REPLAY_PCAP_MAGIC_US) && (Magic != REPLAY_PCAP_MAGIC_NS))
+  {
+    fprintf(stderr, "Not a pcap file (pcapng captures must be converted first: editcap -F pcap)\n");
+    return 1;
+  }
+  FlagNsec = (Magic == REPLAY_PCAP_MAGIC_NS) ? FLAG_ON : FLAG_OFF;
+  LinkType = replay_pcap_32(&Header[20], FlagSwap) & 0xFFFF;
+
+  memset(Request, 0x00, sizeof(Request));
+
+  while (fread(Header, 1, 16, File) == 16)
+  {
+    CaptureTime = ((UINT64)replay_pcap_32(&Header[0], FlagSwap) * 1000000ull) + (replay_pcap_32(&Header[4], FlagSwap) / ((FlagNsec) ? 1000 : 1));
+    Captured    = replay_pcap_32(&Header[8], FlagSwap);
+    if (Captured > sizeof(Packet))
+    {
+      fseek(File, Captured, SEEK_CUR);
+      continue;
+    }
+    if (fread(Packet, 1, Captured, File) != Captured) break;
+
+    /* Find the IP header (the link header is checked first: a truncated capture may be shorter than it). */
+    switch (LinkType)
+    {
+      case (REPLAY_LINK_ETHERNET):
+        if (Captured < 14) continue;
+        Ip       = 14;
+        Protocol = (Packet[12] << 8) | Packet[13];
+        if ((Protocol == 0x8100) && (Captured >= 18))
+        {
+          Ip       = 18;
+          Protocol = (Packet[16] << 8) | Packet[17];
+        }
+      break;
+
+      case (REPLAY_LINK_RAW):
+        if (Captured < 1) continue;
+        Ip       = 0;
+        Protocol = ((Packet[0] >> 4) == 6) ? 0x86DD : 0x0800;
+      break;
+
+      case (REPLAY_LINK_SLL):
+        if (Captured < 16) continue;
+        Ip       = 16;
+        Protocol = (Packet[14] << 8) | Packet[15];
+      break;
+
+      case (REPLAY_LINK_SLL2):
+        if (Captured < 2) continue;
+        Ip       = 20;
+        Protocol = (Packet[0] << 8) | Packet[1];
+      break;
+
+      case (REPLAY_LINK_NULL):
+        if (Captured < 4) continue;
+        Ip       = 4;
+        Protocol = ((Packet[0] == 2) || (Packet[3] == 2)) ? 0x0800 : 0x86DD;
+      break;
+
+      default:
+        fprintf(stderr, "Link type %u not supported\n", LinkType);
+      return 1;
+    }
+    if (Captured < Ip + 20) continue;
+
+    /* Find the UDP header. Client and server addresses are kept as 32 bits in network byte order (last 32 bits for IPv6). */
+    if ((Protocol == 0x0800) && ((Packet[Ip] >> 4) == 4) && (Packet[Ip + 9] == 17))
+    {
+      FlagIPv6 = FLAG_OFF;
+      Udp      = Ip + ((Packet[Ip] & 0x0F) * 4);
+      memcpy(&Client, &Packet[Ip + 12], 4);
+      memcpy(&Server, &Packet[Ip + 16], 4);
+    }
+    else if ((Protocol == 0x86DD) && ((Packet[Ip] >> 4) == 6) && (Packet[Ip + 6] == 17) && (Captured >= Ip + 40))
+    {
+      FlagIPv6 = FLAG_ON;
+      Udp      = Ip + 40;
+      memcpy(&Client, &Packet[Ip + 20], 4);
+      memcpy(&Server, &Packet[Ip + 36], 4);
+    }
+    else
+      continue;
+    if (Captured < Udp + 8) continue;
+
+    SourcePort      = (Packet[Udp] << 8)     | Packet[Udp + 1];
+    DestinationPort = (Packet[Udp + 2] << 8) | Packet[Udp + 3];
+
+    if ((DestinationPort != REPLAY_NTP_PORT) && (SourcePort != REPLAY_NTP_PORT)) continue;
+    if (Captured < Udp + 9) continue;
+
+    /* Direction given by the NTP mode rather than by the ports (a client may also use port 123 as its source port). */
+    Mode = Packet[Udp + 8] & 0x07;
+    if (Mode == 0x03)
+      replay_pcap_packet(Request, CaptureTime, &Packet[Udp + 8], Captured - Udp - 8, Client, Server, FlagIPv6, FLAG_OFF);
+    else if ((Mode == 0x04) || (Mode == 0x05))
+      replay_pcap_packet(Request, CaptureTime, &Packet[Udp + 8], Captured - Udp - 8, Server, Client, FlagIPv6, FLAG_ON);
+  }
+
+  /* Requests still waiting for their reply at the end of the capture. */
+  for (Loop1UInt16 = 0; Loop1UInt16 < REPLAY_PENDING; ++Loop1UInt16)
+    if (Request[Loop1UInt16].FlagPending) ++Stats.Timeouts;
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=replay_pcap_32() */
+/* ============================================================================================================================================================= *\
+                                                     Read a 32-bit value of a pcap header in the byte order of the capture.
+\* ============================================================================================================================================================= */
+static UINT32 replay_pcap_32(const UINT8 *Buffer, UINT8 FlagSwap)
+{
+  if (FlagSwap)
+    return ((UINT32)Buffer[0] << 24) | ((UINT32)Buffer[1] << 16) | ((UINT32)Buffer[2] << 8) | Buffer[3];
+
+  return ((UINT32)Buffer[3] << 24) | ((UINT32)Buffer[2] << 16) | ((UINT32)Buffer[1] << 8) | Buffer[0];
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=replay_pcap_packet() */
+/* ============================================================================================================================================================= *\
+                                                             Replay one NTP packet of a packet capture.
+                 NOTE: A request is kept until the reply echoing its transmit timestamp (or its receive timestamp in interleaved mode) is seen.
+                       Each reply is a read cycle of its own and disciplines the clock. An interleaved reply completes the previous exchange with
+                       the server, as ntp_recv() does on the Pico. Authentication is not verified (keys are not known).
+\* ============================================================================================================================================================= */
+static void replay_pcap_packet(struct replay_request *Request, UINT64 CaptureTime, const UINT8 *Packet, UINT16 Length, UINT32 Client, UINT32 Server, UINT8 FlagIPv6, UINT8 FlagReply)
+{
+  static UINT8  FlagPrevious;
+  static UINT32 Cycle;
+  static UINT32 NextRequest;
+
+  static struct ntp_exchange Previous;
+
+  UINT8 FlagInterleaved;
+
+  UINT16 Loop1UInt16;
+
+  struct ntp_exchange Current;
+  struct ntp_exchange Exchange;
+  struct ntp_packet Info;
+  struct ntp_trace_record Record;
+
+
+  if ((Config.Client != 0) && (Client != Config.Client)) return;
+  if (ntp_packet_parse(Packet, Length, &Info) != NTP_PACKET_OK) return;
+
+  if (!FlagReply)
+  {
+    if (Info.Mode != 0x03) return;
+
+    /* Ring of pending requests: a request overwritten before its reply is seen is counted as lost. */
+    if (Request[NextRequest].FlagPending) ++Stats.Timeouts;
+    Request[NextRequest].FlagPending = FLAG_ON;
+    Request[NextRequest].FlagIPv6    = FlagIPv6;
+    Request[NextRequest].Origin      = Info.Origin;
+    Request[NextRequest].Receive     = Info.Receive;
+    Request[NextRequest].Transmit    = Info.Transmit;
+    Request[NextRequest].Send        = CaptureTime;
+    NextRequest = (NextRequest + 1) % REPLAY_PENDING;
+    return;
+  }
+
+  /* Interleaved reply: it echoes the receive timestamp of the request, whose origin timestamp is the receive timestamp of the previous reply. */
+  FlagInterleaved = FLAG_OFF;
+  for (Loop1UInt16 = 0; Loop1UInt16 < REPLAY_PENDING; ++Loop1UInt16)
+  {
+    if (Request[Loop1UInt16].FlagPending == FLAG_OFF) continue;
+    if (Request[Loop1UInt16].Transmit == Info.Origin) break;
+    if ((Request[Loop1UInt16].Receive == Info.Origin) && (Info.Origin != 0ull) && (FlagPrevious) && (Request[Loop1UInt16].Origin == Previous.T2))
+    {
+      FlagInterleaved = FLAG_ON;
+      break;
+    }
+  }
+  if (Loop1UInt16 == REPLAY_PENDING) return;
+  Request[Loop1UInt16].FlagPending = FLAG_OFF;
+
+  /* Timestamps of this exchange are read from the replayed clock now, before it is disciplined, as ntp_recv() does. */
+  memset(&Current, 0x00, sizeof(Current));
+  Current.Send    = Request[Loop1UInt16].Send;
+  Current.Receive = CaptureTime;
+  Current.T2      = Info.Receive;
+  Current.T3      = (FlagInterleaved) ? Info.Receive : Info.Transmit;
+  ntp_sync_exchange(&Clock, &Current);
+
+  /* As in ntp_recv(): an inconsistent interleaved reply (or one completing a previous exchange too old) is used in basic mode. */
+  if (FlagInterleaved)
+  {
+    Exchange = Previous;
+    if (ntp_sync_interleaved(&Clock, &Exchange, Info.Transmit, CaptureTime) != NTP_SYNC_OK) FlagInterleaved = FLAG_OFF;
+  }
+
+  memset(&Record, 0x00, sizeof(Record));
+  Record.Sequence                     = ++Stats.Records;
+  Record.Type                         = NTP_TRACE_REPLY;
+  Record.Flags                        = NTP_TRACE_FLAG_FIRST | ((FlagIPv6) ? NTP_TRACE_FLAG_IPV6 : 0);
+  Record.Temperature                  = NTP_TRACE_NO_TEMPERATURE;
+  Record.Cycle                        = ++Cycle;
+  Record.Data.Exchange.Send           = Current.Send;
+  Record.Data.Exchange.Receive        = Current.Receive;
+  Record.Data.Exchange.T2             = Current.T2;
+  Record.Data.Exchange.T3             = Current.T3;
+  if (FlagInterleaved)
+  {
+    Record.Flags                     |= NTP_TRACE_FLAG_INTERLEAVED;
+    Record.Data.Exchange.Send         = Previous.Send;
+    Record.Data.Exchange.Receive      = Previous.Receive;
+    Record.Data.Exchange.Complete     = CaptureTime;
+    Record.Data.Exchange.T1           = Previous.T1;
+    Record.Data.Exchange.T2           = Previous.T2;
+    Record.Data.Exchange.T3           = Info.Transmit;
+    Record.Data.Exchange.T4           = Previous.T4;
+  }
+  Record.Data.Exchange.Server         = Server;
+  Record.Data.Exchange.RootDelay      = Info.RootDelay;
+  Record.Data.Exchange.RootDispersion = Info.RootDispersion;
+  Record.Data.Exchange.Status         = ntp_sync_check(&Info, 0);
+  Record.Data.Exchange.Stratum        = Info.Stratum;
+  Record.Data.Exchange.LeapIndicator  = Info.LeapIndicator;
+  Record.Data.Exchange.Mode           = Info.Mode;
+
+  replay_record(&Record);
+
+  Previous     = Current;
+  FlagPrevious = FLAG_ON;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=replay_record() */
+/* ============================================================================================================================================================= *\
+                                                                           Replay one trace record.
+                 NOTE: Records are applied to the replayed clock in the order they have been written on the Pico, i.e. before the Pico's
+                       clock has been updated. After lost records, the replay waits for the next snapshot.
+\* ============================================================================================================================================================= */
+static void replay_record(struct ntp_trace_record *Record)
+{
+  UINT8 Result;
+
+  struct ntp_trace_record State;
+
+
+  switch (Record->Type)
+  {
+    case (NTP_TRACE_LOST):
+      Stats.Lost       += (UINT32)Record->Data.Sample.Value;
+      Stats.FlagStarted = FLAG_OFF;
+      if (Config.FlagVerbose) printf("[%6u] %lld records lost, waiting for the next snapshot\n", Record->Cycle, (long long)Record->Data.Sample.Value);
+    return;
+
+    case (NTP_TRACE_STATE):
+      if ((Stats.FlagStarted) && (!Config.FlagResync))
+      {
+        ++Stats.Snapshots;
+        ntp_trace_snapshot(&Clock, &State);
+        if (memcmp(&State.Data.State, &Record->Data.State, sizeof(State.Data.State)) != 0)
+        {
+          ++Stats.StateErrors;
+          if (Config.FlagVerbose) printf("[%6u] Snapshot differs: frequency %d ppb (recorded %d), steps %u (recorded %u)\n", Record->Cycle, Clock.FrequencyPpb, Record->Data.State.FrequencyPpb, Clock.StepCount, Record->Data.State.StepCount);
+        }
+      }
+      else
+      {
+        ++Stats.Restores;
+        ntp_trace_restore(&Clock, Record);
+        Stats.FlagStarted = FLAG_ON;
+      }
+    return;
+  }
+
+  if (!Stats.FlagStarted)
+  {
+    ++Stats.Skipped;
+    return;
+  }
+
+  switch (Record->Type)
+  {
+    case (NTP_TRACE_REPLY):
+      replay_exchange(Record);
+    break;
+
+    case (NTP_TRACE_TIMEOUT):
+      ++Stats.Timeouts;
+      if (Config.FlagVerbose) printf("[%6u] No reply\n", Record->Cycle);
+    break;
+
+    case (NTP_TRACE_SAMPLE):
+      if (Record->Data.Sample.Source <= NTP_SOURCE_HOLDOVER) ++Stats.Samples[Record->Data.Sample.Source];
+      Result = ntp_clock_sample(&Clock, Record->Data.Sample.LocalTime, Record->Data.Sample.Value, Record->Data.Sample.Source);
+      if (Result == NTP_CLOCK_STEPPED) ++Stats.Steps;
+      if ((Config.FlagVerbose) && (Record->Data.Sample.Source != NTP_SOURCE_PPS))
+        printf("[%6u] Sample from source %u: offset %lld usec   %s\n", Record->Cycle, Record->Data.Sample.Source, (long long)Clock.LastOffset, (Result == NTP_CLOCK_STEPPED) ? "stepped" : "slewed");
+    break;
+
+    case (NTP_TRACE_ADJUST):
+      ++Stats.Adjusts;
+      ntp_clock_adjust_frequency(&Clock, Record->Data.Sample.LocalTime, (INT32)Record->Data.Sample.Value);
+    break;
+
+    case (NTP_TRACE_LEAP):
+      ++Stats.Leaps;
+      Clock.BaseUTC -= (Record->Data.Sample.Value * 1000000ll);
+      if (Config.FlagVerbose) printf("[%6u] Leap second: %lld\n", Record->Cycle, (long long)Record->Data.Sample.Value);
+    break;
+
+    default:
+      ++Stats.Malformed;
+    break;
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=replay_report() */
+/* ============================================================================================================================================================= *\
+                                                                      Print the summary of the replay.
+\* ============================================================================================================================================================= */
+static void replay_report(void)
+{
+  UINT8 Loop1UInt8;
+
+  UINT32 Invalid;
+
+  double Mean;
+  double Rms;
+
+
+  Invalid = 0;
+  for (Loop1UInt8 = 0; Loop1UInt8 <= NTP_SYNC_TIMEOUT; ++Loop1UInt8)
+    Invalid += Stats.Invalid[Loop1UInt8];
+
+  Mean = 0.0;
+  Rms  = 0.0;
+  if (Stats.OffsetCount != 0)
+  {
+    Mean = Stats.OffsetSum / Stats.OffsetCount;
+    Rms  = sqrt(Stats.OffsetSquares / Stats.OffsetCount);
+  }
+
+  printf("\n");
+  printf("Records:          %u read, %u malformed, %u skipped, %u lost on the Pico\n", Stats.Records, Stats.Malformed, Stats.Skipped, Stats.Lost);
+  printf("Exchanges:        %u valid replies (%u interleaved), %u invalid (bogus %u, address %u, mode %u, stratum %u, alarm %u, auth %u), %u without reply\n",
+         Stats.Replies, Stats.Interleaved, Invalid, Stats.Invalid[NTP_SYNC_BOGUS], Stats.Invalid[NTP_SYNC_ADDRESS], Stats.Invalid[NTP_SYNC_MODE], Stats.Invalid[NTP_SYNC_STRATUM],
+         Stats.Invalid[NTP_SYNC_ALARM], Stats.Invalid[NTP_SYNC_AUTH], Stats.Timeouts);
+  printf("Clock inputs:     %u NTP offsets used, %u ignored (PPS locked), %u PPS edges, %u broadcasts / holdover, %u frequency feed-forward, %u leap seconds\n",
+         Stats.Used, Stats.Unused, Stats.Samples[NTP_SOURCE_PPS], Stats.Samples[NTP_SOURCE_NETWORK] + Stats.Samples[NTP_SOURCE_HOLDOVER], Stats.Adjusts, Stats.Leaps);
+  printf("Clock steps:      %u\n", Stats.Steps);
+  printf("NTP offsets:      mean %.1f usec, RMS %.1f usec, max %lld usec (%u offsets, without the first one)\n", Mean, Rms, (long long)Stats.OffsetMax, Stats.OffsetCount);
+  printf("Final frequency:  %d ppb\n", Clock.FrequencyPpb);
+
+  if (!Config.FlagPcap)
+  {
+    printf("Snapshots:        %u restored, %u compared\n", Stats.Restores, Stats.Snapshots);
+    printf("Bit-exact check:  %s (%u exchanges and %u snapshots differ from the Pico)\n", ((Stats.ExchangeErrors == 0) && (Stats.StateErrors == 0)) ? "passed" : "FAILED", Stats.ExchangeErrors, Stats.StateErrors);
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=replay_trace() */
+/* ============================================================================================================================================================= *\
+                                                       Read a trace (lines sent by ntp_trace_drain()) and replay its records.
+                      NOTE: Lines may end with <CR> (as sent by the Pico), <LF> or both. Lines without NTP_TRACE_TAG are ignored.
+\* ============================================================================================================================================================= */
+static INT replay_trace(FILE *File)
+{
+  UCHAR Line[REPLAY_LINE_LEN];
+  UCHAR *Hex;
+
+  INT Character;
+
+  unsigned int Byte;
+
+  UINT8 *Buffer;
+
+  UINT16 Length;
+  UINT16 Loop1UInt16;
+
+  struct ntp_trace_record Record;
+
+
+  Length = 0;
+  do
+  {
+    Character = fgetc(File);
+    if ((Character != '\r') && (Character != '\n') && (Character != EOF))
+    {
+      if (Length < (sizeof(Line) - 1)) Line[Length++] = (UCHAR)Character;
+      continue;
+    }
+
+    Line[Length] = 0x00;
+    Length       = 0;
+    if (strncmp((char *)Line, NTP_TRACE_TAG " ", strlen(NTP_TRACE_TAG) + 1) != 0) continue;
+
+    Hex = &Line[strlen(NTP_TRACE_TAG) + 1];
+    if (strlen((char *)Hex) != (2 * sizeof(Record)))
+    {
+      ++Stats.Malformed;
+      continue;
+    }
+
+    Buffer = (UINT8 *)&Record;
+    for (Loop1UInt16 = 0; Loop1UInt16 < sizeof(Record); ++Loop1UInt16)
+    {
+      if (sscanf((char *)&Hex[2 * Loop1UInt16], "%2x", &Byte) != 1) break;
+      Buffer[Loop1UInt16] = (UINT8)Byte;
+    }
+    if (Loop1UInt16 < sizeof(Record))
+    {
+      ++Stats.Malformed;
+      continue;
+    }
+
+    ++Stats.Records;
+    replay_record(&Record);
+  } while (Character != EOF);
+
+  return 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=replay_usage() */
+/* ============================================================================================================================================================= *\
+                                                                        Display command line options.
+\* ============================================================================================================================================================= */
+static void replay_usage(UCHAR *Name)
+{
+  printf("Usage: %s [options] [file]\n", Name);
+  printf("  file            trace captured from the Pico's USB CDC output, or packet capture with -p (default: stdin)\n");
+  printf("  -p              input is a packet capture (pcap format)\n");
+  printf("  -a <address>    packet capture: replay only the requests of this IPv4 client\n");
+  printf("  -c <file>       write one CSV line per offset fed to the disciplined clock\n");
+  printf("  -r              restore the disciplined clock from each snapshot of the trace instead of comparing\n");
+  printf("  -v              print one line per record replayed\n");
+  printf("Exit code is 2 when the replay of a trace is not bit-exact.\n");
+
+  return;
+}
@@ -0,0 +1,203 @@
+/* ============================================================================================================================================================= *\
+   ntp-sync.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.10
+
+   Processing of the NTP replies received by Pico-NTP-Module (see ntp-sync.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+               1.10 - NTP interleaved mode: exchanges completed by the precise transmit timestamp of the next reply, within a burst of 2
+                      requests whose first exchange is used in basic mode if the second one fails.
+\* ============================================================================================================================================================= */
+
+#include "ntp-sync.h"
+
+
+
+/* Compute the offset and round-trip delay of an exchange from its four timestamps. */
+static void ntp_sync_offset(struct ntp_exchange *Exchange);
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_sync_burst_close() */
+/* ============================================================================================================================================================= *\
+                                           Close a burst of 2 requests and return its first exchange if it was still open.
+                 NOTE: Called when the second reply is inconsistent (see ntp_sync_interleaved()) or has not been received: the first exchange is
+                       then used in basic mode, slewed from Complete on (see ntp_sync_discipline()). Return NTP_SYNC_TIMEOUT, with Exchange left
+                       unchanged, if the burst has already been closed.
+\* ============================================================================================================================================================= */
+UINT8 ntp_sync_burst_close(struct ntp_burst *Burst, UINT64 Complete, struct ntp_exchange *Exchange)
+{
+  if (Burst->FlagOpen == FLAG_OFF) return NTP_SYNC_TIMEOUT;
+  Burst->FlagOpen = FLAG_OFF;
+
+  *Exchange = Burst->First;
+  if (Complete > Exchange->Receive) Exchange->Complete = Complete;
+
+  return NTP_SYNC_OK;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_sync_burst_open() */
+/* ============================================================================================================================================================= *\
+                                  Open a burst of 2 requests, keeping its first exchange to be used in basic mode if the second one fails.
+\* ============================================================================================================================================================= */
+void ntp_sync_burst_open(struct ntp_burst *Burst, const struct ntp_exchange *First, const struct ntp_packet *Info)
+{
+  Burst->First    = *First;
+  Burst->Info     = *Info;
+  Burst->FlagOpen = FLAG_ON;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_sync_check() */
+/* ============================================================================================================================================================= *\
+                                                 Check a parsed NTP reply and return its status (NTP_SYNC_xxx).
+                    NOTE: Checks that need the network stack (server address and port, origin timestamp of our last request) are done by the caller.
+\* ============================================================================================================================================================= */
+UINT8 ntp_sync_check(const struct ntp_packet *Info, INT16 AuthStatus)
+{
+  if (Info->Mode != 0x04)                      return NTP_SYNC_MODE;
+  if (Info->Stratum == 0)                      return NTP_SYNC_STRATUM;
+  if (Info->Stratum > NTP_MAX_STRATUM)         return NTP_SYNC_STRATUM;
+  if (Info->LeapIndicator == NTP_LEAP_ALARM)   return NTP_SYNC_ALARM;
+  if (AuthStatus != 0)                         return NTP_SYNC_AUTH;
+
+  return NTP_SYNC_OK;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_sync_discipline() */
+/* ============================================================================================================================================================= *\
+                                       Feed the offset of an exchange to the disciplined clock, unless PPS disciplines it.
+                   NOTE: When PPS is locked, NTP is only used to make sure that we are on the right second: the offset is used only if it is
+                         larger than NTP_PPS_MAX_OFFSET. An exchange completed late (interleaved mode) is slewed from the time it has been completed.
+                         Return NTP_CLOCK_STEPPED, NTP_CLOCK_SLEWED or NTP_SYNC_UNUSED.
+\* ============================================================================================================================================================= */
+UINT8 ntp_sync_discipline(struct ntp_clock *Clock, const struct ntp_exchange *Exchange, UINT8 FlagPpsLocked)
+{
+  if ((FlagPpsLocked) && (Exchange->Offset <= NTP_PPS_MAX_OFFSET) && (Exchange->Offset >= -NTP_PPS_MAX_OFFSET)) return NTP_SYNC_UNUSED;
+
+  if (Exchange->Complete != Exchange->Receive)
+    return ntp_clock_sample_late(Clock, Exchange->Receive, Exchange->LocalReceive + Exchange->Offset, NTP_SOURCE_NETWORK, Exchange->Complete);
+
+  return ntp_clock_sample(Clock, Exchange->Receive, Exchange->LocalReceive + Exchange->Offset, NTP_SOURCE_NETWORK);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_sync_exchange() */
+/* ============================================================================================================================================================= *\
+                                               Compute the timestamps, offset and round-trip delay of an exchange.
+                 NOTE: Send, Receive, T2 and T3 must be set. Server timestamps are converted using the NTP era closest to the disciplined clock
+                       (or to NTP_TS_PIVOT if the clock has never been set). Our own timestamps are read from the disciplined clock; before the
+                       first sync, the server time is used as a rough estimate. On the Pico, to be called with interrupts disabled (PPS edges).
+\* ============================================================================================================================================================= */
+void ntp_sync_exchange(struct ntp_clock *Clock, struct ntp_exchange *Exchange)
+{
+  Exchange->Complete = Exchange->Receive;
+
+  if (Clock->FlagValid)
+  {
+    Exchange->PivotTime    = ntp_clock_get_utc_us(Clock, Exchange->Receive);
+    Exchange->LocalReceive = Exchange->PivotTime;
+  }
+  else
+  {
+    Exchange->PivotTime    = NTP_TS_PIVOT * 1000000ll;
+    Exchange->LocalReceive = ntp_ts_to_unix_us(Exchange->T3, Exchange->PivotTime);
+  }
+  Exchange->T4 = ntp_ts_from_unix_us(Exchange->LocalReceive);
+  Exchange->T1 = ntp_ts_from_unix_us(Exchange->LocalReceive - (INT64)(Exchange->Receive - Exchange->Send));
+
+  ntp_sync_offset(Exchange);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_sync_interleaved() */
+/* ============================================================================================================================================================= *\
+                             Complete an exchange of interleaved mode with the precise transmit timestamp received in the next reply.
+                 NOTE: The exchange is the one computed by ntp_sync_exchange() when its reply has been received: T1, T2 and T4 are kept and T3
+                       is replaced by the transmit timestamp captured by the server once the reply has actually been sent. Complete is the Pico
+                       timer when the next reply has been received. Return NTP_SYNC_BOGUS if the transmit timestamp is not consistent with T2,
+                       or if the exchange is older than NTP_SYNC_MAX_PREVIOUS: its offset would no longer be the one of the clock (the caller
+                       then uses the reply in basic mode).
+\* ============================================================================================================================================================= */
+UINT8 ntp_sync_interleaved(struct ntp_clock *Clock, struct ntp_exchange *Exchange, ntp_timestamp_t Transmit, UINT64 Complete)
+{
+  INT64 Turnaround;
+
+
+  if ((Complete < Exchange->Receive) || ((Complete - Exchange->Receive) > NTP_SYNC_MAX_PREVIOUS)) return NTP_SYNC_BOGUS;
+
+  Turnaround = ntp_tsdiff_to_us(ntp_ts_diff(Transmit, Exchange->T2));
+  if ((Turnaround < 0) || (Turnaround > NTP_SYNC_MAX_TURNAROUND)) return NTP_SYNC_BOGUS;
+
+  Exchange->T3       = Transmit;
+  Exchange->Complete = Complete;
+
+  /* T4 has been read from the disciplined clock (or estimated from the server time before the first sync) when the reply has been received. */
+  Exchange->PivotTime    = (Clock->FlagValid) ? ntp_clock_get_utc_us(Clock, Complete) : (NTP_TS_PIVOT * 1000000ll);
+  Exchange->LocalReceive = ntp_ts_to_unix_us(Exchange->T4, Exchange->PivotTime);
+
+  ntp_sync_offset(Exchange);
+
+  return NTP_SYNC_OK;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_sync_offset() */
+/* ============================================================================================================================================================= *\
+                                          Compute the offset and round-trip delay of an exchange from its four timestamps.
+\* ============================================================================================================================================================= */
+static void ntp_sync_offset(struct ntp_exchange *Exchange)
+{
+  ntp_tsdiff_t Delay;
+  ntp_tsdiff_t Offset;
+
+
+  /* Delay = (T4 - T1) - (T3 - T2)     Offset = ((T2 - T1) + (T3 - T4)) / 2 */
+  Delay  = ntp_tsdiff_sub(ntp_ts_diff(Exchange->T4, Exchange->T1), ntp_ts_diff(Exchange->T3, Exchange->T2));
+  Offset = ntp_tsdiff_add(ntp_ts_diff(Exchange->T2, Exchange->T1), ntp_ts_diff(Exchange->T3, Exchange->T4)) / 2;
+
+  Exchange->Delay  = (INT32)ntp_tsdiff_to_us(Delay);
+  Exchange->Offset = ntp_tsdiff_to_us(Offset);
+
+  return;
+}
+
@@ -0,0 +1,90 @@
+/* ============================================================================================================================================================= *\
+   ntp-sync.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.10
+
+   Processing of the NTP replies received by Pico-NTP-Module, from the parsed packet to the disciplined clock: reply checks, exchange
+   timestamps (T1 to T4), offset and round-trip delay, and the decision to feed the offset to the disciplined clock. The same functions
+   are used by ntp-replay.c on the host computer, so that traces recorded in the field (see ntp-trace.h) are replayed through the exact
+   code running on the Pico.
+   This file doesn't depend on the Pico SDK so that it may also be compiled on a host computer.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+               1.10 - NTP interleaved mode: exchanges completed by the precise transmit timestamp of the next reply, within a burst of 2
+                      requests whose first exchange is used in basic mode if the second one fails.
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_SYNC_H
+#define _NTP_SYNC_H
+
+#include "baseline.h"
+#include "ntp-clock.h"
+#include "ntp-packet.h"
+#include "ntp-timestamp.h"
+
+
+#define NTP_PPS_MAX_OFFSET     400000  // maximum difference (in usec) between PPS edge and second boundary predicted from NTP.
+#define NTP_SYNC_MAX_TURNAROUND 1000000  // maximum time (in usec) between receive and precise transmit timestamps of an interleaved reply.
+#define NTP_SYNC_MAX_PREVIOUS   8000000  // maximum age (in usec) of the previous exchange completed by an interleaved reply (the clock drifts in between).
+
+#define NTP_SYNC_OK                0   // reply status: valid reply.
+#define NTP_SYNC_BOGUS             1   // reply status: malformed, or doesn't answer our last request.
+#define NTP_SYNC_ADDRESS           2   // reply status: not from the server (address or port) the request has been sent to.
+#define NTP_SYNC_MODE              3   // reply status: not a server reply (mode 4).
+#define NTP_SYNC_STRATUM           4   // reply status: stratum 0 (kiss-o'-death) or above NTP_MAX_STRATUM (unsynchronized).
+#define NTP_SYNC_ALARM             5   // reply status: server clock not synchronized (leap indicator).
+#define NTP_SYNC_AUTH              6   // reply status: MAC missing or invalid.
+#define NTP_SYNC_TIMEOUT           7   // reply status: no reply received.
+
+#define NTP_SYNC_UNUSED            2   // ntp_sync_discipline() return code: offset not used, PPS disciplines the clock.
+
+
+/* One request / reply exchange with an NTP server. */
+struct ntp_exchange
+{
+  UINT64 Send;                   // Pico timer (in usec) when the request has been sent.
+  UINT64 Receive;                // Pico timer (in usec) when the reply has been received.
+  UINT64 Complete;               // Pico timer (in usec) when the exchange has been completed: Receive, or next reply in interleaved mode.
+  ntp_timestamp_t T1;            // origin timestamp: request sent (read from the disciplined clock).
+  ntp_timestamp_t T2;            // receive timestamp: request received by the server.
+  ntp_timestamp_t T3;            // transmit timestamp: reply sent by the server (precise one in interleaved mode).
+  ntp_timestamp_t T4;            // destination timestamp: reply received (read from the disciplined clock).
+  INT64  PivotTime;              // UTC time (in usec since 01-JAN-1970) used to select the NTP era of server timestamps.
+  INT64  LocalReceive;           // UTC time (in usec since 01-JAN-1970) of T4.
+  INT64  Offset;                 // offset of the server clock (in usec): ((T2 - T1) + (T3 - T4)) / 2.
+  INT32  Delay;                  // round-trip delay (in usec): (T4 - T1) - (T3 - T2).
+};
+
+
+/* Burst of 2 requests (interleaved mode): the second request asks for the precise transmit timestamp of the first reply. */
+struct ntp_burst
+{
+  UINT8  FlagOpen;               // flag indicating that the second request has been sent and that its reply is expected.
+  struct ntp_exchange First;     // first exchange (basic mode), as computed by ntp_sync_exchange().
+  struct ntp_packet Info;        // first reply.
+};
+
+
+/* Close a burst of 2 requests and return its first exchange if it was still open. */
+UINT8 ntp_sync_burst_close(struct ntp_burst *Burst, UINT64 Complete, struct ntp_exchange *Exchange);
+
+/* Open a burst of 2 requests, keeping its first exchange to be used in basic mode if the second one fails. */
+void ntp_sync_burst_open(struct ntp_burst *Burst, const struct ntp_exchange *First, const struct ntp_packet *Info);
+
+/* Check a parsed NTP reply and return its status (NTP_SYNC_xxx). */
+UINT8 ntp_sync_check(const struct ntp_packet *Info, INT16 AuthStatus);
+
+/* Feed the offset of an exchange to the disciplined clock, unless PPS disciplines it. */
+UINT8 ntp_sync_discipline(struct ntp_clock *Clock, const struct ntp_exchange *Exchange, UINT8 FlagPpsLocked);
+
+/* Compute the timestamps, offset and round-trip delay of an exchange. */
+void ntp_sync_exchange(struct ntp_clock *Clock, struct ntp_exchange *Exchange);
+
+/* Complete an exchange of interleaved mode with the precise transmit timestamp received in the next reply. */
+UINT8 ntp_sync_interleaved(struct ntp_clock *Clock, struct ntp_exchange *Exchange, ntp_timestamp_t Transmit, UINT64 Complete);
+
+#endif  // _NTP_SYNC_H
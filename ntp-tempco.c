@@ -0,0 +1,323 @@
+/* ============================================================================================================================================================= *\
+   ntp-tempco.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Temperature model of the Pico's crystal used by Pico-NTP-Module (see ntp-tempco.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include <math.h>
+#include <string.h>
+
+#include "ntp-tempco.h"
+
+
+
+/* Add the last temperature recorded, up to the specified Pico timer value, to the measurement interval. */
+static void ntp_tempco_integrate(struct ntp_tempco *Tempco, UINT64 LocalTime);
+
+/* Solve the normal equations of the least squares fit. */
+static void ntp_tempco_solve(struct ntp_tempco *Tempco);
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tempco_correction() */
+/* ============================================================================================================================================================= *\
+                       Return the change of the model frequency (in ppb) since the last call, to be fed forward to the disciplined clock.
+                     NOTE: Both frequencies are computed with the current model: a new fit alone doesn't change the clock frequency, as the
+                           disciplined clock already follows the average frequency error. Return 0 until NTP_TEMPCO_MIN_POINTS measurements are fitted.
+\* ============================================================================================================================================================= */
+INT32 ntp_tempco_correction(struct ntp_tempco *Tempco)
+{
+  INT32 Correction;
+
+
+  if ((Tempco->FlagTemperature == FLAG_OFF) || (Tempco->Points < NTP_TEMPCO_MIN_POINTS)) return 0l;
+
+  if (Tempco->FlagApplied == FLAG_OFF)
+  {
+    Tempco->FlagApplied        = FLAG_ON;
+    Tempco->AppliedTemperature = Tempco->Temperature;
+    return 0l;
+  }
+
+  Correction = ntp_tempco_predict(Tempco, Tempco->Temperature) - ntp_tempco_predict(Tempco, Tempco->AppliedTemperature);
+  Tempco->AppliedTemperature = Tempco->Temperature;
+
+  return Correction;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tempco_fit() */
+/* ============================================================================================================================================================= *\
+                                                  Fit the temperature model with the frequency measurement waiting, if any.
+                 NOTE: To be called from the idle loop: the least squares fit and the solution of the normal equations are too long for an
+                       interrupt handler. Only FlagMeasure and the fit (Matrix, Vector, Coefficient, Points and ResidualPpb) are changed, so that
+                       the fit may be done on a copy of the model. Return 1 if a measurement has been fitted, 0 otherwise.
+\* ============================================================================================================================================================= */
+UINT8 ntp_tempco_fit(struct ntp_tempco *Tempco)
+{
+  UINT8 Loop1UInt8;
+  UINT8 Loop2UInt8;
+
+  double Feature[3];
+  double Ppb;
+
+
+  if (Tempco->FlagMeasure == FLAG_OFF) return 0;
+  Tempco->FlagMeasure = FLAG_OFF;
+
+  /* Pico timer runs fast by Ppb: MeasureLocal = MeasureUTC * (1 + Ppb / 10^9). */
+  Ppb = (Tempco->MeasureUTC > 0) ? ((double)(Tempco->MeasureLocal - Tempco->MeasureUTC) * 1000000000.0) / (double)Tempco->MeasureUTC : (double)(NTP_TEMPCO_MAX_PPB * 2);
+  if ((Ppb >= NTP_TEMPCO_MAX_PPB) || (Ppb <= -NTP_TEMPCO_MAX_PPB) || (Tempco->MeasureSeconds <= 0.0)) return 0;
+
+  /* Mean of x and x^2 over the interval: the fit remains exact for a quadratic model when temperature changes between samples. */
+  Feature[0] = 1.0;
+  Feature[1] = Tempco->MeasureX  / Tempco->MeasureSeconds;
+  Feature[2] = Tempco->MeasureX2 / Tempco->MeasureSeconds;
+
+  if (Tempco->Points >= NTP_TEMPCO_MIN_POINTS)
+    Tempco->ResidualPpb = (INT32)(Ppb - (Tempco->Coefficient[0] + (Tempco->Coefficient[1] * Feature[1]) + (Tempco->Coefficient[2] * Feature[2])));
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < 3; ++Loop1UInt8)
+  {
+    for (Loop2UInt8 = 0; Loop2UInt8 < 3; ++Loop2UInt8)
+      Tempco->Matrix[Loop1UInt8][Loop2UInt8] = (Tempco->Matrix[Loop1UInt8][Loop2UInt8] * NTP_TEMPCO_FORGET) + (Feature[Loop1UInt8] * Feature[Loop2UInt8]);
+    Tempco->Vector[Loop1UInt8] = (Tempco->Vector[Loop1UInt8] * NTP_TEMPCO_FORGET) + (Feature[Loop1UInt8] * Ppb);
+  }
+  ++Tempco->Points;
+  ntp_tempco_solve(Tempco);
+
+  return 1;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tempco_integrate() */
+/* ============================================================================================================================================================= *\
+                              Add the last temperature recorded, up to the specified Pico timer value, to the measurement interval.
+\* ============================================================================================================================================================= */
+static void ntp_tempco_integrate(struct ntp_tempco *Tempco, UINT64 LocalTime)
+{
+  double Seconds;
+  double X;
+
+
+  if ((Tempco->FlagInterval) && (LocalTime > Tempco->LastLocal))
+  {
+    Seconds = (double)(LocalTime - Tempco->LastLocal) / 1000000.0;
+    X       = (double)(Tempco->Temperature - Tempco->Reference) / 1000.0;
+
+    Tempco->SumX    += (X * Seconds);
+    Tempco->SumX2   += (X * X * Seconds);
+    Tempco->Seconds += Seconds;
+  }
+  Tempco->LastLocal = LocalTime;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tempco_predict() */
+/* ============================================================================================================================================================= *\
+                     Return the frequency error of the crystal (in ppb, positive when running fast) predicted by the model at a temperature.
+                           NOTE: Temperatures outside the range recorded so far are clamped: a quadratic fit is not extrapolated.
+\* ============================================================================================================================================================= */
+INT32 ntp_tempco_predict(struct ntp_tempco *Tempco, INT32 Temperature)
+{
+  double X;
+
+
+  if (Temperature < Tempco->Minimum) Temperature = Tempco->Minimum;
+  if (Temperature > Tempco->Maximum) Temperature = Tempco->Maximum;
+
+  X = (double)(Temperature - Tempco->Reference) / 1000.0;
+
+  return (INT32)(Tempco->Coefficient[0] + (Tempco->Coefficient[1] * X) + (Tempco->Coefficient[2] * X * X));
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tempco_reset() */
+/* ============================================================================================================================================================= *\
+                                                                 Initialize a temperature model.
+\* ============================================================================================================================================================= */
+void ntp_tempco_reset(struct ntp_tempco *Tempco)
+{
+  memset(Tempco, 0, sizeof(struct ntp_tempco));
+  Tempco->FlagTemperature = FLAG_OFF;
+  Tempco->FlagInterval    = FLAG_OFF;
+  Tempco->FlagMeasure     = FLAG_OFF;
+  Tempco->FlagApplied     = FLAG_OFF;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tempco_sample() */
+/* ============================================================================================================================================================= *\
+                         Feed a sample of the disciplined clock (Pico timer value and corresponding UTC time) to the temperature model.
+                 NOTE: Called by ntp_clock_sample(). The frequency of the crystal is measured from the raw samples, so that it doesn't depend on
+                       the corrections applied in the meantime. Samples closer than NTP_TEMPCO_MIN_INTERVAL extend the current measurement interval.
+                       The measurement is only recorded here, for ntp_tempco_fit(): a measurement not fitted yet is replaced by the next one.
+\* ============================================================================================================================================================= */
+void ntp_tempco_sample(struct ntp_tempco *Tempco, UINT64 LocalTime, INT64 UTCTime)
+{
+  INT64 ElapsedLocal;
+
+
+  if (Tempco->FlagTemperature == FLAG_OFF) return;
+
+  ntp_tempco_integrate(Tempco, LocalTime);
+
+  if (Tempco->FlagInterval)
+  {
+    ElapsedLocal = (INT64)(LocalTime - Tempco->StartLocal);
+    if (ElapsedLocal < (INT64)NTP_TEMPCO_MIN_INTERVAL) return;
+
+    Tempco->FlagMeasure    = FLAG_ON;
+    Tempco->MeasureLocal   = ElapsedLocal;
+    Tempco->MeasureUTC     = UTCTime - Tempco->StartUTC;
+    Tempco->MeasureX       = Tempco->SumX;
+    Tempco->MeasureX2      = Tempco->SumX2;
+    Tempco->MeasureSeconds = Tempco->Seconds;
+  }
+
+  /* This sample opens the next measurement interval. */
+  Tempco->FlagInterval = FLAG_ON;
+  Tempco->StartLocal   = LocalTime;
+  Tempco->StartUTC     = UTCTime;
+  Tempco->SumX         = 0.0;
+  Tempco->SumX2        = 0.0;
+  Tempco->Seconds      = 0.0;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tempco_solve() */
+/* ============================================================================================================================================================= *\
+                                                      Solve the normal equations of the least squares fit.
+                        NOTE: Gaussian elimination on a 3 x 3 system. NTP_TEMPCO_RIDGE is added to the diagonal for C1 and C2, so that a narrow range
+                              of temperatures gives a flat model instead of a noisy slope. Previous coefficients are kept if the system is singular.
+\* ============================================================================================================================================================= */
+static void ntp_tempco_solve(struct ntp_tempco *Tempco)
+{
+  INT8 Loop1Int8;
+
+  UINT8 Loop1UInt8;
+  UINT8 Loop2UInt8;
+  UINT8 Loop3UInt8;
+  UINT8 Pivot;
+
+  double Factor;
+  double Matrix[3][4];
+  double Temp;
+
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < 3; ++Loop1UInt8)
+  {
+    for (Loop2UInt8 = 0; Loop2UInt8 < 3; ++Loop2UInt8)
+      Matrix[Loop1UInt8][Loop2UInt8] = Tempco->Matrix[Loop1UInt8][Loop2UInt8];
+    Matrix[Loop1UInt8][3] = Tempco->Vector[Loop1UInt8];
+  }
+  Matrix[1][1] += NTP_TEMPCO_RIDGE;
+  Matrix[2][2] += NTP_TEMPCO_RIDGE;
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < 3; ++Loop1UInt8)
+  {
+    /* Partial pivoting. */
+    Pivot = Loop1UInt8;
+    for (Loop2UInt8 = Loop1UInt8 + 1; Loop2UInt8 < 3; ++Loop2UInt8)
+      if (fabs(Matrix[Loop2UInt8][Loop1UInt8]) > fabs(Matrix[Pivot][Loop1UInt8])) Pivot = Loop2UInt8;
+    if (fabs(Matrix[Pivot][Loop1UInt8]) < 1e-12) return;
+
+    for (Loop2UInt8 = 0; Loop2UInt8 < 4; ++Loop2UInt8)
+    {
+      Temp                           = Matrix[Loop1UInt8][Loop2UInt8];
+      Matrix[Loop1UInt8][Loop2UInt8] = Matrix[Pivot][Loop2UInt8];
+      Matrix[Pivot][Loop2UInt8]      = Temp;
+    }
+
+    for (Loop2UInt8 = Loop1UInt8 + 1; Loop2UInt8 < 3; ++Loop2UInt8)
+    {
+      Factor = Matrix[Loop2UInt8][Loop1UInt8] / Matrix[Loop1UInt8][Loop1UInt8];
+      for (Loop3UInt8 = Loop1UInt8; Loop3UInt8 < 4; ++Loop3UInt8)
+        Matrix[Loop2UInt8][Loop3UInt8] -= (Factor * Matrix[Loop1UInt8][Loop3UInt8]);
+    }
+  }
+
+  /* Back substitution. */
+  for (Loop1Int8 = 2; Loop1Int8 >= 0; --Loop1Int8)
+  {
+    Temp = Matrix[Loop1Int8][3];
+    for (Loop2UInt8 = Loop1Int8 + 1; Loop2UInt8 < 3; ++Loop2UInt8)
+      Temp -= (Matrix[Loop1Int8][Loop2UInt8] * Tempco->Coefficient[Loop2UInt8]);
+    Tempco->Coefficient[Loop1Int8] = Temp / Matrix[Loop1Int8][Loop1Int8];
+  }
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tempco_temperature() */
+/* ============================================================================================================================================================= *\
+                                  Record the temperature of the crystal (in 1/1000 degree C) at the specified Pico timer value.
+                     NOTE: Temperature is considered constant until the next call. It should be recorded periodically, at least a few times
+                           per NTP_TEMPCO_MIN_INTERVAL.
+\* ============================================================================================================================================================= */
+void ntp_tempco_temperature(struct ntp_tempco *Tempco, UINT64 LocalTime, INT32 Temperature)
+{
+  if (Tempco->FlagTemperature == FLAG_OFF)
+  {
+    Tempco->FlagTemperature = FLAG_ON;
+    Tempco->Reference       = Temperature;
+    Tempco->Minimum         = Temperature;
+    Tempco->Maximum         = Temperature;
+    Tempco->LastLocal       = LocalTime;
+  }
+
+  ntp_tempco_integrate(Tempco, LocalTime);
+
+  Tempco->Temperature = Temperature;
+  if (Temperature < Tempco->Minimum) Tempco->Minimum = Temperature;
+  if (Temperature > Tempco->Maximum) Tempco->Maximum = Temperature;
+
+  return;
+}
@@ -0,0 +1,82 @@
+/* ============================================================================================================================================================= *\
+   ntp-tempco.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.00
+
+   Temperature model of the Pico's crystal used by Pico-NTP-Module. The frequency error of the crystal is measured between two samples
+   of the disciplined clock (NTP replies or PPS edges) and fitted online against the mean temperature of the same interval, with the
+   model ppb = C0 + C1 x + C2 x^2 (x: temperature, in degree C, relative to the first temperature recorded). Between samples, the
+   change of the model frequency with temperature is fed forward to the disciplined clock (see ntp_clock_adjust_frequency()).
+   Computations use floating point, but they are only done once per sample and once per temperature reading. The least squares fit
+   of a measurement, the longest one, is not done by ntp_tempco_sample() but by ntp_tempco_fit(), to be called from the idle loop.
+   This file doesn't depend on the Pico SDK so that it may also be compiled on a host computer.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_TEMPCO_H
+#define _NTP_TEMPCO_H
+
+#include "baseline.h"
+
+
+#define NTP_TEMPCO_MIN_INTERVAL  600000000ull  // minimum time between two samples (in usec) to measure the frequency of the crystal.
+#define NTP_TEMPCO_MAX_PPB       500000   // frequency measurements larger than this (in ppb) are ignored.
+#define NTP_TEMPCO_MIN_POINTS         6   // frequency measurements required before the model is used.
+#define NTP_TEMPCO_FORGET          0.98   // weight kept by previous measurements at each new one (so that crystal aging is followed).
+#define NTP_TEMPCO_RIDGE            1.0   // regularization of C1 and C2: the model remains flat until temperature has changed enough.
+
+
+struct ntp_tempco
+{
+  UINT8  FlagTemperature;        // flag indicating that at least one temperature has been recorded.
+  INT32  Temperature;            // last temperature recorded (in 1/1000 degree C).
+  INT32  Reference;              // temperature (in 1/1000 degree C) corresponding to x = 0 (first temperature recorded).
+  INT32  Minimum;                // range of temperatures recorded (the model is not extrapolated beyond it).
+  INT32  Maximum;
+  UINT64 LastLocal;              // Pico timer (in usec) when Temperature has been recorded.
+  UINT8  FlagInterval;           // flag indicating that a measurement interval has been opened by a sample.
+  UINT64 StartLocal;             // Pico timer (in usec) of the sample opening the measurement interval.
+  INT64  StartUTC;               // UTC time (in usec since 01-JAN-1970) of the same sample.
+  double SumX;                   // integral of x over the measurement interval (in degree C x sec).
+  double SumX2;                  // integral of x^2 over the measurement interval (in degree C^2 x sec).
+  double Seconds;                // time covered by SumX and SumX2.
+  UINT8  FlagMeasure;            // flag indicating that a frequency measurement waits for ntp_tempco_fit().
+  INT64  MeasureLocal;           // Pico timer time elapsed over the measurement interval (in usec).
+  INT64  MeasureUTC;             // UTC time elapsed over the same interval (in usec).
+  double MeasureX;               // SumX, SumX2 and Seconds of the same interval.
+  double MeasureX2;
+  double MeasureSeconds;
+  double Matrix[3][3];           // normal equations of the least squares fit (older measurements weighted down by NTP_TEMPCO_FORGET).
+  double Vector[3];
+  double Coefficient[3];         // C0 (in ppb), C1 (in ppb / degree C) and C2 (in ppb / degree C^2).
+  UINT32 Points;                 // number of frequency measurements fitted.
+  INT32  ResidualPpb;            // last frequency measurement minus model prediction (before the fit is updated).
+  UINT8  FlagApplied;            // flag indicating that a correction has already been computed.
+  INT32  AppliedTemperature;     // temperature (in 1/1000 degree C) of the last correction.
+};
+
+
+/* Return the change of the model frequency (in ppb) since the last call, to be fed forward to the disciplined clock. */
+INT32 ntp_tempco_correction(struct ntp_tempco *Tempco);
+
+/* Fit the temperature model with the frequency measurement waiting, if any. */
+UINT8 ntp_tempco_fit(struct ntp_tempco *Tempco);
+
+/* Return the frequency error of the crystal (in ppb, positive when running fast) predicted by the model at a temperature. */
+INT32 ntp_tempco_predict(struct ntp_tempco *Tempco, INT32 Temperature);
+
+/* Initialize a temperature model. */
+void ntp_tempco_reset(struct ntp_tempco *Tempco);
+
+/* Feed a sample of the disciplined clock (Pico timer value and corresponding UTC time) to the temperature model. */
+void ntp_tempco_sample(struct ntp_tempco *Tempco, UINT64 LocalTime, INT64 UTCTime);
+
+/* Record the temperature of the crystal (in 1/1000 degree C) at the specified Pico timer value. */
+void ntp_tempco_temperature(struct ntp_tempco *Tempco, UINT64 LocalTime, INT32 Temperature);
+
+#endif  // _NTP_TEMPCO_H
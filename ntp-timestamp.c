@@ -0,0 +1,227 @@
+/* ============================================================================================================================================================= *\
+   ntp-timestamp.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   64-bit NTP timestamps and their arithmetic (see ntp-timestamp.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include "ntp-timestamp.h"
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ts_add() */
+/* ============================================================================================================================================================= *\
+                                                                      Add a difference to a timestamp.
+                                         NOTE: Result wraps around at the end of an NTP era, exactly as NTP timestamps do.
+\* ============================================================================================================================================================= */
+ntp_timestamp_t ntp_ts_add(ntp_timestamp_t Timestamp, ntp_tsdiff_t Difference)
+{
+  return Timestamp + (UINT64)Difference;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ts_diff() */
+/* ============================================================================================================================================================= *\
+                                                     Return the signed difference between two timestamps (TimestampA - TimestampB).
+                         NOTE: Modulo 2^64 arithmetic gives the right answer across era rollover as long as both timestamps are less than 68 years apart.
+\* ============================================================================================================================================================= */
+ntp_tsdiff_t ntp_ts_diff(ntp_timestamp_t TimestampA, ntp_timestamp_t TimestampB)
+{
+  return (ntp_tsdiff_t)(TimestampA - TimestampB);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ts_from_packet() */
+/* ============================================================================================================================================================= *\
+                                                             Read a timestamp from an NTP packet (network byte order).
+\* ============================================================================================================================================================= */
+ntp_timestamp_t ntp_ts_from_packet(const UINT8 *Buffer)
+{
+  UINT8 Loop1UInt8;
+
+  ntp_timestamp_t Timestamp;
+
+
+  Timestamp = 0ull;
+  for (Loop1UInt8 = 0; Loop1UInt8 < 8; ++Loop1UInt8)
+    Timestamp = (Timestamp << 8) | Buffer[Loop1UInt8];
+
+  return Timestamp;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ts_from_unix_us() */
+/* ============================================================================================================================================================= *\
+                                                           Convert Unix time (in usec since 01-JAN-1970) to a timestamp.
+\* ============================================================================================================================================================= */
+ntp_timestamp_t ntp_ts_from_unix_us(INT64 UnixTime)
+{
+  INT64 Microseconds;
+  INT64 Seconds;
+
+
+  /* Split in seconds and microseconds, rounding toward minus infinity. */
+  Seconds      = UnixTime / 1000000ll;
+  Microseconds = UnixTime % 1000000ll;
+  if (Microseconds < 0)
+  {
+    Microseconds += 1000000ll;
+    --Seconds;
+  }
+
+  /* Seconds are truncated to 32 bits: beyond 2036, timestamp belongs to NTP era 1. Fraction is rounded up so that ntp_ts_to_unix_us() gives back the same value. */
+  return ((UINT64)(UINT32)(Seconds + NTP_DELTA) << 32) | (UINT64)((((UINT64)Microseconds << 32) + 999999ull) / 1000000ull);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ts_to_packet() */
+/* ============================================================================================================================================================= *\
+                                                              Write a timestamp to an NTP packet (network byte order).
+\* ============================================================================================================================================================= */
+void ntp_ts_to_packet(ntp_timestamp_t Timestamp, UINT8 *Buffer)
+{
+  UINT8 Loop1UInt8;
+
+
+  for (Loop1UInt8 = 0; Loop1UInt8 < 8; ++Loop1UInt8)
+    Buffer[Loop1UInt8] = (UINT8)(Timestamp >> (56 - (8 * Loop1UInt8)));
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_ts_to_unix_us() */
+/* ============================================================================================================================================================= *\
+                                 Convert a timestamp to Unix time (in usec since 01-JAN-1970), selecting the NTP era closest to a pivot time.
+                     NOTE: PivotTime (Unix time in usec) is usually the current time of the disciplined clock, or NTP_TS_PIVOT if it has never been set.
+                           Result is correct when the timestamp is within 68 years of the pivot time.
+\* ============================================================================================================================================================= */
+INT64 ntp_ts_to_unix_us(ntp_timestamp_t Timestamp, INT64 PivotTime)
+{
+  INT64 PivotSeconds;
+  INT64 Seconds;
+
+
+  /* Pivot time in seconds since 01-JAN-1900 (era 0), then signed distance to the timestamp seconds, modulo 2^32. */
+  PivotSeconds = (PivotTime / 1000000ll) + NTP_DELTA;
+  Seconds      = PivotSeconds + (INT32)((UINT32)(Timestamp >> 32) - (UINT32)PivotSeconds);
+
+  return ((Seconds - NTP_DELTA) * 1000000ll) + (INT64)(((Timestamp & 0xFFFFFFFFull) * 1000000ull) >> 32);
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tsdiff_add() */
+/* ============================================================================================================================================================= *\
+                                                                       Add two differences, with saturation.
+\* ============================================================================================================================================================= */
+ntp_tsdiff_t ntp_tsdiff_add(ntp_tsdiff_t DifferenceA, ntp_tsdiff_t DifferenceB)
+{
+  if ((DifferenceB > 0) && (DifferenceA > (NTP_TSDIFF_MAX - DifferenceB))) return NTP_TSDIFF_MAX;
+  if ((DifferenceB < 0) && (DifferenceA < (NTP_TSDIFF_MIN - DifferenceB))) return NTP_TSDIFF_MIN;
+
+  return DifferenceA + DifferenceB;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tsdiff_from_us() */
+/* ============================================================================================================================================================= *\
+                                                                   Convert a number of usec to a difference.
+\* ============================================================================================================================================================= */
+ntp_tsdiff_t ntp_tsdiff_from_us(INT64 Microseconds)
+{
+  INT64 Remainder;
+  INT64 Seconds;
+
+
+  Seconds   = Microseconds / 1000000ll;
+  Remainder = Microseconds % 1000000ll;
+  if (Remainder < 0)
+  {
+    Remainder += 1000000ll;
+    --Seconds;
+  }
+
+  if (Seconds >  0x7FFFFFFFll) return NTP_TSDIFF_MAX;
+  if (Seconds < -0x80000000ll) return NTP_TSDIFF_MIN;
+
+  return (ntp_tsdiff_t)(((UINT64)Seconds << 32) + (((UINT64)Remainder << 32) / 1000000ull));
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tsdiff_sub() */
+/* ============================================================================================================================================================= *\
+                                                                     Subtract two differences, with saturation.
+\* ============================================================================================================================================================= */
+ntp_tsdiff_t ntp_tsdiff_sub(ntp_tsdiff_t DifferenceA, ntp_tsdiff_t DifferenceB)
+{
+  if ((DifferenceB < 0) && (DifferenceA > (NTP_TSDIFF_MAX + DifferenceB))) return NTP_TSDIFF_MAX;
+  if ((DifferenceB > 0) && (DifferenceA < (NTP_TSDIFF_MIN + DifferenceB))) return NTP_TSDIFF_MIN;
+
+  return DifferenceA - DifferenceB;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_tsdiff_to_us() */
+/* ============================================================================================================================================================= *\
+                                                            Convert a difference to a number of usec (rounded to nearest).
+\* ============================================================================================================================================================= */
+INT64 ntp_tsdiff_to_us(ntp_tsdiff_t Difference)
+{
+  INT64 Seconds;
+
+  UINT64 Fraction;
+
+
+  /* Arithmetic shift rounds seconds toward minus infinity, fraction is then always positive. */
+  Seconds  = Difference >> 32;
+  Fraction = (UINT64)Difference & 0xFFFFFFFFull;
+
+  return (Seconds * 1000000ll) + (INT64)(((Fraction * 1000000ull) + 0x80000000ull) >> 32);
+}
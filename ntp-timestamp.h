@@ -0,0 +1,66 @@
+/* ============================================================================================================================================================= *\
+   ntp-timestamp.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.00
+
+   64-bit NTP timestamps (32-bit seconds since 01-JAN-1900 and 32-bit fraction of second) and their arithmetic.
+   Differences between two timestamps are kept in the same 32.32 fixed-point format (signed), so that offset and delay computations
+   don't lose precision and remain correct across NTP era rollover (07-FEB-2036).
+   This file doesn't depend on the Pico SDK so that it may also be compiled on a host computer.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_TIMESTAMP_H
+#define _NTP_TIMESTAMP_H
+
+#include "baseline.h"
+
+
+#define NTP_DELTA         2208988800   // number of seconds between 01-JAN-1900 and 01-JAN-1970.
+#define NTP_ERA_SECONDS  4294967296ll  // number of seconds in an NTP era (2^32).
+#define NTP_TS_PIVOT      1767225600ll // Unix time (01-JAN-2026) used to select NTP era when no better reference is available.
+
+#define NTP_TSDIFF_MAX     INT64_MAX   // saturation values of a timestamp difference.
+#define NTP_TSDIFF_MIN     INT64_MIN
+
+
+typedef UINT64 ntp_timestamp_t;        // NTP timestamp: seconds since beginning of NTP era (upper 32 bits) and fraction of second (lower 32 bits).
+typedef INT64  ntp_tsdiff_t;           // signed difference between two NTP timestamps, same 32.32 fixed-point format.
+
+
+/* Add a difference to a timestamp. */
+ntp_timestamp_t ntp_ts_add(ntp_timestamp_t Timestamp, ntp_tsdiff_t Difference);
+
+/* Return the signed difference between two timestamps (TimestampA - TimestampB). */
+ntp_tsdiff_t ntp_ts_diff(ntp_timestamp_t TimestampA, ntp_timestamp_t TimestampB);
+
+/* Read a timestamp from an NTP packet (network byte order). */
+ntp_timestamp_t ntp_ts_from_packet(const UINT8 *Buffer);
+
+/* Convert Unix time (in usec since 01-JAN-1970) to a timestamp. */
+ntp_timestamp_t ntp_ts_from_unix_us(INT64 UnixTime);
+
+/* Write a timestamp to an NTP packet (network byte order). */
+void ntp_ts_to_packet(ntp_timestamp_t Timestamp, UINT8 *Buffer);
+
+/* Convert a timestamp to Unix time (in usec since 01-JAN-1970), selecting the NTP era closest to a pivot time. */
+INT64 ntp_ts_to_unix_us(ntp_timestamp_t Timestamp, INT64 PivotTime);
+
+/* Add two differences, with saturation. */
+ntp_tsdiff_t ntp_tsdiff_add(ntp_tsdiff_t DifferenceA, ntp_tsdiff_t DifferenceB);
+
+/* Convert a number of usec to a difference. */
+ntp_tsdiff_t ntp_tsdiff_from_us(INT64 Microseconds);
+
+/* Subtract two differences, with saturation. */
+ntp_tsdiff_t ntp_tsdiff_sub(ntp_tsdiff_t DifferenceA, ntp_tsdiff_t DifferenceB);
+
+/* Convert a difference to a number of usec (rounded to nearest). */
+INT64 ntp_tsdiff_to_us(ntp_tsdiff_t Difference);
+
+#endif  // _NTP_TIMESTAMP_H
@@ -0,0 +1,318 @@
+/* ============================================================================================================================================================= *\
+   ntp-trace.c
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Language: C
+   Version 1.00
+
+   Trace recorder used by Pico-NTP-Module (see ntp-trace.h).
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+\* ============================================================================================================================================================= */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ntp-trace.h"
+
+
+/* Same locking as ntp-log.c: a slot of the ring buffer is reserved under a hardware spin lock, so that both cores and interrupt handlers may write records. */
+#if PICO_ON_DEVICE
+#include "hardware/sync.h"
+#define NTP_TRACE_LOCK(Mask)    Mask = spin_lock_blocking(TraceLock)
+#define NTP_TRACE_UNLOCK(Mask)  spin_unlock(TraceLock, Mask)
+#else   // PICO_ON_DEVICE
+#define NTP_TRACE_LOCK(Mask)    Mask = 0
+#define NTP_TRACE_UNLOCK(Mask)  (void)Mask
+#endif  // PICO_ON_DEVICE
+
+
+
+/* Copy the next record waiting in the ring buffer. */
+static UINT8 ntp_trace_next(struct ntp_trace_record *Record);
+
+
+
+/* Global variables. */
+static struct ntp_trace_record TraceBuffer[NTP_TRACE_SIZE];
+static volatile UINT32 TraceHead;  // position of the next record to be written.
+static UINT32 TraceTail;           // position of the next record to be read.
+static UINT32 TraceLost;           // records overwritten before being read, not reported yet.
+static volatile UINT8 TraceMask;   // categories of records currently written.
+static volatile UINT32 TraceStateAge;  // records written since the last snapshot of the disciplined clock.
+
+#if PICO_ON_DEVICE
+static spin_lock_t *TraceLock;     // hardware spin lock claimed by ntp_trace_init().
+#endif  // PICO_ON_DEVICE
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_trace_drain() */
+/* ============================================================================================================================================================= *\
+                                                       Send records waiting in the ring buffer to stdout.
+                NOTE: To be called from the idle loop (never from an interrupt handler). Each record is sent as a single line beginning with
+                      NTP_TRACE_TAG followed by the bytes of the record in hexadecimal, that ntp-replay.c reads on the host computer. Records
+                      overwritten before being sent are reported as an NTP_TRACE_LOST record. Return the number of records sent.
+\* ============================================================================================================================================================= */
+UINT16 ntp_trace_drain(UINT16 MaxRecords)
+{
+  static const UCHAR Hex[] = "0123456789ABCDEF";
+
+  UCHAR Line[(2 * sizeof(struct ntp_trace_record)) + 1];
+
+  UINT8 *Byte;
+
+  UINT16 Count;
+  UINT16 Loop1UInt16;
+
+  struct ntp_trace_record Record;
+
+
+  Count = 0;
+  while ((Count < MaxRecords) && (ntp_trace_next(&Record)))
+  {
+    Byte = (UINT8 *)&Record;
+    for (Loop1UInt16 = 0; Loop1UInt16 < sizeof(Record); ++Loop1UInt16)
+    {
+      Line[2 * Loop1UInt16]       = Hex[Byte[Loop1UInt16] >> 4];
+      Line[(2 * Loop1UInt16) + 1] = Hex[Byte[Loop1UInt16] & 0x0F];
+    }
+    Line[2 * sizeof(Record)] = 0x00;
+
+    printf("%s %s\r", NTP_TRACE_TAG, Line);
+    ++Count;
+  }
+
+  return Count;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_trace_enable() */
+/* ============================================================================================================================================================= *\
+                                                           Select categories of records to be written.
+                       NOTE: The next record is preceded by a snapshot of the disciplined clock, where a replay may start.
+\* ============================================================================================================================================================= */
+void ntp_trace_enable(UINT8 CategoryMask)
+{
+  TraceStateAge = NTP_TRACE_STATE_PERIOD;
+  TraceMask     = CategoryMask;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_trace_init() */
+/* ============================================================================================================================================================= *\
+                                                                 Initialize the trace recorder.
+\* ============================================================================================================================================================= */
+void ntp_trace_init(UINT8 CategoryMask)
+{
+  TraceMask = 0;
+
+#if PICO_ON_DEVICE
+  if (TraceLock == NULL) TraceLock = spin_lock_init(spin_lock_claim_unused(true));
+#endif  // PICO_ON_DEVICE
+
+  TraceTail = TraceHead;
+  TraceLost = 0;
+  ntp_trace_enable(CategoryMask);
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_trace_next() */
+/* ============================================================================================================================================================= *\
+                                                        Copy the next record waiting in the ring buffer.
+                 NOTE: Same protocol as ntp_log_drain(): a record still being written stops the copy, a record overwritten while being copied
+                       is counted as lost. Lost records are reported first, as an NTP_TRACE_LOST record. Return 0 if no record is waiting.
+\* ============================================================================================================================================================= */
+static UINT8 ntp_trace_next(struct ntp_trace_record *Record)
+{
+  UINT32 Head;
+
+
+  while (1)
+  {
+    Head = TraceHead;
+    if (TraceTail == Head) return 0;
+
+    /* Writers went around the ring buffer: skip records that have been overwritten. */
+    if ((Head - TraceTail) > NTP_TRACE_SIZE)
+    {
+      TraceLost += (Head - TraceTail) - NTP_TRACE_SIZE;
+      TraceTail  = Head - NTP_TRACE_SIZE;
+    }
+
+    if (TraceLost)
+    {
+      memset(Record, 0x00, sizeof(struct ntp_trace_record));
+      Record->Type              = NTP_TRACE_LOST;
+      Record->Sequence          = TraceTail;
+      Record->Temperature       = NTP_TRACE_NO_TEMPERATURE;
+      Record->Data.Sample.Value = TraceLost;
+      TraceLost = 0;
+      return 1;
+    }
+
+    /* Copy the record, then make sure that it was complete and has not been overwritten while we were copying it. */
+    *Record = TraceBuffer[TraceTail & (NTP_TRACE_SIZE - 1)];
+    __asm volatile ("" ::: "memory");
+    if (Record->Sequence == 0) return 0;  // still being written by an interrupt handler.
+
+    if ((Record->Sequence != (TraceTail + 1)) || (TraceBuffer[TraceTail & (NTP_TRACE_SIZE - 1)].Sequence != Record->Sequence))
+    {
+      ++TraceLost;
+      ++TraceTail;
+      continue;
+    }
+    ++TraceTail;
+
+    return 1;
+  }
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_trace_read() */
+/* ============================================================================================================================================================= *\
+                                                            Copy records waiting in the ring buffer.
+            NOTE: For applications keeping the trace themselves (flash, network). Not to be mixed with ntp_trace_drain(). Return the number of records copied.
+\* ============================================================================================================================================================= */
+UINT16 ntp_trace_read(struct ntp_trace_record *Buffer, UINT16 MaxRecords)
+{
+  UINT16 Count;
+
+
+  Count = 0;
+  while ((Count < MaxRecords) && (ntp_trace_next(&Buffer[Count]))) ++Count;
+
+  return Count;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_trace_restore() */
+/* ============================================================================================================================================================= *\
+                                                       Restore a disciplined clock from a snapshot record.
+                         NOTE: Temperature model and stability analyzer attached to the clock, if any, are kept.
+\* ============================================================================================================================================================= */
+void ntp_trace_restore(struct ntp_clock *Clock, const struct ntp_trace_record *Record)
+{
+  Clock->FlagValid     = Record->Data.State.FlagValid;
+  Clock->Source        = Record->Data.State.Source;
+  Clock->BaseLocal     = Record->Data.State.BaseLocal;
+  Clock->BaseUTC       = Record->Data.State.BaseUTC;
+  Clock->PendingOffset = Record->Data.State.PendingOffset;
+  Clock->FrequencyPpb  = Record->Data.State.FrequencyPpb;
+  Clock->LastOffset    = Record->Data.State.LastOffset;
+  Clock->LastSample    = Record->Data.State.LastSample;
+  Clock->SampleCount   = Record->Data.State.SampleCount;
+  Clock->StepCount     = Record->Data.State.StepCount;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_trace_snapshot() */
+/* ============================================================================================================================================================= *\
+                                                        Fill a snapshot record from a disciplined clock.
+                    NOTE: Only the type and the State part are set: temperature and read cycle are left to the caller.
+\* ============================================================================================================================================================= */
+void ntp_trace_snapshot(struct ntp_clock *Clock, struct ntp_trace_record *Record)
+{
+  memset(Record, 0x00, sizeof(struct ntp_trace_record));
+
+  Record->Type                     = NTP_TRACE_STATE;
+  Record->Data.State.FlagValid     = Clock->FlagValid;
+  Record->Data.State.Source        = Clock->Source;
+  Record->Data.State.BaseLocal     = Clock->BaseLocal;
+  Record->Data.State.BaseUTC       = Clock->BaseUTC;
+  Record->Data.State.PendingOffset = Clock->PendingOffset;
+  Record->Data.State.FrequencyPpb  = Clock->FrequencyPpb;
+  Record->Data.State.LastOffset    = Clock->LastOffset;
+  Record->Data.State.LastSample    = Clock->LastSample;
+  Record->Data.State.SampleCount   = Clock->SampleCount;
+  Record->Data.State.StepCount     = Clock->StepCount;
+
+  return;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_trace_state_due() */
+/* ============================================================================================================================================================= *\
+                         Return 1 when a snapshot of the disciplined clock must be written before the next record of the category given.
+\* ============================================================================================================================================================= */
+UINT8 ntp_trace_state_due(UINT8 Category)
+{
+  return (((TraceMask & Category) != 0) && (TraceStateAge >= NTP_TRACE_STATE_PERIOD)) ? 1 : 0;
+}
+
+
+
+
+
+/* $PAGE */
+/* $TITLE=ntp_trace_write() */
+/* ============================================================================================================================================================= *\
+                                                               Write a record in the ring buffer.
+                  NOTE: Never blocks: when the ring buffer is full, the oldest record is overwritten. Only a test of the category mask when the
+                        category is disabled. May be called from interrupt handlers. Sequence is set here.
+\* ============================================================================================================================================================= */
+void ntp_trace_write(UINT8 Category, struct ntp_trace_record *Record)
+{
+  UINT32 Index;
+  UINT32 Mask;
+
+  struct ntp_trace_record *Slot;
+
+
+  if ((TraceMask & Category) == 0) return;
+
+  NTP_TRACE_LOCK(Mask);
+  Index = TraceHead++;
+  TraceStateAge = (Record->Type == NTP_TRACE_STATE) ? 0 : TraceStateAge + 1;
+  NTP_TRACE_UNLOCK(Mask);
+
+  Slot = &TraceBuffer[Index & (NTP_TRACE_SIZE - 1)];
+  Slot->Sequence = 0;
+  __asm volatile ("" ::: "memory");
+  memcpy(((UINT8 *)Slot) + sizeof(Slot->Sequence), ((UINT8 *)Record) + sizeof(Record->Sequence), sizeof(struct ntp_trace_record) - sizeof(Record->Sequence));
+  __asm volatile ("" ::: "memory");
+  Slot->Sequence = Index + 1;
+
+  return;
+}
+
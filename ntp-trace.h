@@ -0,0 +1,150 @@
+/* ============================================================================================================================================================= *\
+   ntp-trace.h
+   St-Louys, Andre - October 2026
+   astlouys@gmail.com
+   Revision 18-OCT-2026
+   Version 1.10
+
+   Trace recorder used by Pico-NTP-Module. Every NTP exchange (T1 to T4, server, stratum, leap indicator, status and temperature) and every
+   other input of the disciplined clock (PPS edges, broadcasts, holdover clock, frequency feed-forward, leap seconds) is written as a
+   fixed-size binary record in a ring buffer, together with a snapshot of the disciplined clock every NTP_TRACE_STATE_PERIOD records.
+   The ring buffer is drained from the idle loop by ntp_trace_drain() (one line of hexadecimal per record) or copied by ntp_trace_read().
+   On the host computer, ntp-replay.c replays the records through the same code (ntp-sync.c and ntp-clock.c), starting from a snapshot:
+   the result is bit-exact, so that algorithm changes may be benchmarked on real field data.
+   Records are written in the Pico's byte order (little endian), and have the same layout on the usual host computers.
+   This file doesn't depend on the Pico SDK so that it may also be compiled on a host computer.
+
+   REVISION HISTORY:
+   =================
+   18-OCT-2026 1.00 - Initial release.
+               1.10 - Exchanges of NTP interleaved mode (completion time of the exchange added to the record).
+\* ============================================================================================================================================================= */
+
+#ifndef _NTP_TRACE_H
+#define _NTP_TRACE_H
+
+#include "baseline.h"
+#include "ntp-clock.h"
+#include "ntp-timestamp.h"
+
+
+#define NTP_TRACE_SIZE            64   // number of records in the ring buffer (must be a power of 2).
+#define NTP_TRACE_STATE_PERIOD    16   // a snapshot of the disciplined clock is written before the first record and then every this many records.
+#define NTP_TRACE_TAG      "#NTPTRC"   // beginning of the lines sent by ntp_trace_drain().
+#define NTP_TRACE_NO_TEMPERATURE  ((INT16)0x8000)  // temperature not known.
+
+/* Categories of records (bit mask given to ntp_trace_enable()). */
+#define NTP_TRACE_EXCHANGE      0x01   // NTP replies (valid or not) and requests without reply.
+#define NTP_TRACE_CLOCK         0x02   // other inputs of the disciplined clock, except PPS edges.
+#define NTP_TRACE_PPS           0x04   // PPS edges (one record per second).
+#define NTP_TRACE_ALL           0xFF
+
+/* Types of records. */
+#define NTP_TRACE_LOST             0   // records overwritten before being read (Sample.Value: number of records lost).
+#define NTP_TRACE_REPLY            1   // NTP reply received (Exchange).
+#define NTP_TRACE_TIMEOUT          2   // no reply to an NTP request (Exchange: Send and Status only).
+#define NTP_TRACE_SAMPLE           3   // sample fed to the disciplined clock other than an NTP reply (Sample.Value: UTC time in usec).
+#define NTP_TRACE_ADJUST           4   // frequency feed-forward (Sample.Value: frequency change in ppb).
+#define NTP_TRACE_LEAP             5   // leap second applied to the disciplined clock (Sample.Value: seconds removed from UTC time).
+#define NTP_TRACE_STATE            6   // snapshot of the disciplined clock (State).
+
+/* Flags of a record. */
+#define NTP_TRACE_FLAG_FIRST    0x01   // first valid reply of a read cycle: the one used to discipline the clock.
+#define NTP_TRACE_FLAG_PPS      0x02   // PPS was locked when the reply has been received.
+#define NTP_TRACE_FLAG_IPV6     0x04   // reply received through IPv6 (Server: last 32 bits of the address).
+#define NTP_TRACE_FLAG_BROADCAST 0x08  // sample computed from a broadcast NTP packet.
+#define NTP_TRACE_FLAG_INTERLEAVED 0x10  // interleaved reply: the exchange is the previous one, completed by this reply (see ntp_sync_interleaved()).
+
+
+/* NTP exchange (NTP_TRACE_REPLY and NTP_TRACE_TIMEOUT records). */
+struct ntp_trace_exchange
+{
+  UINT64 Send;                   // Pico timer (in usec) when the request has been sent.
+  UINT64 Receive;                // Pico timer (in usec) when the reply has been received.
+  UINT64 Complete;               // Pico timer (in usec) when the exchange has been completed (see struct ntp_exchange).
+  ntp_timestamp_t T1;            // origin, receive, transmit and destination timestamps, as computed by ntp_sync_exchange().
+  ntp_timestamp_t T2;
+  ntp_timestamp_t T3;
+  ntp_timestamp_t T4;
+  UINT32 Server;                 // IPv4 address of the server (network byte order).
+  UINT32 RootDelay;              // root delay of the server (in usec).
+  UINT32 RootDispersion;         // root dispersion of the server (in usec).
+  INT32  Delay;                  // round-trip delay (in usec).
+  INT64  Offset;                 // offset of the server clock (in usec).
+  UINT8  Status;                 // status of the reply (NTP_SYNC_xxx, see ntp-sync.h).
+  UINT8  Stratum;
+  UINT8  LeapIndicator;
+  UINT8  Mode;
+  UINT8  Reserved[4];
+};
+
+
+/* Other input of the disciplined clock (NTP_TRACE_SAMPLE, NTP_TRACE_ADJUST, NTP_TRACE_LEAP and NTP_TRACE_LOST records). */
+struct ntp_trace_sample
+{
+  UINT64 LocalTime;              // Pico timer (in usec) of the sample or of the frequency change.
+  INT64  Value;                  // depends on the record type (see NTP_TRACE_xxx).
+  UINT8  Source;                 // source of a sample (NTP_SOURCE_xxx).
+  UINT8  Reserved[7];
+};
+
+
+/* Snapshot of the disciplined clock (NTP_TRACE_STATE records). */
+struct ntp_trace_state
+{
+  UINT64 BaseLocal;
+  INT64  BaseUTC;
+  INT64  PendingOffset;
+  INT64  LastOffset;
+  UINT64 LastSample;
+  UINT32 SampleCount;
+  UINT32 StepCount;
+  INT32  FrequencyPpb;
+  UINT8  FlagValid;
+  UINT8  Source;
+  UINT8  Reserved[2];
+};
+
+
+struct ntp_trace_record
+{
+  UINT32 Sequence;               // position of the record in the trace plus one, written last (0 while the record is being written).
+  UINT8  Type;                   // type of record (NTP_TRACE_xxx).
+  UINT8  Flags;                  // NTP_TRACE_FLAG_xxx.
+  INT16  Temperature;            // crystal temperature (in 1/100 degree C) or NTP_TRACE_NO_TEMPERATURE.
+  UINT32 Cycle;                  // read cycle of the module when the record has been written.
+  UINT32 Reserved;
+  union
+  {
+    struct ntp_trace_exchange Exchange;
+    struct ntp_trace_sample   Sample;
+    struct ntp_trace_state    State;
+  } Data;
+};
+
+
+/* Send records waiting in the ring buffer to stdout. */
+UINT16 ntp_trace_drain(UINT16 MaxRecords);
+
+/* Select categories of records to be written. */
+void ntp_trace_enable(UINT8 CategoryMask);
+
+/* Initialize the trace recorder. */
+void ntp_trace_init(UINT8 CategoryMask);
+
+/* Copy records waiting in the ring buffer. */
+UINT16 ntp_trace_read(struct ntp_trace_record *Buffer, UINT16 MaxRecords);
+
+/* Restore a disciplined clock from a snapshot record. */
+void ntp_trace_restore(struct ntp_clock *Clock, const struct ntp_trace_record *Record);
+
+/* Fill a snapshot record from a disciplined clock. */
+void ntp_trace_snapshot(struct ntp_clock *Clock, struct ntp_trace_record *Record);
+
+/* Return 1 when a snapshot of the disciplined clock must be written before the next record of the category given. */
+UINT8 ntp_trace_state_due(UINT8 Category);
+
+/* Write a record in the ring buffer. */
+void ntp_trace_write(UINT8 Category, struct ntp_trace_record *Record);
+
+#endif  // _NTP_TRACE_H